@@ -53,6 +53,86 @@ class TagsCommand(Command):
         return os.system(cmd)
     
 
+class MockDriverCommand(Command):
+
+    description = "builds the mock ODBC driver used by tests/mockbenchmarks.py"
+
+    user_options = [ ('build-dir=', 'b', 'directory for the driver library (default build/mockdriver)') ]
+
+    def initialize_options(self):
+        self.build_dir = None
+
+    def finalize_options(self):
+        if self.build_dir is None:
+            self.build_dir = join('build', 'mockdriver')
+
+    def run(self):
+        # The driver is loaded by unixODBC or iODBC using its path.  Windows drivers have to be registered, so it isn't
+        # built there.
+        if os.name == 'nt':
+            raise DistutilsPlatformError('The mock driver can only be built for unixODBC and iODBC')
+
+        from distutils.ccompiler import new_compiler
+        from distutils.sysconfig import customize_compiler
+
+        compiler = new_compiler(verbose=self.verbose)
+        customize_compiler(compiler)
+
+        objects = compiler.compile([ join('utils', 'mockdriver', 'mockdriver.cpp') ], output_dir=self.build_dir,
+                                   extra_postargs=['-fPIC', '-O2'])
+        compiler.link_shared_object(objects, 'libpyodbcmock.so', output_dir=self.build_dir)
+
+        print 'Built %s' % abspath(join(self.build_dir, 'libpyodbcmock.so'))
+
+
+class KernelBenchCommand(Command):
+
+    description = "builds the native microbenchmarks in utils/kernelbench"
+
+    user_options = [ ('build-dir=', 'b', 'directory for the executable (default build/kernelbench)') ]
+
+    def initialize_options(self):
+        self.build_dir = None
+
+    def finalize_options(self):
+        if self.build_dir is None:
+            self.build_dir = join('build', 'kernelbench')
+
+    def run(self):
+        # The benchmarks embed Python and compile the pyodbc sources directly, with PYODBC_BENCH defined so the
+        # private conversion functions are reachable.
+        from distutils.ccompiler import new_compiler
+        from distutils.sysconfig import customize_compiler, get_python_inc, get_config_var
+
+        version_str, version = get_version()
+        settings = get_compiler_settings(version_str)
+
+        compiler = new_compiler(verbose=self.verbose)
+        customize_compiler(compiler)
+
+        files = [ join('src', f) for f in os.listdir('src') if f.endswith('.cpp') ]
+        files.append(join('utils', 'kernelbench', 'kernelbench.cpp'))
+
+        objects = compiler.compile(files, output_dir=self.build_dir,
+                                   macros=settings['define_macros'] + [ ('PYODBC_BENCH', 1) ],
+                                   include_dirs=[ 'src', get_python_inc() ],
+                                   extra_postargs=settings.get('extra_compile_args', []) + [ '-O2' ])
+
+        if os.name == 'nt':
+            libraries = settings['libraries']
+            library_dirs = [ join(sys.exec_prefix, 'libs') ]
+            extra_args = []
+        else:
+            libraries = settings['libraries'] + [ 'python%s' % get_config_var('VERSION') ]
+            library_dirs = [ get_config_var('LIBDIR') ]
+            extra_args = ' '.join([ get_config_var(name) or '' for name in ('LIBS', 'SYSLIBS', 'LINKFORSHARED') ]).split()
+
+        compiler.link_executable(objects, 'kernelbench', output_dir=self.build_dir, libraries=libraries,
+                                 library_dirs=library_dirs, extra_postargs=extra_args)
+
+        print 'Built %s' % abspath(compiler.executable_filename('kernelbench', output_dir=self.build_dir))
+
+
 
 def main():
 
@@ -95,8 +175,10 @@ def main():
 
            url = 'http://code.google.com/p/pyodbc',
            download_url = 'http://code.google.com/p/pyodbc/downloads/list',
-           cmdclass = { 'version' : VersionCommand,
-                        'tags'    : TagsCommand })
+           cmdclass = { 'version'    : VersionCommand,
+                        'tags'       : TagsCommand,
+                        'mockdriver' : MockDriverCommand,
+                        'kernelbench': KernelBenchCommand })
 
 
 
@@ -107,7 +189,7 @@ def get_compiler_settings(version_str):
 
     # This isn't the best or right way to do this, but I don't see how someone is supposed to sanely subclass the build
     # command.
-    for option in ['assert', 'trace', 'leak-check']:
+    for option in ['assert', 'trace']:
         try:
             sys.argv.remove('--%s' % option)
             settings['define_macros'].append(('PYODBC_%s' % option.replace('-', '_'), 1))
@@ -144,6 +226,10 @@ def get_compiler_settings(version_str):
         # What is the proper way to detect iODBC, MyODBC, unixODBC, etc.?
         settings['libraries'].append('odbc')
 
+        # Older versions of glibc keep clock_gettime, used for the native timers, in librt.
+        if sys.platform.startswith('linux'):
+            settings['libraries'].append('rt')
+
     get_config(settings, version_str)
 
     return settings
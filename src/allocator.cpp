@@ -0,0 +1,171 @@
+
+// pyodbc_malloc and friends, with allocation accounting that can be turned on at runtime.
+//
+// Every block is preceded by a small header holding its size and category, so freeing a block never requires a lookup
+// and the accounting costs only a few atomic adds.  The header is always written, whether or not tracking is on, so
+// blocks can be freed correctly after tracking is turned on or off.
+
+#include "pyodbc.h"
+#include "threads.h"
+#include "wrapper.h"
+
+struct BlockHeader
+{
+    size_t len;
+    unsigned int category;
+    unsigned int tracked;       // non-zero if the block was counted when it was allocated
+};
+
+// The header is padded so the memory returned is aligned for any type, as with malloc.
+#define HEADER_SIZE 16
+
+struct CategoryCounts
+{
+    UINT64 live_bytes;
+    UINT64 live_blocks;
+    UINT64 peak_bytes;
+    UINT64 allocs;
+    UINT64 frees;
+};
+
+static const char* const category_names[MEM_CATEGORY_COUNT] =
+{
+    "other",
+    "colinfos",
+    "paraminfos",
+    "rowvalues",
+    "decimal",
+    "sqlwchar",
+    "rawrows",
+};
+
+bool memory_tracking = false;
+
+static CategoryCounts counts[MEM_CATEGORY_COUNT];
+static CategoryCounts total;
+
+// When tracking was last turned on, used to report allocation rates.
+static UINT64 tracking_started = 0;
+
+static void UpdatePeak(volatile UINT64* peak, UINT64 live)
+{
+    // Peaks are not updated atomically, so one may be missed if two threads allocate at the same moment.  This is only
+    // for reporting and it is not worth a compare-and-swap loop on every allocation.
+    if (live > *peak)
+        *peak = live;
+}
+
+static void CountAlloc(unsigned int category, size_t len)
+{
+    UpdatePeak(&counts[category].peak_bytes, AtomicAdd(&counts[category].live_bytes, len));
+    UpdatePeak(&total.peak_bytes, AtomicAdd(&total.live_bytes, len));
+    AtomicAdd(&counts[category].live_blocks, 1);
+    AtomicAdd(&total.live_blocks, 1);
+    AtomicAdd(&counts[category].allocs, 1);
+    AtomicAdd(&total.allocs, 1);
+}
+
+static void CountFree(unsigned int category, size_t len)
+{
+    AtomicAdd(&counts[category].live_bytes, (UINT64)0 - len);
+    AtomicAdd(&total.live_bytes, (UINT64)0 - len);
+    AtomicAdd(&counts[category].live_blocks, (UINT64)0 - 1);
+    AtomicAdd(&total.live_blocks, (UINT64)0 - 1);
+    AtomicAdd(&counts[category].frees, 1);
+    AtomicAdd(&total.frees, 1);
+}
+
+void* pyodbc_malloc(size_t len, MemoryCategory category)
+{
+    char* p = (char*)malloc(len + HEADER_SIZE);
+    if (p == 0)
+        return 0;
+
+    BlockHeader* header = (BlockHeader*)p;
+    header->len      = len;
+    header->category = (unsigned int)category;
+    header->tracked  = memory_tracking ? 1 : 0;
+
+    if (header->tracked)
+        CountAlloc(header->category, len);
+
+    return p + HEADER_SIZE;
+}
+
+void* pyodbc_realloc(void* p, size_t len)
+{
+    if (p == 0)
+        return pyodbc_malloc(len);
+
+    BlockHeader* header = (BlockHeader*)((char*)p - HEADER_SIZE);
+    size_t oldlen = header->len;
+
+    header = (BlockHeader*)realloc(header, len + HEADER_SIZE);
+    if (header == 0)
+        return 0;
+
+    header->len = len;
+
+    if (header->tracked)
+    {
+        // Counted as freeing the old size and allocating the new one.
+        CountFree(header->category, oldlen);
+        CountAlloc(header->category, len);
+    }
+
+    return (char*)header + HEADER_SIZE;
+}
+
+void pyodbc_free(void* p)
+{
+    if (p == 0)
+        return;
+
+    BlockHeader* header = (BlockHeader*)((char*)p - HEADER_SIZE);
+
+    if (header->tracked)
+        CountFree(header->category, header->len);
+
+    free(header);
+}
+
+void EnableMemoryTracking(bool enable)
+{
+    if (enable && !memory_tracking)
+        tracking_started = MonotonicMicroseconds();
+    memory_tracking = enable;
+}
+
+static PyObject* CountsToDict(const CategoryCounts& c, double seconds)
+{
+    return Py_BuildValue("{sKsKsKsKsKsd}",
+                         "live_bytes",  c.live_bytes,
+                         "live_blocks", c.live_blocks,
+                         "peak_bytes",  c.peak_bytes,
+                         "allocs",      c.allocs,
+                         "frees",       c.frees,
+                         "alloc_rate",  seconds > 0 ? (double)c.allocs / seconds : 0.0);
+}
+
+PyObject* MemoryStats_ToDict()
+{
+    // The allocation rate is the number of allocations per second since tracking was turned on.
+    double seconds = tracking_started ? (double)(MonotonicMicroseconds() - tracking_started) / 1000000.0 : 0.0;
+
+    Object result(PyDict_New());
+    if (!result)
+        return 0;
+
+    for (int i = 0; i < MEM_CATEGORY_COUNT; i++)
+    {
+        Object item(CountsToDict(counts[i], seconds));
+        if (!item || PyDict_SetItemString(result, category_names[i], item) != 0)
+            return 0;
+    }
+
+    Object item(CountsToDict(total, seconds));
+    if (!item || PyDict_SetItemString(result, "total", item) != 0)
+        return 0;
+
+    return result.Detach();
+}
@@ -0,0 +1,674 @@
+
+#include "pyodbc.h"
+#include "pyodbcmodule.h"
+#include "cursor.h"
+#include "connection.h"
+#include "errors.h"
+#include "wrapper.h"
+#include "threads.h"
+#include "async.h"
+
+#include <new>
+
+// A Future represents an execute or fetch started by Cursor.execute_async or Cursor.fetchmany_async.
+//
+// When the driver supports it (SQL_ASYNC_MODE is SQL_AM_STATEMENT), an execute is "native": it is started with
+// SQL_ATTR_ASYNC_ENABLE turned on and nothing runs on our side while the driver works.  We find out whether it has
+// finished by calling SQLExecute again whenever someone asks (done, result, or pyodbc.wait), so a single thread can
+// have hundreds of statements in flight.
+//
+// Everything else is queued to a pool of native worker threads that run the normal synchronous code, taking the GIL
+// like any other Python thread.  Fetches always use the pool because the rows must be converted to Python objects,
+// which requires the GIL anyway.
+//
+// The pool's mutex protects the queue and every Future's `done` flag.  Waiters sleep on `completed`, which is
+// broadcast whenever any Future completes, so pyodbc.wait can wait on a mix of native and worker futures.  The driver
+// cannot notify us about native futures, so those are polled with an increasing interval.
+//
+// As with the watchdog, the mutex and conditions are never freed since worker threads are still waiting on them when
+// the process exits.  They are created while holding the GIL.
+
+enum
+{
+    FUTURE_EXECUTE,
+    FUTURE_FETCHMANY
+};
+
+struct Future
+{
+    PyObject_HEAD
+
+    // The cursor the operation runs on.  Its async_op points back to this object until the operation completes.
+    Cursor* cursor;
+
+    int  op;                    // FUTURE_EXECUTE or FUTURE_FETCHMANY
+    bool native;                // true if the driver is executing asynchronously and must be polled
+    bool polling;               // true while a thread is polling a native future (with the GIL released)
+
+    // The operation's arguments.  These are released when the operation completes.
+    PyObject* pSql;
+    PyObject* params;
+    bool skip_first;
+    long rows;
+
+    // Set while holding `lock` when the operation completes.  After that, exactly one of `result` and `exc_type` is
+    // set.
+    bool done;
+    PyObject* result;
+    PyObject* exc_type;
+    PyObject* exc_value;
+    PyObject* exc_tb;
+
+    // The next Future in the queue waiting for a worker thread.
+    Future* next;
+};
+
+#define Future_Check(op) PyObject_TypeCheck(op, &FutureType)
+
+static Mutex*     lock      = 0;
+static Condition* work      = 0; // signaled when a Future is queued
+static Condition* completed = 0; // broadcast when any Future completes
+
+static Future* queue_head = 0;
+static Future* queue_tail = 0;
+static int     queued     = 0;
+
+static int threads_max  = 0;     // from pyodbc.async_workers, read when the first worker is started
+static int threads      = 0;
+static int threads_idle = 0;
+
+// The longest we'll sleep between polls of native futures.
+static const unsigned long MAX_POLL_INTERVAL = 16; // milliseconds
+
+
+static bool InitLock()
+{
+    if (lock != 0)
+        return true;
+
+    Mutex*     m = new (std::nothrow) Mutex();
+    Condition* w = m ? new (std::nothrow) Condition(*m) : 0;
+    Condition* c = w ? new (std::nothrow) Condition(*m) : 0;
+
+    if (c == 0)
+    {
+        delete w;
+        delete m;
+        PyErr_NoMemory();
+        return false;
+    }
+
+    lock      = m;
+    work      = w;
+    completed = c;
+    return true;
+}
+
+
+static void Complete(Future* f, PyObject* result)
+{
+    // Records the outcome of the operation and wakes any waiters.  If `result` is zero, the current exception is moved
+    // into the Future.  Called with the GIL held.
+
+    if (result != 0)
+    {
+        f->result = result;
+    }
+    else
+    {
+        PyErr_Fetch(&f->exc_type, &f->exc_value, &f->exc_tb);
+
+        if (f->exc_type == 0)
+        {
+            f->result = Py_None;
+            Py_INCREF(Py_None);
+        }
+    }
+
+    Py_XDECREF(f->pSql);
+    Py_XDECREF(f->params);
+    f->pSql   = 0;
+    f->params = 0;
+
+    f->cursor->async_op = 0;
+
+    MutexLock locker(*lock);
+    f->done = true;
+    completed->Broadcast();
+}
+
+
+static void Poll(Future* f)
+{
+    // Checks a pending native future.  Called with the GIL held.  (Cursor_PollAsync releases it, so `polling` keeps a
+    // second thread from calling SQLExecute on the same statement at the same time.)
+
+    if (f->done || !f->native || f->polling)
+        return;
+
+    f->polling = true;
+
+    PyObject* result;
+    if (Cursor_PollAsync(f->cursor, result) == ASYNC_DONE)
+        Complete(f, result);
+
+    f->polling = false;
+}
+
+
+static void Run(Future* f)
+{
+    // Runs a queued operation on a worker thread.  Called with the GIL held.
+
+    Cursor* cur = f->cursor;
+    PyObject* result;
+
+    if (cur->cnxn == 0 || cur->cnxn->hdbc == SQL_NULL_HANDLE || cur->hstmt == SQL_NULL_HANDLE)
+        result = RaiseErrorV(0, ProgrammingError, "The cursor's connection was closed.");
+    else if (f->op == FUTURE_EXECUTE)
+        result = Cursor_ExecuteImpl(cur, f->pSql, f->params, f->skip_first);
+    else
+        result = Cursor_fetchlist(cur, f->rows);
+
+    Complete(f, result);
+}
+
+
+static void WorkerThread(void*)
+{
+    for (;;)
+    {
+        Future* f;
+
+        {
+            MutexLock locker(*lock);
+
+            threads_idle++;
+            while (queue_head == 0)
+                work->Wait();
+            threads_idle--;
+
+            f = queue_head;
+            queue_head = f->next;
+            if (queue_head == 0)
+                queue_tail = 0;
+            f->next = 0;
+            queued--;
+        }
+
+        PyGILState_STATE state = PyGILState_Ensure();
+        Run(f);
+        Py_DECREF(f);           // the queue's reference
+        PyGILState_Release(state);
+    }
+}
+
+
+static bool Queue(Future* f)
+{
+    // Adds the Future to the worker queue, starting a new worker if all of the current ones are busy.  Returns false
+    // with an exception set if there are no workers and one cannot be started.
+
+    if (threads_max == 0)
+    {
+        Object workers(PyObject_GetAttrString(pModule, "async_workers"));
+        long n = workers.IsValid() ? PyInt_AsLong(workers) : -1;
+        if (n == -1 && PyErr_Occurred())
+            PyErr_Clear();
+        threads_max = (n < 1) ? 1 : (int)n;
+
+        // Worker threads call PyGILState_Ensure, which requires the GIL to have been created.
+        PyEval_InitThreads();
+    }
+
+    MutexLock locker(*lock);
+
+    if (queued >= threads_idle && threads < threads_max)
+    {
+        if (StartThread(WorkerThread, 0))
+        {
+            threads++;
+        }
+        else if (threads == 0)
+        {
+            RaiseErrorV(0, PyExc_RuntimeError, "Unable to start an asynchronous worker thread");
+            return false;
+        }
+    }
+
+    Py_INCREF(f);
+    if (queue_tail)
+        queue_tail->next = f;
+    else
+        queue_head = f;
+    queue_tail = f;
+    queued++;
+
+    work->Signal();
+
+    return true;
+}
+
+
+static bool Unqueue(Future* f)
+{
+    // Removes the Future from the worker queue if a worker has not started it yet.  Returns true if it was removed, in
+    // which case the caller now owns the queue's reference.
+
+    MutexLock locker(*lock);
+
+    Future* prev = 0;
+    for (Future* p = queue_head; p != 0; prev = p, p = p->next)
+    {
+        if (p != f)
+            continue;
+
+        if (prev)
+            prev->next = f->next;
+        else
+            queue_head = f->next;
+        if (queue_tail == f)
+            queue_tail = prev;
+        f->next = 0;
+        queued--;
+        return true;
+    }
+
+    return false;
+}
+
+
+static bool WaitForAny(Future** futures, Py_ssize_t count, long timeout_ms)
+{
+    // Waits until at least one of the futures is done or `timeout_ms` milliseconds have passed.  A negative timeout
+    // waits forever and zero only polls.  Called with the GIL held; it is released while sleeping.
+    //
+    // Returns false with an exception set if interrupted by a signal (e.g. KeyboardInterrupt).
+
+    UINT64 start = MonotonicMicroseconds();
+    unsigned long interval = 1;
+
+    for (;;)
+    {
+        bool native = false;
+
+        for (Py_ssize_t i = 0; i < count; i++)
+        {
+            Poll(futures[i]);
+            if (futures[i]->done)
+                return true;
+            native = native || futures[i]->native;
+        }
+
+        // Worker futures wake us when they complete, but we still wake periodically to check for signals.
+
+        unsigned long sleep = native ? interval : 100;
+
+        if (timeout_ms >= 0)
+        {
+            UINT64 elapsed = (MonotonicMicroseconds() - start) / 1000;
+            if (elapsed >= (UINT64)timeout_ms)
+                return true;
+            if ((UINT64)sleep > (UINT64)timeout_ms - elapsed)
+                sleep = (unsigned long)((UINT64)timeout_ms - elapsed);
+        }
+
+        Py_BEGIN_ALLOW_THREADS
+        lock->Lock();
+        bool any = false;
+        for (Py_ssize_t i = 0; i < count && !any; i++)
+            any = futures[i]->done;
+        if (!any)
+            completed->Wait(sleep);
+        lock->Unlock();
+        Py_END_ALLOW_THREADS
+
+        if (PyErr_CheckSignals() != 0)
+            return false;
+
+        if (interval < MAX_POLL_INTERVAL)
+            interval *= 2;
+    }
+}
+
+
+static bool GetWaitTimeout(PyObject* value, long& timeout_ms)
+{
+    // Converts the `timeout` argument of Future.result and pyodbc.wait.  None means wait forever (-1).
+
+    timeout_ms = -1;
+
+    if (value == 0 || value == Py_None)
+        return true;
+
+    double seconds = PyFloat_AsDouble(value);
+    if (seconds == -1.0 && PyErr_Occurred())
+        return false;
+
+    if (seconds < 0)
+    {
+        PyErr_SetString(PyExc_ValueError, "Cannot use a negative timeout.");
+        return false;
+    }
+
+    timeout_ms = (long)(seconds * 1000.0 + 0.5);
+    return true;
+}
+
+
+static Future* Future_New(Cursor* cur, int op)
+{
+    if (!InitLock())
+        return 0;
+
+    Future* f = PyObject_NEW(Future, &FutureType);
+    if (!f)
+        return 0;
+
+    f->cursor     = cur;
+    f->op         = op;
+    f->native     = false;
+    f->polling    = false;
+    f->pSql       = 0;
+    f->params     = 0;
+    f->skip_first = false;
+    f->rows       = 0;
+    f->done       = false;
+    f->result     = 0;
+    f->exc_type   = 0;
+    f->exc_value  = 0;
+    f->exc_tb     = 0;
+    f->next       = 0;
+
+    Py_INCREF(cur);
+    cur->async_op = (PyObject*)f;
+
+    return f;
+}
+
+
+PyObject* Future_Execute(Cursor* cur, PyObject* pSql, PyObject* params, bool skip_first)
+{
+    Future* f = Future_New(cur, FUTURE_EXECUTE);
+    if (!f)
+        return 0;
+
+    if (cur->cnxn->supports_async)
+    {
+        PyObject* result;
+        switch (Cursor_BeginAsync(cur, pSql, params, skip_first, result))
+        {
+        case ASYNC_PENDING:
+            f->native = true;
+            return (PyObject*)f;
+
+        case ASYNC_DONE:
+            Complete(f, result);
+            return (PyObject*)f;
+
+        case ASYNC_UNSUPPORTED:
+            // The driver advertises statement-level async but refused it for this statement.  Use a worker.
+            break;
+        }
+    }
+
+    f->pSql       = pSql;
+    f->params     = params;
+    f->skip_first = skip_first;
+    Py_INCREF(pSql);
+    Py_XINCREF(params);
+
+    if (!Queue(f))
+        Complete(f, 0);
+
+    return (PyObject*)f;
+}
+
+
+PyObject* Future_FetchMany(Cursor* cur, long rows)
+{
+    Future* f = Future_New(cur, FUTURE_FETCHMANY);
+    if (!f)
+        return 0;
+
+    f->rows = rows;
+
+    if (!Queue(f))
+        Complete(f, 0);
+
+    return (PyObject*)f;
+}
+
+
+PyObject* Future_Wait(PyObject* futures, PyObject* timeout)
+{
+    long timeout_ms;
+    if (!GetWaitTimeout(timeout, timeout_ms))
+        return 0;
+
+    // Copy into a tuple: a list could be modified by another thread while we are waiting without the GIL.
+    Object items(PySequence_Tuple(futures));
+    if (!items)
+        return 0;
+
+    Py_ssize_t count = PyTuple_GET_SIZE(items.Get());
+    for (Py_ssize_t i = 0; i < count; i++)
+    {
+        if (!Future_Check(PyTuple_GET_ITEM(items.Get(), i)))
+        {
+            PyErr_SetString(PyExc_TypeError, "wait() requires a sequence of pyodbc.Future objects");
+            return 0;
+        }
+    }
+
+    if (count != 0 && !WaitForAny((Future**)&PyTuple_GET_ITEM(items.Get(), 0), count, timeout_ms))
+        return 0;
+
+    Object done(PyList_New(0));
+    Object pending(PyList_New(0));
+    if (!done || !pending)
+        return 0;
+
+    for (Py_ssize_t i = 0; i < count; i++)
+    {
+        PyObject* item = PyTuple_GET_ITEM(items.Get(), i);
+        if (PyList_Append(((Future*)item)->done ? done.Get() : pending.Get(), item) != 0)
+            return 0;
+    }
+
+    return Py_BuildValue("(NN)", done.Detach(), pending.Detach());
+}
+
+
+static void Future_dealloc(Future* f)
+{
+    if (!f->done)
+    {
+        // Queued and running worker futures hold a reference, so this must be a native future that was discarded.
+        // Stop the statement so the cursor can be used again.
+        Cursor_AbortAsync(f->cursor);
+        f->cursor->async_op = 0;
+    }
+
+    Py_XDECREF(f->cursor);
+    Py_XDECREF(f->pSql);
+    Py_XDECREF(f->params);
+    Py_XDECREF(f->result);
+    Py_XDECREF(f->exc_type);
+    Py_XDECREF(f->exc_value);
+    Py_XDECREF(f->exc_tb);
+
+    PyObject_Del(f);
+}
+
+
+static char done_doc[] =
+    "done() --> bool\n"
+    "\n"
+    "Returns True if the operation has completed, successfully or not.";
+
+static PyObject* Future_done(PyObject* self, PyObject* args)
+{
+    UNUSED(args);
+
+    Future* f = (Future*)self;
+    Poll(f);
+
+    if (f->done)
+        Py_RETURN_TRUE;
+    Py_RETURN_FALSE;
+}
+
+
+static char* Future_result_kwnames[] = { "timeout", 0 };
+
+static char result_doc[] =
+    "result(timeout=None) --> object\n"
+    "\n"
+    "Waits for the operation to complete and returns its result: the cursor for\n"
+    "execute_async and a list of rows for fetchmany_async.  If the operation\n"
+    "failed, its exception is raised.\n"
+    "\n"
+    "If `timeout` is provided, it is the maximum number of seconds to wait.  If the\n"
+    "operation has not completed by then, an OperationalError with SQLSTATE HYT00\n"
+    "is raised and the operation keeps running.";
+
+static PyObject* Future_result(PyObject* self, PyObject* args, PyObject* kwargs)
+{
+    Future* f = (Future*)self;
+
+    PyObject* pTimeout = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O", Future_result_kwnames, &pTimeout))
+        return 0;
+
+    long timeout_ms;
+    if (!GetWaitTimeout(pTimeout, timeout_ms))
+        return 0;
+
+    if (!WaitForAny(&f, 1, timeout_ms))
+        return 0;
+
+    if (!f->done)
+        return RaiseErrorV("HYT00", OperationalError, "Timeout expired");
+
+    if (f->exc_type)
+    {
+        // PyErr_Restore steals the references, but the Future keeps the exception so result can be called again.
+        Py_INCREF(f->exc_type);
+        Py_XINCREF(f->exc_value);
+        Py_XINCREF(f->exc_tb);
+        PyErr_Restore(f->exc_type, f->exc_value, f->exc_tb);
+        return 0;
+    }
+
+    Py_INCREF(f->result);
+    return f->result;
+}
+
+
+static char cancel_doc[] =
+    "cancel() --> bool\n"
+    "\n"
+    "Requests cancellation of the operation.  Returns False if it has already\n"
+    "completed.  Otherwise the statement is canceled (SQLCancel) and the Future\n"
+    "completes with an OperationalError, unless the operation finishes first.";
+
+static PyObject* Future_cancel(PyObject* self, PyObject* args)
+{
+    UNUSED(args);
+
+    Future* f = (Future*)self;
+    Poll(f);
+
+    if (f->done)
+        Py_RETURN_FALSE;
+
+    if (Unqueue(f))
+    {
+        // A worker never saw it, so there is nothing to cancel in the driver.
+        RaiseErrorV("HY008", OperationalError, "Operation canceled");
+        Complete(f, 0);
+        Py_DECREF(f);           // the queue's reference
+        Py_RETURN_TRUE;
+    }
+
+    // Like Cursor.cancel, we keep the GIL so the statement cannot be freed while we're using it.
+    if (f->cursor->cnxn != 0 && f->cursor->cnxn->hdbc != SQL_NULL_HANDLE && f->cursor->hstmt != SQL_NULL_HANDLE)
+        ODBC_CALL(f->cursor->cnxn, SQLCancel)(f->cursor->hstmt);
+
+    Py_RETURN_TRUE;
+}
+
+
+static PyMethodDef Future_methods[] =
+{
+    { "done",   (PyCFunction)Future_done,   METH_NOARGS,                done_doc   },
+    { "result", (PyCFunction)Future_result, METH_VARARGS|METH_KEYWORDS, result_doc },
+    { "cancel", (PyCFunction)Future_cancel, METH_NOARGS,                cancel_doc },
+    { 0, 0, 0, 0 }
+};
+
+static PyMemberDef Future_members[] =
+{
+    { "cursor", T_OBJECT_EX, offsetof(Future, cursor), READONLY, "The cursor the operation is running on." },
+    { 0 }
+};
+
+static char future_doc[] =
+    "A Future represents an operation started by Cursor.execute_async or\n"
+    "Cursor.fetchmany_async.  Use done() or pyodbc.wait() to check for completion\n"
+    "and result() to get the outcome.  The cursor cannot be used until the\n"
+    "operation completes.\n"
+    "\n"
+    "Discarding a Future whose statement is still executing in the driver cancels\n"
+    "the statement.";
+
+PyTypeObject FutureType =
+{
+    PyObject_HEAD_INIT(0)
+    0,                                                      // ob_size
+    "pyodbc.Future",                                        // tp_name
+    sizeof(Future),                                         // tp_basicsize
+    0,                                                      // tp_itemsize
+    (destructor)Future_dealloc,                             // destructor tp_dealloc
+    0,                                                      // tp_print
+    0,                                                      // tp_getattr
+    0,                                                      // tp_setattr
+    0,                                                      // tp_compare
+    0,                                                      // tp_repr
+    0,                                                      // tp_as_number
+    0,                                                      // tp_as_sequence
+    0,                                                      // tp_as_mapping
+    0,                                                      // tp_hash
+    0,                                                      // tp_call
+    0,                                                      // tp_str
+    0,                                                      // tp_getattro
+    0,                                                      // tp_setattro
+    0,                                                      // tp_as_buffer
+    Py_TPFLAGS_DEFAULT,                                     // tp_flags
+    future_doc,                                             // tp_doc
+    0,                                                      // tp_traverse
+    0,                                                      // tp_clear
+    0,                                                      // tp_richcompare
+    0,                                                      // tp_weaklistoffset
+    0,                                                      // tp_iter
+    0,                                                      // tp_iternext
+    Future_methods,                                         // tp_methods
+    Future_members,                                         // tp_members
+    0,                                                      // tp_getset
+    0,                                                      // tp_base
+    0,                                                      // tp_dict
+    0,                                                      // tp_descr_get
+    0,                                                      // tp_descr_set
+    0,                                                      // tp_dictoffset
+    0,                                                      // tp_init
+    0,                                                      // tp_alloc
+    0,                                                      // tp_new
+    0,                                                      // tp_free
+    0,                                                      // tp_is_gc
+    0,                                                      // tp_bases
+    0,                                                      // tp_mro
+    0,                                                      // tp_cache
+    0,                                                      // tp_subclasses
+    0,                                                      // tp_weaklist
+};
@@ -0,0 +1,18 @@
+
+#ifndef _ASYNC_H_
+#define _ASYNC_H_
+
+struct Cursor;
+
+extern PyTypeObject FutureType;
+
+// Implement Cursor.execute_async and Cursor.fetchmany_async.  The cursor must already have been validated.  Returns a
+// new Future, or zero with an exception set if one could not be created.  Errors from the operation itself are raised
+// by Future.result().
+PyObject* Future_Execute(Cursor* cur, PyObject* pSql, PyObject* params, bool skip_first);
+PyObject* Future_FetchMany(Cursor* cur, long rows);
+
+// Implements pyodbc.wait.
+PyObject* Future_Wait(PyObject* futures, PyObject* timeout);
+
+#endif // _ASYNC_H_
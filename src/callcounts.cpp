@@ -0,0 +1,93 @@
+
+#include "pyodbc.h"
+#include "callcounts.h"
+#include "connection.h"
+#include "threads.h"
+#include "wrapper.h"
+
+static const char* const function_names[ODBC_FUNCTION_COUNT] =
+{
+    "SQLAllocHandle",
+    "SQLBindParameter",
+    "SQLCancel",
+    "SQLColAttribute",
+    "SQLColumns",
+    "SQLDataSources",
+    "SQLDescribeCol",
+    "SQLDescribeParam",
+    "SQLDisconnect",
+    "SQLDriverConnect",
+    "SQLEndTran",
+    "SQLExecDirect",
+    "SQLExecute",
+    "SQLFetch",
+    "SQLFetchScroll",
+    "SQLForeignKeys",
+    "SQLFreeHandle",
+    "SQLFreeStmt",
+    "SQLGetData",
+    "SQLGetDiagRec",
+    "SQLGetInfo",
+    "SQLGetStmtAttr",
+    "SQLGetTypeInfo",
+    "SQLMoreResults",
+    "SQLNumParams",
+    "SQLNumResultCols",
+    "SQLParamData",
+    "SQLPrepare",
+    "SQLPrimaryKeys",
+    "SQLProcedureColumns",
+    "SQLProcedures",
+    "SQLPutData",
+    "SQLRowCount",
+    "SQLSetConnectAttr",
+    "SQLSetEnvAttr",
+    "SQLSetStmtAttr",
+    "SQLSpecialColumns",
+    "SQLStatistics",
+    "SQLTables"
+};
+
+static CallCounts process_counts;
+
+void CountCall(Connection* cnxn, OdbcFunction function)
+{
+    AtomicAdd(&process_counts.calls[function], 1);
+    if (cnxn)
+        AtomicAdd(&cnxn->callcounts.calls[function], 1);
+}
+
+void CountBytesSent(Connection* cnxn, UINT64 bytes)
+{
+    AtomicAdd(&process_counts.bytes_sent, bytes);
+    if (cnxn)
+        AtomicAdd(&cnxn->callcounts.bytes_sent, bytes);
+}
+
+void CountBytesReceived(Connection* cnxn, UINT64 bytes)
+{
+    AtomicAdd(&process_counts.bytes_received, bytes);
+    if (cnxn)
+        AtomicAdd(&cnxn->callcounts.bytes_received, bytes);
+}
+
+PyObject* CallCounts_ToDict(Connection* cnxn)
+{
+    const CallCounts& counts = cnxn ? cnxn->callcounts : process_counts;
+
+    Object calls(PyDict_New());
+    if (!calls)
+        return 0;
+
+    for (int i = 0; i < ODBC_FUNCTION_COUNT; i++)
+    {
+        if (counts.calls[i] == 0)
+            continue;
+
+        Object count(PyLong_FromUnsignedLongLong(counts.calls[i]));
+        if (!count || PyDict_SetItemString(calls, function_names[i], count) != 0)
+            return 0;
+    }
+
+    return Py_BuildValue("{sOsKsK}", "calls", calls.Get(), "bytes_sent", counts.bytes_sent, "bytes_received", counts.bytes_received);
+}
@@ -0,0 +1,84 @@
+
+#ifndef _CALLCOUNTS_H_
+#define _CALLCOUNTS_H_
+
+// Counts of the ODBC functions called and the bytes passed through them, kept per connection and for the whole
+// process.  Every ODBC call site is written as ODBC_CALL(cnxn, SQLFetch)(hstmt) so it is counted.
+//
+// The counters are updated with atomic increments since some calls are made by native threads without the GIL (the
+// statement watchdog, execute_parallel, scatter_gather).
+
+struct Connection;
+
+enum OdbcFunction
+{
+    ODBC_SQLAllocHandle,
+    ODBC_SQLBindParameter,
+    ODBC_SQLCancel,
+    ODBC_SQLColAttribute,
+    ODBC_SQLColumns,
+    ODBC_SQLDataSources,
+    ODBC_SQLDescribeCol,
+    ODBC_SQLDescribeParam,
+    ODBC_SQLDisconnect,
+    ODBC_SQLDriverConnect,
+    ODBC_SQLEndTran,
+    ODBC_SQLExecDirect,
+    ODBC_SQLExecute,
+    ODBC_SQLFetch,
+    ODBC_SQLFetchScroll,
+    ODBC_SQLForeignKeys,
+    ODBC_SQLFreeHandle,
+    ODBC_SQLFreeStmt,
+    ODBC_SQLGetData,
+    ODBC_SQLGetDiagRec,
+    ODBC_SQLGetInfo,
+    ODBC_SQLGetStmtAttr,
+    ODBC_SQLGetTypeInfo,
+    ODBC_SQLMoreResults,
+    ODBC_SQLNumParams,
+    ODBC_SQLNumResultCols,
+    ODBC_SQLParamData,
+    ODBC_SQLPrepare,
+    ODBC_SQLPrimaryKeys,
+    ODBC_SQLProcedureColumns,
+    ODBC_SQLProcedures,
+    ODBC_SQLPutData,
+    ODBC_SQLRowCount,
+    ODBC_SQLSetConnectAttr,
+    ODBC_SQLSetEnvAttr,
+    ODBC_SQLSetStmtAttr,
+    ODBC_SQLSpecialColumns,
+    ODBC_SQLStatistics,
+    ODBC_SQLTables,
+
+    // The wide versions are counted with the ANSI versions.
+    ODBC_SQLDriverConnectW = ODBC_SQLDriverConnect,
+    ODBC_SQLExecDirectW    = ODBC_SQLExecDirect,
+    ODBC_SQLPrepareW       = ODBC_SQLPrepare,
+
+    ODBC_FUNCTION_COUNT = ODBC_SQLTables + 1
+};
+
+struct CallCounts
+{
+    UINT64 calls[ODBC_FUNCTION_COUNT];
+    UINT64 bytes_sent;          // SQL text and parameter data
+    UINT64 bytes_received;      // column data read with SQLGetData
+};
+
+// Counts a call to `function` for the connection, which may be zero for calls not made on a connection, and for the
+// process.
+void CountCall(Connection* cnxn, OdbcFunction function);
+
+void CountBytesSent(Connection* cnxn, UINT64 bytes);
+void CountBytesReceived(Connection* cnxn, UINT64 bytes);
+
+// Counts the call and evaluates to the function so it can be called: ODBC_CALL(cur->cnxn, SQLFetch)(cur->hstmt)
+#define ODBC_CALL(cnxn, function) (CountCall(cnxn, ODBC_##function), function)
+
+// Returns the counts as a new dictionary: { 'calls': { function name: count }, 'bytes_sent': n, 'bytes_received': n }.
+// Functions that have not been called are omitted.  If `cnxn` is zero, the process-wide counts are returned.
+PyObject* CallCounts_ToDict(Connection* cnxn);
+
+#endif // _CALLCOUNTS_H_
@@ -74,6 +74,7 @@ static PyObject* CnxnInfo_New(Connection* cnxn)
     p->odbc_major             = 3;
     p->odbc_minor             = 50;
     p->supports_describeparam = false;
+    p->supports_async         = false;
     p->datetime_precision     = 19; // default: "yyyy-mm-dd hh:mm:ss"
 
     // WARNING: The GIL lock is released for the *entire* function here.  Do not touch any objects, call Python APIs,
@@ -85,7 +86,7 @@ static PyObject* CnxnInfo_New(Connection* cnxn)
 
     char szVer[20];
     SQLSMALLINT cch = 0;
-    ret = SQLGetInfo(cnxn->hdbc, SQL_DRIVER_ODBC_VER, szVer, _countof(szVer), &cch);
+    ret = ODBC_CALL(cnxn, SQLGetInfo)(cnxn->hdbc, SQL_DRIVER_ODBC_VER, szVer, _countof(szVer), &cch);
     if (SQL_SUCCEEDED(ret))
     {
         char* dot = strchr(szVer, '.');
@@ -98,51 +99,58 @@ static PyObject* CnxnInfo_New(Connection* cnxn)
     }
 
     char szYN[2];
-    ret = SQLGetInfo(cnxn->hdbc, SQL_DESCRIBE_PARAMETER, szYN, _countof(szYN), &cch);
+    ret = ODBC_CALL(cnxn, SQLGetInfo)(cnxn->hdbc, SQL_DESCRIBE_PARAMETER, szYN, _countof(szYN), &cch);
     if (SQL_SUCCEEDED(ret))
     {
         p->supports_describeparam = szYN[0] == 'Y';
     }
 
+    SQLUINTEGER asyncmode;
+    ret = ODBC_CALL(cnxn, SQLGetInfo)(cnxn->hdbc, SQL_ASYNC_MODE, &asyncmode, sizeof(asyncmode), 0);
+    if (SQL_SUCCEEDED(ret))
+    {
+        p->supports_async = asyncmode == SQL_AM_STATEMENT;
+    }
+
     // These defaults are tiny, but are necessary for Access.
     p->varchar_maxlength = 255;
     p->wvarchar_maxlength = 255;
     p->binary_maxlength  = 510;
 
     HSTMT hstmt = 0;
-    if (SQL_SUCCEEDED(SQLAllocHandle(SQL_HANDLE_STMT, cnxn->hdbc, &hstmt)))
+    if (SQL_SUCCEEDED(ODBC_CALL(cnxn, SQLAllocHandle)(SQL_HANDLE_STMT, cnxn->hdbc, &hstmt)))
     {
         SQLINTEGER columnsize;
-        if (SQL_SUCCEEDED(SQLGetTypeInfo(hstmt, SQL_TYPE_TIMESTAMP)) && SQL_SUCCEEDED(SQLFetch(hstmt)))
+        if (SQL_SUCCEEDED(ODBC_CALL(cnxn, SQLGetTypeInfo)(hstmt, SQL_TYPE_TIMESTAMP)) && SQL_SUCCEEDED(ODBC_CALL(cnxn, SQLFetch)(hstmt)))
         {
-            if (SQL_SUCCEEDED(SQLGetData(hstmt, 3, SQL_INTEGER, &columnsize, sizeof(columnsize), 0)))
+            if (SQL_SUCCEEDED(ODBC_CALL(cnxn, SQLGetData)(hstmt, 3, SQL_INTEGER, &columnsize, sizeof(columnsize), 0)))
                 p->datetime_precision = (int)columnsize;
 
-            SQLFreeStmt(hstmt, SQL_CLOSE);
+            ODBC_CALL(cnxn, SQLFreeStmt)(hstmt, SQL_CLOSE);
         }
 
-        if (SQL_SUCCEEDED(SQLGetTypeInfo(hstmt, SQL_VARCHAR)) && SQL_SUCCEEDED(SQLFetch(hstmt)))
+        if (SQL_SUCCEEDED(ODBC_CALL(cnxn, SQLGetTypeInfo)(hstmt, SQL_VARCHAR)) && SQL_SUCCEEDED(ODBC_CALL(cnxn, SQLFetch)(hstmt)))
         {
-            if (SQL_SUCCEEDED(SQLGetData(hstmt, 3, SQL_INTEGER, &columnsize, sizeof(columnsize), 0)))
+            if (SQL_SUCCEEDED(ODBC_CALL(cnxn, SQLGetData)(hstmt, 3, SQL_INTEGER, &columnsize, sizeof(columnsize), 0)))
                 p->varchar_maxlength = (int)columnsize;
         
-            SQLFreeStmt(hstmt, SQL_CLOSE);
+            ODBC_CALL(cnxn, SQLFreeStmt)(hstmt, SQL_CLOSE);
         }
         
-        if (SQL_SUCCEEDED(SQLGetTypeInfo(hstmt, SQL_WVARCHAR)) && SQL_SUCCEEDED(SQLFetch(hstmt)))
+        if (SQL_SUCCEEDED(ODBC_CALL(cnxn, SQLGetTypeInfo)(hstmt, SQL_WVARCHAR)) && SQL_SUCCEEDED(ODBC_CALL(cnxn, SQLFetch)(hstmt)))
         {
-            if (SQL_SUCCEEDED(SQLGetData(hstmt, 3, SQL_INTEGER, &columnsize, sizeof(columnsize), 0)))
+            if (SQL_SUCCEEDED(ODBC_CALL(cnxn, SQLGetData)(hstmt, 3, SQL_INTEGER, &columnsize, sizeof(columnsize), 0)))
                 p->wvarchar_maxlength = (int)columnsize;
         
-            SQLFreeStmt(hstmt, SQL_CLOSE);
+            ODBC_CALL(cnxn, SQLFreeStmt)(hstmt, SQL_CLOSE);
         }
         
-        if (SQL_SUCCEEDED(SQLGetTypeInfo(hstmt, SQL_BINARY)) && SQL_SUCCEEDED(SQLFetch(hstmt)))
+        if (SQL_SUCCEEDED(ODBC_CALL(cnxn, SQLGetTypeInfo)(hstmt, SQL_BINARY)) && SQL_SUCCEEDED(ODBC_CALL(cnxn, SQLFetch)(hstmt)))
         {
-            if (SQL_SUCCEEDED(SQLGetData(hstmt, 3, SQL_INTEGER, &columnsize, sizeof(columnsize), 0)))
+            if (SQL_SUCCEEDED(ODBC_CALL(cnxn, SQLGetData)(hstmt, 3, SQL_INTEGER, &columnsize, sizeof(columnsize), 0)))
                 p->binary_maxlength = (int)columnsize;
         
-            SQLFreeStmt(hstmt, SQL_CLOSE);
+            ODBC_CALL(cnxn, SQLFreeStmt)(hstmt, SQL_CLOSE);
         }
     }
 
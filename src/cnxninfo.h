@@ -25,6 +25,7 @@ struct CnxnInfo
     char odbc_minor;
 
     bool supports_describeparam;
+    bool supports_async;
     int datetime_precision;
 
     // These are from SQLGetTypeInfo.column_size, so the char ones are in characters, not bytes.
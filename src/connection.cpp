@@ -17,6 +17,10 @@
 #include "wrapper.h"
 #include "cnxninfo.h"
 #include "sqlwchar.h"
+#include "threads.h"
+#include "resultcache.h"
+#include "utf8.h"
+#include "intern.h"
 
 static char connection_doc[] =
     "Connection objects manage connections to the database.\n"
@@ -73,7 +77,7 @@ static bool Connect(PyObject* pConnectString, HDBC hdbc, bool fAnsi, long timeou
     if (timeout > 0)
     {
         Py_BEGIN_ALLOW_THREADS
-        ret = SQLSetConnectAttr(hdbc, SQL_ATTR_LOGIN_TIMEOUT, (SQLPOINTER)timeout, SQL_IS_UINTEGER);
+        ret = ODBC_CALL(0, SQLSetConnectAttr)(hdbc, SQL_ATTR_LOGIN_TIMEOUT, (SQLPOINTER)timeout, SQL_IS_UINTEGER);
         Py_END_ALLOW_THREADS
         if (!SQL_SUCCEEDED(ret))
             RaiseErrorFromHandle("SQLSetConnectAttr(SQL_ATTR_LOGIN_TIMEOUT)", hdbc, SQL_NULL_HANDLE);
@@ -83,7 +87,7 @@ static bool Connect(PyObject* pConnectString, HDBC hdbc, bool fAnsi, long timeou
     {
         SQLWChar connectString(pConnectString);
         Py_BEGIN_ALLOW_THREADS
-        ret = SQLDriverConnectW(hdbc, 0, connectString, (SQLSMALLINT)connectString.size(), 0, 0, 0, SQL_DRIVER_NOPROMPT);
+        ret = ODBC_CALL(0, SQLDriverConnectW)(hdbc, 0, connectString, (SQLSMALLINT)connectString.size(), 0, 0, 0, SQL_DRIVER_NOPROMPT);
         Py_END_ALLOW_THREADS
         if (SQL_SUCCEEDED(ret))
             return true;
@@ -122,7 +126,7 @@ static bool Connect(PyObject* pConnectString, HDBC hdbc, bool fAnsi, long timeou
     }
 
     Py_BEGIN_ALLOW_THREADS
-    ret = SQLDriverConnect(hdbc, 0, szConnect, SQL_NTS, 0, 0, 0, SQL_DRIVER_NOPROMPT);
+    ret = ODBC_CALL(0, SQLDriverConnect)(hdbc, 0, szConnect, SQL_NTS, 0, 0, 0, SQL_DRIVER_NOPROMPT);
     Py_END_ALLOW_THREADS
     if (SQL_SUCCEEDED(ret))
         return true;
@@ -133,7 +137,39 @@ static bool Connect(PyObject* pConnectString, HDBC hdbc, bool fAnsi, long timeou
 }
 
 
-PyObject* Connection_New(PyObject* pConnectString, bool fAutoCommit, bool fAnsi, bool fUnicodeResults, long timeout)
+static PyObject* CheckEncoding(PyObject* value)
+{
+    // Returns `value`, the name of a codec, as a new PyString reference.  Returns zero with an exception set if it is
+    // not a string or Python has no decoder for it.
+
+    Object name;
+    if (PyUnicode_Check(value))
+    {
+        name.Attach(PyUnicode_AsASCIIString(value));
+        if (!name)
+            return 0;
+    }
+    else if (PyString_Check(value))
+    {
+        Py_INCREF(value);
+        name.Attach(value);
+    }
+    else
+    {
+        PyErr_SetString(PyExc_TypeError, "encoding must be a string or None.");
+        return 0;
+    }
+
+    // This raises LookupError for unknown encodings.
+    Object decoder(PyCodec_Decoder(PyString_AS_STRING(name.Get())));
+    if (!decoder)
+        return 0;
+
+    return name.Detach();
+}
+
+PyObject* Connection_New(PyObject* pConnectString, bool fAutoCommit, bool fAnsi, bool fUnicodeResults, PyObject* encoding,
+                         long timeout)
 {
     // pConnectString
     //   A string or unicode object.  (This must be checked by the caller.)
@@ -143,6 +179,18 @@ PyObject* Connection_New(PyObject* pConnectString, bool fAutoCommit, bool fAnsi,
     //
     // fUnicodeResults
     //   If true, return strings in rows as unicode objects.
+    //
+    // encoding
+    //   If not zero or None, the codec used to decode SQL_CHAR data when fUnicodeResults is true.  (See
+    //   Connection.encoding.)
+
+    Object encodingName;
+    if (encoding && encoding != Py_None)
+    {
+        encodingName.Attach(CheckEncoding(encoding));
+        if (!encodingName)
+            return 0;
+    }
 
     //
     // Allocate HDBC and connect
@@ -151,7 +199,7 @@ PyObject* Connection_New(PyObject* pConnectString, bool fAutoCommit, bool fAnsi,
     HDBC hdbc = SQL_NULL_HANDLE;
     SQLRETURN ret;
     Py_BEGIN_ALLOW_THREADS
-    ret = SQLAllocHandle(SQL_HANDLE_DBC, henv, &hdbc);
+    ret = ODBC_CALL(0, SQLAllocHandle)(SQL_HANDLE_DBC, henv, &hdbc);
     Py_END_ALLOW_THREADS
     if (!SQL_SUCCEEDED(ret))
         return RaiseErrorFromHandle("SQLAllocHandle", SQL_NULL_HANDLE, SQL_NULL_HANDLE);
@@ -160,7 +208,7 @@ PyObject* Connection_New(PyObject* pConnectString, bool fAutoCommit, bool fAnsi,
     {
         // Connect has already set an exception.
         Py_BEGIN_ALLOW_THREADS
-        SQLFreeHandle(SQL_HANDLE_DBC, hdbc);
+        ODBC_CALL(0, SQLFreeHandle)(SQL_HANDLE_DBC, hdbc);
         Py_END_ALLOW_THREADS
         return 0;
     }
@@ -176,7 +224,7 @@ PyObject* Connection_New(PyObject* pConnectString, bool fAutoCommit, bool fAnsi,
     if (cnxn == 0)
     {
         Py_BEGIN_ALLOW_THREADS
-        SQLFreeHandle(SQL_HANDLE_DBC, hdbc);
+        ODBC_CALL(0, SQLFreeHandle)(SQL_HANDLE_DBC, hdbc);
         Py_END_ALLOW_THREADS
         return 0;
     }
@@ -185,8 +233,33 @@ PyObject* Connection_New(PyObject* pConnectString, bool fAutoCommit, bool fAnsi,
     cnxn->nAutoCommit     = fAutoCommit ? SQL_AUTOCOMMIT_ON : SQL_AUTOCOMMIT_OFF;
     cnxn->searchescape    = 0;
     cnxn->timeout         = 0;
+    cnxn->group_commit_count    = 0;
+    cnxn->group_commit_interval = 0;
+    cnxn->pending_commits       = 0;
+    cnxn->written_since_commit  = false;
+    cnxn->first_pending         = 0;
+    cnxn->coalesced_commits     = 0;
+    cnxn->stmt_pool             = 0;
+    cnxn->stmt_pool_count       = 0;
+    cnxn->stmt_pool_size        = 8;
+    cnxn->stmts_allocated       = 0;
+    cnxn->stmts_reused          = 0;
+    cnxn->metadata_cache        = 0;
+    cnxn->metadata_ttl          = 0;
+    cnxn->metadata_hits         = 0;
+    cnxn->metadata_misses       = 0;
+    cnxn->intern_limit          = 0;
+    cnxn->lazy_rows             = false;
+    cnxn->recheck_columns       = false;
+    cnxn->result_cache          = 0;
+    cnxn->txn_written           = false;
+    memset(&cnxn->stats, 0, sizeof(cnxn->stats));
+    memset(&cnxn->callcounts, 0, sizeof(cnxn->callcounts));
     cnxn->unicode_results = fUnicodeResults;
+    cnxn->encoding_utf8   = encodingName && IsUTF8(PyString_AS_STRING(encodingName.Get()));
+    cnxn->encoding        = encodingName.Detach();
     cnxn->conv_count      = 0;
+    cnxn->conv_version    = 0;
     cnxn->conv_types      = 0;
     cnxn->conv_funcs      = 0;
 
@@ -202,7 +275,7 @@ PyObject* Connection_New(PyObject* pConnectString, bool fAutoCommit, bool fAnsi,
     {
         SQLRETURN ret;
         Py_BEGIN_ALLOW_THREADS
-        ret = SQLSetConnectAttr(cnxn->hdbc, SQL_ATTR_AUTOCOMMIT, (SQLPOINTER)cnxn->nAutoCommit, SQL_IS_UINTEGER);
+        ret = ODBC_CALL(cnxn, SQLSetConnectAttr)(cnxn->hdbc, SQL_ATTR_AUTOCOMMIT, (SQLPOINTER)cnxn->nAutoCommit, SQL_IS_UINTEGER);
         Py_END_ALLOW_THREADS
 
         if (!SQL_SUCCEEDED(ret))
@@ -231,6 +304,7 @@ PyObject* Connection_New(PyObject* pConnectString, bool fAutoCommit, bool fAnsi,
     cnxn->odbc_major             = p->odbc_major;
     cnxn->odbc_minor             = p->odbc_minor;
     cnxn->supports_describeparam = p->supports_describeparam;
+    cnxn->supports_async         = p->supports_async;
     cnxn->datetime_precision     = p->datetime_precision;
     cnxn->varchar_maxlength      = p->varchar_maxlength;
     cnxn->wvarchar_maxlength     = p->wvarchar_maxlength;
@@ -239,6 +313,104 @@ PyObject* Connection_New(PyObject* pConnectString, bool fAutoCommit, bool fAnsi,
     return reinterpret_cast<PyObject*>(cnxn);
 }
 
+static void _clear_stmt_pool(Connection* cnxn, int keep)
+{
+    // Frees the pooled statement handles beyond the first `keep`.
+
+    if (cnxn->stmt_pool_count <= keep)
+        return;
+
+    // Take the handles out of the pool before releasing the GIL.
+    HSTMT handles[MAX_STMT_POOL];
+    int count = 0;
+    while (cnxn->stmt_pool_count > keep)
+        handles[count++] = cnxn->stmt_pool[--cnxn->stmt_pool_count];
+
+    if (cnxn->hdbc != SQL_NULL_HANDLE)
+    {
+        Py_BEGIN_ALLOW_THREADS
+        for (int i = 0; i < count; i++)
+            ODBC_CALL(cnxn, SQLFreeHandle)(SQL_HANDLE_STMT, handles[i]);
+        Py_END_ALLOW_THREADS
+    }
+}
+
+HSTMT Connection_TakeStatement(Connection* cnxn)
+{
+    if (cnxn->stmt_pool_count == 0)
+        return SQL_NULL_HANDLE;
+
+    cnxn->stmts_reused++;
+    return cnxn->stmt_pool[--cnxn->stmt_pool_count];
+}
+
+bool Connection_ReturnStatement(Connection* cnxn, HSTMT hstmt)
+{
+    if (cnxn->hdbc == SQL_NULL_HANDLE || cnxn->stmt_pool_count >= cnxn->stmt_pool_size)
+        return false;
+
+    if (cnxn->stmt_pool == 0)
+    {
+        cnxn->stmt_pool = (HSTMT*)pyodbc_malloc(sizeof(HSTMT) * MAX_STMT_POOL);
+        if (cnxn->stmt_pool == 0)
+            return false;
+    }
+
+    cnxn->stmt_pool[cnxn->stmt_pool_count++] = hstmt;
+    return true;
+}
+
+PyObject* Connection_GetCached(Connection* cnxn, PyObject* key)
+{
+    if (cnxn->metadata_ttl == 0)
+        return 0;
+
+    PyObject* entry = cnxn->metadata_cache ? PyDict_GetItem(cnxn->metadata_cache, key) : 0;
+
+    if (entry && PyLong_AsUnsignedLongLong(PyTuple_GET_ITEM(entry, 0)) <= MonotonicMicroseconds())
+    {
+        PyDict_DelItem(cnxn->metadata_cache, key);
+        entry = 0;
+    }
+
+    // An unhashable key raises an exception.  It isn't worth reporting since the caller can always query the database.
+    PyErr_Clear();
+
+    if (entry == 0)
+    {
+        cnxn->metadata_misses++;
+        return 0;
+    }
+
+    cnxn->metadata_hits++;
+    return PyTuple_GET_ITEM(entry, 1);
+}
+
+bool Connection_SetCached(Connection* cnxn, PyObject* key, PyObject* value)
+{
+    if (cnxn->metadata_ttl == 0)
+        return true;
+
+    if (cnxn->metadata_cache == 0)
+    {
+        cnxn->metadata_cache = PyDict_New();
+        if (!cnxn->metadata_cache)
+            return false;
+    }
+
+    Object entry(Py_BuildValue("(NO)", PyLong_FromUnsignedLongLong(MonotonicMicroseconds() + cnxn->metadata_ttl), value));
+    if (!entry)
+        return false;
+
+    return PyDict_SetItem(cnxn->metadata_cache, key, entry) == 0;
+}
+
+static void _clear_metadata_cache(Connection* cnxn)
+{
+    Py_XDECREF(cnxn->metadata_cache);
+    cnxn->metadata_cache = 0;
+}
+
 static void _clear_conv(Connection* cnxn)
 {
     if (cnxn->conv_count != 0)
@@ -252,6 +424,7 @@ static void _clear_conv(Connection* cnxn)
         cnxn->conv_funcs = 0;
 
         cnxn->conv_count = 0;
+        cnxn->conv_version++;
     }
 }
 
@@ -267,6 +440,54 @@ Connection_conv_clear(Connection* cnxn)
     Py_RETURN_NONE;
 }
 
+static void
+_invalidate_result_cache(Connection* cnxn)
+{
+    // Called when the transaction is committed.  If it wrote anything, the cached results may be stale.  The cache can
+    // be shared by other connections, so it is emptied instead of only being bypassed by this one.
+
+    if (cnxn->txn_written && cnxn->result_cache)
+        ResultCache_Invalidate(cnxn->result_cache);
+}
+
+static void
+_clear_group_commits(Connection* cnxn)
+{
+    // Called when a connection with deferred group commits is deleted.  The deferred commits are sent unless something
+    // has been written since the last commit(): there is no way to commit only the work before it, so the whole
+    // transaction is rolled back instead, like any other uncommitted work.  Errors cannot be raised from here, so they
+    // are reported with PyErr_WriteUnraisable.
+
+    PyObject *ptype, *pvalue, *ptraceback;
+    PyErr_Fetch(&ptype, &pvalue, &ptraceback);
+
+    if (cnxn->written_since_commit)
+    {
+        RaiseErrorV(0, ProgrammingError,
+                    "%d deferred group commit(s) were rolled back because the connection was deleted with changes made "
+                    "after the last commit()", cnxn->pending_commits);
+    }
+    else
+    {
+        SQLRETURN ret;
+        Py_BEGIN_ALLOW_THREADS
+        ret = ODBC_CALL(cnxn, SQLEndTran)(SQL_HANDLE_DBC, cnxn->hdbc, SQL_COMMIT);
+        Py_END_ALLOW_THREADS
+        if (!SQL_SUCCEEDED(ret))
+            RaiseErrorFromHandle("SQLEndTran", cnxn->hdbc, SQL_NULL_HANDLE);
+        else
+            _invalidate_result_cache(cnxn);
+    }
+
+    cnxn->pending_commits = 0;
+
+    // The connection is being deallocated and printing it would resurrect it, so None is reported as the source.
+    if (PyErr_Occurred())
+        PyErr_WriteUnraisable(Py_None);
+
+    PyErr_Restore(ptype, pvalue, ptraceback);
+}
+
 static int
 Connection_clear(Connection* cnxn)
 {
@@ -279,12 +500,18 @@ Connection_clear(Connection* cnxn)
 
         TRACE("cnxn.clear cnxn=%p hdbc=%d\n", cnxn, cnxn->hdbc);
 
+        _clear_stmt_pool(cnxn, 0);
+
+        // close() sends deferred group commits before getting here, so this only happens when a connection is deleted.
+        if (cnxn->pending_commits != 0)
+            _clear_group_commits(cnxn);
+
         Py_BEGIN_ALLOW_THREADS
         if (cnxn->nAutoCommit == SQL_AUTOCOMMIT_OFF)
-            SQLEndTran(SQL_HANDLE_DBC, cnxn->hdbc, SQL_ROLLBACK);
+            ODBC_CALL(cnxn, SQLEndTran)(SQL_HANDLE_DBC, cnxn->hdbc, SQL_ROLLBACK);
 
-        SQLDisconnect(cnxn->hdbc);
-        SQLFreeHandle(SQL_HANDLE_DBC, cnxn->hdbc);
+        ODBC_CALL(cnxn, SQLDisconnect)(cnxn->hdbc);
+        ODBC_CALL(cnxn, SQLFreeHandle)(SQL_HANDLE_DBC, cnxn->hdbc);
         Py_END_ALLOW_THREADS
         
         cnxn->hdbc = SQL_NULL_HANDLE;
@@ -292,6 +519,21 @@ Connection_clear(Connection* cnxn)
 
     Py_XDECREF(cnxn->searchescape);
     cnxn->searchescape = 0;
+
+    if (cnxn->stmt_pool)
+    {
+        pyodbc_free(cnxn->stmt_pool);
+        cnxn->stmt_pool = 0;
+    }
+
+    _clear_metadata_cache(cnxn);
+
+    Py_XDECREF(cnxn->result_cache);
+    cnxn->result_cache = 0;
+    cnxn->stmt_pool_count = 0;
+
+    Py_XDECREF(cnxn->encoding);
+    cnxn->encoding = 0;
     
     _clear_conv(cnxn);
 
@@ -316,6 +558,8 @@ static char close_doc[] =
     "Note that closing a connection without committing the changes first will cause\n"
     "an implicit rollback to be performed.";
     
+static bool _flush_group_commits(Connection* cnxn);
+
 static PyObject*
 Connection_close(PyObject* self, PyObject* args)
 {
@@ -325,6 +569,10 @@ Connection_close(PyObject* self, PyObject* args)
     if (!cnxn)
         return 0;
 
+    // Send any deferred group commits first.  If that fails the connection is left open so the caller can decide.
+    if (!_flush_group_commits(cnxn))
+        return 0;
+
     Connection_clear(cnxn);
 
     Py_RETURN_NONE;
@@ -343,7 +591,7 @@ Connection_cursor(PyObject* self, PyObject* args)
 }
 
 static PyObject*
-Connection_execute(PyObject* self, PyObject* args)
+Connection_execute(PyObject* self, PyObject* args, PyObject* kwargs)
 {
     PyObject* result = 0;
 
@@ -357,7 +605,7 @@ Connection_execute(PyObject* self, PyObject* args)
     if (!cursor)
         return 0;
 
-    result = Cursor_execute((PyObject*)cursor, args);
+    result = Cursor_execute((PyObject*)cursor, args, kwargs);
 
     Py_DECREF((PyObject*)cursor);
 
@@ -544,12 +792,23 @@ Connection_getinfo(PyObject* self, PyObject* args)
     if (i == _countof(aInfoTypes))
         return RaiseErrorV(0, ProgrammingError, "Invalid getinfo value: %d", infotype);
 
+    Object key(PyInt_FromLong((long)infotype));
+    if (!key)
+        return 0;
+
+    PyObject* cached = Connection_GetCached(cnxn, key);
+    if (cached)
+    {
+        Py_INCREF(cached);
+        return cached;
+    }
+
     char szBuffer[0x1000];
     SQLSMALLINT cch = 0;
 
     SQLRETURN ret;
     Py_BEGIN_ALLOW_THREADS
-    ret = SQLGetInfo(cnxn->hdbc, (SQLUSMALLINT)infotype, szBuffer, sizeof(szBuffer), &cch);
+    ret = ODBC_CALL(cnxn, SQLGetInfo)(cnxn->hdbc, (SQLUSMALLINT)infotype, szBuffer, sizeof(szBuffer), &cch);
     Py_END_ALLOW_THREADS
     if (!SQL_SUCCEEDED(ret))
     {
@@ -585,9 +844,35 @@ Connection_getinfo(PyObject* self, PyObject* args)
         break;
     }
 
+    if (result && !Connection_SetCached(cnxn, key, result))
+    {
+        Py_DECREF(result);
+        return 0;
+    }
+
     return result;
 }
 
+static char clear_metadata_cache_doc[] =
+    "clear_metadata_cache() --> None\n"
+    "\n"
+    "Discards all getinfo values and catalog function results cached by the\n"
+    "connection.  See metadata_cache_ttl.";
+
+static PyObject*
+Connection_clear_metadata_cache(PyObject* self, PyObject* args)
+{
+    UNUSED(args);
+
+    Connection* cnxn = Connection_Validate(self);
+    if (!cnxn)
+        return 0;
+
+    _clear_metadata_cache(cnxn);
+
+    Py_RETURN_NONE;
+}
+
 
 static PyObject*
 Connection_endtrans(PyObject* self, PyObject* args, SQLSMALLINT type)
@@ -602,23 +887,129 @@ Connection_endtrans(PyObject* self, PyObject* args, SQLSMALLINT type)
 
     SQLRETURN ret;
     Py_BEGIN_ALLOW_THREADS
-    ret = SQLEndTran(SQL_HANDLE_DBC, cnxn->hdbc, type);
+    ret = ODBC_CALL(cnxn, SQLEndTran)(SQL_HANDLE_DBC, cnxn->hdbc, type);
     Py_END_ALLOW_THREADS
     if (!SQL_SUCCEEDED(ret))
     {
+        // Leave any pending group commits alone so the caller can retry.
         RaiseErrorFromHandle("SQLEndTran", cnxn->hdbc, SQL_NULL_HANDLE);
         return 0;
     }
 
+    // A commit covers every deferred commit.  A rollback discards them since they were part of the same transaction.
+    if (type == SQL_COMMIT && cnxn->pending_commits > 1)
+        cnxn->coalesced_commits += cnxn->pending_commits - 1;
+    cnxn->pending_commits = 0;
+
+    if (type == SQL_COMMIT)
+        _invalidate_result_cache(cnxn);
+
+    cnxn->txn_written          = false;
+    cnxn->written_since_commit = false;
+
     Py_RETURN_NONE;
 }
 
+static bool
+_flush_group_commits(Connection* cnxn)
+{
+    // Sends the deferred group commits, if any.  The commit would also include anything written since the last
+    // commit(), which the caller has not asked to commit, so that is an error instead.
+
+    if (cnxn->pending_commits == 0)
+        return true;
+
+    if (cnxn->written_since_commit)
+    {
+        RaiseErrorV(0, ProgrammingError,
+                    "Cannot send the deferred group commits because changes have been made since the last commit().  "
+                    "Call commit() to include them or rollback() to discard the whole transaction.");
+        return false;
+    }
+
+    PyObject* result = Connection_endtrans((PyObject*)cnxn, 0, SQL_COMMIT);
+    if (!result)
+        return false;
+    Py_DECREF(result);
+    return true;
+}
+
+inline bool
+GroupCommitEnabled(Connection* cnxn)
+{
+    return (cnxn->group_commit_count != 0 || cnxn->group_commit_interval != 0) && cnxn->nAutoCommit == SQL_AUTOCOMMIT_OFF;
+}
+
 static PyObject*
 Connection_commit(PyObject* self, PyObject* args)
 {
+    Connection* cnxn = Connection_Validate(self);
+    if (!cnxn)
+        return 0;
+
+    if (GroupCommitEnabled(cnxn))
+    {
+        UINT64 now = MonotonicMicroseconds();
+
+        if (cnxn->pending_commits++ == 0)
+            cnxn->first_pending = now;
+
+        // The commit point: everything written so far is covered by the deferred commits.
+        cnxn->written_since_commit = false;
+
+        bool due = (cnxn->group_commit_count != 0 && cnxn->pending_commits >= cnxn->group_commit_count) ||
+                   (cnxn->group_commit_interval != 0 && now - cnxn->first_pending >= (UINT64)cnxn->group_commit_interval * 1000);
+
+        if (!due)
+            Py_RETURN_NONE;
+    }
+
     return Connection_endtrans(self, args, SQL_COMMIT);
 }
 
+static PyObject*
+Connection_flush(PyObject* self, PyObject* args)
+{
+    Connection* cnxn = Connection_Validate(self);
+    if (!cnxn)
+        return 0;
+
+    if (!_flush_group_commits(cnxn))
+        return 0;
+
+    Py_RETURN_NONE;
+}
+
+static char* Connection_group_commit_kwnames[] = { "count", "interval", 0 };
+
+static PyObject*
+Connection_group_commit(PyObject* self, PyObject* args, PyObject* kwargs)
+{
+    Connection* cnxn = Connection_Validate(self);
+    if (!cnxn)
+        return 0;
+
+    int count = 0;
+    long interval = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|il", Connection_group_commit_kwnames, &count, &interval))
+        return 0;
+
+    if (count < 0 || interval < 0)
+    {
+        PyErr_SetString(PyExc_ValueError, "The group commit count and interval cannot be negative.");
+        return 0;
+    }
+
+    // Send anything deferred under the old settings so it can't be held indefinitely by the new ones.
+    if (!_flush_group_commits(cnxn))
+        return 0;
+
+    cnxn->group_commit_count    = count;
+    cnxn->group_commit_interval = interval;
+
+    Py_RETURN_NONE;
+}
+
 static PyObject*
 Connection_rollback(PyObject* self, PyObject* args)
 {
@@ -629,7 +1020,7 @@ static char cursor_doc[] =
     "Return a new Cursor object using the connection.";
     
 static char execute_doc[] =
-    "execute(sql, [params]) --> Cursor\n"
+    "execute(sql, [params], timeout=None) --> Cursor\n"
     "\n"
     "Create a new Cursor object, call its execute method, and return it.  See\n"
     "Cursor.execute for more details.\n"
@@ -639,7 +1030,32 @@ static char execute_doc[] =
     "statement needs to be executed.";
 
 static char commit_doc[] =
-    "Commit any pending transaction to the database.";
+    "Commit any pending transaction to the database.\n"
+    "\n"
+    "If group commit is enabled (see group_commit), the commit may be deferred and\n"
+    "combined with later ones.";
+
+static char flush_doc[] =
+    "flush() --> None\n"
+    "\n"
+    "Sends any commits deferred by group commit to the database now.  Raises\n"
+    "ProgrammingError if anything was written after the last commit().";
+
+static char group_commit_doc[] =
+    "group_commit(count=0, interval=0) --> None\n"
+    "\n"
+    "Batches commits to reduce the number of SQLEndTran round trips.  While enabled,\n"
+    "commit() only ends the transaction on every `count`th call or once the oldest\n"
+    "deferred commit is `interval` milliseconds old, whichever comes first.  (The\n"
+    "interval is checked when commit() is called; there is no background timer.)\n"
+    "Both zero, the default, commits immediately.  Any deferred commits are flushed\n"
+    "before the settings change.\n"
+    "\n"
+    "Deferred commits are still part of the open transaction: rollback() discards\n"
+    "them.  They are flushed by flush(), close(), and when the connection is deleted.\n"
+    "Since only the whole transaction can be committed, flush() and close() raise\n"
+    "ProgrammingError if anything was written after the last commit().\n"
+    "The coalesced_commits attribute counts the commits that were combined.";
 
 static char rollback_doc[] =
     "Causes the the database to roll back to the start of any pending transaction.";
@@ -682,7 +1098,7 @@ Connection_setautocommit(PyObject* self, PyObject* value, void* closure)
     SQLUINTEGER nAutoCommit = PyObject_IsTrue(value) ? SQL_AUTOCOMMIT_ON : SQL_AUTOCOMMIT_OFF;
     SQLRETURN ret;
     Py_BEGIN_ALLOW_THREADS
-    ret = SQLSetConnectAttr(cnxn->hdbc, SQL_ATTR_AUTOCOMMIT, (SQLPOINTER)nAutoCommit, SQL_IS_UINTEGER);
+    ret = ODBC_CALL(cnxn, SQLSetConnectAttr)(cnxn->hdbc, SQL_ATTR_AUTOCOMMIT, (SQLPOINTER)nAutoCommit, SQL_IS_UINTEGER);
     Py_END_ALLOW_THREADS
     if (!SQL_SUCCEEDED(ret))
     {
@@ -692,6 +1108,17 @@ Connection_setautocommit(PyObject* self, PyObject* value, void* closure)
 
     cnxn->nAutoCommit = nAutoCommit;
 
+    // Turning autocommit on commits the open transaction, which includes any deferred group commits.
+    if (nAutoCommit == SQL_AUTOCOMMIT_ON)
+    {
+        if (cnxn->pending_commits > 1)
+            cnxn->coalesced_commits += cnxn->pending_commits - 1;
+        _invalidate_result_cache(cnxn);
+        cnxn->pending_commits      = 0;
+        cnxn->txn_written          = false;
+        cnxn->written_since_commit = false;
+    }
+
     return 0;
 }
 
@@ -708,7 +1135,7 @@ Connection_getsearchescape(Connection* self, void* closure)
 
         SQLRETURN ret;
         Py_BEGIN_ALLOW_THREADS
-        ret = SQLGetInfo(self->hdbc, SQL_SEARCH_PATTERN_ESCAPE, &sz, _countof(sz), &cch);
+        ret = ODBC_CALL(self, SQLGetInfo)(self->hdbc, SQL_SEARCH_PATTERN_ESCAPE, &sz, _countof(sz), &cch);
         Py_END_ALLOW_THREADS
         if (!SQL_SUCCEEDED(ret))
             return RaiseErrorFromHandle("SQLGetInfo", self->hdbc, SQL_NULL_HANDLE);
@@ -758,7 +1185,7 @@ Connection_settimeout(PyObject* self, PyObject* value, void* closure)
 
     SQLRETURN ret;
     Py_BEGIN_ALLOW_THREADS
-    ret = SQLSetConnectAttr(cnxn->hdbc, SQL_ATTR_CONNECTION_TIMEOUT, (SQLPOINTER)timeout, SQL_IS_UINTEGER);
+    ret = ODBC_CALL(cnxn, SQLSetConnectAttr)(cnxn->hdbc, SQL_ATTR_CONNECTION_TIMEOUT, (SQLPOINTER)timeout, SQL_IS_UINTEGER);
     Py_END_ALLOW_THREADS
     if (!SQL_SUCCEEDED(ret))
     {
@@ -766,11 +1193,380 @@ Connection_settimeout(PyObject* self, PyObject* value, void* closure)
         return -1;
     }
 
+    // The pooled statements have the old query timeout.
+    if (timeout != cnxn->timeout)
+        _clear_stmt_pool(cnxn, 0);
+
     cnxn->timeout = timeout;
 
     return 0;
 }
 
+static PyObject*
+Connection_getcoalesced(PyObject* self, void* closure)
+{
+    UNUSED(closure);
+
+    Connection* cnxn = Connection_Validate(self);
+    if (!cnxn)
+        return 0;
+
+    return PyInt_FromLong(cnxn->coalesced_commits);
+}
+
+static PyObject*
+Connection_getstmtpoolsize(PyObject* self, void* closure)
+{
+    UNUSED(closure);
+
+    Connection* cnxn = Connection_Validate(self);
+    if (!cnxn)
+        return 0;
+
+    return PyInt_FromLong(cnxn->stmt_pool_size);
+}
+
+static int
+Connection_setstmtpoolsize(PyObject* self, PyObject* value, void* closure)
+{
+    UNUSED(closure);
+
+    Connection* cnxn = Connection_Validate(self);
+    if (!cnxn)
+        return -1;
+
+    if (value == 0)
+    {
+        PyErr_SetString(PyExc_TypeError, "Cannot delete the statement_pool_size attribute.");
+        return -1;
+    }
+    long size = PyInt_AsLong(value);
+    if (size == -1 && PyErr_Occurred())
+        return -1;
+    if (size < 0 || size > MAX_STMT_POOL)
+    {
+        PyErr_Format(PyExc_ValueError, "The statement pool size must be between 0 and %d.", MAX_STMT_POOL);
+        return -1;
+    }
+
+    cnxn->stmt_pool_size = (int)size;
+    _clear_stmt_pool(cnxn, cnxn->stmt_pool_size);
+
+    return 0;
+}
+
+static PyObject*
+Connection_getencoding(PyObject* self, void* closure)
+{
+    UNUSED(closure);
+
+    Connection* cnxn = Connection_Validate(self);
+    if (!cnxn)
+        return 0;
+
+    PyObject* encoding = cnxn->encoding ? cnxn->encoding : Py_None;
+    Py_INCREF(encoding);
+    return encoding;
+}
+
+static int
+Connection_setencoding(PyObject* self, PyObject* value, void* closure)
+{
+    UNUSED(closure);
+
+    Connection* cnxn = Connection_Validate(self);
+    if (!cnxn)
+        return -1;
+
+    PyObject* encoding = 0;
+    if (value != 0 && value != Py_None)
+    {
+        encoding = CheckEncoding(value);
+        if (!encoding)
+            return -1;
+    }
+
+    Py_XDECREF(cnxn->encoding);
+    cnxn->encoding      = encoding;
+    cnxn->encoding_utf8 = encoding && IsUTF8(PyString_AS_STRING(encoding));
+
+    return 0;
+}
+
+static PyObject*
+Connection_getstmtsreused(PyObject* self, void* closure)
+{
+    UNUSED(closure);
+
+    Connection* cnxn = Connection_Validate(self);
+    if (!cnxn)
+        return 0;
+
+    return PyInt_FromLong(cnxn->stmts_reused);
+}
+
+static PyObject*
+Connection_getstmtsallocated(PyObject* self, void* closure)
+{
+    UNUSED(closure);
+
+    Connection* cnxn = Connection_Validate(self);
+    if (!cnxn)
+        return 0;
+
+    return PyInt_FromLong(cnxn->stmts_allocated);
+}
+
+static PyObject*
+Connection_getmetadatattl(PyObject* self, void* closure)
+{
+    UNUSED(closure);
+
+    Connection* cnxn = Connection_Validate(self);
+    if (!cnxn)
+        return 0;
+
+    return PyFloat_FromDouble((double)cnxn->metadata_ttl / 1000000.0);
+}
+
+static int
+Connection_setmetadatattl(PyObject* self, PyObject* value, void* closure)
+{
+    UNUSED(closure);
+
+    Connection* cnxn = Connection_Validate(self);
+    if (!cnxn)
+        return -1;
+
+    if (value == 0)
+    {
+        PyErr_SetString(PyExc_TypeError, "Cannot delete the metadata_cache_ttl attribute.");
+        return -1;
+    }
+    double ttl = PyFloat_AsDouble(value);
+    if (ttl == -1.0 && PyErr_Occurred())
+        return -1;
+    if (ttl < 0)
+    {
+        PyErr_SetString(PyExc_ValueError, "Cannot set a negative metadata_cache_ttl.");
+        return -1;
+    }
+
+    // Entries keep the expiration they were created with, so start over.
+    _clear_metadata_cache(cnxn);
+    cnxn->metadata_ttl = (UINT64)(ttl * 1000000.0);
+
+    return 0;
+}
+
+static PyObject*
+Connection_getinternlimit(PyObject* self, void* closure)
+{
+    UNUSED(closure);
+
+    Connection* cnxn = Connection_Validate(self);
+    if (!cnxn)
+        return 0;
+
+    return PyInt_FromLong(cnxn->intern_limit);
+}
+
+static int
+Connection_setinternlimit(PyObject* self, PyObject* value, void* closure)
+{
+    UNUSED(closure);
+
+    Connection* cnxn = Connection_Validate(self);
+    if (!cnxn)
+        return -1;
+
+    if (value == 0)
+    {
+        PyErr_SetString(PyExc_TypeError, "Cannot delete the intern_limit attribute.");
+        return -1;
+    }
+    long limit = PyInt_AsLong(value);
+    if (limit == -1 && PyErr_Occurred())
+        return -1;
+    if (limit < 0 || limit > MAX_INTERN_LIMIT)
+    {
+        PyErr_Format(PyExc_ValueError, "The intern limit must be between 0 and %d.", MAX_INTERN_LIMIT);
+        return -1;
+    }
+
+    // Tables already created for the current results keep the limit they were created with.
+    cnxn->intern_limit = (int)limit;
+
+    return 0;
+}
+
+static PyObject*
+Connection_getlazyrows(PyObject* self, void* closure)
+{
+    UNUSED(closure);
+
+    Connection* cnxn = Connection_Validate(self);
+    if (!cnxn)
+        return 0;
+
+    PyObject* result = cnxn->lazy_rows ? Py_True : Py_False;
+    Py_INCREF(result);
+    return result;
+}
+
+static int
+Connection_setlazyrows(PyObject* self, PyObject* value, void* closure)
+{
+    UNUSED(closure);
+
+    Connection* cnxn = Connection_Validate(self);
+    if (!cnxn)
+        return -1;
+
+    if (value == 0)
+    {
+        PyErr_SetString(PyExc_TypeError, "Cannot delete the lazy_rows attribute.");
+        return -1;
+    }
+
+    int lazy = PyObject_IsTrue(value);
+    if (lazy == -1)
+        return -1;
+
+    cnxn->lazy_rows = (lazy != 0);
+
+    return 0;
+}
+
+static PyObject*
+Connection_getrecheckcolumns(PyObject* self, void* closure)
+{
+    UNUSED(closure);
+
+    Connection* cnxn = Connection_Validate(self);
+    if (!cnxn)
+        return 0;
+
+    PyObject* result = cnxn->recheck_columns ? Py_True : Py_False;
+    Py_INCREF(result);
+    return result;
+}
+
+static int
+Connection_setrecheckcolumns(PyObject* self, PyObject* value, void* closure)
+{
+    UNUSED(closure);
+
+    Connection* cnxn = Connection_Validate(self);
+    if (!cnxn)
+        return -1;
+
+    if (value == 0)
+    {
+        PyErr_SetString(PyExc_TypeError, "Cannot delete the recheck_columns attribute.");
+        return -1;
+    }
+
+    int recheck = PyObject_IsTrue(value);
+    if (recheck == -1)
+        return -1;
+
+    cnxn->recheck_columns = (recheck != 0);
+
+    return 0;
+}
+
+static PyObject*
+Connection_getmetadatahits(PyObject* self, void* closure)
+{
+    UNUSED(closure);
+
+    Connection* cnxn = Connection_Validate(self);
+    if (!cnxn)
+        return 0;
+
+    return PyInt_FromLong(cnxn->metadata_hits);
+}
+
+static PyObject*
+Connection_getmetadatamisses(PyObject* self, void* closure)
+{
+    UNUSED(closure);
+
+    Connection* cnxn = Connection_Validate(self);
+    if (!cnxn)
+        return 0;
+
+    return PyInt_FromLong(cnxn->metadata_misses);
+}
+
+static PyObject*
+Connection_getstats(PyObject* self, void* closure)
+{
+    UNUSED(closure);
+
+    Connection* cnxn = Connection_Validate(self);
+    if (!cnxn)
+        return 0;
+
+    return Stats_ToDict(cnxn->stats);
+}
+
+static PyObject*
+Connection_getodbccounts(PyObject* self, void* closure)
+{
+    UNUSED(closure);
+
+    Connection* cnxn = Connection_Validate(self);
+    if (!cnxn)
+        return 0;
+
+    return CallCounts_ToDict(cnxn);
+}
+
+static PyObject*
+Connection_getresultcache(PyObject* self, void* closure)
+{
+    UNUSED(closure);
+
+    Connection* cnxn = Connection_Validate(self);
+    if (!cnxn)
+        return 0;
+
+    PyObject* cache = cnxn->result_cache ? cnxn->result_cache : Py_None;
+    Py_INCREF(cache);
+    return cache;
+}
+
+static int
+Connection_setresultcache(PyObject* self, PyObject* value, void* closure)
+{
+    UNUSED(closure);
+
+    Connection* cnxn = Connection_Validate(self);
+    if (!cnxn)
+        return -1;
+
+    if (value == 0 || value == Py_None)
+    {
+        Py_XDECREF(cnxn->result_cache);
+        cnxn->result_cache = 0;
+        return 0;
+    }
+
+    if (!ResultCache_Check(value))
+    {
+        PyErr_SetString(PyExc_TypeError, "result_cache must be a pyodbc.ResultCache or None.");
+        return -1;
+    }
+
+    Py_INCREF(value);
+    Py_XDECREF(cnxn->result_cache);
+    cnxn->result_cache = value;
+
+    return 0;
+}
+
 static bool _add_converter(Connection* cnxn, SQLSMALLINT sqltype, PyObject* func)
 {
     if (cnxn->conv_count)
@@ -813,6 +1609,7 @@ static bool _add_converter(Connection* cnxn, SQLSMALLINT sqltype, PyObject* func
     cnxn->conv_count = newcount;
     cnxn->conv_types = newtypes;
     cnxn->conv_funcs = newfuncs;
+    cnxn->conv_version++;
 
     if (oldcount != 0)
     {
@@ -872,7 +1669,13 @@ static PyObject* Connection_exit(Connection* cnxn, PyObject* args)
     I(PyTuple_Check(args));
 
     if (cnxn->nAutoCommit == SQL_AUTOCOMMIT_OFF && PyTuple_GetItem(args, 0) == Py_None)
-        SQLEndTran(SQL_HANDLE_DBC, cnxn->hdbc, SQL_COMMIT);
+    {
+        if (SQL_SUCCEEDED(ODBC_CALL(cnxn, SQLEndTran)(SQL_HANDLE_DBC, cnxn->hdbc, SQL_COMMIT)))
+            _invalidate_result_cache(cnxn);
+        cnxn->pending_commits      = 0;
+        cnxn->txn_written          = false;
+        cnxn->written_since_commit = false;
+    }
 
     Py_RETURN_NONE;
 }
@@ -880,16 +1683,19 @@ static PyObject* Connection_exit(Connection* cnxn, PyObject* args)
 
 static struct PyMethodDef Connection_methods[] =
 {
-    { "cursor",                  (PyCFunction)Connection_cursor,          METH_NOARGS,  cursor_doc     },
-    { "close",                   (PyCFunction)Connection_close,           METH_NOARGS,  close_doc      },
-    { "execute",                 (PyCFunction)Connection_execute,         METH_VARARGS, execute_doc    },
-    { "commit",                  (PyCFunction)Connection_commit,          METH_NOARGS,  commit_doc     },
-    { "rollback",                (PyCFunction)Connection_rollback,        METH_NOARGS,  rollback_doc   },
-    { "getinfo",                 (PyCFunction)Connection_getinfo,         METH_VARARGS, getinfo_doc    },
-    { "add_output_converter",    (PyCFunction)Connection_conv_add,        METH_VARARGS, conv_add_doc   },
-    { "clear_output_converters", (PyCFunction)Connection_conv_clear,      METH_NOARGS,  conv_clear_doc },
-    { "__enter__",               (PyCFunction)Connection_enter,           METH_NOARGS,  enter_doc      },
-    { "__exit__",                (PyCFunction)Connection_exit,            METH_VARARGS, exit_doc       },
+    { "cursor",                  (PyCFunction)Connection_cursor,               METH_NOARGS,                cursor_doc               },
+    { "close",                   (PyCFunction)Connection_close,                METH_NOARGS,                close_doc                },
+    { "execute",                 (PyCFunction)Connection_execute,              METH_VARARGS|METH_KEYWORDS, execute_doc              },
+    { "commit",                  (PyCFunction)Connection_commit,               METH_NOARGS,                commit_doc               },
+    { "rollback",                (PyCFunction)Connection_rollback,             METH_NOARGS,                rollback_doc             },
+    { "flush",                   (PyCFunction)Connection_flush,                METH_NOARGS,                flush_doc                },
+    { "group_commit",            (PyCFunction)Connection_group_commit,         METH_VARARGS|METH_KEYWORDS, group_commit_doc         },
+    { "getinfo",                 (PyCFunction)Connection_getinfo,              METH_VARARGS,               getinfo_doc              },
+    { "clear_metadata_cache",    (PyCFunction)Connection_clear_metadata_cache, METH_NOARGS,                clear_metadata_cache_doc },
+    { "add_output_converter",    (PyCFunction)Connection_conv_add,             METH_VARARGS,               conv_add_doc             },
+    { "clear_output_converters", (PyCFunction)Connection_conv_clear,           METH_NOARGS,                conv_clear_doc           },
+    { "__enter__",               (PyCFunction)Connection_enter,                METH_NOARGS,                enter_doc                },
+    { "__exit__",                (PyCFunction)Connection_exit,                 METH_VARARGS,               exit_doc                 },
     
     { 0, 0, 0, 0 }
 };
@@ -902,6 +1708,36 @@ static PyGetSetDef Connection_getseters[] = {
       "Returns True if the connection is in autocommit mode; False otherwise.", 0 },
     { "timeout", Connection_gettimeout, Connection_settimeout,
       "The timeout in seconds, zero means no timeout.", 0 },
+    { "encoding", Connection_getencoding, Connection_setencoding,
+      "The encoding used to decode char and varchar data when unicode_results is on, or None to have the driver\n"
+      "convert it.", 0 },
+    { "coalesced_commits", Connection_getcoalesced, 0,
+      "The number of commit() calls that group commit combined with another.", 0 },
+    { "statement_pool_size", Connection_getstmtpoolsize, Connection_setstmtpoolsize,
+      "The maximum number of idle statement handles kept for reuse by new cursors.", 0 },
+    { "statements_reused", Connection_getstmtsreused, 0,
+      "The number of cursors that reused a pooled statement handle instead of allocating one.", 0 },
+    { "statements_allocated", Connection_getstmtsallocated, 0,
+      "The number of statement handles allocated for cursors.", 0 },
+    { "intern_limit", Connection_getinternlimit, Connection_setinternlimit,
+      "The most distinct values of each char, date, time, and datetime column of a result set that are returned as "
+      "the same object.  Zero (the default) creates a new object for every value.", 0 },
+    { "lazy_rows", Connection_getlazyrows, Connection_setlazyrows,
+      "If True, rows convert each column to a Python object the first time it is used instead of when fetched.", 0 },
+    { "recheck_columns", Connection_getrecheckcolumns, Connection_setrecheckcolumns,
+      "If True, the description cached for a prepared statement is only reused after describing each column again.", 0 },
+    { "metadata_cache_ttl", Connection_getmetadatattl, Connection_setmetadatattl,
+      "The number of seconds getinfo values and catalog results are cached.  Zero (the default) disables the cache.", 0 },
+    { "metadata_cache_hits", Connection_getmetadatahits, 0,
+      "The number of getinfo and catalog calls answered from the metadata cache.", 0 },
+    { "metadata_cache_misses", Connection_getmetadatamisses, 0,
+      "The number of getinfo and catalog calls that were not in the metadata cache while it was enabled.", 0 },
+    { "result_cache", Connection_getresultcache, Connection_setresultcache,
+      "The pyodbc.ResultCache used to cache SELECT results, or None.", 0 },
+    { "stats", Connection_getstats, 0,
+      "Timing statistics totaled for all of the connection's cursors (see pyodbc.enable_stats).", 0 },
+    { "odbc_counts", Connection_getodbccounts, 0,
+      "The number of calls to each ODBC function and the bytes sent and received on this connection.", 0 },
     { 0 }
 };
 
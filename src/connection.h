@@ -12,8 +12,14 @@
 #ifndef CONNECTION_H
 #define CONNECTION_H
 
+#include "stats.h"
+#include "callcounts.h"
+
 struct Cursor;
 
+// The largest value allowed for Connection.statement_pool_size.
+#define MAX_STMT_POOL 64
+
 extern PyTypeObject ConnectionType;
 
 struct Connection
@@ -37,15 +43,84 @@ struct Connection
     // to insert NULLs into binary columns.
     bool supports_describeparam;
 
+    // Will be true if the driver supports SQL_ATTR_ASYNC_ENABLE on individual statements (SQL_ASYNC_MODE is
+    // SQL_AM_STATEMENT).  If false, Cursor.execute_async uses the worker threads instead.
+    bool supports_async;
+
     // The column size of datetime columns, obtained from SQLGetInfo(), used to determine the datetime precision.
     int datetime_precision;
 
     // If true, then the strings in the rows are returned as unicode objects.
     bool unicode_results;
 
+    // If non-zero, the codec name (a PyString) used to decode SQL_CHAR data when unicode_results is on.  The data is
+    // read as SQL_C_CHAR and decoded instead of being read as SQL_C_WCHAR.  encoding_utf8 is true if this is UTF-8,
+    // which is decoded by PyUnicode_FromUTF8 instead of the codec.
+    PyObject* encoding;
+    bool encoding_utf8;
+
     // The connection timeout in seconds.
     int timeout;
 
+    // Group commit (see Connection.group_commit).  When either setting is non-zero and autocommit is off, commit()
+    // only ends the transaction every `group_commit_count` calls or once the oldest deferred commit is
+    // `group_commit_interval` milliseconds old.  Both zero means every commit() is sent immediately.
+    int group_commit_count;
+    long group_commit_interval;
+
+    int pending_commits;        // commit() calls that have not been sent to the database yet
+
+    // True if a statement other than a SELECT has been executed since the last commit() or rollback().  Deferred
+    // commits only cover the work done before the last commit(), so they cannot be sent implicitly (by flush(),
+    // close(), etc.) while this is set: ODBC can only commit the whole transaction.
+    bool written_since_commit;
+    UINT64 first_pending;       // MonotonicMicroseconds() when the oldest pending commit was deferred
+    long coalesced_commits;     // commit() calls that were merged into another call's SQLEndTran
+
+    // A pool of idle statement handles.  When a cursor is closed its HSTMT is closed and reset and put here so the next
+    // Cursor_New can reuse it instead of calling SQLAllocHandle (and SQLSetStmtAttr for the timeout).  All pooled
+    // handles have SQL_ATTR_QUERY_TIMEOUT set to `timeout`, so the pool is emptied when the timeout changes.  Only
+    // accessed while holding the GIL.
+    HSTMT* stmt_pool;           // array of MAX_STMT_POOL handles, allocated on first use
+    int stmt_pool_count;        // the number of idle handles in stmt_pool
+    int stmt_pool_size;         // the maximum number of idle handles kept (<= MAX_STMT_POOL); zero disables pooling
+    long stmts_allocated;       // handles allocated by SQLAllocHandle for cursors
+    long stmts_reused;          // handles taken from the pool
+
+    // The metadata cache (see Connection.metadata_cache_ttl) for getinfo values and catalog function results.  Maps
+    // from a key (the infotype for getinfo or a tuple for catalog functions) to an (expiration, value) tuple, where
+    // expiration is a MonotonicMicroseconds value.  Zero until something is cached.
+    PyObject* metadata_cache;
+    UINT64 metadata_ttl;        // microseconds; zero disables the cache
+    long metadata_hits;
+    long metadata_misses;
+
+    // The most distinct values interned for each character and date/time column of a result set, or zero to not
+    // intern them (see Connection.intern_limit and intern.h).
+    int intern_limit;
+
+    // If true, fetched rows keep the data read for each column and convert it to a Python object the first time the
+    // column is used (see Connection.lazy_rows and rawrow.h).
+    bool lazy_rows;
+
+    // If true, a prepared statement's cached result metadata is only reused after checking each column with
+    // SQLDescribeCol, for drivers whose column types can change between executes with the same parameter types (see
+    // Connection.recheck_columns and Cursor.cached_colinfos).
+    bool recheck_columns;
+
+    // The pyodbc.ResultCache used for SELECT results, or zero if results are not cached.
+    PyObject* result_cache;
+
+    // True if a statement other than a SELECT has been executed in the current transaction.  The result cache is not
+    // used until the transaction ends since cached results would not reflect the changes.
+    bool txn_written;
+
+    // Totals for all of the connection's cursors.  Only collected while pyodbc.enable_stats is on.
+    Stats stats;
+
+    // The ODBC calls made on the connection (see Connection.odbc_counts).
+    CallCounts callcounts;
+
     // These are copied from cnxn info for performance and convenience.
 
     int varchar_maxlength;
@@ -62,15 +137,43 @@ struct Connection
     int conv_count;             // how many items are in conv_types and conv_funcs.
     SQLSMALLINT* conv_types;            // array of SQL_TYPEs to convert
     PyObject** conv_funcs;      // array of Python functions
+
+    // Incremented whenever the set of converted SQL types changes, which changes the types in Cursor.description.
+    // Cursors compare it to the version their cached result metadata was created with.
+    int conv_version;
 };
 
 #define Connection_Check(op) PyObject_TypeCheck(op, &ConnectionType)
 #define Connection_CheckExact(op) ((op)->ob_type == &ConnectionType)
 
+/*
+ * Returns an idle statement handle from the connection's pool, or SQL_NULL_HANDLE if the pool is empty.
+ */
+HSTMT Connection_TakeStatement(Connection* cnxn);
+
+/*
+ * Offers a statement handle that is no longer used to the connection's pool.  The handle must be closed
+ * (SQLFreeStmt(SQL_CLOSE)) and must not have statement attributes other than the defaults and the query timeout.
+ * Returns false if the pool is full or disabled, in which case the caller must free the handle.
+ */
+bool Connection_ReturnStatement(Connection* cnxn, HSTMT hstmt);
+
+/*
+ * Returns the value cached for `key` in the connection's metadata cache (a borrowed reference), or zero if the cache is
+ * disabled or the value is not cached or has expired.  An exception is never set.
+ */
+PyObject* Connection_GetCached(Connection* cnxn, PyObject* key);
+
+/*
+ * Adds `value` to the connection's metadata cache if it is enabled.  Returns false if an exception was set.
+ */
+bool Connection_SetCached(Connection* cnxn, PyObject* key, PyObject* value);
+
 /*
  * Used by the module's connect function to create new connection objects.  If unable to connect to the database, an
  * exception is set and zero is returned.
  */
-PyObject* Connection_New(PyObject* pConnectString, bool fAutoCommit, bool fAnsi, bool fUnicodeResults, long timeout);
+PyObject* Connection_New(PyObject* pConnectString, bool fAutoCommit, bool fAnsi, bool fUnicodeResults, PyObject* encoding,
+                         long timeout);
 
 #endif
@@ -0,0 +1,33 @@
+
+#include "pyodbc.h"
+#include "cpufeatures.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+bool cpu_has_avx2 = false;
+
+void CpuFeatures_init()
+{
+#if defined(PYODBC_AVX2) && defined(_MSC_VER)
+    // The processor must support AVX2 and the OS must save the AVX registers (OSXSAVE and the XCR0 YMM bits).
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return;
+
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx     = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6)
+        return;
+
+    __cpuidex(info, 7, 0);
+    cpu_has_avx2 = (info[1] & (1 << 5)) != 0;
+#elif defined(PYODBC_AVX2)
+    // This checks the OS support as well.
+    __builtin_cpu_init();
+    cpu_has_avx2 = __builtin_cpu_supports("avx2") != 0;
+#endif
+}
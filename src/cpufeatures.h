@@ -0,0 +1,31 @@
+
+#ifndef _CPUFEATURES_H_
+#define _CPUFEATURES_H_
+
+// Compile-time and runtime detection of the x86 vector instructions used by the text conversion kernels.
+//
+// SSE2 is part of every x64 processor, so it is used whenever the compiler targets it.  AVX2 is only used if the
+// processor and OS support it, which is checked once at import.  Functions using AVX2 are marked PYODBC_TARGET_AVX2 so
+// the rest of the module can still be compiled for older processors.
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PYODBC_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER) && _MSC_VER >= 1700 && defined(PYODBC_SSE2)
+#define PYODBC_AVX2 1
+#define PYODBC_TARGET_AVX2
+#include <immintrin.h>
+#elif defined(__GNUC__) && defined(PYODBC_SSE2) && (defined(__clang__) || __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#define PYODBC_AVX2 1
+#define PYODBC_TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#endif
+
+// True if the AVX2 kernels can be used.  Always false when PYODBC_AVX2 is not defined.
+extern bool cpu_has_avx2;
+
+void CpuFeatures_init();
+
+#endif // _CPUFEATURES_H_
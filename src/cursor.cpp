@@ -24,6 +24,16 @@
 #include "getdata.h"
 #include "dbspecific.h"
 #include "sqlwchar.h"
+#include "watchdog.h"
+#include "threads.h"
+#include "async.h"
+#include "resultcache.h"
+#include "querylog.h"
+#include "latency.h"
+#include "trace.h"
+#include "intern.h"
+#include "rawrow.h"
+#include "wrapper.h"
 
 enum
 {
@@ -31,6 +41,7 @@ enum
     CURSOR_REQUIRE_OPEN    = 0x00000003, // includes _CNXN
     CURSOR_REQUIRE_RESULTS = 0x00000007, // includes _OPEN
     CURSOR_RAISE_ERROR     = 0x00000010,
+    CURSOR_ALLOW_ASYNC     = 0x00000020, // don't fail _OPEN if an asynchronous operation is pending
 };
 
 inline bool
@@ -94,9 +105,16 @@ Cursor* Cursor_Validate(PyObject* obj, DWORD flags)
                 PyErr_SetString(ProgrammingError, "The cursor's connection has been closed.");
             return 0;
         }
+
+        if (cursor->async_op != 0 && !(flags & CURSOR_ALLOW_ASYNC))
+        {
+            if (flags & CURSOR_RAISE_ERROR)
+                PyErr_SetString(ProgrammingError, "The cursor has an asynchronous operation in progress.");
+            return 0;
+        }
     }
 
-    if (IsSet(flags, CURSOR_REQUIRE_RESULTS) && cursor->colinfos == 0)
+    if (IsSet(flags, CURSOR_REQUIRE_RESULTS) && cursor->colinfos == 0 && cursor->preloaded == 0)
     {
         if (flags & CURSOR_RAISE_ERROR)
             PyErr_SetString(ProgrammingError, "No results.  Previous SQL was not a query.");
@@ -220,150 +238,65 @@ PythonTypeFromSqlType(Cursor* cur, const SQLCHAR* name, SQLSMALLINT type, bool u
 }
 
 
-static bool
-create_name_map(Cursor* cur, SQLSMALLINT field_count, bool lower)
+static void
+StopRecording(Cursor* cur)
 {
-    // Called after an execute to construct the map shared by rows.
+    // Discards the rows recorded for the result cache.
 
-    bool success = false;
-    PyObject *desc = 0, *colmap = 0, *colinfo = 0, *type = 0, *index = 0, *nullable_obj=0;
-    SQLRETURN ret;
+    Py_XDECREF(cur->record_key);
+    Py_XDECREF(cur->record_rows);
+    cur->record_key  = 0;
+    cur->record_rows = 0;
+    cur->record_size = 0;
+}
 
-	I(cur->hstmt != SQL_NULL_HANDLE && cur->colinfos != 0);
 
-    // These are the values we expect after free_results.  If this function fails, we do not modify any members, so
-    // they should be set to something Cursor_close can deal with.
-    I(cur->description == Py_None);
-    I(cur->map_name_to_index == 0);
+static bool
+RecordRow(Cursor* cur, PyObject** apValues, Py_ssize_t cValues)
+{
+    // Adds a fetched row to the rows being recorded for the result cache.  If the result set is now too large to
+    // cache, recording stops.
 
-    if (cur->cnxn->hdbc == SQL_NULL_HANDLE)
+    cur->record_size += ResultCache_RowSize(apValues, cValues);
+    if (cur->cnxn->result_cache == 0 || cur->record_size > ResultCache_MaxBytes(cur->cnxn->result_cache))
     {
-        RaiseErrorV(0, ProgrammingError, "The cursor's connection was closed.");
-        return false;
+        StopRecording(cur);
+        return true;
     }
 
-    desc   = PyTuple_New((Py_ssize_t)field_count);
-    colmap = PyDict_New();
-    if (!desc || !colmap)
-        goto done;
-    
-    for (int i = 0; i < field_count; i++)
-    {
-        SQLCHAR name[300];
-        SQLSMALLINT nDataType;
-        SQLULEN nColSize;           // precision
-        SQLSMALLINT cDecimalDigits; // scale
-        SQLSMALLINT nullable;
-
-        Py_BEGIN_ALLOW_THREADS
-		ret = SQLDescribeCol(cur->hstmt, (SQLUSMALLINT)(i + 1), name, _countof(name), 0, &nDataType, &nColSize, &cDecimalDigits, &nullable);
-		Py_END_ALLOW_THREADS
-
-        if (cur->cnxn->hdbc == SQL_NULL_HANDLE)
-        {
-            // The connection was closed by another thread in the ALLOW_THREADS block above.
-            RaiseErrorV(0, ProgrammingError, "The cursor's connection was closed.");
-            goto done;
-        }
-
-        if (!SQL_SUCCEEDED(ret))
-        {
-            RaiseErrorFromHandle("SQLDescribeCol", cur->cnxn->hdbc, cur->hstmt);
-            goto done;
-        }
-
-        TRACE("Col %d: type=%d colsize=%d\n", (i+1), (int)nDataType, (int)nColSize);
-
-        if (lower)
-            _strlwr((char*)name);
-        
-        type = PythonTypeFromSqlType(cur, name, nDataType, cur->cnxn->unicode_results);
-        if (!type)
-            goto done;
-
-        switch (nullable)
-        {
-        case SQL_NO_NULLS:
-            nullable_obj = Py_False;
-            break;
-        case SQL_NULLABLE:
-            nullable_obj = Py_True;
-            break;
-        case SQL_NULLABLE_UNKNOWN:
-        default:
-            nullable_obj = Py_None;
-            break;
-        }
-
-        // The Oracle ODBC driver has a bug (I call it) that it returns a data size of 0 when a numeric value is
-        // retrieved from a UNION: http://support.microsoft.com/?scid=kb%3Ben-us%3B236786&x=13&y=6
-        //
-        // Unfortunately, I don't have a test system for this yet, so I'm *trying* something.  (Not a good sign.)  If
-        // the size is zero and it appears to be a numeric type, we'll try to come up with our own length using any
-        // other data we can get.
-
-        if (nColSize == 0 && IsNumericType(nDataType))
-        {
-            // I'm not sure how
-            if (cDecimalDigits != 0)
-            {
-                nColSize = (SQLUINTEGER)(cDecimalDigits + 3);
-            }
-            else
-            {
-                // I'm not sure if this is a good idea, but ...
-                nColSize = 42;
-            }
-        }
-        
-        colinfo = Py_BuildValue("(sOOiiiO)",
-                                (char*)name,
-                                type,                // type_code
-                                Py_None,             // display size
-                                (int)nColSize,       // internal_size
-                                (int)nColSize,       // precision
-                                (int)cDecimalDigits, // scale
-                                nullable_obj);       // null_ok
-        if (!colinfo)
-            goto done;
-
-
-        nullable_obj = 0;
-
-        index = PyInt_FromLong(i);
-        if (!index)
-            goto done;
-
-        PyDict_SetItemString(colmap, (const char*)name, index);
-        Py_DECREF(index);       // SetItemString increments
-        index = 0;
+    PyObject* values = PyTuple_New(cValues);
+    if (!values)
+        return false;
 
-        PyTuple_SET_ITEM(desc, i, colinfo);
-        colinfo = 0;            // reference stolen by SET_ITEM
+    for (Py_ssize_t i = 0; i < cValues; i++)
+    {
+        Py_INCREF(apValues[i]);
+        PyTuple_SET_ITEM(values, i, apValues[i]);
     }
 
-    Py_XDECREF(cur->description);
-    cur->description = desc;
-    desc = 0;
-    cur->map_name_to_index = colmap;
-    colmap = 0;
+    int result = PyList_Append(cur->record_rows, values);
+    Py_DECREF(values);
+    return result == 0;
+}
+
 
-    success = true;
+static void
+FinishRecording(Cursor* cur)
+{
+    // Called when the last row has been fetched: adds the recorded rows to the result cache.
 
-  done:
-    Py_XDECREF(nullable_obj);
-    Py_XDECREF(desc);
-    Py_XDECREF(colmap);
-    Py_XDECREF(index);
-    Py_XDECREF(colinfo);
+    if (cur->cnxn->result_cache)
+        ResultCache_Add(cur->cnxn->result_cache, cur->record_key, cur->record_generation, cur->description, cur->map_name_to_index, cur->record_rows, cur->record_size);
 
-    return success;
+    StopRecording(cur);
 }
 
+
 enum free_results_type
 {
     FREE_STATEMENT,
-    KEEP_STATEMENT
+    KEEP_STATEMENT,
+    FREE_PREPARED               // FREE_STATEMENT and discard the prepared statement, used by the catalog functions
 };
 
 static bool
@@ -375,27 +308,38 @@ free_results(Cursor* self, free_results_type free_statement)
     // If we ran out of memory, it is possible that we have a cursor but colinfos is zero.  However, we should be
     // deleting this object, so the cursor will be freed when the HSTMT is destroyed. */
 
+    if (self->querylog_sql)
+        QueryLog_RecordResult(self);
+
     if (self->colinfos)
     {
         pyodbc_free(self->colinfos);
         self->colinfos = 0;
     }
+
+    Intern_Free(self);
+
+    if (self->raw_block)
+    {
+        RawBlock_Release(self->raw_block);
+        self->raw_block = 0;
+    }
     
     if (StatementIsValid(self))
     {
-        if (free_statement == FREE_STATEMENT)
+        if (free_statement != KEEP_STATEMENT)
         {
             SQLRETURN ret;
             Py_BEGIN_ALLOW_THREADS
-            ret = SQLFreeStmt(self->hstmt, SQL_CLOSE);
+            ret = ODBC_CALL(self->cnxn, SQLFreeStmt)(self->hstmt, SQL_CLOSE);
             Py_END_ALLOW_THREADS;
         }
         else
         {
             SQLRETURN ret;
             Py_BEGIN_ALLOW_THREADS
-            ret = SQLFreeStmt(self->hstmt, SQL_UNBIND);
-            ret = SQLFreeStmt(self->hstmt, SQL_RESET_PARAMS);
+            ret = ODBC_CALL(self->cnxn, SQLFreeStmt)(self->hstmt, SQL_UNBIND);
+            ret = ODBC_CALL(self->cnxn, SQLFreeStmt)(self->hstmt, SQL_RESET_PARAMS);
             Py_END_ALLOW_THREADS;
             
         }
@@ -421,6 +365,24 @@ free_results(Cursor* self, free_results_type free_statement)
         self->map_name_to_index = 0;
     }
 
+    if (self->preloaded)
+    {
+        Py_DECREF(self->preloaded);
+        self->preloaded = 0;
+    }
+
+    StopRecording(self);
+
+    // A result set that was not fetched to the end is not counted in the fetch latency.
+    self->fetch_start = 0;
+
+    if (self->trace_id)
+        Trace_RecordResult(self);
+
+    // The catalog functions replace the prepared statement, so it must be prepared again on the next execute.
+    if (free_statement == FREE_PREPARED)
+        FreeParameterInfo(self);
+
     self->rowcount = -1;
 
     return true;
@@ -443,9 +405,25 @@ closeimpl(Cursor* cur)
     {
         HSTMT hstmt = cur->hstmt;
         cur->hstmt = SQL_NULL_HANDLE;
-        Py_BEGIN_ALLOW_THREADS
-        SQLFreeHandle(SQL_HANDLE_STMT, hstmt);
-        Py_END_ALLOW_THREADS
+
+        // The statement was closed by free_results.  If the parameter bindings can be reset too, the handle is as good
+        // as new and can be reused by the next cursor.
+        bool pool = !cur->attrs_changed && cur->async_op == 0 && cur->cnxn->stmt_pool_size != 0;
+        if (pool)
+        {
+            SQLRETURN ret;
+            Py_BEGIN_ALLOW_THREADS
+            ret = ODBC_CALL(cur->cnxn, SQLFreeStmt)(hstmt, SQL_RESET_PARAMS);
+            Py_END_ALLOW_THREADS
+            pool = SQL_SUCCEEDED(ret) && Connection_ReturnStatement(cur->cnxn, hstmt);
+        }
+
+        if (!pool && cur->cnxn->hdbc != SQL_NULL_HANDLE)
+        {
+            Py_BEGIN_ALLOW_THREADS
+            ODBC_CALL(cur->cnxn, SQLFreeHandle)(SQL_HANDLE_STMT, hstmt);
+            Py_END_ALLOW_THREADS
+        }
     }
 
     
@@ -453,6 +431,16 @@ closeimpl(Cursor* cur)
     Py_XDECREF(cur->description);
     Py_XDECREF(cur->map_name_to_index);
     Py_XDECREF(cur->cnxn);
+    Py_XDECREF(cur->sql_source);
+
+    pyodbc_free(cur->scratch);
+    pyodbc_free(cur->sql_text);
+
+    cur->scratch = 0;
+    cur->scratch_size = 0;
+    cur->sql_source = 0;
+    cur->sql_text = 0;
+    cur->sql_text_capacity = 0;
 
     cur->pPreparedSQL = 0;
     cur->description = 0;
@@ -488,15 +476,19 @@ Cursor_dealloc(Cursor* cursor)
         closeimpl(cursor);
     }
 
+    // closeimpl records this when the connection is still open.
+    QueryLog_RecordResult(cursor);
+
     PyObject_Del(cursor);
 }
 
 
 
-bool
-InitColumnInfo(Cursor* cursor, SQLUSMALLINT iCol, ColumnInfo* pinfo)
+static bool
+InitColumnInfo(Cursor* cursor, SQLUSMALLINT iCol, ColumnInfo* pinfo, bool lower, PyObject* desc, PyObject* colmap)
 {
-    // Initializes ColumnInfo from result set metadata.
+    // Initializes ColumnInfo from result set metadata and adds the column to the description tuple `desc` and the name
+    // map `colmap`.
 
     SQLRETURN ret;
 
@@ -505,7 +497,7 @@ InitColumnInfo(Cursor* cursor, SQLUSMALLINT iCol, ColumnInfo* pinfo)
     // I suspect the problem is that it doesn't allow NULLs in some of the parameters, so I'm going to supply them all
     // to see what happens.
 
-    SQLCHAR     ColumnName[200];
+    SQLCHAR     ColumnName[300];
     SQLSMALLINT BufferLength  = _countof(ColumnName);
     SQLSMALLINT NameLength    = 0;
     SQLSMALLINT DataType      = 0;
@@ -514,7 +506,7 @@ InitColumnInfo(Cursor* cursor, SQLUSMALLINT iCol, ColumnInfo* pinfo)
     SQLSMALLINT Nullable      = 0;
 
     Py_BEGIN_ALLOW_THREADS
-    ret = SQLDescribeCol(cursor->hstmt, iCol,
+    ret = ODBC_CALL(cursor->cnxn, SQLDescribeCol)(cursor->hstmt, iCol,
                          ColumnName,
                          BufferLength,
                          &NameLength,
@@ -524,8 +516,10 @@ InitColumnInfo(Cursor* cursor, SQLUSMALLINT iCol, ColumnInfo* pinfo)
                          &Nullable);
     Py_END_ALLOW_THREADS
 
-    pinfo->sql_type    = DataType;
-    pinfo->column_size = ColumnSize;
+    pinfo->sql_type       = DataType;
+    pinfo->column_size    = ColumnSize;
+    pinfo->decimal_digits = DecimalDigits;
+    pinfo->nullable       = Nullable;
 
     if (cursor->cnxn->hdbc == SQL_NULL_HANDLE)
     {
@@ -540,6 +534,8 @@ InitColumnInfo(Cursor* cursor, SQLUSMALLINT iCol, ColumnInfo* pinfo)
         return false;
     }
 
+    TRACE("Col %d: type=%d colsize=%d\n", (int)iCol, (int)DataType, (int)ColumnSize);
+
     // If it is an integer type, determine if it is signed or unsigned.  The buffer size is the same but we'll need to
     // know when we convert to a Python integer.
 
@@ -552,7 +548,7 @@ InitColumnInfo(Cursor* cursor, SQLUSMALLINT iCol, ColumnInfo* pinfo)
     {
         SQLLEN f;
         Py_BEGIN_ALLOW_THREADS
-        ret = SQLColAttribute(cursor->hstmt, iCol, SQL_DESC_UNSIGNED, 0, 0, 0, &f);
+        ret = ODBC_CALL(cursor->cnxn, SQLColAttribute)(cursor->hstmt, iCol, SQL_DESC_UNSIGNED, 0, 0, 0, &f);
         Py_END_ALLOW_THREADS
 
         if (cursor->cnxn->hdbc == SQL_NULL_HANDLE)
@@ -575,44 +571,376 @@ InitColumnInfo(Cursor* cursor, SQLUSMALLINT iCol, ColumnInfo* pinfo)
         pinfo->is_unsigned = false;
     }
 
+    //
+    // The description entry and name map.
+    //
+
+    if (lower)
+        _strlwr((char*)ColumnName);
+        
+    PyObject* type = PythonTypeFromSqlType(cursor, ColumnName, DataType, cursor->cnxn->unicode_results);
+    if (!type)
+        return false;
+
+    PyObject* nullable_obj;
+    switch (Nullable)
+    {
+    case SQL_NO_NULLS:
+        nullable_obj = Py_False;
+        break;
+    case SQL_NULLABLE:
+        nullable_obj = Py_True;
+        break;
+    case SQL_NULLABLE_UNKNOWN:
+    default:
+        nullable_obj = Py_None;
+        break;
+    }
+
+    // The Oracle ODBC driver has a bug (I call it) that it returns a data size of 0 when a numeric value is
+    // retrieved from a UNION: http://support.microsoft.com/?scid=kb%3Ben-us%3B236786&x=13&y=6
+    //
+    // Unfortunately, I don't have a test system for this yet, so I'm *trying* something.  (Not a good sign.)  If
+    // the size is zero and it appears to be a numeric type, we'll try to come up with our own length using any
+    // other data we can get.
+
+    if (ColumnSize == 0 && IsNumericType(DataType))
+    {
+        // I'm not sure how
+        if (DecimalDigits != 0)
+        {
+            ColumnSize = (SQLUINTEGER)(DecimalDigits + 3);
+        }
+        else
+        {
+            // I'm not sure if this is a good idea, but ...
+            ColumnSize = 42;
+        }
+    }
+        
+    PyObject* colinfo = Py_BuildValue("(sOOiiiO)",
+                                      (char*)ColumnName,
+                                      type,                // type_code
+                                      Py_None,             // display size
+                                      (int)ColumnSize,     // internal_size
+                                      (int)ColumnSize,     // precision
+                                      (int)DecimalDigits,  // scale
+                                      nullable_obj);       // null_ok
+    if (!colinfo)
+        return false;
+
+    PyTuple_SET_ITEM(desc, iCol - 1, colinfo);
+
+    Object index(PyInt_FromLong(iCol - 1));
+    if (!index || PyDict_SetItemString(colmap, (const char*)ColumnName, index) == -1)
+        return false;
+
     return true;
 }
 
 
 static bool
-PrepareResults(Cursor* cur, int cCols)
+PrepareResults(Cursor* cur, int cCols, bool lower)
 {
     // Called after a SELECT has been executed to perform pre-fetch work.
     // 
-    // Allocates the ColumnInfo structures describing the returned data.
+    // Allocates the ColumnInfo structures describing the returned data and creates the description tuple and the map
+    // shared by rows.
 
-    int i;
-    I(cur->colinfos == 0);
+    I(cur->hstmt != SQL_NULL_HANDLE && cur->colinfos == 0);
 
-    cur->colinfos = (ColumnInfo*)pyodbc_malloc(sizeof(ColumnInfo) * cCols);
-    if (cur->colinfos == 0)
+    // These are the values we expect after free_results.  If this function fails, we do not modify any members, so
+    // they should be set to something Cursor_close can deal with.
+    I(cur->description == Py_None);
+    I(cur->map_name_to_index == 0);
+
+    if (cur->cnxn->hdbc == SQL_NULL_HANDLE)
+    {
+        RaiseErrorV(0, ProgrammingError, "The cursor's connection was closed.");
+        return false;
+    }
+
+    ColumnInfo* colinfos = (ColumnInfo*)pyodbc_malloc(sizeof(ColumnInfo) * cCols, MEM_COLINFOS);
+    if (colinfos == 0)
     {
         PyErr_NoMemory();
         return false;
     }
 
-    for (i = 0; i < cCols; i++)
+    Object desc(PyTuple_New((Py_ssize_t)cCols));
+    Object colmap(PyDict_New());
+    if (!desc || !colmap)
+    {
+        pyodbc_free(colinfos);
+        return false;
+    }
+
+    for (int i = 0; i < cCols; i++)
+    {
+        if (!InitColumnInfo(cur, (SQLUSMALLINT)(i + 1), &colinfos[i], lower, desc, colmap))
+        {
+            pyodbc_free(colinfos);
+            return false;
+        }
+    }
+
+    cur->colinfos = colinfos;
+
+    Py_DECREF(cur->description);
+    cur->description = desc.Detach();
+    cur->map_name_to_index = colmap.Detach();
+
+    return true;
+}
+
+
+void
+FreeColumnCache(Cursor* cur)
+{
+    if (cur->cached_colinfos)
+    {
+        pyodbc_free(cur->cached_colinfos);
+        cur->cached_colinfos = 0;
+        cur->cached_count    = 0;
+    }
+
+    Py_XDECREF(cur->cached_description);
+    Py_XDECREF(cur->cached_map);
+    cur->cached_description = 0;
+    cur->cached_map         = 0;
+}
+
+
+const SQLWCHAR*
+Cursor_SQLText(Cursor* cur, PyObject* pSql, Py_ssize_t& cch)
+{
+    Py_UNICODE* pch = PyUnicode_AS_UNICODE(pSql);
+    Py_ssize_t  len = PyUnicode_GET_SIZE(pSql);
+
+#if SQLWCHAR_SIZE == Py_UNICODE_SIZE
+    // No conversion is needed, so point into the Unicode object.
+    UNUSED(cur);
+    cch = len;
+    return (const SQLWCHAR*)pch;
+#else
+    // Since sql_source is immutable and we hold a reference, the text cannot have changed.
+    if (pSql == cur->sql_source)
+    {
+        cch = cur->sql_text_len;
+        return cur->sql_text;
+    }
+
+    Py_XDECREF(cur->sql_source);
+    cur->sql_source = 0;
+
+    Py_ssize_t needed = SQLWCHAR_Length(pch, len) + 1;
+    if (needed > cur->sql_text_capacity)
+    {
+        pyodbc_free(cur->sql_text);
+        cur->sql_text_capacity = 0;
+        cur->sql_text = (SQLWCHAR*)pyodbc_malloc(sizeof(SQLWCHAR) * needed, MEM_SQLWCHAR);
+        if (cur->sql_text == 0)
+        {
+            PyErr_NoMemory();
+            return 0;
+        }
+        cur->sql_text_capacity = needed;
+    }
+
+    cch = SQLWCHAR_Copy(cur->sql_text, pch, len);
+    if (cch == -1)
+        return 0;
+
+    cur->sql_source   = pSql;
+    cur->sql_text_len = cch;
+    Py_INCREF(pSql);
+    return cur->sql_text;
+#endif
+}
+
+
+static bool
+CachedColumnsMatch(Cursor* cur, int cCols, bool& match)
+{
+    // Sets `match` to true if the columns of the results just executed are the ones cached.  Used when the connection's
+    // recheck_columns is set, for dynamically typed databases like SQLite where a column's type can depend on the
+    // values in it, so each column is described again and compared.  This is still cheaper than creating the metadata:
+    // SQLColAttribute and the Python objects are skipped.
+
+    match = false;
+
+    for (int i = 0; i < cCols; i++)
+    {
+        SQLCHAR     ColumnName[300];
+        SQLSMALLINT NameLength    = 0;
+        SQLSMALLINT DataType      = 0;
+        SQLULEN     ColumnSize    = 0;
+        SQLSMALLINT DecimalDigits = 0;
+        SQLSMALLINT Nullable      = 0;
+
+        SQLRETURN ret;
+        Py_BEGIN_ALLOW_THREADS
+        ret = ODBC_CALL(cur->cnxn, SQLDescribeCol)(cur->hstmt, (SQLUSMALLINT)(i + 1), ColumnName, _countof(ColumnName),
+                                                   &NameLength, &DataType, &ColumnSize, &DecimalDigits, &Nullable);
+        Py_END_ALLOW_THREADS
+
+        if (cur->cnxn->hdbc == SQL_NULL_HANDLE)
+        {
+            // The connection was closed by another thread in the ALLOW_THREADS block above.
+            RaiseErrorV(0, ProgrammingError, "The cursor's connection was closed.");
+            return false;
+        }
+
+        if (!SQL_SUCCEEDED(ret))
+        {
+            RaiseErrorFromHandle("SQLDescribeCol", cur->cnxn->hdbc, cur->hstmt);
+            return false;
+        }
+
+        const ColumnInfo& cached = cur->cached_colinfos[i];
+        if (DataType != cached.sql_type || ColumnSize != cached.column_size ||
+            DecimalDigits != cached.decimal_digits || Nullable != cached.nullable)
+        {
+            return true;
+        }
+
+        if (cur->cached_lower)
+            _strlwr((char*)ColumnName);
+
+        PyObject* name = PyTuple_GET_ITEM(PyTuple_GET_ITEM(cur->cached_description, i), 0);
+        if (strcmp(PyString_AS_STRING(name), (const char*)ColumnName) != 0)
+            return true;
+    }
+
+    match = true;
+    return true;
+}
+
+static bool
+PrepareResultsCached(Cursor* cur, int cCols)
+{
+    // Called by execute instead of PrepareResults.  If the prepared statement was executed before and its columns are
+    // unchanged, its result metadata is reused instead of creating it again.  Otherwise the metadata is created and, if
+    // a statement is prepared, cached for the next execute.
+
+    bool lower = lowercase();
+
+    // The cache is freed when the parameter types change (see PrepareAndBind), so it is for the same SQL and types.
+    bool match = (cur->cached_colinfos != 0 && cur->cached_count == cCols && cur->cached_lower == lower &&
+                  cur->cached_conv_version == cur->cnxn->conv_version);
+
+    if (match && cur->cnxn->recheck_columns && !CachedColumnsMatch(cur, cCols, match))
+        return false;
+
+    if (match)
     {
-        if (!InitColumnInfo(cur, (SQLUSMALLINT)(i + 1), &cur->colinfos[i]))
+        I(cur->colinfos == 0 && cur->description == Py_None && cur->map_name_to_index == 0);
+
+        cur->colinfos = (ColumnInfo*)pyodbc_malloc(sizeof(ColumnInfo) * cCols, MEM_COLINFOS);
+        if (cur->colinfos == 0)
         {
-            pyodbc_free(cur->colinfos);
-            cur->colinfos = 0;
+            PyErr_NoMemory();
             return false;
         }
+        memcpy(cur->colinfos, cur->cached_colinfos, sizeof(ColumnInfo) * cCols);
+
+        Py_DECREF(cur->description);
+        cur->description = cur->cached_description;
+        Py_INCREF(cur->description);
+
+        cur->map_name_to_index = cur->cached_map;
+        Py_INCREF(cur->map_name_to_index);
+
+        return true;
+    }
+
+    FreeColumnCache(cur);
+
+    if (!PrepareResults(cur, cCols, lower))
+        return false;
+
+    if (cur->pPreparedSQL != 0)
+    {
+        // Failing to cache is not an error; the next execute will describe the columns again.
+        cur->cached_colinfos = (ColumnInfo*)pyodbc_malloc(sizeof(ColumnInfo) * cCols, MEM_COLINFOS);
+        if (cur->cached_colinfos != 0)
+        {
+            memcpy(cur->cached_colinfos, cur->colinfos, sizeof(ColumnInfo) * cCols);
+            cur->cached_count        = cCols;
+            cur->cached_description  = cur->description;
+            cur->cached_map          = cur->map_name_to_index;
+            cur->cached_lower        = lower;
+            cur->cached_conv_version = cur->cnxn->conv_version;
+            Py_INCREF(cur->cached_description);
+            Py_INCREF(cur->cached_map);
+        }
+    }
+
+    return true;
+}
+
+static bool
+SetStatementAsync(Cursor* cur, bool enable)
+{
+    // Turns SQL_ATTR_ASYNC_ENABLE on or off for the cursor's statement.  Returns false with an exception set if the
+    // driver refuses.
+
+    SQLRETURN ret;
+    Py_BEGIN_ALLOW_THREADS
+    ret = ODBC_CALL(cur->cnxn, SQLSetStmtAttr)(cur->hstmt, SQL_ATTR_ASYNC_ENABLE, (SQLPOINTER)(enable ? SQL_ASYNC_ENABLE_ON : SQL_ASYNC_ENABLE_OFF), SQL_IS_UINTEGER);
+    Py_END_ALLOW_THREADS
+
+    if (cur->cnxn->hdbc == SQL_NULL_HANDLE)
+    {
+        // The connection was closed by another thread in the ALLOW_THREADS block above.
+        RaiseErrorV(0, ProgrammingError, "The cursor's connection was closed.");
+        return false;
+    }
+
+    if (!SQL_SUCCEEDED(ret))
+    {
+        RaiseErrorFromHandle("SQLSetStmtAttr", cur->cnxn->hdbc, cur->hstmt);
+        return false;
     }
 
     return true;
 }
 
+static PyObject* execute_complete(Cursor* cur, SQLRETURN ret, const char* szLastFunction, bool async);
+
+static SQLRETURN
+PutData(Cursor* cur, SQLPOINTER pData, SQLLEN cbData)
+{
+    // Sends one piece of a data-at-execution parameter.  Only the call itself is timed as part of the execute since the
+    // pieces are converted with the GIL held.
+
+    SQLRETURN ret;
+    StatsTimer timer(cur, &Stats::execute);
+    Py_BEGIN_ALLOW_THREADS
+    do
+    {
+        ret = ODBC_CALL(cur->cnxn, SQLPutData)(cur->hstmt, pData, cbData);
+    }
+    while (ret == SQL_STILL_EXECUTING);
+    Py_END_ALLOW_THREADS
+    return ret;
+}
+
+static void
+InvalidateResultCache(Cursor* cur, bool write)
+{
+    // Called after a statement is executed.  In autocommit mode, a statement other than a SELECT has already committed
+    // its changes, so the cached results may be stale.  (In a transaction, the cache is invalidated when it is
+    // committed.)
+
+    if (write && cur->cnxn->result_cache && cur->cnxn->nAutoCommit != SQL_AUTOCOMMIT_OFF)
+        ResultCache_Invalidate(cur->cnxn->result_cache);
+}
+
 static PyObject*
-execute(Cursor* cur, PyObject* pSql, PyObject* params, bool skip_first)
+execute_statement(Cursor* cur, PyObject* pSql, PyObject* params, bool skip_first)
 {
-    // Internal function to execute SQL, called by .execute and .executemany.
+    // Internal function to execute SQL, called by .execute and .executemany through execute().
     // 
     // pSql
     //   A PyString, PyUnicode, or derived object containing the SQL.
@@ -642,6 +970,46 @@ execute(Cursor* cur, PyObject* pSql, PyObject* params, bool skip_first)
 
     free_results(cur, FREE_STATEMENT);
 
+    // Cursor.stats describes the most recent statement.
+    if (stats_enabled)
+    {
+        memset(&cur->stats, 0, sizeof(cur->stats));
+        memset(&cur->gilclock, 0, sizeof(cur->gilclock));
+        Stats_Add(cur, &Stats::executes, 1);
+    }
+
+    // SELECT results can come from the connection's result cache, but not once the transaction has written something
+    // the cached results would not reflect.
+
+    Connection* cnxn = cur->cnxn;
+    Object cachekey;
+    UINT64 generation = 0;
+    bool write = false;
+
+    if (cnxn->result_cache || cnxn->nAutoCommit == SQL_AUTOCOMMIT_OFF)
+    {
+        bool select = IsSelectStatement(pSql);
+        write = !select;
+
+        if (write && cnxn->nAutoCommit == SQL_AUTOCOMMIT_OFF)
+        {
+            cnxn->txn_written          = true;
+            cnxn->written_since_commit = true;
+        }
+
+        if (select && cnxn->result_cache && !cnxn->txn_written)
+        {
+            // Saved before executing so rows read while another statement changes the database are not cached.
+            generation = ResultCache_Generation(cnxn->result_cache);
+            cachekey = ResultCache_MakeKey(cnxn, pSql, params, skip_first);
+            if (cachekey.IsValid() && ResultCache_Lookup(cnxn->result_cache, cachekey, cur))
+            {
+                Py_INCREF(cur);
+                return (PyObject*)cur;
+            }
+        }
+    }
+
     const char* szLastFunction = "";
 
     if (cParams > 0)
@@ -654,8 +1022,9 @@ execute(Cursor* cur, PyObject* pSql, PyObject* params, bool skip_first)
             return 0;
         
         szLastFunction = "SQLExecute";
+        StatsTimer timer(cur, &Stats::execute);
         Py_BEGIN_ALLOW_THREADS
-        ret = SQLExecute(cur->hstmt);
+        ret = ODBC_CALL(cur->cnxn, SQLExecute)(cur->hstmt);
         Py_END_ALLOW_THREADS
     }
     else
@@ -663,27 +1032,105 @@ execute(Cursor* cur, PyObject* pSql, PyObject* params, bool skip_first)
         // REVIEW: Why don't we always prepare?  It is highly unlikely that a user would need to execute the same SQL
         // repeatedly if it did not have parameters, so we are not losing performance, but it would simplify the code.
 
-        Py_XDECREF(cur->pPreparedSQL);
-        cur->pPreparedSQL = 0;
+        FreeParameterInfo(cur);
 
         szLastFunction = "SQLExecDirect";
         if (PyString_Check(pSql))
         {
+            CountBytesSent(cur->cnxn, PyString_GET_SIZE(pSql));
+            StatsTimer timer(cur, &Stats::execute);
             Py_BEGIN_ALLOW_THREADS
-            ret = SQLExecDirect(cur->hstmt, (SQLCHAR*)PyString_AS_STRING(pSql), SQL_NTS);
+            ret = ODBC_CALL(cur->cnxn, SQLExecDirect)(cur->hstmt, (SQLCHAR*)PyString_AS_STRING(pSql), SQL_NTS);
             Py_END_ALLOW_THREADS
         }
         else
         {
-            SQLWChar query(pSql);
+            Py_ssize_t cch;
+            const SQLWCHAR* query = Cursor_SQLText(cur, pSql, cch);
             if (!query)
                 return 0;
+            CountBytesSent(cur->cnxn, cch * sizeof(SQLWCHAR));
+            StatsTimer timer(cur, &Stats::execute);
             Py_BEGIN_ALLOW_THREADS
-            ret = SQLExecDirectW(cur->hstmt, query, SQL_NTS);
+            ret = ODBC_CALL(cur->cnxn, SQLExecDirectW)(cur->hstmt, (SQLWCHAR*)query, SQL_NTS);
             Py_END_ALLOW_THREADS
         }
     }
-    
+
+    PyObject* result = execute_complete(cur, ret, szLastFunction, false);
+
+    InvalidateResultCache(cur, write);
+
+    if (result && cachekey.IsValid() && cur->colinfos != 0)
+    {
+        // Record the rows as they are fetched so they can be cached once all have been read.
+        cur->record_rows = PyList_New(0);
+        if (cur->record_rows)
+        {
+            cur->record_key        = cachekey.Detach();
+            cur->record_generation = generation;
+        }
+        else
+            PyErr_Clear();
+    }
+
+    return result;
+}
+
+static PyObject*
+execute(Cursor* cur, PyObject* pSql, PyObject* params, bool skip_first)
+{
+    // Executes the statement (see execute_statement for the parameters) and records it in the query log, latency
+    // histograms, and trace.
+
+    if (!querylog_active && !latency_enabled && !trace_active)
+        return execute_statement(cur, pSql, params, skip_first);
+
+    // Record the previous statement's results first so a slow query handler is not timed as part of this one.
+    if (cur->querylog_sql)
+        QueryLog_RecordResult(cur);
+
+    Py_ssize_t cParams = 0;
+    if (params && PySequence_Check(params))
+    {
+        cParams = PySequence_Length(params) - (skip_first ? 1 : 0);
+        if (cParams < 0)
+        {
+            PyErr_Clear();
+            cParams = 0;
+        }
+    }
+
+    UINT64 start = MonotonicNanoseconds();
+    PyObject* result = execute_statement(cur, pSql, params, skip_first);
+    UINT64 duration = MonotonicNanoseconds() - start;
+
+    if (querylog_active)
+        QueryLog_Record(cur, pSql, cParams, duration, result != 0);
+
+    if (latency_enabled && result)
+        Latency_RecordExecute(cur, pSql, duration);
+
+    if (trace_active && result)
+        Trace_RecordExecute(cur, pSql, params, skip_first, duration);
+
+    return result;
+}
+
+static PyObject*
+execute_complete(Cursor* cur, SQLRETURN ret, const char* szLastFunction, bool async)
+{
+    // Finishes an execute once SQLExecute or SQLExecDirect has returned something other than SQL_STILL_EXECUTING:
+    // supplies any data-at-execution parameters and gathers the result set information.
+    //
+    // ret
+    //   The value returned by the execute function named by szLastFunction.
+    //
+    // async
+    //   True if SQL_ATTR_ASYNC_ENABLE is on.  It is turned off here once the statement no longer needs data so the
+    //   remaining calls (and later fetches) are synchronous.  If an error is returned it may still be on, so callers
+    //   must turn it off themselves.
+
     if (cur->cnxn->hdbc == SQL_NULL_HANDLE)
     {
         // The connection was closed by another thread in the ALLOW_THREADS block above.
@@ -697,7 +1144,14 @@ execute(Cursor* cur, PyObject* pSql, PyObject* params, bool skip_first)
     {
         // We could try dropping through the while and if below, but if there is an error, we need to raise it before
         // FreeParameterData calls more ODBC functions.
-        return RaiseErrorFromHandle("SQLExecDirectW", cur->cnxn->hdbc, cur->hstmt);
+        return RaiseErrorFromHandle(szLastFunction, cur->cnxn->hdbc, cur->hstmt);
+    }
+
+    if (async && ret != SQL_NEED_DATA)
+    {
+        if (!SetStatementAsync(cur, false))
+            return 0;
+        async = false;
     }
     
     while (ret == SQL_NEED_DATA)
@@ -707,9 +1161,17 @@ execute(Cursor* cur, PyObject* pSql, PyObject* params, bool skip_first)
 
         szLastFunction = "SQLParamData";
         PyObject* pParam;
+        StatsTimer paramtimer(cur, &Stats::execute);
         Py_BEGIN_ALLOW_THREADS
-        ret = SQLParamData(cur->hstmt, (SQLPOINTER*)&pParam);
+        do
+        {
+            // When asynchronous execution is enabled, the final SQLParamData executes the statement.  We don't have a
+            // way to give control back to the caller in the middle of sending data, so just wait for it.
+            ret = ODBC_CALL(cur->cnxn, SQLParamData)(cur->hstmt, (SQLPOINTER*)&pParam);
+        }
+        while (ret == SQL_STILL_EXECUTING);
         Py_END_ALLOW_THREADS
+        paramtimer.Stop();
 
         if (ret != SQL_NEED_DATA && ret != SQL_NO_DATA && !SQL_SUCCEEDED(ret))
             return RaiseErrorFromHandle("SQLParamData", cur->cnxn->hdbc, cur->hstmt);
@@ -729,15 +1191,49 @@ execute(Cursor* cur, PyObject* pSql, PyObject* params, bool skip_first)
                 SQLLEN cb;
                 while (it.Next(pb, cb))
                 {
-                    Py_BEGIN_ALLOW_THREADS
-                    ret = SQLPutData(cur->hstmt, pb, cb);
-                    Py_END_ALLOW_THREADS
+                    ret = PutData(cur, pb, cb);
                     if (!SQL_SUCCEEDED(ret))
                         return RaiseErrorFromHandle("SQLPutData", cur->cnxn->hdbc, cur->hstmt);
+                    CountBytesSent(cur->cnxn, cb);
                 }
             }
             else if (PyUnicode_Check(pParam))
             {
+#if SQLWCHAR_SIZE != Py_UNICODE_SIZE
+                // Convert and send the value a piece at a time so the whole value is never copied.  Each piece is
+                // whole characters, so surrogate pairs are never split between them.
+
+                const Py_UNICODE* pch = PyUnicode_AS_UNICODE(pParam);
+                Py_ssize_t length = PyUnicode_GET_SIZE(pParam);
+                Py_ssize_t piece  = min(cur->cnxn->varchar_maxlength, length);
+
+                bool allocated;
+                SQLWCHAR* buffer = (SQLWCHAR*)AllocScratch(cur, sizeof(SQLWCHAR) * (piece * 2 + 1), allocated);
+                if (!buffer)
+                    return 0;
+
+                Py_ssize_t offset = 0;
+                while (offset < length)
+                {
+                    Py_ssize_t remaining = min(piece, length - offset);
+                    Py_ssize_t cch = SQLWCHAR_Copy(buffer, &pch[offset], remaining);
+                    if (cch == -1)
+                        break;
+                    ret = PutData(cur, buffer, (SQLLEN)(cch * sizeof(SQLWCHAR)));
+                    if (!SQL_SUCCEEDED(ret))
+                    {
+                        RaiseErrorFromHandle("SQLPutData", cur->cnxn->hdbc, cur->hstmt);
+                        break;
+                    }
+                    CountBytesSent(cur->cnxn, cch * sizeof(SQLWCHAR));
+                    offset += remaining;
+                }
+
+                if (allocated)
+                    pyodbc_free(buffer);
+                if (offset < length)
+                    return 0;
+#else
                 SQLWChar wchar(pParam); // Will convert to SQLWCHAR if necessary.
 
                 Py_ssize_t offset = 0;            // in characters
@@ -746,13 +1242,13 @@ execute(Cursor* cur, PyObject* pSql, PyObject* params, bool skip_first)
                 while (offset < length)
                 {
                     SQLLEN remaining = min(cur->cnxn->varchar_maxlength, length - offset);
-                    Py_BEGIN_ALLOW_THREADS
-                    ret = SQLPutData(cur->hstmt, (SQLPOINTER)wchar[offset], (SQLLEN)(remaining * sizeof(SQLWCHAR)));
-                    Py_END_ALLOW_THREADS
+                    ret = PutData(cur, (SQLPOINTER)wchar[offset], (SQLLEN)(remaining * sizeof(SQLWCHAR)));
                     if (!SQL_SUCCEEDED(ret))
                         return RaiseErrorFromHandle("SQLPutData", cur->cnxn->hdbc, cur->hstmt);
+                    CountBytesSent(cur->cnxn, remaining * sizeof(SQLWCHAR));
                     offset += remaining;
                 }
+#endif
             }
             else if (PyString_Check(pParam))
             {
@@ -763,11 +1259,10 @@ execute(Cursor* cur, PyObject* pSql, PyObject* params, bool skip_first)
                 {
                     SQLLEN remaining = min(cur->cnxn->varchar_maxlength, cb - offset);
                     TRACE("SQLPutData [%d] (%d) %s\n", offset, remaining, &p[offset]);
-                    Py_BEGIN_ALLOW_THREADS
-                    ret = SQLPutData(cur->hstmt, (SQLPOINTER)&p[offset], remaining);
-                    Py_END_ALLOW_THREADS
+                    ret = PutData(cur, (SQLPOINTER)&p[offset], remaining);
                     if (!SQL_SUCCEEDED(ret))
                         return RaiseErrorFromHandle("SQLPutData", cur->cnxn->hdbc, cur->hstmt);
+                    CountBytesSent(cur->cnxn, remaining);
                     offset += remaining;
                 }
             }
@@ -778,6 +1273,9 @@ execute(Cursor* cur, PyObject* pSql, PyObject* params, bool skip_first)
 
     FreeParameterData(cur);
 
+    if (async && !SetStatementAsync(cur, false))
+        return 0;
+
     if (ret == SQL_NO_DATA)
     {
         // Example: A delete statement that did not delete anything.
@@ -791,7 +1289,7 @@ execute(Cursor* cur, PyObject* pSql, PyObject* params, bool skip_first)
 
     SQLLEN cRows = -1;
     Py_BEGIN_ALLOW_THREADS
-    ret = SQLRowCount(cur->hstmt, &cRows);
+    ret = ODBC_CALL(cur->cnxn, SQLRowCount)(cur->hstmt, &cRows);
     Py_END_ALLOW_THREADS
     if (!SQL_SUCCEEDED(ret))
         return RaiseErrorFromHandle("SQLRowCount", cur->cnxn->hdbc, cur->hstmt);
@@ -802,7 +1300,7 @@ execute(Cursor* cur, PyObject* pSql, PyObject* params, bool skip_first)
 
     SQLSMALLINT cCols = 0;
     Py_BEGIN_ALLOW_THREADS
-    ret = SQLNumResultCols(cur->hstmt, &cCols);
+    ret = ODBC_CALL(cur->cnxn, SQLNumResultCols)(cur->hstmt, &cCols);
     Py_END_ALLOW_THREADS
     if (!SQL_SUCCEEDED(ret))
     {
@@ -827,10 +1325,7 @@ execute(Cursor* cur, PyObject* pSql, PyObject* params, bool skip_first)
     {
         // A result set was created.
 
-        if (!PrepareResults(cur, cCols))
-            return 0;
-
-        if (!create_name_map(cur, cCols, lowercase()))
+        if (!PrepareResultsCached(cur, cCols))
             return 0;
     }
 
@@ -838,14 +1333,192 @@ execute(Cursor* cur, PyObject* pSql, PyObject* params, bool skip_first)
     return (PyObject*)cur;
 }
 
+PyObject*
+Cursor_ExecuteImpl(Cursor* cur, PyObject* pSql, PyObject* params, bool skip_first)
+{
+    return execute(cur, pSql, params, skip_first);
+}
+
+static AsyncStatus
+FinishAsync(Cursor* cur, SQLRETURN ret, PyObject*& result)
+{
+    result = execute_complete(cur, ret, "SQLExecute", true);
+
+    // Asynchronous executes always prepare, so pPreparedSQL is the statement.
+    InvalidateResultCache(cur, cur->pPreparedSQL != 0 && !IsSelectStatement(cur->pPreparedSQL));
+
+    if (result == 0 && StatementIsValid(cur))
+    {
+        // An error can leave asynchronous execution enabled.  Turn it off without disturbing the exception.
+        Py_BEGIN_ALLOW_THREADS
+        ODBC_CALL(cur->cnxn, SQLSetStmtAttr)(cur->hstmt, SQL_ATTR_ASYNC_ENABLE, (SQLPOINTER)SQL_ASYNC_ENABLE_OFF, SQL_IS_UINTEGER);
+        Py_END_ALLOW_THREADS
+    }
+
+    return ASYNC_DONE;
+}
+
+AsyncStatus
+Cursor_BeginAsync(Cursor* cur, PyObject* pSql, PyObject* params, bool skip_first, PyObject*& result)
+{
+    // Starts executing SQL with SQL_ATTR_ASYNC_ENABLE turned on.  The statement is always prepared (synchronously)
+    // first, even without parameters, so Cursor_PollAsync only ever has to call SQLExecute.
+    //
+    // Returns ASYNC_UNSUPPORTED, without an exception and without executing anything, if the driver refuses to
+    // enable asynchronous execution for the statement.
+
+    result = 0;
+
+    if (params)
+    {
+        if (!PyTuple_Check(params) && !PyList_Check(params) && !Row_Check(params))
+        {
+            RaiseErrorV(0, PyExc_TypeError, "Params must be in a list, tuple, or Row");
+            return ASYNC_DONE;
+        }
+    }
+
+    if (!free_results(cur, FREE_STATEMENT))
+        return ASYNC_DONE;
+
+    if (cur->cnxn->nAutoCommit == SQL_AUTOCOMMIT_OFF && !IsSelectStatement(pSql))
+    {
+        cur->cnxn->txn_written          = true;
+        cur->cnxn->written_since_commit = true;
+    }
+
+    if (!PrepareAndBind(cur, pSql, params, skip_first))
+        return ASYNC_DONE;
+
+    if (!SetStatementAsync(cur, true))
+    {
+        PyErr_Clear();
+        FreeParameterData(cur);
+        return ASYNC_UNSUPPORTED;
+    }
+
+    SQLRETURN ret;
+    Py_BEGIN_ALLOW_THREADS
+    ret = ODBC_CALL(cur->cnxn, SQLExecute)(cur->hstmt);
+    Py_END_ALLOW_THREADS
+
+    if (ret == SQL_STILL_EXECUTING)
+        return ASYNC_PENDING;
+
+    return FinishAsync(cur, ret, result);
+}
+
+AsyncStatus
+Cursor_PollAsync(Cursor* cur, PyObject*& result)
+{
+    // Checks whether an execute started by Cursor_BeginAsync has finished.  ODBC reports the status of an
+    // asynchronous call when the same function is called again with the same arguments.
+
+    result = 0;
+
+    if (!StatementIsValid(cur))
+    {
+        RaiseErrorV(0, ProgrammingError, "The cursor's connection was closed.");
+        return ASYNC_DONE;
+    }
+
+    SQLRETURN ret;
+    Py_BEGIN_ALLOW_THREADS
+    ret = ODBC_CALL(cur->cnxn, SQLExecute)(cur->hstmt);
+    Py_END_ALLOW_THREADS
+
+    if (ret == SQL_STILL_EXECUTING)
+        return ASYNC_PENDING;
+
+    return FinishAsync(cur, ret, result);
+}
+
+void
+Cursor_AbortAsync(Cursor* cur)
+{
+    // Cancels an execute started by Cursor_BeginAsync that is still running and waits for the driver to give up on
+    // it.  Used when a pending Future is deleted.  Never sets an exception.
+
+    if (StatementIsValid(cur))
+    {
+        Py_BEGIN_ALLOW_THREADS
+        ODBC_CALL(cur->cnxn, SQLCancel)(cur->hstmt);
+
+        // Drivers usually give up quickly, but poll with a back-off like the Future waits instead of spinning.
+        unsigned long interval = 1;
+        while (ODBC_CALL(cur->cnxn, SQLExecute)(cur->hstmt) == SQL_STILL_EXECUTING)
+        {
+            SleepMilliseconds(interval);
+            if (interval < 16)
+                interval *= 2;
+        }
+        ODBC_CALL(cur->cnxn, SQLSetStmtAttr)(cur->hstmt, SQL_ATTR_ASYNC_ENABLE, (SQLPOINTER)SQL_ASYNC_ENABLE_OFF, SQL_IS_UINTEGER);
+        ODBC_CALL(cur->cnxn, SQLFreeStmt)(cur->hstmt, SQL_CLOSE);
+        Py_END_ALLOW_THREADS
+    }
+
+    FreeParameterData(cur);
+}
+
 inline bool
 IsSequence(PyObject* p)
 {
     return PySequence_Check(p) && !PyString_Check(p) && !PyBuffer_Check(p) && !PyUnicode_Check(p);
 }
 
+static bool
+GetTimeoutArg(PyObject* value, long& timeout_ms)
+{
+    // Converts the optional `timeout` keyword accepted by execute and the fetch methods.  The value is in seconds and
+    // can be an int or a float.  None or a missing keyword (value == 0) means no per-call timeout.
+
+    timeout_ms = 0;
+
+    if (value == 0 || value == Py_None)
+        return true;
+
+    double seconds = PyFloat_AsDouble(value);
+    if (seconds == -1.0 && PyErr_Occurred())
+        return false;
+
+    if (Py_IS_NAN(seconds) || Py_IS_INFINITY(seconds))
+    {
+        PyErr_SetString(PyExc_ValueError, "The timeout must be a finite number.");
+        return false;
+    }
+
+    if (seconds < 0)
+    {
+        PyErr_SetString(PyExc_ValueError, "Cannot use a negative timeout.");
+        return false;
+    }
+
+    // Converting a double that does not fit in a long is undefined, so clamp it first.
+    double ms = seconds * 1000.0 + 0.5;
+    timeout_ms = (ms >= (double)LONG_MAX) ? LONG_MAX : (long)ms;
+    if (timeout_ms == 0 && seconds > 0)
+        timeout_ms = 1;
+
+    return true;
+}
+
+static PyObject*
+CheckDeadline(Deadline& deadline, PyObject* result)
+{
+    // Disarms the deadline and returns `result`.  If the watchdog canceled the statement and the call failed, the
+    // driver's error (usually HY008, operation canceled) is replaced with a timeout error.
+
+    if (deadline.Disarm() && result == 0 && PyErr_Occurred())
+    {
+        PyErr_Clear();
+        return RaiseErrorV("HYT00", OperationalError, "Timeout expired");
+    }
+
+    return result;
+}
+
 static char execute_doc[] =
-    "C.execute(sql, [params]) --> Cursor\n"
+    "C.execute(sql, [params], timeout=None) --> Cursor\n"
     "\n"
     "Prepare and execute a database query or command.\n"
     "\n"
@@ -856,35 +1529,39 @@ static char execute_doc[] =
     "\n"
     "    or\n"
     "\n"
-    "  cursor.execute(sql, param1, param2)\n";
+    "  cursor.execute(sql, param1, param2)\n"
+    "\n"
+    "If `timeout` is provided, it is the maximum number of seconds (int or float)\n"
+    "the statement may run.  The statement is canceled when the time expires and an\n"
+    "OperationalError with SQLSTATE HYT00 is raised.";
 
-PyObject*
-Cursor_execute(PyObject* self, PyObject* args)
+static bool
+GetExecuteArgs(const char* szFunction, PyObject* args, PyObject*& pSql, PyObject*& params, bool& skip_first)
 {
-    Py_ssize_t cParams = PyTuple_Size(args) - 1;
+    // Extracts the SQL and the optional parameters from the positional arguments passed to execute or execute_async.
+    // The results are suitable for passing to the execute function.  `szFunction` is the name of the method, used in
+    // error messages.
 
-    Cursor* cursor = Cursor_Validate(self, CURSOR_REQUIRE_OPEN | CURSOR_RAISE_ERROR);
-    if (!cursor)
-        return 0;
+    Py_ssize_t cParams = PyTuple_Size(args) - 1;
 
     if (cParams < 0)
     {
-        PyErr_SetString(PyExc_TypeError, "execute() takes at least 1 argument (0 given)");
-        return 0;
+        PyErr_Format(PyExc_TypeError, "%s() takes at least 1 argument (0 given)", szFunction);
+        return false;
     }
 
-    PyObject* pSql = PyTuple_GET_ITEM(args, 0);
+    pSql = PyTuple_GET_ITEM(args, 0);
 
     if (!PyString_Check(pSql) && !PyUnicode_Check(pSql))
     {
-        PyErr_SetString(PyExc_TypeError, "The first argument to execute must be a string or unicode query.");
-        return 0;
+        PyErr_Format(PyExc_TypeError, "The first argument to %s must be a string or unicode query.", szFunction);
+        return false;
     }
 
     // Figure out if there were parameters and how they were passed.  Our optional parameter passing complicates this slightly.
 
-    bool skip_first = false;
-    PyObject *params = 0;
+    skip_first = false;
+    params     = 0;
     if (cParams == 1 && IsSequence(PyTuple_GET_ITEM(args, 1)))
     {
         // There is a single argument and it is a sequence, so we must treat it as a sequence of parameters.  (This is
@@ -899,9 +1576,72 @@ Cursor_execute(PyObject* self, PyObject* args)
         skip_first = true;
     }
 
+    return true;
+}
+
+PyObject*
+Cursor_execute(PyObject* self, PyObject* args, PyObject* kwargs)
+{
+    Cursor* cursor = Cursor_Validate(self, CURSOR_REQUIRE_OPEN | CURSOR_RAISE_ERROR);
+    if (!cursor)
+        return 0;
+
+    // The parameters can be passed individually, so the only keyword we can accept is the timeout.
+
+    PyObject* pTimeout = 0;
+    if (kwargs && PyDict_Size(kwargs) != 0)
+    {
+        pTimeout = PyDict_GetItemString(kwargs, "timeout");
+        if (PyDict_Size(kwargs) != (pTimeout ? 1 : 0))
+        {
+            PyErr_SetString(PyExc_TypeError, "execute() only accepts the 'timeout' keyword argument");
+            return 0;
+        }
+    }
+
+    long timeout_ms;
+    if (!GetTimeoutArg(pTimeout, timeout_ms))
+        return 0;
+
+    PyObject* pSql;
+    PyObject* params;
+    bool skip_first;
+    if (!GetExecuteArgs("execute", args, pSql, params, skip_first))
+        return 0;
+
     // Execute.
 
-    return execute(cursor, pSql, params, skip_first);
+    Deadline deadline(cursor->hstmt, timeout_ms);
+    return CheckDeadline(deadline, execute(cursor, pSql, params, skip_first));
+}
+
+static char execute_async_doc[] =
+    "C.execute_async(sql, [params]) --> Future\n"
+    "\n"
+    "Starts executing a query or command and returns a pyodbc.Future without\n"
+    "waiting for it to complete.  The arguments are the same as execute, and the\n"
+    "result of the Future is the cursor.\n"
+    "\n"
+    "If the driver supports statement-level asynchronous execution, the statement\n"
+    "runs in the driver and is polled by Future.done(), Future.result(), and\n"
+    "pyodbc.wait().  Otherwise it is run on one of pyodbc's worker threads.\n"
+    "\n"
+    "The cursor cannot be used until the operation completes.";
+
+static PyObject*
+Cursor_execute_async(PyObject* self, PyObject* args)
+{
+    Cursor* cursor = Cursor_Validate(self, CURSOR_REQUIRE_OPEN | CURSOR_RAISE_ERROR);
+    if (!cursor)
+        return 0;
+
+    PyObject* pSql;
+    PyObject* params;
+    bool skip_first;
+    if (!GetExecuteArgs("execute_async", args, pSql, params, skip_first))
+        return 0;
+
+    return Future_Execute(cursor, pSql, params, skip_first);
 }
 
 static PyObject*
@@ -957,7 +1697,42 @@ Cursor_executemany(PyObject* self, PyObject* args)
 
 
 static PyObject*
-Cursor_fetch(Cursor* cur)
+FetchPreloaded(Cursor* cur)
+{
+    // Cursor_fetch for a cursor with preloaded results: returns the next preloaded row as a new Row.  A new Row is
+    // created every time since Rows can be modified and the values may be shared by other cursors.
+
+    if (cur->preloaded_pos >= PyTuple_GET_SIZE(cur->preloaded))
+    {
+        if (cur->querylog_sql)
+            QueryLog_RecordResult(cur);
+        return 0;
+    }
+
+    PyObject* values = PyTuple_GET_ITEM(cur->preloaded, cur->preloaded_pos);
+    Py_ssize_t field_count = PyTuple_GET_SIZE(values);
+
+    PyObject** apValues = (PyObject**)pyodbc_malloc(sizeof(PyObject*) * field_count, MEM_ROWVALUES);
+    if (apValues == 0)
+        return PyErr_NoMemory();
+
+    for (Py_ssize_t i = 0; i < field_count; i++)
+    {
+        apValues[i] = PyTuple_GET_ITEM(values, i);
+        Py_INCREF(apValues[i]);
+    }
+
+    cur->preloaded_pos++;
+
+    if (cur->querylog_sql)
+        cur->querylog_rows++;
+
+    return (PyObject*)Row_New(cur->description, cur->map_name_to_index, field_count, apValues);
+}
+
+
+static PyObject*
+FetchRow(Cursor* cur)
 {
     // Internal function to fetch a single row and construct a Row object from it.  Used by all of the fetching
     // functions.
@@ -969,9 +1744,14 @@ Cursor_fetch(Cursor* cur)
     Py_ssize_t field_count, i;
     PyObject** apValues;
 
-    Py_BEGIN_ALLOW_THREADS
-    ret = SQLFetch(cur->hstmt);
-    Py_END_ALLOW_THREADS
+    if (cur->preloaded)
+        return FetchPreloaded(cur);
+
+    StatsTimer fetchtimer(cur, &Stats::fetch);
+    FETCH_BEGIN_ALLOW_THREADS(cur)
+    ret = ODBC_CALL(cur->cnxn, SQLFetch)(cur->hstmt);
+    FETCH_END_ALLOW_THREADS(cur)
+    fetchtimer.Stop();
 
     if (cur->cnxn->hdbc == SQL_NULL_HANDLE)
     {
@@ -980,42 +1760,106 @@ Cursor_fetch(Cursor* cur)
     }
 
     if (ret == SQL_NO_DATA)
+    {
+        if (cur->record_rows)
+            FinishRecording(cur);
+        if (cur->fetch_start)
+            Latency_RecordFetch(cur);
+        if (cur->trace_id)
+            Trace_RecordResult(cur);
+        if (cur->querylog_sql)
+            QueryLog_RecordResult(cur);
+        if (cur->raw_block)
+        {
+            // No more rows will be added, so the block can be freed once the rows in it are done with it.
+            RawBlock_Release(cur->raw_block);
+            cur->raw_block = 0;
+        }
         return 0;
+    }
 
     if (!SQL_SUCCEEDED(ret))
         return RaiseErrorFromHandle("SQLFetch", cur->cnxn->hdbc, cur->hstmt);
 
     field_count = PyTuple_GET_SIZE(cur->description);
 
-    apValues = (PyObject**)pyodbc_malloc(sizeof(PyObject*) * field_count);
+    apValues = (PyObject**)pyodbc_malloc(sizeof(PyObject*) * field_count, MEM_ROWVALUES);
 
     if (apValues == 0)
         return PyErr_NoMemory();
 
-    for (i = 0; i < field_count; i++)
-    {
-        PyObject* value = GetData(cur, i);
+    StatsTimer columntimer(cur, &Stats::columns);
 
-        if (!value)
-        {
-            FreeRowValues(i, apValues);
+    // Lazy rows keep the data and convert columns when they are used.  Rows recorded for the result cache need their
+    // values now.
+    const char* raw = 0;
+
+    if (cur->cnxn->lazy_rows && !cur->record_rows)
+    {
+        raw = GetRawRow(cur, field_count, apValues);
+        if (!raw)
             return 0;
+    }
+    else
+    {
+        for (i = 0; i < field_count; i++)
+        {
+            PyObject* value = GetData(cur, i);
+
+            if (!value)
+            {
+                FreeRowValues(i, apValues);
+                return 0;
+            }
+
+            apValues[i] = value;
         }
+    }
+
+    columntimer.Stop();
+    Stats_Count(cur, &Stats::rows, 1);
 
-        apValues[i] = value;
+    if (cur->trace_id)
+        cur->trace_rows++;
+
+    if (cur->querylog_sql)
+        cur->querylog_rows++;
+
+    if (cur->record_rows && !RecordRow(cur, apValues, field_count))
+    {
+        FreeRowValues(field_count, apValues);
+        return 0;
     }
 
+    if (raw)
+        return (PyObject*)Row_NewLazy(cur->description, cur->map_name_to_index, field_count, apValues, cur->raw_block, raw);
+
     return (PyObject*)Row_New(cur->description, cur->map_name_to_index, field_count, apValues);
 }
 
 
 static PyObject*
+Cursor_fetch(Cursor* cur)
+{
+    // Fetches a single row as its own fetch call for the GIL hold timing.  Returns the same as FetchRow.
+
+    GilClock_Begin(cur);
+    PyObject* row = FetchRow(cur);
+    GilClock_End(cur, row ? 1 : 0);
+    return row;
+}
+
+
+PyObject*
 Cursor_fetchlist(Cursor* cur, Py_ssize_t max)
 {
     // max
     //   The maximum number of rows to fetch.  If -1, fetch all rows.
     // 
     // Returns a list of Rows.  If there are no rows, an empty list is returned.
+    //
+    // The GIL hold timing covers the whole batch, so the longest hold reported is the longest between any two ODBC
+    // calls made for it.
 
     PyObject* results;
     PyObject* row;
@@ -1024,14 +1868,17 @@ Cursor_fetchlist(Cursor* cur, Py_ssize_t max)
     if (!results)
         return 0;
 
+    GilClock_Begin(cur);
+
     while (max == -1 || max > 0)
     {
-        row = Cursor_fetch(cur);
+        row = FetchRow(cur);
 
         if (!row)
         {
             if (PyErr_Occurred())
             {
+                GilClock_End(cur, PyList_GET_SIZE(results));
                 Py_DECREF(results);
                 return 0;
             }
@@ -1045,6 +1892,8 @@ Cursor_fetchlist(Cursor* cur, Py_ssize_t max)
             max--;
     }
 
+    GilClock_End(cur, PyList_GET_SIZE(results));
+
     return results;
 }
 
@@ -1074,17 +1923,26 @@ Cursor_iternext(PyObject* self)
     return result;
 }
 
+static char* Cursor_fetchone_kwnames[] = { "timeout", 0 };
+
 static PyObject*
-Cursor_fetchone(PyObject* self, PyObject* args)
+Cursor_fetchone(PyObject* self, PyObject* args, PyObject* kwargs)
 {
-    UNUSED(args);
-    
+    PyObject* pTimeout = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O", Cursor_fetchone_kwnames, &pTimeout))
+        return 0;
+
+    long timeout_ms;
+    if (!GetTimeoutArg(pTimeout, timeout_ms))
+        return 0;
+
     PyObject* row;
     Cursor* cursor = Cursor_Validate(self, CURSOR_REQUIRE_RESULTS | CURSOR_RAISE_ERROR);
     if (!cursor)
         return 0;
 
-    row = Cursor_fetch(cursor);
+    Deadline deadline(cursor->hstmt, timeout_ms);
+    row = CheckDeadline(deadline, Cursor_fetch(cursor));
 
     if (!row)
     {
@@ -1097,22 +1955,31 @@ Cursor_fetchone(PyObject* self, PyObject* args)
 }
 
 static PyObject*
-Cursor_fetchall(PyObject* self, PyObject* args)
+Cursor_fetchall(PyObject* self, PyObject* args, PyObject* kwargs)
 {
-    UNUSED(args);
-    
+    PyObject* pTimeout = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O", Cursor_fetchone_kwnames, &pTimeout))
+        return 0;
+
+    long timeout_ms;
+    if (!GetTimeoutArg(pTimeout, timeout_ms))
+        return 0;
+
     PyObject* result;
     Cursor* cursor = Cursor_Validate(self, CURSOR_REQUIRE_RESULTS | CURSOR_RAISE_ERROR);
     if (!cursor)
         return 0;
 
-    result = Cursor_fetchlist(cursor, -1);
+    Deadline deadline(cursor->hstmt, timeout_ms);
+    result = CheckDeadline(deadline, Cursor_fetchlist(cursor, -1));
 
     return result;
 }
 
+static char* Cursor_fetchmany_kwnames[] = { "size", "timeout", 0 };
+
 static PyObject*
-Cursor_fetchmany(PyObject* self, PyObject* args)
+Cursor_fetchmany(PyObject* self, PyObject* args, PyObject* kwargs)
 {
     long rows;
     PyObject* result;
@@ -1122,14 +1989,161 @@ Cursor_fetchmany(PyObject* self, PyObject* args)
         return 0;
 
     rows = cursor->arraysize;
-    if (!PyArg_ParseTuple(args, "|l", &rows))
+    PyObject* pTimeout = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|lO", Cursor_fetchmany_kwnames, &rows, &pTimeout))
+        return 0;
+
+    long timeout_ms;
+    if (!GetTimeoutArg(pTimeout, timeout_ms))
         return 0;
 
-    result = Cursor_fetchlist(cursor, rows);
+    Deadline deadline(cursor->hstmt, timeout_ms);
+    result = CheckDeadline(deadline, Cursor_fetchlist(cursor, rows));
 
     return result;
 }
 
+static char fetchmany_async_doc[] =
+    "fetchmany_async(size=cursor.arraysize) --> Future\n"
+    "\n"
+    "Starts fetching the next set of rows and returns a pyodbc.Future whose result\n"
+    "is the list fetchmany would return.  The rows are always fetched by one of\n"
+    "pyodbc's worker threads.\n"
+    "\n"
+    "The cursor cannot be used until the operation completes.";
+
+static PyObject*
+Cursor_fetchmany_async(PyObject* self, PyObject* args)
+{
+    Cursor* cursor = Cursor_Validate(self, CURSOR_REQUIRE_RESULTS | CURSOR_RAISE_ERROR);
+    if (!cursor)
+        return 0;
+
+    long rows = cursor->arraysize;
+    if (!PyArg_ParseTuple(args, "|l", &rows))
+        return 0;
+
+    return Future_FetchMany(cursor, rows);
+}
+
+static char cancel_doc[] =
+    "cancel() --> None\n"
+    "\n"
+    "Cancels the statement currently running on this cursor by calling SQLCancel.\n"
+    "\n"
+    "This is designed to be called from a different thread than the one executing\n"
+    "or fetching.  The interrupted call will raise an OperationalError (usually\n"
+    "with SQLSTATE HY008).  If nothing is running, this does nothing.";
+
+static PyObject*
+Cursor_cancel(PyObject* self, PyObject* args)
+{
+    UNUSED(args);
+
+    Cursor* cursor = Cursor_Validate(self, CURSOR_REQUIRE_OPEN | CURSOR_ALLOW_ASYNC | CURSOR_RAISE_ERROR);
+    if (!cursor)
+        return 0;
+
+    // SQLCancel is one of the few ODBC functions that can be called on a statement while another thread is using
+    // it.  We deliberately do *not* release the GIL here: the thread running the statement needs the GIL to close the
+    // cursor, so holding it guarantees the HSTMT is not freed out from under us.  SQLCancel only sends a request to
+    // the server, so it is quick.
+
+    SQLRETURN ret = ODBC_CALL(cursor->cnxn, SQLCancel)(cursor->hstmt);
+    if (!SQL_SUCCEEDED(ret))
+        return RaiseErrorFromHandle("SQLCancel", cursor->cnxn->hdbc, cursor->hstmt);
+
+    Py_RETURN_NONE;
+}
+
+static bool
+GetCachedCatalog(Cursor* cur, const char* name, PyObject* args, PyObject* kwargs, Object& key)
+{
+    // Looks up the results of catalog function `name` in the connection's metadata cache.  If they are cached, the
+    // cursor is set up to return them and true is returned.  Otherwise, if the cache is enabled, `key` is set to the
+    // key CacheCatalog should store the results under.
+    //
+    // Must be called after free_results.  Problems creating the key are not errors; the function is simply not cached.
+
+    if (cur->cnxn->metadata_ttl == 0)
+        return false;
+
+    Object items;
+    if (kwargs && PyDict_Size(kwargs) != 0)
+    {
+        Object list(PyDict_Items(kwargs));
+        if (!list || PyList_Sort(list) == -1)
+        {
+            PyErr_Clear();
+            return false;
+        }
+        items = PyList_AsTuple(list);
+    }
+
+    key = Py_BuildValue("(sOO)", name, args, items.IsValid() ? items.Get() : Py_None);
+    if (!key)
+    {
+        PyErr_Clear();
+        return false;
+    }
+
+    PyObject* cached = Connection_GetCached(cur->cnxn, key);
+    if (!cached)
+        return false;
+
+    // (description, map_name_to_index, rows)
+
+    Py_DECREF(cur->description);
+    cur->description = PyTuple_GET_ITEM(cached, 0);
+    Py_INCREF(cur->description);
+
+    cur->map_name_to_index = PyTuple_GET_ITEM(cached, 1);
+    Py_INCREF(cur->map_name_to_index);
+
+    cur->preloaded = PyTuple_GET_ITEM(cached, 2);
+    Py_INCREF(cur->preloaded);
+    cur->preloaded_pos = 0;
+
+    return true;
+}
+
+
+static bool
+CacheCatalog(Cursor* cur, PyObject* key)
+{
+    // Reads all of the results of a catalog function that was just executed and stores them in the connection's
+    // metadata cache under `key`.  The cursor then returns the cached copy, so results look the same whether or not
+    // they came from the cache.
+
+    Object rows(Cursor_fetchlist(cur, -1));
+    if (!rows)
+        return false;
+
+    Py_ssize_t count = PyList_GET_SIZE(rows.Get());
+    Object values(PyTuple_New(count));
+    if (!values)
+        return false;
+
+    for (Py_ssize_t i = 0; i < count; i++)
+    {
+        PyObject* t = PySequence_Tuple(PyList_GET_ITEM(rows.Get(), i));
+        if (!t)
+            return false;
+        PyTuple_SET_ITEM(values.Get(), i, t);
+    }
+
+    Object entry(Py_BuildValue("(OOO)", cur->description, cur->map_name_to_index, values.Get()));
+    if (!entry || !Connection_SetCached(cur->cnxn, key, entry))
+        return false;
+
+    // The description and map were set by PrepareResults.
+    cur->preloaded     = values.Detach();
+    cur->preloaded_pos = 0;
+
+    return true;
+}
+
+
 static char tables_doc[] =
     "C.tables(table=None, catalog=None, schema=None, tableType=None) --> self\n"
     "\n"
@@ -1162,13 +2176,20 @@ Cursor_tables(PyObject* self, PyObject* args, PyObject* kwargs)
 
     Cursor* cur = Cursor_Validate(self, CURSOR_REQUIRE_OPEN);
     
-    if (!free_results(cur, FREE_STATEMENT))
+    if (!free_results(cur, FREE_PREPARED))
         return 0;
+
+    Object cachekey;
+    if (GetCachedCatalog(cur, "tables", args, kwargs, cachekey))
+    {
+        Py_INCREF(cur);
+        return (PyObject*)cur;
+    }
     
     SQLRETURN ret = 0;
 
     Py_BEGIN_ALLOW_THREADS
-    ret = SQLTables(cur->hstmt, (SQLCHAR*)szCatalog, SQL_NTS, (SQLCHAR*)szSchema, SQL_NTS, 
+    ret = ODBC_CALL(cur->cnxn, SQLTables)(cur->hstmt, (SQLCHAR*)szCatalog, SQL_NTS, (SQLCHAR*)szSchema, SQL_NTS, 
                     (SQLCHAR*)szTableName, SQL_NTS, (SQLCHAR*)szTableType, SQL_NTS);
     Py_END_ALLOW_THREADS
 
@@ -1177,15 +2198,15 @@ Cursor_tables(PyObject* self, PyObject* args, PyObject* kwargs)
 
     SQLSMALLINT cCols;
     Py_BEGIN_ALLOW_THREADS
-    ret = SQLNumResultCols(cur->hstmt, &cCols);
+    ret = ODBC_CALL(cur->cnxn, SQLNumResultCols)(cur->hstmt, &cCols);
     Py_END_ALLOW_THREADS
     if (!SQL_SUCCEEDED(ret))
         return RaiseErrorFromHandle("SQLNumResultCols", cur->cnxn->hdbc, cur->hstmt);
     
-    if (!PrepareResults(cur, cCols))
+    if (!PrepareResults(cur, cCols, true))
         return 0;
 
-    if (!create_name_map(cur, cCols, true))
+    if (cachekey.IsValid() && !CacheCatalog(cur, cachekey))
         return 0;
 
     // Return the cursor so the results can be iterated over directly.
@@ -1232,13 +2253,20 @@ Cursor_columns(PyObject* self, PyObject* args, PyObject* kwargs)
 
     Cursor* cur = Cursor_Validate(self, CURSOR_REQUIRE_OPEN);
     
-    if (!free_results(cur, FREE_STATEMENT))
+    if (!free_results(cur, FREE_PREPARED))
         return 0;
+
+    Object cachekey;
+    if (GetCachedCatalog(cur, "columns", args, kwargs, cachekey))
+    {
+        Py_INCREF(cur);
+        return (PyObject*)cur;
+    }
     
     SQLRETURN ret = 0;
 
     Py_BEGIN_ALLOW_THREADS
-    ret = SQLColumns(cur->hstmt, (SQLCHAR*)szCatalog, SQL_NTS, (SQLCHAR*)szSchema, SQL_NTS, (SQLCHAR*)szTable, SQL_NTS, (SQLCHAR*)szColumn, SQL_NTS);
+    ret = ODBC_CALL(cur->cnxn, SQLColumns)(cur->hstmt, (SQLCHAR*)szCatalog, SQL_NTS, (SQLCHAR*)szSchema, SQL_NTS, (SQLCHAR*)szTable, SQL_NTS, (SQLCHAR*)szColumn, SQL_NTS);
     Py_END_ALLOW_THREADS
 
     if (!SQL_SUCCEEDED(ret))
@@ -1246,15 +2274,15 @@ Cursor_columns(PyObject* self, PyObject* args, PyObject* kwargs)
 
     SQLSMALLINT cCols;
     Py_BEGIN_ALLOW_THREADS
-    ret = SQLNumResultCols(cur->hstmt, &cCols);
+    ret = ODBC_CALL(cur->cnxn, SQLNumResultCols)(cur->hstmt, &cCols);
     Py_END_ALLOW_THREADS
     if (!SQL_SUCCEEDED(ret))
         return RaiseErrorFromHandle("SQLNumResultCols", cur->cnxn->hdbc, cur->hstmt);
     
-    if (!PrepareResults(cur, cCols))
+    if (!PrepareResults(cur, cCols, true))
         return 0;
 
-    if (!create_name_map(cur, cCols, true))
+    if (cachekey.IsValid() && !CacheCatalog(cur, cachekey))
         return 0;
 
     // Return the cursor so the results can be iterated over directly.
@@ -1305,8 +2333,15 @@ Cursor_statistics(PyObject* self, PyObject* args, PyObject* kwargs)
 
     Cursor* cur = Cursor_Validate(self, CURSOR_REQUIRE_OPEN);
     
-    if (!free_results(cur, FREE_STATEMENT))
+    if (!free_results(cur, FREE_PREPARED))
         return 0;
+
+    Object cachekey;
+    if (GetCachedCatalog(cur, "statistics", args, kwargs, cachekey))
+    {
+        Py_INCREF(cur);
+        return (PyObject*)cur;
+    }
     
     SQLUSMALLINT nUnique   = (SQLUSMALLINT)(PyObject_IsTrue(pUnique) ? SQL_INDEX_UNIQUE : SQL_INDEX_ALL);
     SQLUSMALLINT nReserved = (SQLUSMALLINT)(PyObject_IsTrue(pQuick)  ? SQL_QUICK : SQL_ENSURE);
@@ -1314,7 +2349,7 @@ Cursor_statistics(PyObject* self, PyObject* args, PyObject* kwargs)
     SQLRETURN ret = 0;
 
     Py_BEGIN_ALLOW_THREADS
-    ret = SQLStatistics(cur->hstmt, (SQLCHAR*)szCatalog, SQL_NTS, (SQLCHAR*)szSchema, SQL_NTS, (SQLCHAR*)szTable, SQL_NTS, 
+    ret = ODBC_CALL(cur->cnxn, SQLStatistics)(cur->hstmt, (SQLCHAR*)szCatalog, SQL_NTS, (SQLCHAR*)szSchema, SQL_NTS, (SQLCHAR*)szTable, SQL_NTS, 
                         nUnique, nReserved);
     Py_END_ALLOW_THREADS
 
@@ -1323,15 +2358,15 @@ Cursor_statistics(PyObject* self, PyObject* args, PyObject* kwargs)
 
     SQLSMALLINT cCols;
     Py_BEGIN_ALLOW_THREADS
-    ret = SQLNumResultCols(cur->hstmt, &cCols);
+    ret = ODBC_CALL(cur->cnxn, SQLNumResultCols)(cur->hstmt, &cCols);
     Py_END_ALLOW_THREADS
     if (!SQL_SUCCEEDED(ret))
         return RaiseErrorFromHandle("SQLNumResultCols", cur->cnxn->hdbc, cur->hstmt);
     
-    if (!PrepareResults(cur, cCols))
+    if (!PrepareResults(cur, cCols, true))
         return 0;
 
-    if (!create_name_map(cur, cCols, true))
+    if (cachekey.IsValid() && !CacheCatalog(cur, cachekey))
         return 0;
 
     // Return the cursor so the results can be iterated over directly.
@@ -1383,15 +2418,22 @@ _specialColumns(PyObject* self, PyObject* args, PyObject* kwargs, SQLUSMALLINT n
 
     Cursor* cur = Cursor_Validate(self, CURSOR_REQUIRE_OPEN);
     
-    if (!free_results(cur, FREE_STATEMENT))
+    if (!free_results(cur, FREE_PREPARED))
         return 0;
+
+    Object cachekey;
+    if (GetCachedCatalog(cur, nIdType == SQL_BEST_ROWID ? "rowIdColumns" : "rowVerColumns", args, kwargs, cachekey))
+    {
+        Py_INCREF(cur);
+        return (PyObject*)cur;
+    }
     
     SQLRETURN ret = 0;
 
     SQLUSMALLINT nNullable = (SQLUSMALLINT)(PyObject_IsTrue(pNullable) ? SQL_NULLABLE : SQL_NO_NULLS);
 
     Py_BEGIN_ALLOW_THREADS
-    ret = SQLSpecialColumns(cur->hstmt, nIdType, (SQLCHAR*)szCatalog, SQL_NTS, (SQLCHAR*)szSchema, SQL_NTS, (SQLCHAR*)szTable, SQL_NTS,
+    ret = ODBC_CALL(cur->cnxn, SQLSpecialColumns)(cur->hstmt, nIdType, (SQLCHAR*)szCatalog, SQL_NTS, (SQLCHAR*)szSchema, SQL_NTS, (SQLCHAR*)szTable, SQL_NTS,
                             SQL_SCOPE_TRANSACTION, nNullable);
     Py_END_ALLOW_THREADS
 
@@ -1400,15 +2442,15 @@ _specialColumns(PyObject* self, PyObject* args, PyObject* kwargs, SQLUSMALLINT n
 
     SQLSMALLINT cCols;
     Py_BEGIN_ALLOW_THREADS
-    ret = SQLNumResultCols(cur->hstmt, &cCols);
+    ret = ODBC_CALL(cur->cnxn, SQLNumResultCols)(cur->hstmt, &cCols);
     Py_END_ALLOW_THREADS
     if (!SQL_SUCCEEDED(ret))
         return RaiseErrorFromHandle("SQLNumResultCols", cur->cnxn->hdbc, cur->hstmt);
     
-    if (!PrepareResults(cur, cCols))
+    if (!PrepareResults(cur, cCols, true))
         return 0;
 
-    if (!create_name_map(cur, cCols, true))
+    if (cachekey.IsValid() && !CacheCatalog(cur, cachekey))
         return 0;
 
     // Return the cursor so the results can be iterated over directly.
@@ -1455,13 +2497,20 @@ Cursor_primaryKeys(PyObject* self, PyObject* args, PyObject* kwargs)
 
     Cursor* cur = Cursor_Validate(self, CURSOR_REQUIRE_OPEN);
     
-    if (!free_results(cur, FREE_STATEMENT))
+    if (!free_results(cur, FREE_PREPARED))
         return 0;
+
+    Object cachekey;
+    if (GetCachedCatalog(cur, "primaryKeys", args, kwargs, cachekey))
+    {
+        Py_INCREF(cur);
+        return (PyObject*)cur;
+    }
     
     SQLRETURN ret = 0;
 
     Py_BEGIN_ALLOW_THREADS
-    ret = SQLPrimaryKeys(cur->hstmt, (SQLCHAR*)szCatalog, SQL_NTS, (SQLCHAR*)szSchema, SQL_NTS, (SQLCHAR*)szTable, SQL_NTS);
+    ret = ODBC_CALL(cur->cnxn, SQLPrimaryKeys)(cur->hstmt, (SQLCHAR*)szCatalog, SQL_NTS, (SQLCHAR*)szSchema, SQL_NTS, (SQLCHAR*)szTable, SQL_NTS);
     Py_END_ALLOW_THREADS
 
     if (!SQL_SUCCEEDED(ret))
@@ -1469,15 +2518,15 @@ Cursor_primaryKeys(PyObject* self, PyObject* args, PyObject* kwargs)
 
     SQLSMALLINT cCols;
     Py_BEGIN_ALLOW_THREADS
-    ret = SQLNumResultCols(cur->hstmt, &cCols);
+    ret = ODBC_CALL(cur->cnxn, SQLNumResultCols)(cur->hstmt, &cCols);
     Py_END_ALLOW_THREADS
     if (!SQL_SUCCEEDED(ret))
         return RaiseErrorFromHandle("SQLNumResultCols", cur->cnxn->hdbc, cur->hstmt);
     
-    if (!PrepareResults(cur, cCols))
+    if (!PrepareResults(cur, cCols, true))
         return 0;
 
-    if (!create_name_map(cur, cCols, true))
+    if (cachekey.IsValid() && !CacheCatalog(cur, cachekey))
         return 0;
 
     // Return the cursor so the results can be iterated over directly.
@@ -1527,13 +2576,20 @@ Cursor_foreignKeys(PyObject* self, PyObject* args, PyObject* kwargs)
 
     Cursor* cur = Cursor_Validate(self, CURSOR_REQUIRE_OPEN);
     
-    if (!free_results(cur, FREE_STATEMENT))
+    if (!free_results(cur, FREE_PREPARED))
         return 0;
+
+    Object cachekey;
+    if (GetCachedCatalog(cur, "foreignKeys", args, kwargs, cachekey))
+    {
+        Py_INCREF(cur);
+        return (PyObject*)cur;
+    }
     
     SQLRETURN ret = 0;
 
     Py_BEGIN_ALLOW_THREADS
-    ret = SQLForeignKeys(cur->hstmt, (SQLCHAR*)szCatalog, SQL_NTS, (SQLCHAR*)szSchema, SQL_NTS, (SQLCHAR*)szTable, SQL_NTS,
+    ret = ODBC_CALL(cur->cnxn, SQLForeignKeys)(cur->hstmt, (SQLCHAR*)szCatalog, SQL_NTS, (SQLCHAR*)szSchema, SQL_NTS, (SQLCHAR*)szTable, SQL_NTS,
                          (SQLCHAR*)szForeignCatalog, SQL_NTS, (SQLCHAR*)szForeignSchema, SQL_NTS, (SQLCHAR*)szForeignTable, SQL_NTS);
     Py_END_ALLOW_THREADS
 
@@ -1542,15 +2598,15 @@ Cursor_foreignKeys(PyObject* self, PyObject* args, PyObject* kwargs)
 
     SQLSMALLINT cCols;
     Py_BEGIN_ALLOW_THREADS
-    ret = SQLNumResultCols(cur->hstmt, &cCols);
+    ret = ODBC_CALL(cur->cnxn, SQLNumResultCols)(cur->hstmt, &cCols);
     Py_END_ALLOW_THREADS
     if (!SQL_SUCCEEDED(ret))
         return RaiseErrorFromHandle("SQLNumResultCols", cur->cnxn->hdbc, cur->hstmt);
     
-    if (!PrepareResults(cur, cCols))
+    if (!PrepareResults(cur, cCols, true))
         return 0;
 
-    if (!create_name_map(cur, cCols, true))
+    if (cachekey.IsValid() && !CacheCatalog(cur, cachekey))
         return 0;
 
     // Return the cursor so the results can be iterated over directly.
@@ -1596,13 +2652,20 @@ Cursor_getTypeInfo(PyObject* self, PyObject* args, PyObject* kwargs)
 
     Cursor* cur = Cursor_Validate(self, CURSOR_REQUIRE_OPEN);
     
-    if (!free_results(cur, FREE_STATEMENT))
+    if (!free_results(cur, FREE_PREPARED))
         return 0;
+
+    Object cachekey;
+    if (GetCachedCatalog(cur, "getTypeInfo", args, kwargs, cachekey))
+    {
+        Py_INCREF(cur);
+        return (PyObject*)cur;
+    }
     
     SQLRETURN ret = 0;
 
     Py_BEGIN_ALLOW_THREADS
-    ret = SQLGetTypeInfo(cur->hstmt, nDataType);
+    ret = ODBC_CALL(cur->cnxn, SQLGetTypeInfo)(cur->hstmt, nDataType);
     Py_END_ALLOW_THREADS
 
     if (!SQL_SUCCEEDED(ret))
@@ -1610,15 +2673,15 @@ Cursor_getTypeInfo(PyObject* self, PyObject* args, PyObject* kwargs)
 
     SQLSMALLINT cCols;
     Py_BEGIN_ALLOW_THREADS
-    ret = SQLNumResultCols(cur->hstmt, &cCols);
+    ret = ODBC_CALL(cur->cnxn, SQLNumResultCols)(cur->hstmt, &cCols);
     Py_END_ALLOW_THREADS
     if (!SQL_SUCCEEDED(ret))
         return RaiseErrorFromHandle("SQLNumResultCols", cur->cnxn->hdbc, cur->hstmt);
     
-    if (!PrepareResults(cur, cCols))
+    if (!PrepareResults(cur, cCols, true))
         return 0;
 
-    if (!create_name_map(cur, cCols, true))
+    if (cachekey.IsValid() && !CacheCatalog(cur, cachekey))
         return 0;
 
     // Return the cursor so the results can be iterated over directly.
@@ -1635,11 +2698,18 @@ Cursor_nextset(PyObject* self, PyObject* args)
     
     if (!cur)
         return 0;
+
+    if (cur->preloaded)
+    {
+        // Results from a cache only hold the one result set and the statement is no longer positioned on it.
+        free_results(cur, FREE_STATEMENT);
+        Py_RETURN_FALSE;
+    }
     
     SQLRETURN ret = 0;
 
     Py_BEGIN_ALLOW_THREADS
-    ret = SQLMoreResults(cur->hstmt);
+    ret = ODBC_CALL(cur->cnxn, SQLMoreResults)(cur->hstmt);
     Py_END_ALLOW_THREADS
 
     if (ret == SQL_NO_DATA)
@@ -1650,7 +2720,7 @@ Cursor_nextset(PyObject* self, PyObject* args)
 
     SQLSMALLINT cCols;
     Py_BEGIN_ALLOW_THREADS
-    ret = SQLNumResultCols(cur->hstmt, &cCols);
+    ret = ODBC_CALL(cur->cnxn, SQLNumResultCols)(cur->hstmt, &cCols);
     Py_END_ALLOW_THREADS
     if (!SQL_SUCCEEDED(ret))
     {
@@ -1666,16 +2736,13 @@ Cursor_nextset(PyObject* self, PyObject* args)
     {
         // A result set was created.
 
-        if (!PrepareResults(cur, cCols))
-            return 0;
-
-        if (!create_name_map(cur, cCols, lowercase()))
+        if (!PrepareResults(cur, cCols, lowercase()))
             return 0;
     }
 
     SQLLEN cRows;
     Py_BEGIN_ALLOW_THREADS
-    ret = SQLRowCount(cur->hstmt, &cRows);
+    ret = ODBC_CALL(cur->cnxn, SQLRowCount)(cur->hstmt, &cRows);
     Py_END_ALLOW_THREADS
     cur->rowcount = (int)cRows;
 
@@ -1724,13 +2791,20 @@ Cursor_procedureColumns(PyObject* self, PyObject* args, PyObject* kwargs)
 
     Cursor* cur = Cursor_Validate(self, CURSOR_REQUIRE_OPEN);
     
-    if (!free_results(cur, FREE_STATEMENT))
+    if (!free_results(cur, FREE_PREPARED))
         return 0;
+
+    Object cachekey;
+    if (GetCachedCatalog(cur, "procedureColumns", args, kwargs, cachekey))
+    {
+        Py_INCREF(cur);
+        return (PyObject*)cur;
+    }
     
     SQLRETURN ret = 0;
 
     Py_BEGIN_ALLOW_THREADS
-    ret = SQLProcedureColumns(cur->hstmt, (SQLCHAR*)szCatalog, SQL_NTS, (SQLCHAR*)szSchema, SQL_NTS,
+    ret = ODBC_CALL(cur->cnxn, SQLProcedureColumns)(cur->hstmt, (SQLCHAR*)szCatalog, SQL_NTS, (SQLCHAR*)szSchema, SQL_NTS,
                               (SQLCHAR*)szProcedure, SQL_NTS, 0, 0);
     Py_END_ALLOW_THREADS
 
@@ -1739,15 +2813,15 @@ Cursor_procedureColumns(PyObject* self, PyObject* args, PyObject* kwargs)
 
     SQLSMALLINT cCols;
     Py_BEGIN_ALLOW_THREADS
-    ret = SQLNumResultCols(cur->hstmt, &cCols);
+    ret = ODBC_CALL(cur->cnxn, SQLNumResultCols)(cur->hstmt, &cCols);
     Py_END_ALLOW_THREADS
     if (!SQL_SUCCEEDED(ret))
         return RaiseErrorFromHandle("SQLNumResultCols", cur->cnxn->hdbc, cur->hstmt);
     
-    if (!PrepareResults(cur, cCols))
+    if (!PrepareResults(cur, cCols, true))
         return 0;
 
-    if (!create_name_map(cur, cCols, true))
+    if (cachekey.IsValid() && !CacheCatalog(cur, cachekey))
         return 0;
 
     // Return the cursor so the results can be iterated over directly.
@@ -1784,13 +2858,20 @@ Cursor_procedures(PyObject* self, PyObject* args, PyObject* kwargs)
 
     Cursor* cur = Cursor_Validate(self, CURSOR_REQUIRE_OPEN);
     
-    if (!free_results(cur, FREE_STATEMENT))
+    if (!free_results(cur, FREE_PREPARED))
         return 0;
+
+    Object cachekey;
+    if (GetCachedCatalog(cur, "procedures", args, kwargs, cachekey))
+    {
+        Py_INCREF(cur);
+        return (PyObject*)cur;
+    }
     
     SQLRETURN ret = 0;
 
     Py_BEGIN_ALLOW_THREADS
-    ret = SQLProcedures(cur->hstmt, (SQLCHAR*)szCatalog, SQL_NTS, (SQLCHAR*)szSchema, SQL_NTS, (SQLCHAR*)szProcedure, SQL_NTS);
+    ret = ODBC_CALL(cur->cnxn, SQLProcedures)(cur->hstmt, (SQLCHAR*)szCatalog, SQL_NTS, (SQLCHAR*)szSchema, SQL_NTS, (SQLCHAR*)szProcedure, SQL_NTS);
     Py_END_ALLOW_THREADS
 
     if (!SQL_SUCCEEDED(ret))
@@ -1798,15 +2879,15 @@ Cursor_procedures(PyObject* self, PyObject* args, PyObject* kwargs)
 
     SQLSMALLINT cCols;
     Py_BEGIN_ALLOW_THREADS
-    ret = SQLNumResultCols(cur->hstmt, &cCols);
+    ret = ODBC_CALL(cur->cnxn, SQLNumResultCols)(cur->hstmt, &cCols);
     Py_END_ALLOW_THREADS
     if (!SQL_SUCCEEDED(ret))
         return RaiseErrorFromHandle("SQLNumResultCols", cur->cnxn->hdbc, cur->hstmt);
     
-    if (!PrepareResults(cur, cCols))
+    if (!PrepareResults(cur, cCols, true))
         return 0;
 
-    if (!create_name_map(cur, cCols, true))
+    if (cachekey.IsValid() && !CacheCatalog(cur, cachekey))
         return 0;
 
     // Return the cursor so the results can be iterated over directly.
@@ -1818,7 +2899,8 @@ static char skip_doc[] =
     "skip(count) --> None\n" \
     "\n" \
     "Skips the next `count` records by calling SQLFetchScroll with SQL_FETCH_NEXT.\n"
-    "For convenience, skip(0) is accepted and will do nothing.";
+    "For convenience, skip(0) is accepted and will do nothing.  Results returned\n"
+    "from a cache are skipped without calling the driver.";
 
 static PyObject* Cursor_skip(PyObject* self, PyObject* args)
 {
@@ -1829,9 +2911,20 @@ static PyObject* Cursor_skip(PyObject* self, PyObject* args)
     int count;
     if (!PyArg_ParseTuple(args, "i", &count))
         return 0;
-    if (count == 0)
+    if (count <= 0)
         Py_RETURN_NONE;
 
+    if (cursor->preloaded)
+    {
+        // The rows were already read (see FetchPreloaded), so there is no statement to fetch from.
+        Py_ssize_t remaining = PyTuple_GET_SIZE(cursor->preloaded) - cursor->preloaded_pos;
+        cursor->preloaded_pos += min((Py_ssize_t)count, remaining);
+        Py_RETURN_NONE;
+    }
+
+    // The skipped rows are not read, so the results can no longer be added to the result cache.
+    StopRecording(cursor);
+
     // Note: I'm not sure about the performance implications of looping here -- I certainly would rather use
     // SQLFetchScroll(SQL_FETCH_RELATIVE, count), but it requires scrollable cursors which are often slower.  I would
     // not expect skip to be used in performance intensive code since different SQL would probably be the "right"
@@ -1840,7 +2933,7 @@ static PyObject* Cursor_skip(PyObject* self, PyObject* args)
     SQLRETURN ret = SQL_SUCCESS;
     Py_BEGIN_ALLOW_THREADS
     for (int i = 0; i < count && SQL_SUCCEEDED(ret); i++)
-        ret = SQLFetchScroll(cursor->hstmt, SQL_FETCH_NEXT, 0);
+        ret = ODBC_CALL(cursor->cnxn, SQLFetchScroll)(cursor->hstmt, SQL_FETCH_NEXT, 0);
     Py_END_ALLOW_THREADS
 
     if (!SQL_SUCCEEDED(ret) && ret != SQL_NO_DATA)
@@ -1906,7 +2999,7 @@ static PyObject* Cursor_getnoscan(PyObject* self, void *closure)
     SQLUINTEGER noscan = SQL_NOSCAN_OFF;
     SQLRETURN ret;
     Py_BEGIN_ALLOW_THREADS
-    ret = SQLGetStmtAttr(cursor->hstmt, SQL_ATTR_NOSCAN, (SQLPOINTER)&noscan, sizeof(SQLUINTEGER), 0);
+    ret = ODBC_CALL(cursor->cnxn, SQLGetStmtAttr)(cursor->hstmt, SQL_ATTR_NOSCAN, (SQLPOINTER)&noscan, sizeof(SQLUINTEGER), 0);
     Py_END_ALLOW_THREADS
 
     if (!SQL_SUCCEEDED(ret))
@@ -1936,9 +3029,10 @@ static PyObject* Cursor_setnoscan(PyObject* self, PyObject* value, void *closure
     }
 
     SQLUINTEGER noscan = PyObject_IsTrue(value) ? SQL_NOSCAN_ON : SQL_NOSCAN_OFF;
+    cursor->attrs_changed = true;
     SQLRETURN ret;
     Py_BEGIN_ALLOW_THREADS
-    ret = SQLSetStmtAttr(cursor->hstmt, SQL_ATTR_NOSCAN, (SQLPOINTER)noscan, 0);
+    ret = ODBC_CALL(cursor->cnxn, SQLSetStmtAttr)(cursor->hstmt, SQL_ATTR_NOSCAN, (SQLPOINTER)noscan, 0);
     Py_END_ALLOW_THREADS
     if (!SQL_SUCCEEDED(ret))
     {
@@ -1948,9 +3042,21 @@ static PyObject* Cursor_setnoscan(PyObject* self, PyObject* value, void *closure
     return 0;
 }
 
+static PyObject* Cursor_getstats(PyObject* self, void *closure)
+{
+    UNUSED(closure);
+
+    Cursor* cursor = Cursor_Validate(self, CURSOR_RAISE_ERROR);
+    if (!cursor)
+        return 0;
+
+    return Stats_ToDict(cursor->stats);
+}
+
 static PyGetSetDef Cursor_getsetters[] =
 {
     {"noscan", (getter)Cursor_getnoscan, (setter)Cursor_setnoscan, "NOSCAN statement attr", 0},
+    {"stats", (getter)Cursor_getstats, 0, "Timing statistics for the last statement executed (see pyodbc.enable_stats)", 0},
     { 0 }
 };
 
@@ -1971,16 +3077,18 @@ static char nextset_doc[] = "nextset() --> True | None\n" \
 static char ignored_doc[] = "Ignored.";
 
 static char fetchone_doc[] =
-    "fetchone() --> Row | None\n" \
+    "fetchone(timeout=None) --> Row | None\n" \
     "\n" \
     "Fetch the next row of a query result set, returning a single Row instance, or\n" \
     "None when no more data is available.\n" \
     "\n" \
     "A ProgrammingError exception is raised if the previous call to execute() did\n" \
-    "not produce any result set or no call was issued yet.";
+    "not produce any result set or no call was issued yet.\n" \
+    "\n" \
+    "See execute for a description of `timeout`.";
 
-static char fetchall_doc[] =
-    "fetchmany(size=cursor.arraysize) --> list of Rows\n" \
+static char fetchmany_doc[] =
+    "fetchmany(size=cursor.arraysize, timeout=None) --> list of Rows\n" \
     "\n" \
     "Fetch the next set of rows of a query result, returning a list of Row\n" \
     "instances. An empty list is returned when no more rows are available.\n" \
@@ -1992,27 +3100,33 @@ static char fetchall_doc[] =
     "being available, fewer rows may be returned.\n" \
     "\n" \
     "A ProgrammingError exception is raised if the previous call to execute() did\n" \
-    "not produce any result set or no call was issued yet.";
+    "not produce any result set or no call was issued yet.\n" \
+    "\n" \
+    "If `timeout` is provided, it limits the time taken by the entire fetch.  See\n" \
+    "execute.";
 
-static char fetchmany_doc[] =
-    "fetchmany() --> list of Rows\n" \
+static char fetchall_doc[] =
+    "fetchall(timeout=None) --> list of Rows\n" \
     "\n" \
     "Fetch all remaining rows of a query result, returning them as a list of Rows.\n" \
     "An empty list is returned if there are no more rows.\n" \
     "\n" \
     "A ProgrammingError exception is raised if the previous call to execute() did\n" \
-    "not produce any result set or no call was issued yet.";
+    "not produce any result set or no call was issued yet.\n" \
+    "\n" \
+    "If `timeout` is provided, it limits the time taken by the entire fetch.  See\n" \
+    "execute.";
 
 static PyMethodDef Cursor_methods[] =
 {
     { "close",            (PyCFunction)Cursor_close,            METH_NOARGS,                close_doc            },
-    { "execute",          (PyCFunction)Cursor_execute,          METH_VARARGS,               execute_doc          },
+    { "execute",          (PyCFunction)Cursor_execute,          METH_VARARGS|METH_KEYWORDS, execute_doc          },
     { "executemany",      (PyCFunction)Cursor_executemany,      METH_VARARGS,               executemany_doc      },
     { "setinputsizes",    (PyCFunction)Cursor_ignored,          METH_VARARGS,               ignored_doc          },
     { "setoutputsize",    (PyCFunction)Cursor_ignored,          METH_VARARGS,               ignored_doc          },
-    { "fetchone",         (PyCFunction)Cursor_fetchone,         METH_NOARGS,                fetchone_doc         },
-    { "fetchall",         (PyCFunction)Cursor_fetchall,         METH_NOARGS,                fetchall_doc         },
-    { "fetchmany",        (PyCFunction)Cursor_fetchmany,        METH_VARARGS,               fetchmany_doc        },
+    { "fetchone",         (PyCFunction)Cursor_fetchone,         METH_VARARGS|METH_KEYWORDS, fetchone_doc         },
+    { "fetchall",         (PyCFunction)Cursor_fetchall,         METH_VARARGS|METH_KEYWORDS, fetchall_doc         },
+    { "fetchmany",        (PyCFunction)Cursor_fetchmany,        METH_VARARGS|METH_KEYWORDS, fetchmany_doc        },
     { "nextset",          (PyCFunction)Cursor_nextset,          METH_NOARGS,                nextset_doc          },
     { "tables",           (PyCFunction)Cursor_tables,           METH_VARARGS|METH_KEYWORDS, tables_doc           },
     { "columns",          (PyCFunction)Cursor_columns,          METH_VARARGS|METH_KEYWORDS, columns_doc          },
@@ -2025,6 +3139,9 @@ static PyMethodDef Cursor_methods[] =
     { "procedures",       (PyCFunction)Cursor_procedures,       METH_VARARGS|METH_KEYWORDS, procedures_doc       },
     { "procedureColumns", (PyCFunction)Cursor_procedureColumns, METH_VARARGS|METH_KEYWORDS, procedureColumns_doc },
     { "skip",             (PyCFunction)Cursor_skip,             METH_VARARGS,               skip_doc             },
+    { "cancel",           (PyCFunction)Cursor_cancel,           METH_NOARGS,                cancel_doc           },
+    { "execute_async",    (PyCFunction)Cursor_execute_async,    METH_VARARGS,               execute_async_doc    },
+    { "fetchmany_async",  (PyCFunction)Cursor_fetchmany_async,  METH_VARARGS,               fetchmany_async_doc  },
     { 0, 0, 0, 0 }
 };
 
@@ -2106,18 +3223,66 @@ Cursor_New(Connection* cnxn)
         cur->pPreparedSQL      = 0;
         cur->paramcount        = 0;
         cur->paramtypes        = 0;
+        cur->boundtypes        = 0;
         cur->paramInfos        = 0;
+        cur->scratch           = 0;
+        cur->scratch_size      = 0;
+        cur->scratch_used      = 0;
+        cur->scratch_needed    = 0;
+        cur->sql_source        = 0;
+        cur->sql_text          = 0;
+        cur->sql_text_len      = 0;
+        cur->sql_text_capacity = 0;
         cur->colinfos          = 0;
         cur->arraysize         = 1;
         cur->rowcount          = -1;
         cur->map_name_to_index = 0;
+        cur->interns           = 0;
+        cur->intern_count      = 0;
+        cur->raw_block         = 0;
+        cur->async_op          = 0;
+        cur->attrs_changed     = false;
+
+        cur->preloaded         = 0;
+        cur->preloaded_pos     = 0;
+        cur->fetch_fingerprint = 0;
+        cur->fetch_start       = 0;
+        cur->trace_id          = 0;
+        cur->trace_start       = 0;
+        cur->trace_rows        = 0;
+        cur->querylog_sql      = 0;
+        cur->querylog_params   = 0;
+        cur->querylog_duration = 0;
+        cur->querylog_rows     = 0;
+        cur->trace_bytes       = 0;
+        cur->record_key        = 0;
+        cur->record_generation = 0;
+        cur->record_rows       = 0;
+        cur->record_size       = 0;
+        memset(&cur->stats, 0, sizeof(cur->stats));
+        memset(&cur->gilclock, 0, sizeof(cur->gilclock));
+
+        cur->cached_colinfos     = 0;
+        cur->cached_count        = 0;
+        cur->cached_description  = 0;
+        cur->cached_map          = 0;
+        cur->cached_lower        = false;
+        cur->cached_conv_version = 0;
 
         Py_INCREF(cnxn);
         Py_INCREF(cur->description);
 
+        // Pooled handles are already reset and have the connection's timeout.
+        cur->hstmt = Connection_TakeStatement(cnxn);
+        if (cur->hstmt != SQL_NULL_HANDLE)
+        {
+            TRACE("cursor.new cnxn=%p hdbc=%d cursor=%p hstmt=%d (pooled)\n", cnxn, cnxn->hdbc, cur, cur->hstmt);
+            return cur;
+        }
+
         SQLRETURN ret;
         Py_BEGIN_ALLOW_THREADS
-        ret = SQLAllocHandle(SQL_HANDLE_STMT, cnxn->hdbc, &cur->hstmt);
+        ret = ODBC_CALL(cnxn, SQLAllocHandle)(SQL_HANDLE_STMT, cnxn->hdbc, &cur->hstmt);
         Py_END_ALLOW_THREADS
 
         if (!SQL_SUCCEEDED(ret))
@@ -2127,10 +3292,12 @@ Cursor_New(Connection* cnxn)
             return 0;
         }
 
+        cnxn->stmts_allocated++;
+
         if (cnxn->timeout)
         {
             Py_BEGIN_ALLOW_THREADS
-            ret = SQLSetStmtAttr(cur->hstmt, SQL_ATTR_QUERY_TIMEOUT, (SQLPOINTER)cnxn->timeout, 0);
+            ret = ODBC_CALL(cur->cnxn, SQLSetStmtAttr)(cur->hstmt, SQL_ATTR_QUERY_TIMEOUT, (SQLPOINTER)cnxn->timeout, 0);
             Py_END_ALLOW_THREADS
         
             if (!SQL_SUCCEEDED(ret))
@@ -14,7 +14,11 @@
 #ifndef CURSOR_H
 #define CURSOR_H
 
+#include "stats.h"
+
 struct Connection;
+struct InternTable;
+struct RawBlock;
 
 struct ColumnInfo
 {
@@ -32,6 +36,11 @@ struct ColumnInfo
     // of the integer types are the same size whether signed and unsigned, so we can allocate memory ahead of time
     // without knowing this.  We use this during the fetch when converting to a Python integer or long.
     bool is_unsigned;
+
+    // The remaining SQLDescribeCol values, kept so a cached description can be checked against the next execute's
+    // results (see cached_colinfos).
+    SQLSMALLINT decimal_digits;
+    SQLSMALLINT nullable;
 };
 
 struct ParamInfo
@@ -96,6 +105,10 @@ struct Cursor
     // allocated (length == paramcount) but all entries are set to SQL_UNKNOWN_TYPE.
     SQLSMALLINT* paramtypes;
 
+    // If non-zero, the C and SQL types (two entries per parameter) pPreparedSQL's parameters were last bound with,
+    // allocated via malloc.  The cached result metadata is only valid for these types (see cached_colinfos).
+    SQLSMALLINT* boundtypes;
+
     // If non-zero, a pointer to a buffer containing the actual parameters bound.  If pPreparedSQL is zero, this should
     // be freed using free and set to zero.
     //
@@ -103,6 +116,24 @@ struct Cursor
     // bind into the Python objects directly.
     ParamInfo* paramInfos;
 
+    // A buffer for parameter values that have to be converted before they are bound, such as Unicode parameters when
+    // SQLWCHAR and Py_UNICODE are different sizes, so each execute does not allocate them (see AllocScratch).  The
+    // first scratch_used bytes hold the current parameters' values and it is emptied when they are freed.  If they need
+    // more than scratch_size bytes, the rest are allocated separately and the buffer is enlarged to scratch_needed
+    // when it is emptied.
+    char*  scratch;
+    size_t scratch_size;
+    size_t scratch_used;
+    size_t scratch_needed;
+
+    // The SQLWCHAR text of the last Unicode SQL prepared or executed, sql_source, when SQLWCHAR and Py_UNICODE are
+    // different sizes.  Executing the same object again, which is usual in a loop, reuses it instead of converting it
+    // again, and the buffer is reused when the next statement is converted.  See Cursor_SQLText.
+    PyObject*  sql_source;
+    SQLWCHAR*  sql_text;
+    Py_ssize_t sql_text_len;        // in SQLWCHARs, not including the NULL terminator
+    Py_ssize_t sql_text_capacity;   // in SQLWCHARs
+
     //
     // Result Information
     //
@@ -126,14 +157,110 @@ struct Cursor
     // This duplicates some ODBC functionality, but allows us to use Row objects after the statement is closed and
     // should use less memory than putting each column into the Row's __dict__.
     //
-    // Since this is shared by Row objects, it cannot be reused.  New dictionaries are created for every execute.  This
-    // will be zero whenever there are no results.
+    // Since this is shared by Row objects, it is never modified after it is created.  It is only reused when a prepared
+    // statement is executed again (see cached_colinfos).  This will be zero whenever there are no results.
     PyObject* map_name_to_index;
+
+    // If non-zero, an array of intern_count tables, one per result column, of the character values read so far (see
+    // intern.h).  Created by the first lookup when the connection's intern_limit is non-zero and freed with the
+    // results.
+    InternTable* interns;
+    Py_ssize_t intern_count;
+
+    // The block the next lazy row's data is added to (see rawrow.h), or zero.  The cursor holds a reference, which is
+    // released when the last row has been fetched or with the results.
+    RawBlock* raw_block;
+
+    // If non-zero, a tuple of value tuples that the fetch functions return (as Rows) instead of reading from the HSTMT.
+    // This is used when a result set comes from a cache.  preloaded_pos is the index of the next row to return.
+    // colinfos is zero in this case, so check this too when testing whether there are results.
+    PyObject* preloaded;
+    Py_ssize_t preloaded_pos;
+
+    // If non-zero, the rows are being recorded for the connection's result cache.  record_rows is a list of value
+    // tuples and record_size their estimated size.  When the result set has been fetched to the end, they are added to
+    // the cache under record_key unless the cache has been invalidated since record_generation.  Recording stops if the
+    // rows become too large to cache.
+    PyObject* record_key;
+    PyObject* record_rows;
+    size_t record_size;
+    UINT64 record_generation;
+
+    // When fetch_start is non-zero, the time the last execute finished.  Reading to the end of the result set records
+    // the time since then in the fetch latency histogram for fetch_fingerprint.
+    UINT64 fetch_fingerprint;
+    UINT64 fetch_start;
+
+    // When trace_id is non-zero, the id of the statement whose result set is being traced (see trace.h), the time its
+    // execute finished, and the rows and bytes fetched from it so far.
+    UINT64 trace_id;
+    UINT64 trace_start;
+    UINT64 trace_rows;
+    UINT64 trace_bytes;
+
+    // When querylog_sql is non-zero, the query log event of the statement whose result set is being read (see
+    // querylog.h) and the rows fetched from it so far.  It is recorded when the result set is finished.
+    PyObject*  querylog_sql;
+    Py_ssize_t querylog_params;
+    UINT64     querylog_duration;
+    Py_ssize_t querylog_rows;
+
+    // The result metadata from the last execute of pPreparedSQL.  Executing the same prepared statement with parameters
+    // of the same types produces the same columns, so these are copied instead of creating the metadata again.  They
+    // are only used if the number of columns, the lowercase setting, and the connection's conv_version are the same as
+    // when they were created and, if the connection's recheck_columns is set, SQLDescribeCol still returns the same
+    // name, type, size, digits, and nullability for every column.  They are freed whenever pPreparedSQL is or a
+    // parameter is bound with a different type.  cached_colinfos is zero when nothing is cached.
+    ColumnInfo* cached_colinfos;
+    int         cached_count;
+    PyObject*   cached_description;
+    PyObject*   cached_map;
+    bool        cached_lower;
+    int         cached_conv_version;
+
+    // If non-zero, the pyodbc.Future (a borrowed reference) of an asynchronous operation still running on this cursor.
+    // The Future holds a reference to the cursor and clears this when it completes.  The cursor cannot be used in the
+    // meantime.
+    PyObject* async_op;
+
+    // True if a statement attribute (other than the query timeout) was changed from its default, such as by setting
+    // noscan.  The handle is freed when the cursor is closed instead of being returned to the connection's pool.
+    bool attrs_changed;
+
+    // Statistics for the most recent statement.  Only collected while pyodbc.enable_stats is on.
+    Stats stats;
+
+    // Times the GIL during the current fetch call.
+    GilClock gilclock;
 };
 
 void Cursor_init();
 
+// Frees the result metadata cached for the prepared statement.  Called whenever pPreparedSQL is freed or replaced.
+void FreeColumnCache(Cursor* cur);
+
+// Returns the Unicode SQL `pSql` as NULL terminated SQLWCHARs, which are valid until the next call, and sets `cch` to
+// their length.  Returns zero with an exception set if it cannot be converted.
+const SQLWCHAR* Cursor_SQLText(Cursor* cur, PyObject* pSql, Py_ssize_t& cch);
+
 Cursor* Cursor_New(Connection* cnxn);
-PyObject* Cursor_execute(PyObject* self, PyObject* args);
+PyObject* Cursor_execute(PyObject* self, PyObject* args, PyObject* kwargs);
+
+// The internal execute and fetch implementations.  These do not validate the cursor.
+PyObject* Cursor_ExecuteImpl(Cursor* cur, PyObject* pSql, PyObject* params, bool skip_first);
+PyObject* Cursor_fetchlist(Cursor* cur, Py_ssize_t max);
+
+// Statement-level asynchronous execution (SQL_ATTR_ASYNC_ENABLE), used by the Future objects in async.cpp.
+
+enum AsyncStatus
+{
+    ASYNC_DONE,                 // finished; the result is set, or it is zero and an exception is set
+    ASYNC_PENDING,              // the driver is still executing; call Cursor_PollAsync later
+    ASYNC_UNSUPPORTED,          // the driver would not enable asynchronous execution; nothing was executed
+};
+
+AsyncStatus Cursor_BeginAsync(Cursor* cur, PyObject* pSql, PyObject* params, bool skip_first, PyObject*& result);
+AsyncStatus Cursor_PollAsync(Cursor* cur, PyObject*& result);
+void Cursor_AbortAsync(Cursor* cur);
 
 #endif
@@ -1,6 +1,7 @@
 
 #include "pyodbc.h"
 #include "errors.h"
+#include "callcounts.h"
 #include "pyodbcmodule.h"
 
 // Exceptions
@@ -22,6 +23,7 @@ static const struct SqlStateMapping sql_state_mapping[] =
     { "24",    2, &ProgrammingError },
     { "25",    2, &ProgrammingError },
     { "42",    2, &ProgrammingError },
+    { "HY008", 5, &OperationalError },
     { "HYT00", 5, &OperationalError },
     { "HYT01", 5, &OperationalError },
 };
@@ -227,7 +229,7 @@ PyObject* GetErrorFromHandle(const char* szFunction, HDBC hdbc, HSTMT hstmt)
 
         SQLRETURN ret;
         Py_BEGIN_ALLOW_THREADS
-        ret = SQLGetDiagRec(nHandleType, h, iRecord, (SQLCHAR*)sqlstateT, &nNativeError, (SQLCHAR*)szMsg, (short)(_countof(szMsg)-1), &cchMsg);
+        ret = ODBC_CALL(0, SQLGetDiagRec)(nHandleType, h, iRecord, (SQLCHAR*)sqlstateT, &nNativeError, (SQLCHAR*)szMsg, (short)(_countof(szMsg)-1), &cchMsg);
         Py_END_ALLOW_THREADS
         if (!SQL_SUCCEEDED(ret))
             break;
@@ -294,7 +296,7 @@ static bool GetSqlState(HSTMT hstmt, char* szSqlState)
     SQLRETURN ret;
 
     Py_BEGIN_ALLOW_THREADS
-    ret = SQLGetDiagRec(SQL_HANDLE_STMT, hstmt, 1, (SQLCHAR*)szSqlState, &nNative, szMsg, cbMsg, &cchMsg);
+    ret = ODBC_CALL(0, SQLGetDiagRec)(SQL_HANDLE_STMT, hstmt, 1, (SQLCHAR*)szSqlState, &nNative, szMsg, cbMsg, &cchMsg);
     Py_END_ALLOW_THREADS
     return SQL_SUCCEEDED(ret);
 }
@@ -0,0 +1,726 @@
+
+#include "pyodbc.h"
+#include "pyodbcmodule.h"
+#include "connection.h"
+#include "cursor.h"
+#include "row.h"
+#include "errors.h"
+#include "wrapper.h"
+#include "threads.h"
+#include "gather.h"
+
+#include <new>
+
+// scatter_gather runs one query per partition, each on its own connection, and returns a single iterator over all of
+// the rows.
+//
+// Every partition has a dedicated native thread that executes the query and then fetches batches of rows into a
+// small queue.  The threads use the normal cursor code, so the GIL is released during the ODBC calls and only held
+// while building Rows.  A partition's thread stops fetching when its queue is full, so memory use is bounded by
+// partitions * MAX_BATCHES * batch_size rows no matter how slowly the iterator is consumed.
+//
+// Without order_by, the iterator returns rows from whichever partition has some ready.  With order_by, each
+// partition's query must already be sorted on those columns and the iterator does a k-way merge: it returns the row
+// with the smallest key among the partitions' next rows.  Since the number of partitions is the number of
+// connections, a linear scan for the smallest key is cheaper than maintaining a heap.
+//
+// The Python lists (batches) are only touched while holding the GIL.  The counts and flags the threads wait on are
+// protected by the Gather's lock.
+
+static const int MAX_BATCHES = 4;
+
+struct Gather;
+
+struct Partition
+{
+    Gather* owner;
+
+    // From the arguments.  These are not changed after the threads are started.
+    Connection* cnxn;
+    PyObject* pSql;
+    PyObject* params;           // zero if there are none
+
+    // The cursor the thread is using, so it can be canceled.  Only accessed with the GIL held.
+    Cursor* cursor;
+
+    // Lists of Rows fetched by the thread and not yet taken by the iterator.
+    PyObject* batches;
+
+    // Protected by the owner's lock.
+    int queued;                 // the number of items in `batches`
+    bool finished;              // the thread has exited and will not add more batches
+
+    // Only used by the iterator.
+    PyObject* current;          // the batch rows are being returned from
+    Py_ssize_t index;           // the next row in `current`
+    PyObject* key;              // the order_by values of the next row when merging, or zero if not computed
+    bool exhausted;             // no more rows
+};
+
+struct Gather
+{
+    PyObject_HEAD
+
+    Mutex* lock;
+    Condition* changed;         // broadcast whenever a queue or flag changes
+
+    Partition* partitions;
+    int count;
+
+    PyObject* order_by;         // tuple of column indexes and names; zero if the rows are not merged
+    bool reverse;
+    long batch_size;
+
+    // Protected by `lock`.
+    bool stop;                  // set when the iterator is deleted; the threads exit as soon as they can
+    int running;                // the number of threads that have not exited
+    int queued;                 // the total number of queued batches in all partitions
+
+    // The first error from any partition.  Only accessed with the GIL held.
+    PyObject* exc_type;
+    PyObject* exc_value;
+    PyObject* exc_tb;
+
+    // The partition to check first when not merging, so partitions are served round robin.
+    int next;
+};
+
+
+static void Fail(Gather* g)
+{
+    // Records the current exception if it is the first.  Called with the GIL held.
+
+    if (g->exc_type == 0)
+        PyErr_Fetch(&g->exc_type, &g->exc_value, &g->exc_tb);
+    else
+        PyErr_Clear();
+}
+
+
+static PyObject* RaiseFailure(Gather* g)
+{
+    // Raises the recorded error.  The Gather keeps it, so every later call raises it too.
+
+    Py_INCREF(g->exc_type);
+    Py_XINCREF(g->exc_value);
+    Py_XINCREF(g->exc_tb);
+    PyErr_Restore(g->exc_type, g->exc_value, g->exc_tb);
+    return 0;
+}
+
+
+static void PartitionThread(void* arg)
+{
+    Partition* p = (Partition*)arg;
+    Gather* g = p->owner;
+
+    PyGILState_STATE gil = PyGILState_Ensure();
+
+    bool ok = true;
+
+    Cursor* cursor = Cursor_New(p->cnxn);
+    if (!cursor)
+    {
+        ok = false;
+    }
+    else
+    {
+        p->cursor = cursor;
+
+        PyObject* result = Cursor_ExecuteImpl(cursor, p->pSql, p->params, false);
+        if (!result)
+            ok = false;
+        Py_XDECREF(result);
+
+        if (ok && cursor->colinfos == 0)
+        {
+            RaiseErrorV(0, ProgrammingError, "A scatter_gather query did not return any results.");
+            ok = false;
+        }
+    }
+
+    while (ok)
+    {
+        bool stop;
+
+        Py_BEGIN_ALLOW_THREADS
+        g->lock->Lock();
+        while (p->queued >= MAX_BATCHES && !g->stop)
+            g->changed->Wait();
+        stop = g->stop;
+        g->lock->Unlock();
+        Py_END_ALLOW_THREADS
+
+        if (stop)
+            break;
+
+        PyObject* rows = Cursor_fetchlist(cursor, g->batch_size);
+        if (!rows)
+        {
+            ok = false;
+            break;
+        }
+
+        if (PyList_GET_SIZE(rows) == 0)
+        {
+            Py_DECREF(rows);
+            break;
+        }
+
+        int rc = PyList_Append(p->batches, rows);
+        Py_DECREF(rows);
+        if (rc != 0)
+        {
+            ok = false;
+            break;
+        }
+
+        MutexLock locker(*g->lock);
+        p->queued++;
+        g->queued++;
+        g->changed->Broadcast();
+    }
+
+    if (!ok)
+        Fail(g);
+
+    p->cursor = 0;
+    Py_XDECREF(cursor);
+
+    // The Gather cannot be freed until its deallocator gets the GIL back, so it is safe to use up to the release.
+    {
+        MutexLock locker(*g->lock);
+        p->finished = true;
+        g->running--;
+        g->changed->Broadcast();
+    }
+
+    PyGILState_Release(gil);
+}
+
+
+static bool TakeBatch(Gather* g, Partition* p)
+{
+    // Moves the partition's oldest queued batch into `current`.  Returns false if nothing is queued.  Called with the
+    // GIL held.
+
+    if (PyList_GET_SIZE(p->batches) == 0)
+        return false;
+
+    Py_XDECREF(p->current);
+    p->current = PyList_GET_ITEM(p->batches, 0);
+    Py_INCREF(p->current);
+    p->index = 0;
+
+    PySequence_DelItem(p->batches, 0);
+
+    MutexLock locker(*g->lock);
+    p->queued--;
+    g->queued--;
+    g->changed->Broadcast();
+    return true;
+}
+
+
+inline bool HasRow(Partition* p)
+{
+    return p->current != 0 && p->index < PyList_GET_SIZE(p->current);
+}
+
+
+static bool Fill(Gather* g, Partition* p)
+{
+    // Waits until the partition has a row available or is exhausted.  Returns false with an exception set if any
+    // partition has failed.
+
+    while (!p->exhausted && !HasRow(p))
+    {
+        if (TakeBatch(g, p))
+            continue;
+
+        if (g->exc_type)
+        {
+            RaiseFailure(g);
+            return false;
+        }
+
+        bool finished;
+        Py_BEGIN_ALLOW_THREADS
+        g->lock->Lock();
+        while (p->queued == 0 && !p->finished)
+            g->changed->Wait();
+        finished = p->finished && p->queued == 0;
+        g->lock->Unlock();
+        Py_END_ALLOW_THREADS
+
+        if (finished)
+        {
+            if (g->exc_type)
+            {
+                RaiseFailure(g);
+                return false;
+            }
+
+            Py_XDECREF(p->current);
+            p->current   = 0;
+            p->exhausted = true;
+        }
+    }
+
+    return true;
+}
+
+
+static PyObject* TakeRow(Partition* p)
+{
+    PyObject* row = PyList_GET_ITEM(p->current, p->index++);
+    Py_INCREF(row);
+
+    Py_XDECREF(p->key);
+    p->key = 0;
+
+    return row;
+}
+
+
+static PyObject* GetKey(Gather* g, PyObject* row)
+{
+    // Returns a tuple of the row's order_by values.  Tuples compare item by item, so comparing the tuples compares
+    // the rows.
+
+    Py_ssize_t count = PyTuple_GET_SIZE(g->order_by);
+
+    Object key(PyTuple_New(count));
+    if (!key)
+        return 0;
+
+    for (Py_ssize_t i = 0; i < count; i++)
+    {
+        PyObject* column = PyTuple_GET_ITEM(g->order_by, i);
+        PyObject* value;
+        if (PyInt_Check(column))
+            value = PySequence_GetItem(row, PyInt_AS_LONG(column));
+        else
+            value = PyObject_GetAttr(row, column);
+        if (!value)
+            return 0;
+        PyTuple_SET_ITEM(key.Get(), i, value);
+    }
+
+    return key.Detach();
+}
+
+
+static PyObject* NextMerged(Gather* g)
+{
+    Partition* best = 0;
+
+    for (int i = 0; i < g->count; i++)
+    {
+        Partition* p = &g->partitions[i];
+
+        if (!Fill(g, p))
+            return 0;
+
+        if (p->exhausted)
+            continue;
+
+        if (p->key == 0)
+        {
+            p->key = GetKey(g, PyList_GET_ITEM(p->current, p->index));
+            if (p->key == 0)
+                return 0;
+        }
+
+        if (best == 0)
+        {
+            best = p;
+            continue;
+        }
+
+        // Only replace on strictly less so ties keep partition order.
+        int less = PyObject_RichCompareBool(p->key, best->key, g->reverse ? Py_GT : Py_LT);
+        if (less == -1)
+            return 0;
+        if (less)
+            best = p;
+    }
+
+    if (best == 0)
+        return 0;
+
+    return TakeRow(best);
+}
+
+
+static PyObject* NextUnordered(Gather* g)
+{
+    for (;;)
+    {
+        if (g->exc_type)
+            return RaiseFailure(g);
+
+        // Return a row from the first partition that has one, starting after the one we used last time.
+
+        bool all_exhausted = true;
+
+        for (int n = 0; n < g->count; n++)
+        {
+            int i = (g->next + n) % g->count;
+            Partition* p = &g->partitions[i];
+
+            if (p->exhausted)
+                continue;
+
+            if (HasRow(p) || TakeBatch(g, p))
+            {
+                g->next = (i + 1) % g->count;
+                return TakeRow(p);
+            }
+
+            bool finished;
+            {
+                MutexLock locker(*g->lock);
+                finished = p->finished && p->queued == 0;
+            }
+
+            if (finished)
+            {
+                Py_XDECREF(p->current);
+                p->current   = 0;
+                p->exhausted = true;
+            }
+            else
+            {
+                all_exhausted = false;
+            }
+        }
+
+        if (all_exhausted)
+            return g->exc_type ? RaiseFailure(g) : 0;
+
+        // Wait for any partition to queue a batch or finish.
+
+        Py_BEGIN_ALLOW_THREADS
+        g->lock->Lock();
+        int running = g->running;
+        while (g->queued == 0 && g->running == running)
+            g->changed->Wait();
+        g->lock->Unlock();
+        Py_END_ALLOW_THREADS
+    }
+}
+
+
+static PyObject* Gather_iter(PyObject* self)
+{
+    Py_INCREF(self);
+    return self;
+}
+
+
+static PyObject* Gather_iternext(PyObject* self)
+{
+    // Returns zero without an exception when there are no more rows.
+
+    Gather* g = (Gather*)self;
+    return g->order_by ? NextMerged(g) : NextUnordered(g);
+}
+
+
+static void Gather_dealloc(Gather* g)
+{
+    if (g->lock)
+    {
+        // Stop the threads and wait for them since they use this object.  Canceling makes any statement that is
+        // still running fail quickly.  (Like Cursor.cancel, we hold the GIL while calling SQLCancel so the statement
+        // cannot be freed underneath us.)
+
+        for (int i = 0; i < g->count; i++)
+        {
+            Cursor* cursor = g->partitions[i].cursor;
+            if (cursor && cursor->cnxn->hdbc != SQL_NULL_HANDLE && cursor->hstmt != SQL_NULL_HANDLE)
+                ODBC_CALL(cursor->cnxn, SQLCancel)(cursor->hstmt);
+        }
+
+        Py_BEGIN_ALLOW_THREADS
+        g->lock->Lock();
+        g->stop = true;
+        g->changed->Broadcast();
+        while (g->running > 0)
+            g->changed->Wait();
+        g->lock->Unlock();
+        Py_END_ALLOW_THREADS
+
+        delete g->changed;
+        delete g->lock;
+    }
+
+    if (g->partitions)
+    {
+        for (int i = 0; i < g->count; i++)
+        {
+            Partition* p = &g->partitions[i];
+            Py_XDECREF(p->cnxn);
+            Py_XDECREF(p->pSql);
+            Py_XDECREF(p->params);
+            Py_XDECREF(p->batches);
+            Py_XDECREF(p->current);
+            Py_XDECREF(p->key);
+        }
+        pyodbc_free(g->partitions);
+    }
+
+    Py_XDECREF(g->order_by);
+    Py_XDECREF(g->exc_type);
+    Py_XDECREF(g->exc_value);
+    Py_XDECREF(g->exc_tb);
+
+    PyObject_Del(g);
+}
+
+
+static bool InitPartition(Partition* p, PyObject* item)
+{
+    // Fills in a partition from a (connection, sql) or (connection, sql, params) item.
+
+    if (!PyTuple_Check(item) || PyTuple_GET_SIZE(item) < 2 || PyTuple_GET_SIZE(item) > 3)
+    {
+        PyErr_SetString(PyExc_TypeError, "scatter_gather partitions must be (connection, sql) or (connection, sql, params) tuples");
+        return false;
+    }
+
+    PyObject* cnxn   = PyTuple_GET_ITEM(item, 0);
+    PyObject* pSql   = PyTuple_GET_ITEM(item, 1);
+    PyObject* params = PyTuple_GET_SIZE(item) == 3 ? PyTuple_GET_ITEM(item, 2) : Py_None;
+
+    if (!Connection_Check(cnxn))
+    {
+        PyErr_SetString(PyExc_TypeError, "scatter_gather partitions must start with a Connection");
+        return false;
+    }
+
+    if (((Connection*)cnxn)->hdbc == SQL_NULL_HANDLE)
+    {
+        PyErr_SetString(ProgrammingError, "Attempt to use a closed connection.");
+        return false;
+    }
+
+    if (!PyString_Check(pSql) && !PyUnicode_Check(pSql))
+    {
+        PyErr_SetString(PyExc_TypeError, "The scatter_gather SQL must be a string or unicode query.");
+        return false;
+    }
+
+    if (params != Py_None && !PyTuple_Check(params) && !PyList_Check(params) && !Row_Check(params))
+    {
+        PyErr_SetString(PyExc_TypeError, "Params must be in a list, tuple, or Row");
+        return false;
+    }
+
+    p->batches = PyList_New(0);
+    if (!p->batches)
+        return false;
+
+    p->cnxn   = (Connection*)cnxn;
+    p->pSql   = pSql;
+    p->params = params == Py_None ? 0 : params;
+    Py_INCREF(p->cnxn);
+    Py_INCREF(p->pSql);
+    Py_XINCREF(p->params);
+
+    return true;
+}
+
+
+static PyObject* NormalizeOrderBy(PyObject* order_by)
+{
+    // Returns a tuple of column indexes and names.  A single index or name is allowed for convenience.
+
+    if (PyInt_Check(order_by) || PyString_Check(order_by))
+        return Py_BuildValue("(O)", order_by);
+
+    Object columns(PySequence_Tuple(order_by));
+    if (!columns)
+        return 0;
+
+    for (Py_ssize_t i = 0; i < PyTuple_GET_SIZE(columns.Get()); i++)
+    {
+        PyObject* column = PyTuple_GET_ITEM(columns.Get(), i);
+        if (!PyInt_Check(column) && !PyString_Check(column))
+        {
+            PyErr_SetString(PyExc_TypeError, "order_by must contain column indexes or names");
+            return 0;
+        }
+    }
+
+    if (PyTuple_GET_SIZE(columns.Get()) == 0)
+    {
+        PyErr_SetString(PyExc_ValueError, "order_by must not be empty");
+        return 0;
+    }
+
+    return columns.Detach();
+}
+
+
+PyObject* Gather_New(PyObject* partitions, PyObject* order_by, bool reverse, long batch_size)
+{
+    if (batch_size < 1)
+    {
+        PyErr_SetString(PyExc_ValueError, "batch_size must be at least 1");
+        return 0;
+    }
+
+    Object items(PySequence_Tuple(partitions));
+    if (!items)
+        return 0;
+
+    int count = (int)PyTuple_GET_SIZE(items.Get());
+    if (count == 0)
+    {
+        PyErr_SetString(ProgrammingError, "scatter_gather requires at least one partition.");
+        return 0;
+    }
+
+    Gather* g = PyObject_NEW(Gather, &GatherType);
+    if (!g)
+        return 0;
+
+    g->lock       = 0;
+    g->changed    = 0;
+    g->partitions = 0;
+    g->count      = 0;
+    g->order_by   = 0;
+    g->reverse    = reverse;
+    g->batch_size = batch_size;
+    g->stop       = false;
+    g->running    = 0;
+    g->queued     = 0;
+    g->exc_type   = 0;
+    g->exc_value  = 0;
+    g->exc_tb     = 0;
+    g->next       = 0;
+
+    Object result((PyObject*)g);
+
+    if (order_by != 0 && order_by != Py_None)
+    {
+        g->order_by = NormalizeOrderBy(order_by);
+        if (!g->order_by)
+            return 0;
+    }
+
+    g->partitions = (Partition*)pyodbc_malloc(sizeof(Partition) * count);
+    if (!g->partitions)
+        return PyErr_NoMemory();
+    memset(g->partitions, 0, sizeof(Partition) * count);
+    g->count = count;
+
+    for (int i = 0; i < count; i++)
+    {
+        g->partitions[i].owner = g;
+        if (!InitPartition(&g->partitions[i], PyTuple_GET_ITEM(items.Get(), i)))
+            return 0;
+
+        // Each thread owns its connection.
+        for (int j = 0; j < i; j++)
+        {
+            if (g->partitions[j].cnxn == g->partitions[i].cnxn)
+            {
+                PyErr_SetString(ProgrammingError, "A connection was used by more than one scatter_gather partition.");
+                return 0;
+            }
+        }
+    }
+
+    Mutex* lock = new (std::nothrow) Mutex();
+    Condition* changed = lock ? new (std::nothrow) Condition(*lock) : 0;
+    if (!changed)
+    {
+        delete lock;
+        return PyErr_NoMemory();
+    }
+    g->lock    = lock;
+    g->changed = changed;
+
+    // The threads call PyGILState_Ensure, which requires the GIL to have been created.
+    PyEval_InitThreads();
+
+    // We hold the GIL, so none of the threads can do anything until we return.
+
+    for (int i = 0; i < count; i++)
+    {
+        Partition* p = &g->partitions[i];
+
+        MutexLock locker(*g->lock);
+        if (StartThread(PartitionThread, p))
+        {
+            g->running++;
+        }
+        else
+        {
+            p->finished = true;
+            RaiseErrorV(0, PyExc_RuntimeError, "Unable to start a thread for scatter_gather");
+            Fail(g);
+        }
+    }
+
+    return result.Detach();
+}
+
+
+static char gather_doc[] =
+    "An iterator over the rows of a scatter_gather call.  See pyodbc.scatter_gather.\n"
+    "\n"
+    "Deleting the iterator before it is exhausted cancels the partitions' queries.";
+
+PyTypeObject GatherType =
+{
+    PyObject_HEAD_INIT(0)
+    0,                                                      // ob_size
+    "pyodbc.ScatterGather",                                 // tp_name
+    sizeof(Gather),                                         // tp_basicsize
+    0,                                                      // tp_itemsize
+    (destructor)Gather_dealloc,                             // destructor tp_dealloc
+    0,                                                      // tp_print
+    0,                                                      // tp_getattr
+    0,                                                      // tp_setattr
+    0,                                                      // tp_compare
+    0,                                                      // tp_repr
+    0,                                                      // tp_as_number
+    0,                                                      // tp_as_sequence
+    0,                                                      // tp_as_mapping
+    0,                                                      // tp_hash
+    0,                                                      // tp_call
+    0,                                                      // tp_str
+    0,                                                      // tp_getattro
+    0,                                                      // tp_setattro
+    0,                                                      // tp_as_buffer
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_ITER,              // tp_flags
+    gather_doc,                                             // tp_doc
+    0,                                                      // tp_traverse
+    0,                                                      // tp_clear
+    0,                                                      // tp_richcompare
+    0,                                                      // tp_weaklistoffset
+    Gather_iter,                                            // tp_iter
+    Gather_iternext,                                        // tp_iternext
+    0,                                                      // tp_methods
+    0,                                                      // tp_members
+    0,                                                      // tp_getset
+    0,                                                      // tp_base
+    0,                                                      // tp_dict
+    0,                                                      // tp_descr_get
+    0,                                                      // tp_descr_set
+    0,                                                      // tp_dictoffset
+    0,                                                      // tp_init
+    0,                                                      // tp_alloc
+    0,                                                      // tp_new
+    0,                                                      // tp_free
+    0,                                                      // tp_is_gc
+    0,                                                      // tp_bases
+    0,                                                      // tp_mro
+    0,                                                      // tp_cache
+    0,                                                      // tp_subclasses
+    0,                                                      // tp_weaklist
+};
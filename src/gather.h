@@ -0,0 +1,11 @@
+
+#ifndef _GATHER_H_
+#define _GATHER_H_
+
+extern PyTypeObject GatherType;
+
+// Implements pyodbc.scatter_gather.  `partitions` is a sequence of (connection, sql) or (connection, sql, params)
+// items.  Returns an iterator over the rows of all partitions, merged on the `order_by` columns if it is not None.
+PyObject* Gather_New(PyObject* partitions, PyObject* order_by, bool reverse, long batch_size);
+
+#endif // _GATHER_H_
@@ -9,6 +9,11 @@
 #include "errors.h"
 #include "dbspecific.h"
 #include "sqlwchar.h"
+#include "utf8.h"
+#include "intern.h"
+#include "rawrow.h"
+#include "row.h"
+#include "kernelbench.h"
 
 void GetData_init()
 {
@@ -29,9 +34,10 @@ class DataBuffer
     //
     // When dealing with Unicode, there are two widths we have to be aware of: (1) SQLWCHAR and (2) Py_UNICODE.  If
     // these are the same we can use a PyUnicode object so we don't have to allocate our own buffer and then the
-    // Unicode object.  If they are not the same (e.g. OS/X where wchar_t-->4 Py_UNICODE-->2) then we need to maintain
-    // our own buffer and pass it to the PyUnicode object later.  Many Linux distros are now using UCS4, so Py_UNICODE
-    // will be larger than SQLWCHAR.
+    // Unicode object.  Many Linux distros are now using UCS4, so Py_UNICODE will be larger than SQLWCHAR.  In that
+    // case we still read into a PyUnicode object, which has room for twice the SQLWCHARs, and widen the text in place
+    // when it is detached (see WidenSQLWCHAR).  If SQLWCHAR is larger (e.g. OS/X where wchar_t-->4 Py_UNICODE-->2)
+    // then we need to maintain our own buffer and pass it to the PyUnicode object later.
     //
     // To reduce heap fragmentation, we perform the initial read into an array on the stack since we don't know the
     // length of the data.  If the data doesn't fit, this class then allocates new memory.  If the first read gives us
@@ -84,6 +90,18 @@ public:
         }
     }
 
+    const char* GetStackData(Py_ssize_t& cb)
+    {
+        // Returns the data if it was all read into the stack buffer, which detaching the value does not change, and
+        // sets `cb` to its length.  Otherwise returns zero.
+
+        if (!usingStack)
+            return 0;
+
+        cb = bytesUsed;
+        return buffer;
+    }
+
     char* GetBuffer()
     {
         if (!buffer)
@@ -126,16 +144,17 @@ public:
                 bufferOwner = PyString_FromStringAndSize(0, newSize);
                 buffer      = bufferOwner ? PyString_AS_STRING(bufferOwner) : 0;
             }
-            else if (sizeof(SQLWCHAR) == Py_UNICODE_SIZE)
+            else if (sizeof(SQLWCHAR) <= Py_UNICODE_SIZE)
             {
-                // Allocate directly into a Unicode object.
+                // Allocate directly into a Unicode object.  If Py_UNICODE is wider, this leaves room to widen the text
+                // in place.
                 bufferOwner = PyUnicode_FromUnicode(0, newSize / element_size);
                 buffer      = bufferOwner ? (char*)PyUnicode_AsUnicode(bufferOwner) : 0;
             }
             else
             {
                 // We're Unicode, but SQLWCHAR and Py_UNICODE don't match, so maintain our own SQLWCHAR buffer.
-                buffer = (char*)pyodbc_malloc((size_t)newSize);
+                buffer = (char*)pyodbc_malloc((size_t)newSize, MEM_SQLWCHAR);
             }
 
             if (buffer == 0)
@@ -162,7 +181,7 @@ public:
         }
         else
         {
-            char* tmp = (char*)realloc(buffer, (size_t)newSize);
+            char* tmp = (char*)pyodbc_realloc(buffer, (size_t)newSize);
             if (tmp == 0)
                 return false;
             buffer = tmp;
@@ -203,7 +222,13 @@ public:
 
         if (bufferOwner && PyUnicode_CheckExact(bufferOwner))
         {
-            if (PyUnicode_Resize(&bufferOwner, bytesUsed / element_size) == -1)
+            Py_ssize_t cch = bytesUsed / element_size;
+#ifdef SQLWCHAR_WIDEN
+            Py_UNICODE* pch = PyUnicode_AS_UNICODE(bufferOwner);
+            if (WidenSQLWCHAR(pch, (const SQLWCHAR*)pch, cch))
+                cch = CombineSurrogates(pch, cch);
+#endif
+            if (PyUnicode_Resize(&bufferOwner, cch) == -1)
                 return 0;
             PyObject* tmp = bufferOwner;
             bufferOwner = 0;
@@ -214,13 +239,67 @@ public:
         // We have allocated our own SQLWCHAR buffer and must now copy it to a Unicode object.
         PyObject* result = PyUnicode_FromSQLWCHAR((const SQLWCHAR*)buffer, bytesUsed / element_size);
         if (result == 0)
-            return false;
+            return 0;
         pyodbc_free(buffer);
         buffer = 0;
         return result;
     }
+
+    PyObject* DecodeValue(Connection* cnxn)
+    {
+        // Used instead of DetachValue for SQL_C_CHAR data when the connection has an encoding.  Decodes the text into
+        // a new Unicode object, leaving the buffer to be freed by the destructor.
+
+        if (bytesUsed == SQL_NULL_DATA || buffer == 0)
+            Py_RETURN_NONE;
+
+        if (cnxn->encoding_utf8)
+            return PyUnicode_FromUTF8(buffer, bytesUsed);
+
+        return PyUnicode_Decode(buffer, bytesUsed, PyString_AS_STRING(cnxn->encoding), "strict");
+    }
 };
 
+#ifdef PYODBC_BENCH
+PyObject* Bench_DataBuffer(SQLSMALLINT dataType, const char* data, Py_ssize_t cb)
+{
+    // The first read fills the stack buffer, less room for the NULL terminator, and reports the total length.  The
+    // buffer is then grown to hold the rest, which the second read fills.
+
+    char tempBuffer[1024];
+    DataBuffer buffer(dataType, tempBuffer, sizeof(tempBuffer));
+
+    SQLLEN cbFirst = buffer.GetRemaining() - buffer.null_size;
+    if (cbFirst > cb)
+        cbFirst = cb;
+
+    memcpy(buffer.GetBuffer(), data, (size_t)cbFirst);
+    buffer.AddUsed(cbFirst);
+
+    if (cbFirst < cb)
+    {
+        if (!buffer.AllocateMore(cb - cbFirst))
+            return PyErr_NoMemory();
+        memcpy(buffer.GetBuffer(), data + cbFirst, (size_t)(cb - cbFirst));
+        buffer.AddUsed(cb - cbFirst);
+    }
+
+    return buffer.DetachValue();
+}
+#endif
+
+inline void CountBytes(Cursor* cur, SQLLEN cb)
+{
+    // Adds the length returned by SQLGetData to the byte counts.  Negative lengths are indicators like SQL_NULL_DATA.
+    if (cb > 0)
+    {
+        CountBytesReceived(cur->cnxn, (UINT64)cb);
+        Stats_Count(cur, &Stats::bytes, (UINT64)cb);
+        if (cur->trace_id)
+            cur->trace_bytes += (UINT64)cb;
+    }
+}
+
 static PyObject*
 GetDataString(Cursor* cur, Py_ssize_t iCol)
 {
@@ -251,6 +330,7 @@ GetDataString(Cursor* cur, Py_ssize_t iCol)
         pinfo->column_size = 36;
 
     SQLSMALLINT nTargetType;
+    bool decode = false;        // read as SQL_C_CHAR and decode with the connection's encoding
 
     switch (pinfo->sql_type)
     {
@@ -259,7 +339,12 @@ GetDataString(Cursor* cur, Py_ssize_t iCol)
     case SQL_LONGVARCHAR:
     case SQL_GUID:
     case SQL_SS_XML:
-        if (cur->cnxn->unicode_results)
+        if (cur->cnxn->unicode_results && cur->cnxn->encoding)
+        {
+            nTargetType  = SQL_C_CHAR;
+            decode       = true;
+        }
+        else if (cur->cnxn->unicode_results)
             nTargetType  = SQL_C_WCHAR;
         else
             nTargetType  = SQL_C_CHAR;
@@ -284,9 +369,11 @@ GetDataString(Cursor* cur, Py_ssize_t iCol)
         SQLRETURN ret;
         SQLLEN cbData = 0;
 
-        Py_BEGIN_ALLOW_THREADS
-        ret = SQLGetData(cur->hstmt, (SQLUSMALLINT)(iCol+1), nTargetType, buffer.GetBuffer(), buffer.GetRemaining(), &cbData);
-        Py_END_ALLOW_THREADS;
+        StatsTimer timer(cur, &Stats::getdata);
+        FETCH_BEGIN_ALLOW_THREADS(cur)
+        ret = ODBC_CALL(cur->cnxn, SQLGetData)(cur->hstmt, (SQLUSMALLINT)(iCol+1), nTargetType, buffer.GetBuffer(), buffer.GetRemaining(), &cbData);
+        FETCH_END_ALLOW_THREADS(cur)
+        timer.Stop();
 
         if (cbData == SQL_NULL_DATA)
             Py_RETURN_NONE;
@@ -330,6 +417,7 @@ GetDataString(Cursor* cur, Py_ssize_t iCol)
             }
 
             buffer.AddUsed(cbRead);
+            CountBytes(cur, cbRead);
             if (!buffer.AllocateMore(cbMore))
                 return PyErr_NoMemory();
         }
@@ -337,10 +425,32 @@ GetDataString(Cursor* cur, Py_ssize_t iCol)
         {
             // For some reason, the NULL terminator is used in intermediate buffers but not in this final one.
             buffer.AddUsed(cbData);
+            CountBytes(cur, cbData);
         }
 
         if (ret == SQL_SUCCESS || ret == SQL_NO_DATA)
-            return buffer.DetachValue();
+        {
+            // Short values are looked up in the column's intern table, if it has one, before creating an object.
+
+            Py_ssize_t cb = 0;
+            const char* pb = buffer.GetStackData(cb);
+            InternTable* table = (pb && cb <= INTERN_MAX_BYTES) ? Intern_GetTable(cur, iCol, nTargetType) : 0;
+            long hash = 0;
+
+            if (table)
+            {
+                PyObject* value = Intern_Find(cur, table, pb, cb, hash);
+                if (value)
+                    return value;
+            }
+
+            PyObject* value = decode ? buffer.DecodeValue(cur->cnxn) : buffer.DetachValue();
+
+            if (table && value)
+                Intern_Add(table, pb, cb, hash, value);
+
+            return value;
+        }
     }
 
     // REVIEW: Add an error message.
@@ -404,9 +514,12 @@ GetDataDecimal(Cursor* cur, Py_ssize_t iCol)
         return PyErr_NoMemory();
 
     SQLRETURN ret;
-    Py_BEGIN_ALLOW_THREADS
-    ret = SQLGetData(cur->hstmt, (SQLUSMALLINT)(iCol+1), SQL_C_CHAR, sz, cbNeeded, &cbFetched);
-    Py_END_ALLOW_THREADS
+    StatsTimer timer(cur, &Stats::getdata);
+    FETCH_BEGIN_ALLOW_THREADS(cur)
+    ret = ODBC_CALL(cur->cnxn, SQLGetData)(cur->hstmt, (SQLUSMALLINT)(iCol+1), SQL_C_CHAR, sz, cbNeeded, &cbFetched);
+    FETCH_END_ALLOW_THREADS(cur)
+    timer.Stop();
+    CountBytes(cur, cbFetched);
     if (!SQL_SUCCEEDED(ret))
         return RaiseErrorFromHandle("SQLGetData", cur->cnxn->hdbc, cur->hstmt);
 
@@ -443,9 +556,12 @@ GetDataBit(Cursor* cur, Py_ssize_t iCol)
     SQLLEN cbFetched;
     SQLRETURN ret;
 
-    Py_BEGIN_ALLOW_THREADS
-    ret = SQLGetData(cur->hstmt, (SQLUSMALLINT)(iCol+1), SQL_C_BIT, &ch, sizeof(ch), &cbFetched);
-    Py_END_ALLOW_THREADS
+    StatsTimer timer(cur, &Stats::getdata);
+    FETCH_BEGIN_ALLOW_THREADS(cur)
+    ret = ODBC_CALL(cur->cnxn, SQLGetData)(cur->hstmt, (SQLUSMALLINT)(iCol+1), SQL_C_BIT, &ch, sizeof(ch), &cbFetched);
+    FETCH_END_ALLOW_THREADS(cur)
+    timer.Stop();
+    CountBytes(cur, cbFetched);
 
     if (!SQL_SUCCEEDED(ret))
         return RaiseErrorFromHandle("SQLGetData", cur->cnxn->hdbc, cur->hstmt);
@@ -470,9 +586,12 @@ GetDataLong(Cursor* cur, Py_ssize_t iCol)
 
     SQLSMALLINT nCType = pinfo->is_unsigned ? SQL_C_ULONG : SQL_C_LONG;
 
-    Py_BEGIN_ALLOW_THREADS
-    ret = SQLGetData(cur->hstmt, (SQLUSMALLINT)(iCol+1), nCType, &value, sizeof(value), &cbFetched);
-    Py_END_ALLOW_THREADS
+    StatsTimer timer(cur, &Stats::getdata);
+    FETCH_BEGIN_ALLOW_THREADS(cur)
+    ret = ODBC_CALL(cur->cnxn, SQLGetData)(cur->hstmt, (SQLUSMALLINT)(iCol+1), nCType, &value, sizeof(value), &cbFetched);
+    FETCH_END_ALLOW_THREADS(cur)
+    timer.Stop();
+    CountBytes(cur, cbFetched);
     if (!SQL_SUCCEEDED(ret))
         return RaiseErrorFromHandle("SQLGetData", cur->cnxn->hdbc, cur->hstmt);
 
@@ -494,9 +613,12 @@ static PyObject* GetDataLongLong(Cursor* cur, Py_ssize_t iCol)
     SQLLEN      cbFetched;
     SQLRETURN   ret;
 
-    Py_BEGIN_ALLOW_THREADS
-    ret = SQLGetData(cur->hstmt, (SQLUSMALLINT)(iCol+1), nCType, &value, sizeof(value), &cbFetched);
-    Py_END_ALLOW_THREADS
+    StatsTimer timer(cur, &Stats::getdata);
+    FETCH_BEGIN_ALLOW_THREADS(cur)
+    ret = ODBC_CALL(cur->cnxn, SQLGetData)(cur->hstmt, (SQLUSMALLINT)(iCol+1), nCType, &value, sizeof(value), &cbFetched);
+    FETCH_END_ALLOW_THREADS(cur)
+    timer.Stop();
+    CountBytes(cur, cbFetched);
 
     if (!SQL_SUCCEEDED(ret))
         return RaiseErrorFromHandle("SQLGetData", cur->cnxn->hdbc, cur->hstmt);
@@ -517,9 +639,12 @@ GetDataDouble(Cursor* cur, Py_ssize_t iCol)
     SQLLEN cbFetched = 0;
     SQLRETURN ret;
 
-    Py_BEGIN_ALLOW_THREADS
-    ret = SQLGetData(cur->hstmt, (SQLUSMALLINT)(iCol+1), SQL_C_DOUBLE, &value, sizeof(value), &cbFetched);
-    Py_END_ALLOW_THREADS
+    StatsTimer timer(cur, &Stats::getdata);
+    FETCH_BEGIN_ALLOW_THREADS(cur)
+    ret = ODBC_CALL(cur->cnxn, SQLGetData)(cur->hstmt, (SQLUSMALLINT)(iCol+1), SQL_C_DOUBLE, &value, sizeof(value), &cbFetched);
+    FETCH_END_ALLOW_THREADS(cur)
+    timer.Stop();
+    CountBytes(cur, cbFetched);
     if (!SQL_SUCCEEDED(ret))
         return RaiseErrorFromHandle("SQLGetData", cur->cnxn->hdbc, cur->hstmt);
 
@@ -533,21 +658,58 @@ static PyObject*
 GetSqlServerTime(Cursor* cur, Py_ssize_t iCol)
 {
     SQL_SS_TIME2_STRUCT value;
+    memset(&value, 0, sizeof(value));   // the padding is part of the intern key
 
     SQLLEN cbFetched = 0;
     SQLRETURN ret;
 
-    Py_BEGIN_ALLOW_THREADS
-    ret = SQLGetData(cur->hstmt, (SQLUSMALLINT)(iCol+1), SQL_C_BINARY, &value, sizeof(value), &cbFetched);
-    Py_END_ALLOW_THREADS
+    StatsTimer timer(cur, &Stats::getdata);
+    FETCH_BEGIN_ALLOW_THREADS(cur)
+    ret = ODBC_CALL(cur->cnxn, SQLGetData)(cur->hstmt, (SQLUSMALLINT)(iCol+1), SQL_C_BINARY, &value, sizeof(value), &cbFetched);
+    FETCH_END_ALLOW_THREADS(cur)
+    timer.Stop();
+    CountBytes(cur, cbFetched);
     if (!SQL_SUCCEEDED(ret))
         return RaiseErrorFromHandle("SQLGetData", cur->cnxn->hdbc, cur->hstmt);
 
     if (cbFetched == SQL_NULL_DATA)
         Py_RETURN_NONE;
 
+    InternTable* table = Intern_GetTable(cur, iCol, SQL_C_BINARY);
+    long hash = 0;
+    if (table)
+    {
+        PyObject* result = Intern_Find(cur, table, (const char*)&value, sizeof(value), hash);
+        if (result)
+            return result;
+    }
+
+    int micros = (int)(value.fraction / 1000); // nanos --> micros
+    PyObject* result = PyTime_FromTime(value.hour, value.minute, value.second, micros);
+
+    if (table && result)
+        Intern_Add(table, (const char*)&value, sizeof(value), hash, result);
+
+    return result;
+}
+
+PyObject*
+TemporalFromStruct(SQLSMALLINT sql_type, const TIMESTAMP_STRUCT& value)
+{
+    switch (sql_type)
+    {
+    case SQL_TYPE_TIME:
+    {
+        int micros = (int)(value.fraction / 1000); // nanos --> micros
+        return PyTime_FromTime(value.hour, value.minute, value.second, micros);
+    }
+
+    case SQL_TYPE_DATE:
+        return PyDate_FromDate(value.year, value.month, value.day);
+    }
+
     int micros = (int)(value.fraction / 1000); // nanos --> micros
-    return PyTime_FromTime(value.hour, value.minute, value.second, micros);
+    return PyDateTime_FromDateAndTime(value.year, value.month, value.day, value.hour, value.minute, value.second, micros);
 }
 
 static PyObject*
@@ -558,29 +720,55 @@ GetDataTimestamp(Cursor* cur, Py_ssize_t iCol)
     SQLLEN cbFetched = 0;
     SQLRETURN ret;
 
-    Py_BEGIN_ALLOW_THREADS
-    ret = SQLGetData(cur->hstmt, (SQLUSMALLINT)(iCol+1), SQL_C_TYPE_TIMESTAMP, &value, sizeof(value), &cbFetched);
-    Py_END_ALLOW_THREADS
+    StatsTimer timer(cur, &Stats::getdata);
+    FETCH_BEGIN_ALLOW_THREADS(cur)
+    ret = ODBC_CALL(cur->cnxn, SQLGetData)(cur->hstmt, (SQLUSMALLINT)(iCol+1), SQL_C_TYPE_TIMESTAMP, &value, sizeof(value), &cbFetched);
+    FETCH_END_ALLOW_THREADS(cur)
+    timer.Stop();
+    CountBytes(cur, cbFetched);
     if (!SQL_SUCCEEDED(ret))
         return RaiseErrorFromHandle("SQLGetData", cur->cnxn->hdbc, cur->hstmt);
 
     if (cbFetched == SQL_NULL_DATA)
         Py_RETURN_NONE;
 
-    switch (cur->colinfos[iCol].sql_type)
+    SQLSMALLINT sql_type = cur->colinfos[iCol].sql_type;
+
+    InternTable* table = Intern_GetTable(cur, iCol, SQL_C_TYPE_TIMESTAMP);
+    if (table == 0)
+        return TemporalFromStruct(sql_type, value);
+
+    // The intern key is only the fields the Python object uses, so whatever a driver puts in the time of a date or the
+    // date of a time does not prevent a match.  The fields are SQLSMALLINTs followed by the fraction, without padding.
+
+    const char* pb;
+    size_t cb;
+    switch (sql_type)
     {
+    case SQL_TYPE_DATE:
+        pb = (const char*)&value.year;
+        cb = (size_t)((const char*)&value.hour - pb);
+        break;
     case SQL_TYPE_TIME:
-    {
-        int micros = (int)(value.fraction / 1000); // nanos --> micros
-        return PyTime_FromTime(value.hour, value.minute, value.second, micros);
+        pb = (const char*)&value.hour;
+        cb = (size_t)((const char*)(&value + 1) - pb);
+        break;
+    default:
+        pb = (const char*)&value;
+        cb = sizeof(value);
+        break;
     }
 
-    case SQL_TYPE_DATE:
-        return PyDate_FromDate(value.year, value.month, value.day);
-    }
+    long hash = 0;
+    PyObject* result = Intern_Find(cur, table, pb, (Py_ssize_t)cb, hash);
+    if (result)
+        return result;
 
-    int micros = (int)(value.fraction / 1000); // nanos --> micros
-    return PyDateTime_FromDateAndTime(value.year, value.month, value.day, value.hour, value.minute, value.second, micros);
+    result = TemporalFromStruct(sql_type, value);
+    if (result)
+        Intern_Add(table, pb, (Py_ssize_t)cb, hash, result);
+
+    return result;
 }
 
 int GetUserConvIndex(Cursor* cur, SQLSMALLINT sql_type)
@@ -665,3 +853,368 @@ GetData(Cursor* cur, Py_ssize_t iCol)
     return RaiseErrorV("HY106", ProgrammingError, "ODBC SQL type %d is not yet supported.  column-index=%zd  type=%d",
                        (int)pinfo->sql_type, iCol, (int)pinfo->sql_type);
 }
+
+
+//
+// Lazy rows
+//
+
+class RawWriter
+{
+    // Appends a row's data to the cursor's current RawBlock, cur->raw_block.  If the row does not fit, what has been
+    // written so far is moved to a new block, so pointers into the row are only valid until the next Reserve.
+
+    Cursor* cur;
+    size_t start;               // the offset of the row in the block
+    size_t pos;                 // the offset of the end of the data written
+
+public:
+    RawWriter(Cursor* _cur)
+    {
+        cur   = _cur;
+        start = cur->raw_block ? ((cur->raw_block->used + 7) & ~(size_t)7) : 0;
+        pos   = start;
+    }
+
+    char* Reserve(size_t cb, size_t cbKeep = 0)
+    {
+        // Returns a pointer to at least `cb` bytes at the end of the row's data, or zero if memory could not be
+        // allocated.  The first `cbKeep` of them have already been written and are kept if the row is moved.
+
+        RawBlock* block = cur->raw_block;
+        if (block && pos + cb <= block->size)
+            return block->data + pos;
+
+        size_t written = pos - start;
+        size_t size    = written + cb;
+        if (size < RAW_BLOCK_SIZE)
+            size = RAW_BLOCK_SIZE;
+
+        RawBlock* newblock = RawBlock_New(size);
+        if (newblock == 0)
+            return 0;
+
+        if (block)
+        {
+            memcpy(newblock->data, block->data + start, written + cbKeep);
+            RawBlock_Release(block);
+        }
+
+        cur->raw_block = newblock;
+        start = 0;
+        pos   = written;
+        return newblock->data + pos;
+    }
+
+    Py_ssize_t Append(size_t cb)
+    {
+        // Adds `cb` bytes, which have been written at the pointer returned by Reserve, to the row.  Returns their
+        // offset from the start of the row.  The next data starts 8-byte aligned.
+
+        Py_ssize_t offset = (Py_ssize_t)(pos - start);
+        pos += (cb + 7) & ~(size_t)7;
+        return offset;
+    }
+
+    char* Row()
+    {
+        return cur->raw_block->data + start;
+    }
+
+    void Finish()
+    {
+        // The row's data is complete; the next row starts after it.
+        cur->raw_block->used = pos;
+    }
+};
+
+static RawKind GetRawKind(Cursor* cur, Py_ssize_t iCol, SQLSMALLINT& ctype)
+{
+    // Returns how column iCol is kept in a lazy row and sets `ctype` to the C type it is read as.  Returns RAW_NONE if
+    // it must be converted during the fetch, which is when converting it needs more than the data: user-defined
+    // conversions, decimals (which use the current locale settings), and text in encodings other than UTF-8.  Columns
+    // GetData does not support are also converted during the fetch so the error is raised there.
+
+    ColumnInfo* pinfo = &cur->colinfos[iCol];
+
+    if (GetUserConvIndex(cur, pinfo->sql_type) != -1)
+        return RAW_NONE;
+
+    switch (pinfo->sql_type)
+    {
+    case SQL_CHAR:
+    case SQL_VARCHAR:
+    case SQL_LONGVARCHAR:
+    case SQL_GUID:
+    case SQL_SS_XML:
+        if (!cur->cnxn->unicode_results)
+        {
+            ctype = SQL_C_CHAR;
+            return RAW_STR;
+        }
+        if (!cur->cnxn->encoding)
+        {
+            ctype = SQL_C_WCHAR;
+            return RAW_WCHAR;
+        }
+        if (cur->cnxn->encoding_utf8)
+        {
+            ctype = SQL_C_CHAR;
+            return RAW_UTF8;
+        }
+        return RAW_NONE;
+
+    case SQL_WCHAR:
+    case SQL_WVARCHAR:
+    case SQL_WLONGVARCHAR:
+        ctype = SQL_C_WCHAR;
+        return RAW_WCHAR;
+
+    case SQL_BINARY:
+    case SQL_VARBINARY:
+    case SQL_LONGVARBINARY:
+        ctype = SQL_C_BINARY;
+        return RAW_BUFFER;
+
+    case SQL_BIT:
+        ctype = SQL_C_BIT;
+        return RAW_BIT;
+
+    case SQL_TINYINT:
+    case SQL_SMALLINT:
+    case SQL_INTEGER:
+        ctype = pinfo->is_unsigned ? SQL_C_ULONG : SQL_C_LONG;
+        return pinfo->is_unsigned ? RAW_ULONG : RAW_LONG;
+
+    case SQL_BIGINT:
+        ctype = pinfo->is_unsigned ? SQL_C_UBIGINT : SQL_C_SBIGINT;
+        return pinfo->is_unsigned ? RAW_UBIGINT : RAW_BIGINT;
+
+    case SQL_REAL:
+    case SQL_FLOAT:
+    case SQL_DOUBLE:
+        ctype = SQL_C_DOUBLE;
+        return RAW_DOUBLE;
+
+    case SQL_TYPE_DATE:
+        ctype = SQL_C_TYPE_TIMESTAMP;
+        return RAW_DATE;
+
+    case SQL_TYPE_TIME:
+        ctype = SQL_C_TYPE_TIMESTAMP;
+        return RAW_TIME;
+
+    case SQL_TYPE_TIMESTAMP:
+        ctype = SQL_C_TYPE_TIMESTAMP;
+        return RAW_DATETIME;
+
+    case SQL_SS_TIME2:
+        ctype = SQL_C_BINARY;
+        return RAW_SS_TIME;
+    }
+
+    return RAW_NONE;
+}
+
+static bool GetRawFixed(Cursor* cur, Py_ssize_t iCol, SQLSMALLINT ctype, size_t cb, RawWriter& writer, Py_ssize_t& offset,
+                        bool& isnull)
+{
+    // Reads a fixed length value of `cb` bytes into the row.
+
+    char* pb = writer.Reserve(cb);
+    if (pb == 0)
+    {
+        PyErr_NoMemory();
+        return false;
+    }
+    memset(pb, 0, cb);
+
+    SQLLEN cbFetched = 0;
+    SQLRETURN ret;
+
+    StatsTimer timer(cur, &Stats::getdata);
+    FETCH_BEGIN_ALLOW_THREADS(cur)
+    ret = ODBC_CALL(cur->cnxn, SQLGetData)(cur->hstmt, (SQLUSMALLINT)(iCol+1), ctype, pb, (SQLLEN)cb, &cbFetched);
+    FETCH_END_ALLOW_THREADS(cur)
+    timer.Stop();
+    CountBytes(cur, cbFetched);
+
+    if (!SQL_SUCCEEDED(ret))
+    {
+        RaiseErrorFromHandle("SQLGetData", cur->cnxn->hdbc, cur->hstmt);
+        return false;
+    }
+
+    isnull = (cbFetched == SQL_NULL_DATA);
+    if (!isnull)
+        offset = writer.Append(cb);
+    return true;
+}
+
+static bool GetRawString(Cursor* cur, Py_ssize_t iCol, SQLSMALLINT ctype, RawWriter& writer, Py_ssize_t& offset,
+                         Py_ssize_t& length, bool& isnull)
+{
+    // Reads variable length data into the row.  Like GetDataString, but the data is read directly into the row, which
+    // is enlarged as needed, and nothing is converted.
+
+    ColumnInfo* pinfo = &cur->colinfos[iCol];
+
+    size_t null_size = (ctype == SQL_C_BINARY) ? 0 : (ctype == SQL_C_WCHAR) ? sizeof(SQLWCHAR) : 1;
+    size_t element   = (ctype == SQL_C_WCHAR) ? sizeof(SQLWCHAR) : 1;
+
+    // Start with room for the whole value if the column is not too wide.
+    size_t cbChunk = 1024;
+    if (pinfo->column_size != (SQLULEN)SQL_NO_TOTAL && pinfo->column_size > 0 && pinfo->column_size < (SQLULEN)4096)
+        cbChunk = (size_t)pinfo->column_size * element + null_size;
+
+    size_t cbTotal = 0;
+
+    for (;;)
+    {
+        char* pb = writer.Reserve(cbTotal + cbChunk, cbTotal);
+        if (pb == 0)
+        {
+            PyErr_NoMemory();
+            return false;
+        }
+
+        SQLLEN cbData = 0;
+        SQLRETURN ret;
+
+        StatsTimer timer(cur, &Stats::getdata);
+        FETCH_BEGIN_ALLOW_THREADS(cur)
+        ret = ODBC_CALL(cur->cnxn, SQLGetData)(cur->hstmt, (SQLUSMALLINT)(iCol+1), ctype, pb + cbTotal, (SQLLEN)cbChunk, &cbData);
+        FETCH_END_ALLOW_THREADS(cur)
+        timer.Stop();
+
+        if (cbData == SQL_NULL_DATA)
+        {
+            isnull = true;
+            return true;
+        }
+
+        if (ret == SQL_NO_DATA)
+            break;
+
+        if (!SQL_SUCCEEDED(ret))
+        {
+            RaiseErrorFromHandle("SQLGetData", cur->cnxn->hdbc, cur->hstmt);
+            return false;
+        }
+
+        if (ret == SQL_SUCCESS)
+        {
+            cbTotal += (size_t)cbData;
+            CountBytes(cur, cbData);
+            break;
+        }
+
+        // SQL_SUCCESS_WITH_INFO: the chunk was filled, less the NULL terminator, and cbData is the length remaining
+        // before this read (see GetDataString).
+
+        size_t cbRead = cbChunk - null_size;
+        if (cbData != SQL_NO_TOTAL && (size_t)cbData < cbChunk)
+            cbRead = (size_t)cbData - null_size;
+
+        cbTotal += cbRead;
+        CountBytes(cur, (SQLLEN)cbRead);
+
+        if (cbData == SQL_NO_TOTAL)
+            cbChunk = cbChunk * 2;
+        else if ((size_t)cbData > cbRead)
+            cbChunk = (size_t)cbData - cbRead + null_size;
+        else
+            cbChunk = null_size + 1;
+    }
+
+    isnull = false;
+    length = (Py_ssize_t)cbTotal;
+    offset = writer.Append(cbTotal);
+    return true;
+}
+
+const char* GetRawRow(Cursor* cur, Py_ssize_t cCols, PyObject** apValues)
+{
+    RawWriter writer(cur);
+
+    // The RawColumn array is first.  Since the row may move to a new block, it is always accessed through writer.Row().
+    size_t cbHeader = sizeof(RawColumn) * (size_t)cCols;
+    if (writer.Reserve(cbHeader) == 0)
+    {
+        pyodbc_free(apValues);
+        PyErr_NoMemory();
+        return 0;
+    }
+    writer.Append(cbHeader);
+
+    for (Py_ssize_t i = 0; i < cCols; i++)
+    {
+        SQLSMALLINT ctype = 0;
+        RawKind kind = GetRawKind(cur, i, ctype);
+
+        Py_ssize_t offset = 0;
+        Py_ssize_t length = 0;
+        bool isnull = false;
+        bool ok = true;
+
+        switch (kind)
+        {
+        case RAW_NONE:
+            break;
+
+        case RAW_STR:
+        case RAW_UTF8:
+        case RAW_WCHAR:
+        case RAW_BUFFER:
+            ok = GetRawString(cur, i, ctype, writer, offset, length, isnull);
+            break;
+
+        default:
+        {
+            size_t cb;
+            switch (kind)
+            {
+            case RAW_BIT:     cb = sizeof(SQLCHAR);             break;
+            case RAW_LONG:
+            case RAW_ULONG:   cb = sizeof(long);                break;
+            case RAW_BIGINT:
+            case RAW_UBIGINT: cb = sizeof(SQLBIGINT);           break;
+            case RAW_DOUBLE:  cb = sizeof(double);              break;
+            case RAW_SS_TIME: cb = sizeof(SQL_SS_TIME2_STRUCT); break;
+            default:          cb = sizeof(TIMESTAMP_STRUCT);    break;
+            }
+            ok = GetRawFixed(cur, i, ctype, cb, writer, offset, isnull);
+            length = (Py_ssize_t)cb;
+            break;
+        }
+        }
+
+        PyObject* value = 0;
+        if (ok && kind == RAW_NONE)
+        {
+            value = GetData(cur, i);
+            ok = (value != 0);
+        }
+        else if (ok && isnull)
+        {
+            value = Py_None;
+            Py_INCREF(value);
+            kind = RAW_NONE;
+        }
+
+        if (!ok)
+        {
+            FreeRowValues(i, apValues);
+            return 0;
+        }
+
+        RawColumn& col = ((RawColumn*)writer.Row())[i];
+        col.kind   = kind;
+        col.offset = offset;
+        col.length = length;
+        apValues[i] = value;
+    }
+
+    writer.Finish();
+    return writer.Row();
+}
@@ -6,6 +6,15 @@ void GetData_init();
 
 PyObject* GetData(Cursor* cur, Py_ssize_t iCol);
 
+// Reads the current row's columns for a lazy row (see rawrow.h).  Columns that can be converted later are copied into
+// the cursor's raw_block and their entries in apValues are set to zero; the rest are converted now, as GetData would.
+// Returns the start of the row's data in cur->raw_block.  Otherwise returns zero with an exception set, after freeing
+// apValues and any values in it.
+const char* GetRawRow(Cursor* cur, Py_ssize_t cCols, PyObject** apValues);
+
+// Returns the date, time, or datetime for a column of type `sql_type` read as a TIMESTAMP_STRUCT.
+PyObject* TemporalFromStruct(SQLSMALLINT sql_type, const TIMESTAMP_STRUCT& value);
+
 /**
  * If this sql type has a user-defined conversion, the index into the connection's `conv_funcs` array is returned.
  * Otherwise -1 is returned.
@@ -0,0 +1,197 @@
+
+#include "pyodbc.h"
+#include "cursor.h"
+#include "connection.h"
+#include "intern.h"
+
+// Each table is an open addressing hash table with at least twice as many slots as its limit, so it is never more than
+// half full and a probe always ends at an empty slot.  Entries are never removed; a full table just stops adding.
+
+struct InternEntry
+{
+    long hash;
+    PyObject* key;              // a PyString of the bytes read, which is `value` itself for SQL_C_CHAR columns
+    PyObject* value;
+};
+
+struct InternTable
+{
+    SQLSMALLINT ctype;          // the C type the column is read as, or zero before the first lookup
+    bool disabled;              // true if the column's values are not interned
+    int limit;                  // the connection's intern_limit when the table was created
+    int count;
+    int mask;                   // the number of slots minus one
+    InternEntry* entries;       // allocated when the first value is added
+
+    UINT64 hits;
+    UINT64 misses;
+};
+
+static long Hash(const char* pb, Py_ssize_t cb)
+{
+    // Mixes in 8 bytes at a time, which is much cheaper than creating a string to use Python's hash.
+
+    const UINT64 k = 0x9E3779B97F4A7C15ULL;
+    UINT64 h = (UINT64)cb * k;
+
+    for (; cb >= 8; pb += 8, cb -= 8)
+    {
+        UINT64 w;
+        memcpy(&w, pb, 8);
+        h = (h ^ w) * k;
+        h ^= h >> 32;
+    }
+
+    UINT64 w = 0;
+    memcpy(&w, pb, (size_t)cb);
+    h = (h ^ w) * k;
+    h ^= h >> 32;
+
+    return (long)h;
+}
+
+static void FreeEntries(InternTable* table)
+{
+    if (!table->entries)
+        return;
+
+    for (int i = 0; i <= table->mask; i++)
+    {
+        if (table->entries[i].key)
+        {
+            Py_DECREF(table->entries[i].key);
+            Py_DECREF(table->entries[i].value);
+        }
+    }
+
+    pyodbc_free(table->entries);
+    table->entries = 0;
+    table->count   = 0;
+}
+
+InternTable* Intern_GetTable(Cursor* cur, Py_ssize_t iCol, SQLSMALLINT ctype)
+{
+    if (cur->interns == 0)
+    {
+        if (cur->cnxn->intern_limit == 0)
+            return 0;
+
+        Py_ssize_t cCols = PyTuple_GET_SIZE(cur->description);
+        cur->interns = (InternTable*)pyodbc_malloc(sizeof(InternTable) * cCols);
+        if (cur->interns == 0)
+            return 0;
+        memset(cur->interns, 0, sizeof(InternTable) * cCols);
+        cur->intern_count = cCols;
+    }
+
+    I(iCol < cur->intern_count);
+    InternTable* table = &cur->interns[iCol];
+
+    if (table->ctype == 0)
+    {
+        table->ctype = ctype;
+        table->limit = cur->cnxn->intern_limit;
+        table->disabled = (table->limit == 0);
+    }
+
+    // The C type only changes if the connection's encoding is changed while the results are being read.
+    if (table->disabled || table->ctype != ctype)
+        return 0;
+
+    return table;
+}
+
+PyObject* Intern_Find(Cursor* cur, InternTable* table, const char* pb, Py_ssize_t cb, long& hash)
+{
+    hash = Hash(pb, cb);
+
+    if (table->entries)
+    {
+        for (int i = (int)(hash & table->mask); table->entries[i].key; i = (i + 1) & table->mask)
+        {
+            InternEntry& entry = table->entries[i];
+            if (entry.hash == hash && PyString_GET_SIZE(entry.key) == cb &&
+                memcmp(PyString_AS_STRING(entry.key), pb, (size_t)cb) == 0)
+            {
+                table->hits++;
+                Stats_Count(cur, &Stats::intern_hits, 1);
+                Py_INCREF(entry.value);
+                return entry.value;
+            }
+        }
+    }
+
+    table->misses++;
+    Stats_Count(cur, &Stats::intern_misses, 1);
+
+    // Once the table is full it can only hit values already in it.  If those are less than a third of the lookups, the
+    // column is mostly unique values and the table is not worth keeping.
+    if (table->count == table->limit && table->misses > table->hits * 2)
+    {
+        FreeEntries(table);
+        table->disabled = true;
+    }
+
+    return 0;
+}
+
+void Intern_Add(InternTable* table, const char* pb, Py_ssize_t cb, long hash, PyObject* value)
+{
+    if (table->disabled || table->count >= table->limit)
+        return;
+
+    if (table->entries == 0)
+    {
+        int slots = 16;
+        while (slots < table->limit * 2)
+            slots *= 2;
+
+        table->entries = (InternEntry*)pyodbc_malloc(sizeof(InternEntry) * slots);
+        if (table->entries == 0)
+        {
+            table->disabled = true;
+            return;
+        }
+        memset(table->entries, 0, sizeof(InternEntry) * slots);
+        table->mask = slots - 1;
+    }
+
+    PyObject* key;
+    if (table->ctype == SQL_C_CHAR && PyString_CheckExact(value))
+    {
+        key = value;
+        Py_INCREF(key);
+    }
+    else
+    {
+        key = PyString_FromStringAndSize(pb, cb);
+        if (key == 0)
+        {
+            PyErr_Clear();
+            return;
+        }
+    }
+
+    int i = (int)(hash & table->mask);
+    while (table->entries[i].key)
+        i = (i + 1) & table->mask;
+
+    table->entries[i].hash  = hash;
+    table->entries[i].key   = key;
+    table->entries[i].value = value;
+    Py_INCREF(value);
+    table->count++;
+}
+
+void Intern_Free(Cursor* cur)
+{
+    if (cur->interns == 0)
+        return;
+
+    for (Py_ssize_t i = 0; i < cur->intern_count; i++)
+        FreeEntries(&cur->interns[i]);
+
+    pyodbc_free(cur->interns);
+    cur->interns      = 0;
+    cur->intern_count = 0;
+}
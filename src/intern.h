@@ -0,0 +1,35 @@
+
+#ifndef _INTERN_H_
+#define _INTERN_H_
+
+// Interning of repeated column values.  When a connection's intern_limit is non-zero, each character, date, time, and
+// datetime column of a result set gets a table of up to intern_limit distinct values, keyed by the bytes read from the
+// driver (the text, or the fields of the TIMESTAMP_STRUCT that are used), and a value read again returns the same
+// object instead of a new one.  Low-cardinality columns (status codes, country codes, dates in a fact table, and the
+// like) then cost one object per distinct value instead of one per row.  A column whose table fills up while mostly
+// missing stops being looked up, so unique values only pay for the lookups until then.
+
+struct Cursor;
+struct InternTable;
+
+// The longest character value, in bytes as read from the driver, that is interned.
+#define INTERN_MAX_BYTES 128
+
+// The largest allowed intern_limit.
+#define MAX_INTERN_LIMIT 65536
+
+// Returns the table for column iCol, read as `ctype`, or zero if its values are not interned.  The tables are created
+// on first use.  An exception is never set.
+InternTable* Intern_GetTable(Cursor* cur, Py_ssize_t iCol, SQLSMALLINT ctype);
+
+// Returns a new reference to the value interned for the `cb` bytes at `pb`, or zero if there is none, and sets `hash`
+// for Intern_Add.  Counts the hit or miss in the cursor's stats.  An exception is never set.
+PyObject* Intern_Find(Cursor* cur, InternTable* table, const char* pb, Py_ssize_t cb, long& hash);
+
+// Adds `value`, which was created from the `cb` bytes at `pb`, unless the table is full.  An exception is never set.
+void Intern_Add(InternTable* table, const char* pb, Py_ssize_t cb, long hash, PyObject* value);
+
+// Frees the cursor's tables and the values in them.  Called whenever the cursor's results are freed.
+void Intern_Free(Cursor* cur);
+
+#endif // _INTERN_H_
@@ -0,0 +1,24 @@
+
+#ifndef _KERNELBENCH_H_
+#define _KERNELBENCH_H_
+
+// Entry points used by the native microbenchmarks in utils/kernelbench to call functions that are otherwise private
+// to their files.  They only exist when built with PYODBC_BENCH, which `python setup.py kernelbench` defines; the
+// module itself never includes them.
+
+#ifdef PYODBC_BENCH
+
+struct ParamInfo;
+
+// params.cpp: call CreateDecimalString and GetDecimalInfo.  The caller frees the string returned by the first and the
+// ParameterValuePtr allocated by the second with pyodbc_free.
+char* Bench_CreateDecimalString(long sign, PyObject* digits, long exp);
+bool Bench_GetDecimalInfo(PyObject* param, ParamInfo& info);
+
+// getdata.cpp: reads `cb` bytes of `data` through a DataBuffer the way GetDataString does when the value does not fit
+// in its stack buffer, and returns the detached value.
+PyObject* Bench_DataBuffer(SQLSMALLINT dataType, const char* data, Py_ssize_t cb);
+
+#endif // PYODBC_BENCH
+
+#endif // _KERNELBENCH_H_
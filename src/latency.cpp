@@ -0,0 +1,244 @@
+
+#include "pyodbc.h"
+#include "latency.h"
+#include "querylog.h"
+#include "cursor.h"
+#include "threads.h"
+#include "wrapper.h"
+
+#define LATENCY_BUCKETS 256
+
+// The most statements tracked.  Statements first seen after this are not recorded until the histograms are reset.
+#define MAX_FINGERPRINTS 1024
+
+// The number of slots in the hash table.  It is a power of two and kept at most half full so probes are short.
+#define TABLE_SIZE (MAX_FINGERPRINTS * 2)
+
+struct Histogram
+{
+    UINT64 count;
+    UINT64 sum;                 // nanoseconds
+    UINT64 max;
+    unsigned int buckets[LATENCY_BUCKETS];
+};
+
+struct LatencyEntry
+{
+    UINT64 fingerprint;
+    PyObject* sql;              // the first statement seen with this fingerprint
+    Histogram execute;
+    Histogram fetch;
+};
+
+bool latency_enabled = false;
+
+// An open addressed hash table of entries keyed by fingerprint, allocated when the first statement is recorded.  Like
+// the rest of the histograms, it is only used by threads holding the GIL.
+static LatencyEntry** table = 0;
+static int entry_count = 0;
+
+static LatencyEntry* FindEntry(UINT64 fingerprint, bool create)
+{
+    if (!table)
+    {
+        if (!create)
+            return 0;
+        table = (LatencyEntry**)pyodbc_malloc(sizeof(LatencyEntry*) * TABLE_SIZE);
+        if (!table)
+            return 0;
+        memset(table, 0, sizeof(LatencyEntry*) * TABLE_SIZE);
+    }
+
+    size_t i = (size_t)(fingerprint & (TABLE_SIZE - 1));
+    while (table[i])
+    {
+        if (table[i]->fingerprint == fingerprint)
+            return table[i];
+        i = (i + 1) & (TABLE_SIZE - 1);
+    }
+
+    if (!create || entry_count == MAX_FINGERPRINTS)
+        return 0;
+
+    LatencyEntry* entry = (LatencyEntry*)pyodbc_malloc(sizeof(LatencyEntry));
+    if (!entry)
+        return 0;
+    memset(entry, 0, sizeof(LatencyEntry));
+    entry->fingerprint = fingerprint;
+
+    table[i] = entry;
+    entry_count++;
+    return entry;
+}
+
+static int BucketIndex(UINT64 ns)
+{
+    // Values 0-3 have their own buckets.  Larger values use the position of the highest bit and the two bits below it.
+    if (ns < 4)
+        return (int)ns;
+
+    int msb = 0;
+    for (UINT64 v = ns; v > 1; v >>= 1)
+        msb++;
+
+    return msb * 4 + (int)((ns >> (msb - 2)) & 3);
+}
+
+static UINT64 BucketUpperBound(int index)
+{
+    if (index < 4)
+        return (UINT64)index;
+
+    int msb = index / 4;
+    int sub = index % 4;
+    return ((UINT64)(4 + sub + 1) << (msb - 2)) - 1;
+}
+
+static void AddToHistogram(Histogram& h, UINT64 ns)
+{
+    h.count++;
+    h.sum += ns;
+    if (ns > h.max)
+        h.max = ns;
+    h.buckets[BucketIndex(ns)]++;
+}
+
+void Latency_RecordExecute(Cursor* cur, PyObject* pSql, UINT64 duration)
+{
+    UINT64 fingerprint = SqlFingerprint(pSql);
+
+    LatencyEntry* entry = FindEntry(fingerprint, true);
+    if (!entry)
+        return;
+
+    if (!entry->sql)
+    {
+        Py_INCREF(pSql);
+        entry->sql = pSql;
+    }
+
+    AddToHistogram(entry->execute, duration);
+
+    // Results served from the result cache are not timed since they never reach the driver.
+    if (cur->description != Py_None && !cur->preloaded)
+    {
+        cur->fetch_fingerprint = fingerprint;
+        cur->fetch_start       = MonotonicNanoseconds();
+    }
+}
+
+void Latency_RecordFetch(Cursor* cur)
+{
+    UINT64 start = cur->fetch_start;
+    cur->fetch_start = 0;
+
+    if (start == 0)
+        return;
+
+    // The entry will be gone if the histograms were reset during the fetch.
+    LatencyEntry* entry = FindEntry(cur->fetch_fingerprint, false);
+    if (entry)
+        AddToHistogram(entry->fetch, MonotonicNanoseconds() - start);
+}
+
+void Latency_Reset()
+{
+    if (!table)
+        return;
+
+    for (int i = 0; i < TABLE_SIZE; i++)
+    {
+        if (table[i])
+        {
+            Py_XDECREF(table[i]->sql);
+            pyodbc_free(table[i]);
+        }
+    }
+
+    pyodbc_free(table);
+    table = 0;
+    entry_count = 0;
+}
+
+static double Seconds(UINT64 ns)
+{
+    return (double)ns / 1000000000.0;
+}
+
+static UINT64 Percentile(const Histogram& h, double q)
+{
+    // Returns the upper bound of the bucket holding the q'th value, which overstates it by less than 25%.
+
+    UINT64 target = (UINT64)(q * (double)h.count);
+    if (target < h.count)
+        target++;
+
+    UINT64 seen = 0;
+    for (int i = 0; i < LATENCY_BUCKETS; i++)
+    {
+        seen += h.buckets[i];
+        if (seen >= target)
+        {
+            UINT64 bound = BucketUpperBound(i);
+            return bound < h.max ? bound : h.max;
+        }
+    }
+
+    return h.max;
+}
+
+static PyObject* HistogramToDict(const Histogram& h)
+{
+    Object buckets(PyList_New(0));
+    if (!buckets)
+        return 0;
+
+    for (int i = 0; i < LATENCY_BUCKETS; i++)
+    {
+        if (h.buckets[i] == 0)
+            continue;
+
+        Object item(Py_BuildValue("(dI)", Seconds(BucketUpperBound(i)), h.buckets[i]));
+        if (!item || PyList_Append(buckets, item) != 0)
+            return 0;
+    }
+
+    return Py_BuildValue("{sKsdsdsdsdsdsdsO}",
+                         "count",   h.count,
+                         "sum",     Seconds(h.sum),
+                         "max",     Seconds(h.max),
+                         "p50",     Seconds(Percentile(h, 0.50)),
+                         "p90",     Seconds(Percentile(h, 0.90)),
+                         "p99",     Seconds(Percentile(h, 0.99)),
+                         "p999",    Seconds(Percentile(h, 0.999)),
+                         "buckets", buckets.Get());
+}
+
+PyObject* Latency_ToDict()
+{
+    Object result(PyDict_New());
+    if (!result)
+        return 0;
+
+    if (!table)
+        return result.Detach();
+
+    for (int i = 0; i < TABLE_SIZE; i++)
+    {
+        LatencyEntry* entry = table[i];
+        if (!entry)
+            continue;
+
+        Object execute(HistogramToDict(entry->execute));
+        Object fetch(HistogramToDict(entry->fetch));
+        if (!execute || !fetch)
+            return 0;
+
+        Object item(Py_BuildValue("{sOsOsO}", "sql", entry->sql, "execute", execute.Get(), "fetch", fetch.Get()));
+        Object key(PyLong_FromUnsignedLongLong(entry->fingerprint));
+        if (!item || !key || PyDict_SetItem(result, key, item) != 0)
+            return 0;
+    }
+
+    return result.Detach();
+}
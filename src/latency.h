@@ -0,0 +1,30 @@
+
+#ifndef _LATENCY_H_
+#define _LATENCY_H_
+
+// Latency histograms kept per SQL fingerprint (see SqlFingerprint), so percentiles can be reported without timing
+// Python wrappers around every execute.  Each statement has two histograms: the time to execute, and for statements
+// that return rows, the time from the end of the execute until the last row has been fetched.
+//
+// Durations are counted in log-scaled buckets with 4 sub-buckets per power of two, so each bucket is within 25% of
+// the values counted in it.
+
+struct Cursor;
+
+// True if histograms are being collected, turned on by pyodbc.enable_latency_histograms.
+extern bool latency_enabled;
+
+// Records a successful execute of `pSql` that took `duration` nanoseconds.  If the statement returned a result set,
+// the cursor starts timing the fetch.
+void Latency_RecordExecute(Cursor* cur, PyObject* pSql, UINT64 duration);
+
+// Called when a cursor has fetched its last row.
+void Latency_RecordFetch(Cursor* cur);
+
+// Returns a dictionary mapping each fingerprint to a dictionary with the SQL and the two histograms.
+PyObject* Latency_ToDict();
+
+// Discards all of the histograms.
+void Latency_Reset();
+
+#endif // _LATENCY_H_
@@ -0,0 +1,265 @@
+
+#include "pyodbc.h"
+#include "pyodbcmodule.h"
+#include "connection.h"
+#include "cursor.h"
+#include "row.h"
+#include "errors.h"
+#include "wrapper.h"
+#include "threads.h"
+#include "parallel.h"
+
+// execute_parallel runs a list of independent statements over a set of connections.  One native thread is started for
+// each connection (but no more than there are jobs).  Each thread creates a cursor on its connection, then repeatedly
+// takes the next job, executes it, and fetches all of its rows.  The threads use the normal cursor code, so the GIL is
+// released during every ODBC call and only held while building Python objects.  The calling thread waits without the
+// GIL until every thread has exited.
+//
+// Results are stored by job index, so they are returned in job order no matter which connection ran them.
+
+struct ParallelState
+{
+    Mutex     lock;
+    Condition exited;           // broadcast when a thread exits
+    int       running;          // protected by `lock`
+
+    // The remaining fields are only used while holding the GIL.
+
+    PyObject*  connections;     // tuple of Connection objects
+    PyObject*  jobs;            // tuple of (sql, params) tuples; params is None if there are none
+    PyObject*  results;         // list with one item per job
+    Py_ssize_t next_cnxn;       // index of the connection for the next thread to start
+    Py_ssize_t next_job;        // index of the next job to run
+
+    // The first error.  Once set, the threads stop taking new jobs.
+    PyObject* exc_type;
+    PyObject* exc_value;
+    PyObject* exc_tb;
+
+    UINT64 busy;                // the summed run time of every job, in microseconds
+
+    ParallelState()
+        : exited(lock)
+    {
+        running     = 0;
+        connections = 0;
+        jobs        = 0;
+        results     = 0;
+        next_cnxn   = 0;
+        next_job    = 0;
+        exc_type    = 0;
+        exc_value   = 0;
+        exc_tb      = 0;
+        busy        = 0;
+    }
+};
+
+
+static void Fail(ParallelState* state)
+{
+    // Records the current exception if it is the first.  Called with the GIL held.
+
+    if (state->exc_type == 0)
+        PyErr_Fetch(&state->exc_type, &state->exc_value, &state->exc_tb);
+    else
+        PyErr_Clear();
+}
+
+
+static PyObject* RunJob(Cursor* cursor, PyObject* pSql, PyObject* params)
+{
+    // Executes one job.  Returns a list of Rows if the statement created a result set, otherwise the row count.
+
+    PyObject* result = Cursor_ExecuteImpl(cursor, pSql, params == Py_None ? 0 : params, false);
+    if (!result)
+        return 0;
+    Py_DECREF(result);
+
+    if (cursor->colinfos == 0)
+        return PyInt_FromLong(cursor->rowcount);
+
+    return Cursor_fetchlist(cursor, -1);
+}
+
+
+static void ParallelThread(void* arg)
+{
+    ParallelState* state = (ParallelState*)arg;
+
+    PyGILState_STATE gil = PyGILState_Ensure();
+
+    Connection* cnxn = (Connection*)PyTuple_GET_ITEM(state->connections, state->next_cnxn++);
+
+    Cursor* cursor = Cursor_New(cnxn);
+    if (!cursor)
+    {
+        Fail(state);
+    }
+    else
+    {
+        Py_ssize_t cJobs = PyTuple_GET_SIZE(state->jobs);
+
+        while (state->exc_type == 0 && state->next_job < cJobs)
+        {
+            Py_ssize_t i = state->next_job++;
+            PyObject* job = PyTuple_GET_ITEM(state->jobs, i);
+
+            UINT64 start = MonotonicMicroseconds();
+            PyObject* result = RunJob(cursor, PyTuple_GET_ITEM(job, 0), PyTuple_GET_ITEM(job, 1));
+            state->busy += MonotonicMicroseconds() - start;
+
+            if (!result)
+            {
+                Fail(state);
+                break;
+            }
+
+            PyList_SetItem(state->results, i, result);
+        }
+
+        Py_DECREF(cursor);
+    }
+
+    // The caller cannot destroy the state until it gets the GIL back, so it is safe to use up to the release.
+    {
+        MutexLock locker(state->lock);
+        state->running--;
+        state->exited.Broadcast();
+    }
+
+    PyGILState_Release(gil);
+}
+
+
+static PyObject* NormalizeJobs(PyObject* jobs)
+{
+    // Converts the jobs into a tuple of (sql, params) tuples, validating them so the threads don't have to.
+
+    Object items(PySequence_Tuple(jobs));
+    if (!items)
+        return 0;
+
+    Py_ssize_t cJobs = PyTuple_GET_SIZE(items.Get());
+
+    Object normalized(PyTuple_New(cJobs));
+    if (!normalized)
+        return 0;
+
+    for (Py_ssize_t i = 0; i < cJobs; i++)
+    {
+        PyObject* job    = PyTuple_GET_ITEM(items.Get(), i);
+        PyObject* pSql   = job;
+        PyObject* params = Py_None;
+
+        if (PyTuple_Check(job) || PyList_Check(job))
+        {
+            Py_ssize_t c = PySequence_Size(job);
+            if (c < 1 || c > 2)
+                return RaiseErrorV(0, ProgrammingError, "Job %d must be a SQL string or a (sql, params) sequence.", (int)i);
+
+            pSql   = PySequence_Fast_GET_ITEM(job, 0);
+            params = c == 2 ? PySequence_Fast_GET_ITEM(job, 1) : Py_None;
+        }
+
+        if (!PyString_Check(pSql) && !PyUnicode_Check(pSql))
+            return RaiseErrorV(0, ProgrammingError, "Job %d must be a SQL string or a (sql, params) sequence.", (int)i);
+
+        if (params != Py_None && !PyTuple_Check(params) && !PyList_Check(params) && !Row_Check(params))
+            return RaiseErrorV(0, ProgrammingError, "The parameters for job %d must be in a list, tuple, or Row.", (int)i);
+
+        PyObject* t = Py_BuildValue("(OO)", pSql, params);
+        if (!t)
+            return 0;
+        PyTuple_SET_ITEM(normalized.Get(), i, t);
+    }
+
+    return normalized.Detach();
+}
+
+
+PyObject* ExecuteParallel(PyObject* connections, PyObject* jobs, bool timings)
+{
+    Object cnxns(PySequence_Tuple(connections));
+    if (!cnxns)
+        return 0;
+
+    Py_ssize_t cCnxns = PyTuple_GET_SIZE(cnxns.Get());
+    if (cCnxns == 0)
+        return RaiseErrorV(0, ProgrammingError, "execute_parallel requires at least one connection.");
+
+    for (Py_ssize_t i = 0; i < cCnxns; i++)
+    {
+        PyObject* p = PyTuple_GET_ITEM(cnxns.Get(), i);
+
+        if (!Connection_Check(p))
+            return RaiseErrorV(0, PyExc_TypeError, "execute_parallel requires a sequence of Connection objects.");
+
+        if (((Connection*)p)->hdbc == SQL_NULL_HANDLE)
+            return RaiseErrorV(0, ProgrammingError, "Attempt to use a closed connection.");
+
+        // Each thread owns its connection, so a connection cannot be listed twice.
+        for (Py_ssize_t j = 0; j < i; j++)
+            if (PyTuple_GET_ITEM(cnxns.Get(), j) == p)
+                return RaiseErrorV(0, ProgrammingError, "A connection was passed to execute_parallel more than once.");
+    }
+
+    Object normalized(NormalizeJobs(jobs));
+    if (!normalized)
+        return 0;
+
+    Py_ssize_t cJobs = PyTuple_GET_SIZE(normalized.Get());
+
+    Object results(PyList_New(cJobs));
+    if (!results)
+        return 0;
+    for (Py_ssize_t i = 0; i < cJobs; i++)
+    {
+        Py_INCREF(Py_None);
+        PyList_SET_ITEM(results.Get(), i, Py_None);
+    }
+
+    ParallelState state;
+    state.connections = cnxns.Get();
+    state.jobs        = normalized.Get();
+    state.results     = results.Get();
+
+    // The threads call PyGILState_Ensure, which requires the GIL to have been created.
+    PyEval_InitThreads();
+
+    int cThreads = (int)min(cCnxns, cJobs);
+
+    UINT64 start = MonotonicMicroseconds();
+
+    int started = 0;
+    for (int i = 0; i < cThreads; i++)
+    {
+        MutexLock locker(state.lock);
+        if (!StartThread(ParallelThread, &state))
+            break;
+        state.running++;
+        started++;
+    }
+
+    if (started == 0 && cJobs != 0)
+        return RaiseErrorV(0, PyExc_RuntimeError, "Unable to start a thread for execute_parallel");
+
+    Py_BEGIN_ALLOW_THREADS
+    state.lock.Lock();
+    while (state.running > 0)
+        state.exited.Wait();
+    state.lock.Unlock();
+    Py_END_ALLOW_THREADS
+
+    UINT64 wall = MonotonicMicroseconds() - start;
+
+    if (state.exc_type)
+    {
+        PyErr_Restore(state.exc_type, state.exc_value, state.exc_tb);
+        return 0;
+    }
+
+    if (!timings)
+        return results.Detach();
+
+    return Py_BuildValue("(Ndd)", results.Detach(), (double)wall / 1000000.0, (double)state.busy / 1000000.0);
+}
@@ -0,0 +1,10 @@
+
+#ifndef _PARALLEL_H_
+#define _PARALLEL_H_
+
+// Implements pyodbc.execute_parallel.  Runs each job in `jobs` (a SQL string or a (sql, params) sequence) on one of
+// the Connection objects in `connections` and returns a list with one result per job, in the order of the jobs.  If
+// `timings` is true, returns (results, wall_seconds, summed_seconds) instead.
+PyObject* ExecuteParallel(PyObject* connections, PyObject* jobs, bool timings);
+
+#endif // _PARALLEL_H_
@@ -9,6 +9,7 @@
 #include "errors.h"
 #include "dbspecific.h"
 #include "sqlwchar.h"
+#include "kernelbench.h"
 
 inline Connection* GetConnection(Cursor* cursor)
 {
@@ -17,7 +18,54 @@ inline Connection* GetConnection(Cursor* cursor)
 
 static bool GetParamType(Cursor* cur, Py_ssize_t iParam, SQLSMALLINT& type);
 
-static void FreeInfos(ParamInfo* a, Py_ssize_t count)
+// The largest the scratch buffer is enlarged to.  Parameters needing more than this on every execute allocate the
+// difference each time, but a cursor that once executed with a huge parameter doesn't hold on to that much memory.
+static const size_t MAX_SCRATCH = 256 * 1024;
+
+void* AllocScratch(Cursor* cur, size_t cb, bool& allocated)
+{
+    // Keep each allocation aligned for any value type.
+    cb = (cb + 7) & ~(size_t)7;
+
+    cur->scratch_needed += cb;
+
+    if (cur->scratch_used + cb <= cur->scratch_size)
+    {
+        void* p = cur->scratch + cur->scratch_used;
+        cur->scratch_used += cb;
+        allocated = false;
+        return p;
+    }
+
+    void* p = pyodbc_malloc(cb, MEM_SQLWCHAR);
+    if (p == 0)
+    {
+        PyErr_NoMemory();
+        return 0;
+    }
+    allocated = true;
+    return p;
+}
+
+static void ResetScratch(Cursor* cur)
+{
+    // Empties the scratch buffer, enlarging it if the last parameters didn't fit.  Failing to enlarge it is not an
+    // error since AllocScratch will allocate separately.
+
+    size_t needed = min(cur->scratch_needed, MAX_SCRATCH);
+    if (needed > cur->scratch_size)
+    {
+        // Nothing in it needs to be kept, so there is no need to realloc.
+        pyodbc_free(cur->scratch);
+        cur->scratch      = (char*)pyodbc_malloc(needed, MEM_SQLWCHAR);
+        cur->scratch_size = cur->scratch ? needed : 0;
+    }
+
+    cur->scratch_used   = 0;
+    cur->scratch_needed = 0;
+}
+
+static void FreeInfos(Cursor* cur, ParamInfo* a, Py_ssize_t count)
 {
     for (Py_ssize_t i = 0; i < count; i++)
     {
@@ -26,6 +74,8 @@ static void FreeInfos(ParamInfo* a, Py_ssize_t count)
         Py_XDECREF(a[i].pyParameterValue);
     }
     pyodbc_free(a);
+
+    ResetScratch(cur);
 }
 
 #define _MAKESTR(n) case n: return #n
@@ -155,13 +205,18 @@ static bool GetUnicodeInfo(Cursor* cur, Py_ssize_t index, PyObject* param, Param
 #if SQLWCHAR_SIZE == Py_UNICODE_SIZE
         info.ParameterValuePtr = pch;
 #else
-        // SQLWCHAR and Py_UNICODE are not the same size, so we need to allocate and copy a buffer.
+        // SQLWCHAR and Py_UNICODE are not the same size, so we need to convert into a buffer, which comes from the
+        // cursor's scratch buffer.  The length can change if there are surrogate pairs.
         if (len > 0)
         {
-            info.ParameterValuePtr = SQLWCHAR_FromUnicode(pch, len);
+            Py_ssize_t cch = SQLWCHAR_Length(pch, len);
+            info.ParameterValuePtr = AllocScratch(cur, sizeof(SQLWCHAR) * (cch + 1), info.allocated);
             if (info.ParameterValuePtr == 0)
                 return false;
-            info.allocated = true;
+            if (SQLWCHAR_Copy((SQLWCHAR*)info.ParameterValuePtr, pch, len) == -1)
+                return false;
+            len = cch;
+            info.ColumnSize = (SQLUINTEGER)len;
         }
         else
         {
@@ -176,6 +231,10 @@ static bool GetUnicodeInfo(Cursor* cur, Py_ssize_t index, PyObject* param, Param
     {
         // Too long to pass all at once, so we'll provide the data at execute.
 
+#if SQLWCHAR_SIZE != Py_UNICODE_SIZE
+        len = SQLWCHAR_Length(pch, len);
+        info.ColumnSize = (SQLUINTEGER)len;
+#endif
         info.ParameterType     = SQL_WLONGVARCHAR;
         info.StrLen_or_Ind     = SQL_LEN_DATA_AT_EXEC((SQLLEN)(len * sizeof(SQLWCHAR)));
         info.ParameterValuePtr = param;
@@ -302,7 +361,7 @@ static char* CreateDecimalString(long sign, PyObject* digits, long exp)
         // (1 2 3) exp = 2 --> '12300'
 
         len = sign + count + exp + 1; // 1: NULL
-        pch = (char*)pyodbc_malloc((size_t)len);
+        pch = (char*)pyodbc_malloc((size_t)len, MEM_DECIMAL);
         if (pch)
         {
             char* p = pch;
@@ -320,7 +379,7 @@ static char* CreateDecimalString(long sign, PyObject* digits, long exp)
         // (1 2 3) exp = -2 --> 1.23 : prec = 3, scale = 2
 
         len = sign + count + 2; // 2: decimal + NULL
-        pch = (char*)pyodbc_malloc((size_t)len);
+        pch = (char*)pyodbc_malloc((size_t)len, MEM_DECIMAL);
         if (pch)
         {
             char* p = pch;
@@ -341,7 +400,7 @@ static char* CreateDecimalString(long sign, PyObject* digits, long exp)
 
         len = sign + -exp + 3; // 3: leading zero + decimal + NULL
 
-        pch = (char*)pyodbc_malloc((size_t)len);
+        pch = (char*)pyodbc_malloc((size_t)len, MEM_DECIMAL);
         if (pch)
         {
             char* p = pch;
@@ -419,6 +478,19 @@ static bool GetDecimalInfo(Cursor* cur, Py_ssize_t index, PyObject* param, Param
     return true;
 }
 
+#ifdef PYODBC_BENCH
+char* Bench_CreateDecimalString(long sign, PyObject* digits, long exp)
+{
+    return CreateDecimalString(sign, digits, exp);
+}
+
+bool Bench_GetDecimalInfo(PyObject* param, ParamInfo& info)
+{
+    // GetDecimalInfo does not use the cursor.
+    return GetDecimalInfo(0, 0, param, info);
+}
+#endif
+
 static bool GetBufferInfo(Cursor* cur, Py_ssize_t index, PyObject* param, ParamInfo& info)
 {
     info.ValueType = SQL_C_BINARY;
@@ -501,6 +573,29 @@ static bool GetParameterInfo(Cursor* cur, Py_ssize_t index, PyObject* param, Par
     return false;
 }
 
+static UINT64 ParameterSize(const ParamInfo& info)
+{
+    // Returns the number of bytes of parameter data the driver will read from the bound buffer.  Data-at-execution
+    // parameters are counted as they are sent by SQLPutData.  The fixed-length types ignore StrLen_or_Ind, so they are
+    // counted by the C type, which is not always the size of the Data member holding the value.
+
+    if (info.StrLen_or_Ind >= 0)
+    {
+        switch (info.ValueType)
+        {
+        case SQL_C_LONG:
+            return sizeof(SQLINTEGER); // Data.l is a long, which is 8 bytes on LP64, but SQL_C_LONG is 32 bits
+        case SQL_C_SBIGINT:
+            return sizeof(INT64);
+        case SQL_C_DOUBLE:
+            return sizeof(double);
+        }
+        return (UINT64)info.StrLen_or_Ind;
+    }
+
+    return 0;
+}
+
 bool BindParameter(Cursor* cur, Py_ssize_t index, ParamInfo& info)
 {
     TRACE("BIND: param=%d ValueType=%d (%s) ParameterType=%d (%s) ColumnSize=%d DecimalDigits=%d BufferLength=%d *pcb=%d\n",
@@ -509,7 +604,7 @@ bool BindParameter(Cursor* cur, Py_ssize_t index, ParamInfo& info)
 
     SQLRETURN ret = -1;
     Py_BEGIN_ALLOW_THREADS
-    ret = SQLBindParameter(cur->hstmt, (SQLUSMALLINT)(index + 1), SQL_PARAM_INPUT, info.ValueType, info.ParameterType, info.ColumnSize, info.DecimalDigits, info.ParameterValuePtr, info.BufferLength, &info.StrLen_or_Ind);
+    ret = ODBC_CALL(cur->cnxn, SQLBindParameter)(cur->hstmt, (SQLUSMALLINT)(index + 1), SQL_PARAM_INPUT, info.ValueType, info.ParameterType, info.ColumnSize, info.DecimalDigits, info.ParameterValuePtr, info.BufferLength, &info.StrLen_or_Ind);
     Py_END_ALLOW_THREADS;
 
     if (GetConnection(cur)->hdbc == SQL_NULL_HANDLE)
@@ -525,6 +620,8 @@ bool BindParameter(Cursor* cur, Py_ssize_t index, ParamInfo& info)
         return false;
     }
 
+    CountBytesSent(cur->cnxn, ParameterSize(info));
+
     return true;
 }
 
@@ -539,11 +636,11 @@ void FreeParameterData(Cursor* cur)
         if (cur->cnxn->hdbc != SQL_NULL_HANDLE)
         {
             Py_BEGIN_ALLOW_THREADS
-            SQLFreeStmt(cur->hstmt, SQL_RESET_PARAMS);
+            ODBC_CALL(cur->cnxn, SQLFreeStmt)(cur->hstmt, SQL_RESET_PARAMS);
             Py_END_ALLOW_THREADS
         }
 
-        FreeInfos(cur->paramInfos, cur->paramcount);
+        FreeInfos(cur, cur->paramInfos, cur->paramcount);
         cur->paramInfos = 0;
     }
 }
@@ -553,13 +650,53 @@ void FreeParameterInfo(Cursor* cur)
     // Internal function to free just the cached parameter information.  This is not used by the general cursor code
     // since this information is also freed in the less granular free_results function that clears everything.
 
+    FreeColumnCache(cur);
+
     Py_XDECREF(cur->pPreparedSQL);
     pyodbc_free(cur->paramtypes);
+    pyodbc_free(cur->boundtypes);
     cur->pPreparedSQL = 0;
     cur->paramtypes   = 0;
+    cur->boundtypes   = 0;
     cur->paramcount   = 0;
 }
 
+static bool UpdateBoundTypes(Cursor* cur)
+{
+    // Records the C and SQL types the parameters in cur->paramInfos are about to be bound with.  The result metadata
+    // cached for the prepared statement can depend on them (e.g. "select ?"), so it is freed if any type differs from
+    // the previous execute.
+
+    if (cur->boundtypes == 0)
+    {
+        cur->boundtypes = (SQLSMALLINT*)pyodbc_malloc(sizeof(SQLSMALLINT) * 2 * cur->paramcount, MEM_PARAMINFOS);
+        if (cur->boundtypes == 0)
+        {
+            PyErr_NoMemory();
+            return false;
+        }
+        memset(cur->boundtypes, 0, sizeof(SQLSMALLINT) * 2 * cur->paramcount);
+    }
+
+    bool changed = false;
+    for (int i = 0; i < cur->paramcount; i++)
+    {
+        SQLSMALLINT* types = &cur->boundtypes[i * 2];
+        const ParamInfo& info = cur->paramInfos[i];
+        if (types[0] != info.ValueType || types[1] != info.ParameterType)
+        {
+            types[0] = info.ValueType;
+            types[1] = info.ParameterType;
+            changed  = true;
+        }
+    }
+
+    if (changed)
+        FreeColumnCache(cur);
+
+    return true;
+}
+
 bool PrepareAndBind(Cursor* cur, PyObject* pSql, PyObject* original_params, bool skip_first)
 {
     //
@@ -586,24 +723,31 @@ bool PrepareAndBind(Cursor* cur, PyObject* pSql, PyObject* original_params, bool
         if (PyString_Check(pSql))
         {
             TRACE("SQLPrepare(%s)\n", PyString_AS_STRING(pSql));
+            CountBytesSent(cur->cnxn, PyString_GET_SIZE(pSql));
+            StatsTimer timer(cur, &Stats::prepare);
             Py_BEGIN_ALLOW_THREADS
-            ret = SQLPrepare(cur->hstmt, (SQLCHAR*)PyString_AS_STRING(pSql), SQL_NTS);
+            ret = ODBC_CALL(cur->cnxn, SQLPrepare)(cur->hstmt, (SQLCHAR*)PyString_AS_STRING(pSql), SQL_NTS);
             if (SQL_SUCCEEDED(ret))
             {
                 szErrorFunc = "SQLNumParams";
-                ret = SQLNumParams(cur->hstmt, &cParamsT);
+                ret = ODBC_CALL(cur->cnxn, SQLNumParams)(cur->hstmt, &cParamsT);
             }
             Py_END_ALLOW_THREADS
         }
         else
         {
-            SQLWChar sql(pSql);
+            Py_ssize_t cch;
+            const SQLWCHAR* sql = Cursor_SQLText(cur, pSql, cch);
+            if (!sql)
+                return false;
+            CountBytesSent(cur->cnxn, cch * sizeof(SQLWCHAR));
+            StatsTimer timer(cur, &Stats::prepare);
             Py_BEGIN_ALLOW_THREADS
-            ret = SQLPrepareW(cur->hstmt, sql, SQL_NTS);
+            ret = ODBC_CALL(cur->cnxn, SQLPrepareW)(cur->hstmt, (SQLWCHAR*)sql, SQL_NTS);
             if (SQL_SUCCEEDED(ret))
             {
                 szErrorFunc = "SQLNumParams";
-                ret = SQLNumParams(cur->hstmt, &cParamsT);
+                ret = ODBC_CALL(cur->cnxn, SQLNumParams)(cur->hstmt, &cParamsT);
             }
             Py_END_ALLOW_THREADS
         }
@@ -634,7 +778,13 @@ bool PrepareAndBind(Cursor* cur, PyObject* pSql, PyObject* original_params, bool
         return false;
     }
 
-    cur->paramInfos = (ParamInfo*)pyodbc_malloc(sizeof(ParamInfo) * cParams);
+    if (cParams == 0)
+    {
+        // Nothing to bind.  (Asynchronous executes always prepare, even without parameters.)
+        return true;
+    }
+
+    cur->paramInfos = (ParamInfo*)pyodbc_malloc(sizeof(ParamInfo) * cParams, MEM_PARAMINFOS);
     if (cur->paramInfos == 0)
     {
         PyErr_NoMemory();
@@ -653,17 +803,24 @@ bool PrepareAndBind(Cursor* cur, PyObject* pSql, PyObject* original_params, bool
         // it will be released when FreeInfos is called.
         if (!GetParameterInfo(cur, i, param, cur->paramInfos[i]))
         {
-            FreeInfos(cur->paramInfos, cParams);
+            FreeInfos(cur, cur->paramInfos, cParams);
             cur->paramInfos = 0;
             return false;
         }
     }
 
+    if (!UpdateBoundTypes(cur))
+    {
+        FreeInfos(cur, cur->paramInfos, cParams);
+        cur->paramInfos = 0;
+        return false;
+    }
+
     for (Py_ssize_t i = 0; i < cParams; i++)
     {
         if (!BindParameter(cur, i, cur->paramInfos[i]))
         {
-            FreeInfos(cur->paramInfos, cParams);
+            FreeInfos(cur, cur->paramInfos, cParams);
             cur->paramInfos = 0;
             return false;
         }
@@ -691,7 +848,7 @@ static bool GetParamType(Cursor* cur, Py_ssize_t index, SQLSMALLINT& type)
 
     if (cur->paramtypes == 0)
     {
-        cur->paramtypes = reinterpret_cast<SQLSMALLINT*>(pyodbc_malloc(sizeof(SQLSMALLINT) * cur->paramcount));
+        cur->paramtypes = reinterpret_cast<SQLSMALLINT*>(pyodbc_malloc(sizeof(SQLSMALLINT) * cur->paramcount, MEM_PARAMINFOS));
         if (cur->paramtypes == 0)
         {
             PyErr_NoMemory();
@@ -710,7 +867,7 @@ static bool GetParamType(Cursor* cur, Py_ssize_t index, SQLSMALLINT& type)
         SQLRETURN ret;
 
         Py_BEGIN_ALLOW_THREADS
-        ret = SQLDescribeParam(cur->hstmt, (SQLUSMALLINT)(index + 1), &cur->paramtypes[index], &ParameterSizePtr, &DecimalDigitsPtr, &NullablePtr);
+        ret = ODBC_CALL(cur->cnxn, SQLDescribeParam)(cur->hstmt, (SQLUSMALLINT)(index + 1), &cur->paramtypes[index], &ParameterSizePtr, &DecimalDigitsPtr, &NullablePtr);
         Py_END_ALLOW_THREADS
 
         if (!SQL_SUCCEEDED(ret))
@@ -8,4 +8,9 @@ bool PrepareAndBind(Cursor* cur, PyObject* pSql, PyObject* params, bool skip_fir
 void FreeParameterData(Cursor* cur);
 void FreeParameterInfo(Cursor* cur);
 
+// Allocates `cb` bytes for the current parameters from the cursor's scratch buffer, which are valid until the
+// parameters are freed.  If the buffer is full, the memory is allocated with pyodbc_malloc instead and `allocated` is
+// set to true, in which case the caller must free it.  Returns zero with an exception set if out of memory.
+void* AllocScratch(Cursor* cur, size_t cb, bool& allocated);
+
 #endif
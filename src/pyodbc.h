@@ -152,15 +152,35 @@ inline void DebugTrace(const char* szFmt, ...) { UNUSED(szFmt); }
 #endif
 #define TRACE DebugTrace
 
-#ifdef PYODBC_LEAK_CHECK
-#define pyodbc_malloc(len) _pyodbc_malloc(__FILE__, __LINE__, len)
-void* _pyodbc_malloc(const char* filename, int lineno, size_t len);
+// pyodbc's own allocations.  Each block records its size and the kind of data it holds so live memory can be accounted
+// for at runtime (see pyodbc.enable_memory_tracking).  Memory from pyodbc_malloc must only be passed to pyodbc_realloc
+// and pyodbc_free.
+
+enum MemoryCategory
+{
+    MEM_OTHER,
+    MEM_COLINFOS,               // ColumnInfo arrays
+    MEM_PARAMINFOS,             // ParamInfo arrays and parameter types
+    MEM_ROWVALUES,              // the value arrays of Row objects
+    MEM_DECIMAL,                // decimal parameters converted to strings
+    MEM_SQLWCHAR,               // Unicode strings converted to SQLWCHAR
+    MEM_RAWROWS,                // the column data of lazy rows (RawBlocks)
+
+    MEM_CATEGORY_COUNT
+};
+
+void* pyodbc_malloc(size_t len, MemoryCategory category = MEM_OTHER);
+void* pyodbc_realloc(void* p, size_t len);
 void pyodbc_free(void* p);
-void pyodbc_leak_check();
-#else
-#define pyodbc_malloc malloc
-#define pyodbc_free free
-#endif
+
+// True while allocations are being counted.  Blocks allocated while this is false are never counted, even if they are
+// freed after it is turned on.
+extern bool memory_tracking;
+
+void EnableMemoryTracking(bool enable);
+
+// Returns a dictionary mapping each category name (and "total") to a dictionary of its counts.
+PyObject* MemoryStats_ToDict();
 
 void PrintBytes(void* p, size_t len);
 
@@ -18,6 +18,14 @@
 #include "errors.h"
 #include "getdata.h"
 #include "cnxninfo.h"
+#include "async.h"
+#include "parallel.h"
+#include "gather.h"
+#include "resultcache.h"
+#include "querylog.h"
+#include "latency.h"
+#include "trace.h"
+#include "cpufeatures.h"
 #include "dbspecific.h"
 
 #include <time.h>
@@ -207,6 +215,7 @@ static bool import_types()
     Cursor_init();
     CnxnInfo_init();
     GetData_init();
+    CpuFeatures_init();
 
     PyObject* decimalmod = PyImport_ImportModule("decimal");
     if (!decimalmod)
@@ -233,20 +242,20 @@ static bool AllocateEnv()
 
     if (bPooling)
     {
-        if (!SQL_SUCCEEDED(SQLSetEnvAttr(SQL_NULL_HANDLE, SQL_ATTR_CONNECTION_POOLING, (SQLPOINTER)SQL_CP_ONE_PER_HENV, sizeof(int))))
+        if (!SQL_SUCCEEDED(ODBC_CALL(0, SQLSetEnvAttr)(SQL_NULL_HANDLE, SQL_ATTR_CONNECTION_POOLING, (SQLPOINTER)SQL_CP_ONE_PER_HENV, sizeof(int))))
         {
             Py_FatalError("Unable to set SQL_ATTR_CONNECTION_POOLING attribute.");
             return false;
         }
     }
     
-    if (!SQL_SUCCEEDED(SQLAllocHandle(SQL_HANDLE_ENV, SQL_NULL_HANDLE, &henv)))
+    if (!SQL_SUCCEEDED(ODBC_CALL(0, SQLAllocHandle)(SQL_HANDLE_ENV, SQL_NULL_HANDLE, &henv)))
     {
         Py_FatalError("Can't initialize module pyodbc.  SQLAllocEnv failed.");
         return false;
     }
 
-    if (!SQL_SUCCEEDED(SQLSetEnvAttr(henv, SQL_ATTR_ODBC_VERSION, (SQLPOINTER)SQL_OV_ODBC3, sizeof(int))))
+    if (!SQL_SUCCEEDED(ODBC_CALL(0, SQLSetEnvAttr)(henv, SQL_ATTR_ODBC_VERSION, (SQLPOINTER)SQL_OV_ODBC3, sizeof(int))))
     {
         Py_FatalError("Unable to set SQL_ATTR_ODBC_VERSION attribute.");
         return false;
@@ -280,6 +289,7 @@ static PyObject* mod_connect(PyObject* self, PyObject* args, PyObject* kwargs)
     int fAutoCommit = 0;
     int fAnsi = 0;              // force ansi
     int fUnicodeResults = 0;
+    PyObject* encoding = 0;     // borrowed from kwargs
     long timeout = 0;
 
     Py_ssize_t size = args ? PyTuple_Size(args) : 0;
@@ -335,6 +345,11 @@ static PyObject* mod_connect(PyObject* self, PyObject* args, PyObject* kwargs)
                 fUnicodeResults = PyObject_IsTrue(value);
                 continue;
             }
+            if (_strcmpi(szKey, "encoding") == 0)
+            {
+                encoding = value;
+                continue;
+            }
             if (_strcmpi(szKey, "timeout") == 0)
             {
                 timeout = PyInt_AsLong(value);
@@ -392,7 +407,7 @@ static PyObject* mod_connect(PyObject* self, PyObject* args, PyObject* kwargs)
             return 0;
     }
      
-    return (PyObject*)Connection_New(pConnectString.Get(), fAutoCommit != 0, fAnsi != 0, fUnicodeResults != 0, timeout);
+    return (PyObject*)Connection_New(pConnectString.Get(), fAutoCommit != 0, fAnsi != 0, fUnicodeResults != 0, encoding, timeout);
 }
 
 
@@ -420,7 +435,7 @@ mod_datasources(PyObject* self)
     for (;;)
     {
         Py_BEGIN_ALLOW_THREADS
-        ret = SQLDataSources(henv, SQL_FETCH_NEXT, szDSN,  _countof(szDSN),  &cbDSN, szDesc, _countof(szDesc), &cbDesc);
+        ret = ODBC_CALL(0, SQLDataSources)(henv, SQL_FETCH_NEXT, szDSN,  _countof(szDSN),  &cbDSN, szDesc, _countof(szDesc), &cbDesc);
         Py_END_ALLOW_THREADS
         if (!SQL_SUCCEEDED(ret))
             break;
@@ -538,6 +553,12 @@ static char connect_doc[] =
     "    drivers that return the wrong SQLSTATE (or if pyodbc is out of date and\n"
     "    should support other SQLSTATEs).\n"
     "   \n"
+    "  encoding\n"
+    "    The name of a Python codec, such as 'utf-8', used to decode char and\n"
+    "    varchar columns when unicode_results is true.  They are then read from the\n"
+    "    driver as bytes instead of being converted to SQLWCHAR by the driver.  The\n"
+    "    default, None, lets the driver convert them.  See Connection.encoding.\n"
+    "   \n"
     "  timeout\n"
     "    An integer login timeout in seconds, used to set the SQL_ATTR_LOGIN_TIMEOUT\n"
     "    attribute of the connection.  The default is 0 which means the database's\n"
@@ -569,15 +590,376 @@ static char datasources_doc[] =
     "\n" \
     "Returns a dictionary mapping available DSNs to their descriptions.";
 
+static char wait_doc[] =
+    "wait(futures, timeout=None) -> (done, pending)\n" \
+    "\n" \
+    "Waits until at least one of the pyodbc.Future objects in `futures` has\n" \
+    "completed and returns two lists: the futures that are done and those that are\n" \
+    "still pending.  If `timeout` is provided, it is the maximum number of seconds\n" \
+    "to wait; a timeout of 0 only polls.\n" \
+    "\n" \
+    "Statements executing asynchronously in the driver are polled while waiting, so\n" \
+    "a single thread can drive many concurrent queries with a loop around wait().";
+
+static char* mod_wait_kwnames[] = { "futures", "timeout", 0 };
+
+static PyObject*
+mod_wait(PyObject* self, PyObject* args, PyObject* kwargs)
+{
+    UNUSED(self);
+
+    PyObject* futures;
+    PyObject* timeout = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|O", mod_wait_kwnames, &futures, &timeout))
+        return 0;
+
+    return Future_Wait(futures, timeout);
+}
+
+static char execute_parallel_doc[] =
+    "execute_parallel(connections, jobs, timings=False) -> [ result, ... ]\n" \
+    "\n" \
+    "Runs independent statements concurrently, one native thread per connection,\n" \
+    "and returns their results in the order of `jobs`.  Each job is a SQL string or\n" \
+    "a (sql, params) sequence.  The result of a query is a list of Rows (as from\n" \
+    "fetchall); the result of any other statement is its row count.\n" \
+    "\n" \
+    "The connections must not be used by other threads until this returns.  If a\n" \
+    "job fails, no new jobs are started and the first error is raised.\n" \
+    "\n" \
+    "If `timings` is True, returns (results, wall_seconds, summed_seconds) where\n" \
+    "summed_seconds is the total of the individual jobs' run times.";
+
+static char* mod_execute_parallel_kwnames[] = { "connections", "jobs", "timings", 0 };
+
+static PyObject*
+mod_execute_parallel(PyObject* self, PyObject* args, PyObject* kwargs)
+{
+    UNUSED(self);
+
+    PyObject* connections;
+    PyObject* jobs;
+    PyObject* timings = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|O", mod_execute_parallel_kwnames, &connections, &jobs, &timings))
+        return 0;
+
+    return ExecuteParallel(connections, jobs, timings != 0 && PyObject_IsTrue(timings));
+}
+
+static char scatter_gather_doc[] =
+    "scatter_gather(partitions, order_by=None, reverse=False, batch_size=256) -> iterator\n" \
+    "\n" \
+    "Runs one query per partition in parallel and returns an iterator over all of\n" \
+    "their rows.  Each partition is a (connection, sql) or (connection, sql, params)\n" \
+    "tuple and must use its own connection.  Rows are fetched in the background,\n" \
+    "batch_size at a time, by one thread per partition.\n" \
+    "\n" \
+    "If order_by is given (a column index or name, or a sequence of them), each\n" \
+    "partition's results must already be sorted on those columns and the rows are\n" \
+    "merged so the combined output stays sorted.  Otherwise rows are returned in the\n" \
+    "order they arrive.";
+
+static char* mod_scatter_gather_kwnames[] = { "partitions", "order_by", "reverse", "batch_size", 0 };
+
+static PyObject*
+mod_scatter_gather(PyObject* self, PyObject* args, PyObject* kwargs)
+{
+    UNUSED(self);
+
+    PyObject* partitions;
+    PyObject* order_by   = 0;
+    PyObject* reverse    = 0;
+    long      batch_size = 256;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|OOl", mod_scatter_gather_kwnames, &partitions, &order_by, &reverse, &batch_size))
+        return 0;
+
+    return Gather_New(partitions, order_by, reverse != 0 && PyObject_IsTrue(reverse), batch_size);
+}
+
+static char enable_stats_doc[] =
+    "enable_stats(enabled=True) -> bool\n" \
+    "\n" \
+    "Turns the collection of Cursor.stats and Connection.stats on or off and returns\n" \
+    "the previous setting.  While on, the time spent preparing, executing, fetching,\n" \
+    "and converting is measured with a monotonic clock, along with the number of rows\n" \
+    "and bytes fetched, and how long the GIL was held and released while fetching.\n" \
+    "It is off by default since reading the clock adds a small cost to each call.";
+
+static char* mod_enable_stats_kwnames[] = { "enabled", 0 };
+
+static PyObject*
+mod_enable_stats(PyObject* self, PyObject* args, PyObject* kwargs)
+{
+    UNUSED(self);
+
+    PyObject* enabled = Py_True;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O", mod_enable_stats_kwnames, &enabled))
+        return 0;
+
+    bool previous = stats_enabled;
+    stats_enabled = PyObject_IsTrue(enabled) != 0;
+
+    if (previous)
+        Py_RETURN_TRUE;
+    Py_RETURN_FALSE;
+}
+
+static char set_gil_warning_handler_doc[] =
+    "set_gil_warning_handler(callback, threshold=0.01) --> None\n" \
+    "\n" \
+    "Calls callback(cursor, seconds, rows) after a fetch call (fetchone, fetchmany,\n" \
+    "fetchall, or iterating) that held the GIL for at least `threshold` seconds\n" \
+    "without releasing it for an ODBC call.  Long holds keep other Python threads from\n" \
+    "running and usually mean expensive conversions or very wide rows.  Pass None to\n" \
+    "remove the handler.  Exceptions raised by the callback are printed and ignored.";
+
+static char* mod_set_gil_warning_handler_kwnames[] = { "callback", "threshold", 0 };
+
+static PyObject*
+mod_set_gil_warning_handler(PyObject* self, PyObject* args, PyObject* kwargs)
+{
+    UNUSED(self);
+
+    PyObject* callback;
+    double threshold = 0.01;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|d", mod_set_gil_warning_handler_kwnames, &callback, &threshold))
+        return 0;
+
+    if (callback != Py_None && !PyCallable_Check(callback))
+        return PyErr_Format(PyExc_TypeError, "The GIL warning handler must be callable");
+
+    if (threshold < 0)
+        return PyErr_Format(PyExc_ValueError, "The GIL warning threshold cannot be negative");
+
+    Stats_SetGilWarningHandler(callback == Py_None ? 0 : callback, (UINT64)(threshold * 1000000000.0));
+
+    Py_RETURN_NONE;
+}
+
+static char odbc_counts_doc[] =
+    "odbc_counts() --> { 'calls' : { function : count }, 'bytes_sent' : n, 'bytes_received' : n }\n" \
+    "\n" \
+    "Returns the number of times each ODBC function has been called by all\n" \
+    "connections in this process, the bytes of SQL text and parameter data sent,\n" \
+    "and the bytes of column data received.  Connection.odbc_counts has the same\n" \
+    "counts for a single connection.";
+
+static PyObject*
+mod_odbc_counts(PyObject* self, PyObject* args)
+{
+    UNUSED(self, args);
+    return CallCounts_ToDict(0);
+}
+
+static char enable_latency_histograms_doc[] =
+    "enable_latency_histograms(enabled=True) --> bool\n" \
+    "\n" \
+    "Turns the collection of latency histograms on or off and returns the previous\n" \
+    "setting.  See latency_histograms.";
+
+static char* mod_enable_latency_histograms_kwnames[] = { "enabled", 0 };
+
+static PyObject*
+mod_enable_latency_histograms(PyObject* self, PyObject* args, PyObject* kwargs)
+{
+    UNUSED(self);
+
+    PyObject* enabled = Py_True;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O", mod_enable_latency_histograms_kwnames, &enabled))
+        return 0;
+
+    bool previous = latency_enabled;
+    latency_enabled = PyObject_IsTrue(enabled) != 0;
+
+    if (previous)
+        Py_RETURN_TRUE;
+    Py_RETURN_FALSE;
+}
+
+static char latency_histograms_doc[] =
+    "latency_histograms() --> { fingerprint : { 'sql' : sql, 'execute' : histogram, 'fetch' : histogram } }\n" \
+    "\n" \
+    "Returns the latency histograms for each statement executed while collection\n" \
+    "was enabled, keyed by the statement's fingerprint (see drain_query_log).  Each\n" \
+    "histogram is a dictionary with the count, sum, max, p50, p90, p99, and p999\n" \
+    "in seconds, and a list of (upper_bound_seconds, count) buckets.  'fetch' is\n" \
+    "the time from the end of the execute until the last row was fetched.";
+
+static PyObject*
+mod_latency_histograms(PyObject* self, PyObject* args)
+{
+    UNUSED(self, args);
+    return Latency_ToDict();
+}
+
+static char reset_latency_histograms_doc[] =
+    "reset_latency_histograms() --> None\n" \
+    "\n" \
+    "Discards all of the latency histograms.";
 
-#ifdef PYODBC_LEAK_CHECK
-static PyObject* mod_leakcheck(PyObject* self, PyObject* args)
+static PyObject*
+mod_reset_latency_histograms(PyObject* self, PyObject* args)
 {
     UNUSED(self, args);
-    pyodbc_leak_check();
+    Latency_Reset();
+    Py_RETURN_NONE;
+}
+
+static char enable_query_log_doc[] =
+    "enable_query_log(size=1024) --> None\n" \
+    "\n" \
+    "Records every statement executed into a ring buffer holding the most recent\n" \
+    "`size` statements, which are read with drain_query_log.  Any events not yet\n" \
+    "drained are discarded.  A size of 0 turns the log off.";
+
+static char* mod_enable_query_log_kwnames[] = { "size", 0 };
+
+static PyObject*
+mod_enable_query_log(PyObject* self, PyObject* args, PyObject* kwargs)
+{
+    UNUSED(self);
+
+    Py_ssize_t size = 1024;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|n", mod_enable_query_log_kwnames, &size))
+        return 0;
+
+    if (size < 0)
+        return PyErr_Format(PyExc_ValueError, "The query log size cannot be negative");
+
+    if (!QueryLog_SetSize(size))
+        return 0;
+
+    Py_RETURN_NONE;
+}
+
+static char drain_query_log_doc[] =
+    "drain_query_log() --> [ (sql, fingerprint, params, seconds, rowcount, sqlstate), ... ]\n" \
+    "\n" \
+    "Returns the statements recorded since the last call, oldest first, and empties\n" \
+    "the query log.  The fingerprint is the same for statements that differ only in\n" \
+    "literal values.  Statements that return rows are recorded when their results\n" \
+    "are finished, and rowcount is the number of rows fetched.  sqlstate is None\n" \
+    "unless the statement raised an error.";
+
+static PyObject*
+mod_drain_query_log(PyObject* self, PyObject* args)
+{
+    UNUSED(self, args);
+    return QueryLog_Drain();
+}
+
+static char set_slow_query_handler_doc[] =
+    "set_slow_query_handler(callback, threshold=1.0) --> None\n" \
+    "\n" \
+    "Calls callback(sql, seconds, rowcount, sqlstate) after each statement that takes\n" \
+    "at least `threshold` seconds to execute, when it is recorded in the query log.\n" \
+    "Pass None to remove the handler.\n" \
+    "Exceptions raised by the callback are printed and ignored.";
+
+static char* mod_set_slow_query_handler_kwnames[] = { "callback", "threshold", 0 };
+
+static PyObject*
+mod_set_slow_query_handler(PyObject* self, PyObject* args, PyObject* kwargs)
+{
+    UNUSED(self);
+
+    PyObject* callback;
+    double threshold = 1.0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|d", mod_set_slow_query_handler_kwnames, &callback, &threshold))
+        return 0;
+
+    if (callback != Py_None && !PyCallable_Check(callback))
+        return PyErr_Format(PyExc_TypeError, "The slow query handler must be callable");
+
+    if (threshold < 0)
+        return PyErr_Format(PyExc_ValueError, "The slow query threshold cannot be negative");
+
+    QueryLog_SetSlowHandler(callback == Py_None ? 0 : callback, (UINT64)(threshold * 1000000000.0));
+
     Py_RETURN_NONE;
 }
-#endif
+
+static char start_trace_doc[] =
+    "start_trace(filename) --> None\n" \
+    "\n" \
+    "Records the shape of each statement executed to a binary trace file: its\n" \
+    "fingerprint, the types and sizes of its parameters and result columns, and the\n" \
+    "rows and bytes fetched.  SQL text and values are not recorded.  Each parameter\n" \
+    "set passed to executemany is recorded as a separate execute.  Any trace\n" \
+    "already being recorded is stopped first.  Replay a trace with\n" \
+    "tests/replaytrace.py.";
+
+static PyObject*
+mod_start_trace(PyObject* self, PyObject* args)
+{
+    UNUSED(self);
+
+    const char* filename;
+    if (!PyArg_ParseTuple(args, "s", &filename))
+        return 0;
+
+    if (!Trace_Start(filename))
+        return 0;
+
+    Py_RETURN_NONE;
+}
+
+static char stop_trace_doc[] =
+    "stop_trace() --> int\n" \
+    "\n" \
+    "Stops recording the trace started by start_trace, closes the file, and returns\n" \
+    "the number of statements recorded.  Result sets still open are not recorded.";
+
+static PyObject*
+mod_stop_trace(PyObject* self, PyObject* args)
+{
+    UNUSED(self, args);
+
+    UINT64 statements;
+    if (!Trace_Stop(statements))
+        return 0;
+
+    return PyLong_FromUnsignedLongLong(statements);
+}
+
+static char enable_memory_tracking_doc[] =
+    "enable_memory_tracking(enabled=True) --> bool\n" \
+    "\n" \
+    "Turns the accounting of pyodbc's own memory allocations on or off and returns\n" \
+    "the previous setting.  See memory_stats.";
+
+static char* mod_enable_memory_tracking_kwnames[] = { "enabled", 0 };
+
+static PyObject*
+mod_enable_memory_tracking(PyObject* self, PyObject* args, PyObject* kwargs)
+{
+    UNUSED(self);
+
+    PyObject* enabled = Py_True;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O", mod_enable_memory_tracking_kwnames, &enabled))
+        return 0;
+
+    bool previous = memory_tracking;
+    EnableMemoryTracking(PyObject_IsTrue(enabled) != 0);
+
+    if (previous)
+        Py_RETURN_TRUE;
+    Py_RETURN_FALSE;
+}
+
+static char memory_stats_doc[] =
+    "memory_stats() --> { category : { 'live_bytes' : n, ... } }\n" \
+    "\n" \
+    "Returns the memory allocated by pyodbc while tracking was enabled, by category\n" \
+    "and in total.  Each category has live_bytes, live_blocks, peak_bytes, allocs,\n" \
+    "frees, and alloc_rate (allocations per second).";
+
+static PyObject*
+mod_memory_stats(PyObject* self, PyObject* args)
+{
+    UNUSED(self, args);
+    return MemoryStats_ToDict();
+}
 
 #ifdef WINVER
 static char drivers_doc[] = "drivers() -> [ driver, ... ]\n\nReturns a list of installed drivers";
@@ -619,20 +1001,32 @@ static PyObject* mod_drivers(PyObject* self, PyObject* args)
 
 static PyMethodDef pyodbc_methods[] =
 {
-    { "connect",            (PyCFunction)mod_connect,            METH_VARARGS|METH_KEYWORDS, connect_doc },
-    { "TimeFromTicks",      (PyCFunction)mod_timefromticks,      METH_VARARGS,               timefromticks_doc },
-    { "DateFromTicks",      (PyCFunction)mod_datefromticks,      METH_VARARGS,               datefromticks_doc },
-    { "TimestampFromTicks", (PyCFunction)mod_timestampfromticks, METH_VARARGS,               timestampfromticks_doc },
-    { "dataSources",        (PyCFunction)mod_datasources,        METH_NOARGS,                datasources_doc },
+    { "connect",                   (PyCFunction)mod_connect,                   METH_VARARGS|METH_KEYWORDS, connect_doc },
+    { "TimeFromTicks",             (PyCFunction)mod_timefromticks,             METH_VARARGS,               timefromticks_doc },
+    { "DateFromTicks",             (PyCFunction)mod_datefromticks,             METH_VARARGS,               datefromticks_doc },
+    { "TimestampFromTicks",        (PyCFunction)mod_timestampfromticks,        METH_VARARGS,               timestampfromticks_doc },
+    { "dataSources",               (PyCFunction)mod_datasources,               METH_NOARGS,                datasources_doc },
+    { "wait",                      (PyCFunction)mod_wait,                      METH_VARARGS|METH_KEYWORDS, wait_doc },
+    { "execute_parallel",          (PyCFunction)mod_execute_parallel,          METH_VARARGS|METH_KEYWORDS, execute_parallel_doc },
+    { "scatter_gather",            (PyCFunction)mod_scatter_gather,            METH_VARARGS|METH_KEYWORDS, scatter_gather_doc },
+    { "enable_stats",              (PyCFunction)mod_enable_stats,              METH_VARARGS|METH_KEYWORDS, enable_stats_doc },
+    { "set_gil_warning_handler",   (PyCFunction)mod_set_gil_warning_handler,   METH_VARARGS|METH_KEYWORDS, set_gil_warning_handler_doc },
+    { "odbc_counts",               (PyCFunction)mod_odbc_counts,               METH_NOARGS,                odbc_counts_doc },
+    { "enable_latency_histograms", (PyCFunction)mod_enable_latency_histograms, METH_VARARGS|METH_KEYWORDS, enable_latency_histograms_doc },
+    { "latency_histograms",        (PyCFunction)mod_latency_histograms,        METH_NOARGS,                latency_histograms_doc },
+    { "reset_latency_histograms",  (PyCFunction)mod_reset_latency_histograms,  METH_NOARGS,                reset_latency_histograms_doc },
+    { "enable_memory_tracking",    (PyCFunction)mod_enable_memory_tracking,    METH_VARARGS|METH_KEYWORDS, enable_memory_tracking_doc },
+    { "memory_stats",              (PyCFunction)mod_memory_stats,              METH_NOARGS,                memory_stats_doc },
+    { "enable_query_log",          (PyCFunction)mod_enable_query_log,          METH_VARARGS|METH_KEYWORDS, enable_query_log_doc },
+    { "drain_query_log",           (PyCFunction)mod_drain_query_log,           METH_NOARGS,                drain_query_log_doc },
+    { "set_slow_query_handler",    (PyCFunction)mod_set_slow_query_handler,    METH_VARARGS|METH_KEYWORDS, set_slow_query_handler_doc },
+    { "start_trace",               (PyCFunction)mod_start_trace,               METH_VARARGS,               start_trace_doc },
+    { "stop_trace",                (PyCFunction)mod_stop_trace,                METH_NOARGS,                stop_trace_doc },
 
 #ifdef WINVER
     { "drivers", (PyCFunction)mod_drivers, METH_NOARGS, drivers_doc },
 #endif
 
-#ifdef PYODBC_LEAK_CHECK
-    { "leakcheck", (PyCFunction)mod_leakcheck, METH_NOARGS, 0 },
-#endif
-
     { 0, 0, 0, 0 }
 };
 
@@ -955,7 +1349,8 @@ initpyodbc()
         return;
     }
 
-    if (PyType_Ready(&ConnectionType) < 0 || PyType_Ready(&CursorType) < 0 || PyType_Ready(&RowType) < 0 || PyType_Ready(&CnxnInfoType) < 0)
+    if (PyType_Ready(&ConnectionType) < 0 || PyType_Ready(&CursorType) < 0 || PyType_Ready(&RowType) < 0 || PyType_Ready(&CnxnInfoType) < 0 ||
+        PyType_Ready(&FutureType) < 0 || PyType_Ready(&GatherType) < 0 || PyType_Ready(&ResultCacheType) < 0)
         return;
 
     pModule = Py_InitModule4("pyodbc", pyodbc_methods, module_doc, NULL, PYTHON_API_VERSION);
@@ -978,6 +1373,7 @@ initpyodbc()
     Py_INCREF(Py_True);
     PyModule_AddObject(pModule, "lowercase", Py_False);
     Py_INCREF(Py_False);
+    PyModule_AddIntConstant(pModule, "async_workers", 8);
                        
     PyModule_AddObject(pModule, "Connection", (PyObject*)&ConnectionType);
     Py_INCREF((PyObject*)&ConnectionType);
@@ -985,6 +1381,10 @@ initpyodbc()
     Py_INCREF((PyObject*)&CursorType);
     PyModule_AddObject(pModule, "Row", (PyObject*)&RowType);
     Py_INCREF((PyObject*)&RowType);
+    PyModule_AddObject(pModule, "Future", (PyObject*)&FutureType);
+    Py_INCREF((PyObject*)&FutureType);
+    PyModule_AddObject(pModule, "ResultCache", (PyObject*)&ResultCacheType);
+    Py_INCREF((PyObject*)&ResultCacheType);
 
     // Add the SQL_XXX defines from ODBC.
     for (unsigned int i = 0; i < _countof(aConstants); i++)
@@ -0,0 +1,289 @@
+
+#include "pyodbc.h"
+#include "querylog.h"
+#include "cursor.h"
+#include "wrapper.h"
+
+// The ring is only written and drained by threads holding the GIL (execute always records after reacquiring it), so
+// it needs no lock of its own.  `head` counts every event ever recorded and `tail` is the count when it was last
+// drained; slot i holds event number i % ring_size.
+
+struct QueryEvent
+{
+    PyObject* sql;              // a reference to the SQL string, or zero if the slot has never been used
+    UINT64 fingerprint;
+    UINT64 duration;            // nanoseconds
+    Py_ssize_t params;
+    Py_ssize_t rows;            // rows fetched, or Cursor.rowcount if there were no results; -1 if it failed
+    char sqlstate[6];           // empty if the statement succeeded
+};
+
+bool querylog_active = false;
+
+static QueryEvent* ring      = 0;
+static size_t      ring_size = 0;
+static UINT64      head      = 0;
+static UINT64      tail      = 0;
+
+static PyObject* slow_callback  = 0;
+static UINT64    slow_threshold = 0;
+
+static void UpdateActive()
+{
+    querylog_active = (ring_size != 0 || slow_callback != 0);
+}
+
+static void FreeRing()
+{
+    for (size_t i = 0; i < ring_size; i++)
+        Py_XDECREF(ring[i].sql);
+    pyodbc_free(ring);
+    ring      = 0;
+    ring_size = 0;
+    head      = 0;
+    tail      = 0;
+}
+
+bool QueryLog_SetSize(Py_ssize_t size)
+{
+    FreeRing();
+
+    if (size > 0)
+    {
+        ring = (QueryEvent*)pyodbc_malloc(sizeof(QueryEvent) * size);
+        if (!ring)
+        {
+            UpdateActive();
+            PyErr_NoMemory();
+            return false;
+        }
+        memset(ring, 0, sizeof(QueryEvent) * size);
+        ring_size = (size_t)size;
+    }
+
+    UpdateActive();
+    return true;
+}
+
+void QueryLog_SetSlowHandler(PyObject* callback, UINT64 threshold)
+{
+    Py_XINCREF(callback);
+    Py_XDECREF(slow_callback);
+    slow_callback  = callback;
+    slow_threshold = threshold;
+    UpdateActive();
+}
+
+static void GetSqlState(char* sqlstate)
+{
+    // Copies the SQLSTATE of the current exception, which pyodbc stores in the exception's args, without clearing the
+    // exception.  Exceptions not raised from an ODBC error (e.g. a TypeError from a bad parameter) leave it empty.
+
+    sqlstate[0] = 0;
+
+    PyObject *type, *value, *traceback;
+    PyErr_Fetch(&type, &value, &traceback);
+    PyErr_NormalizeException(&type, &value, &traceback);
+
+    if (value)
+    {
+        PyObject* args = PyObject_GetAttrString(value, "args");
+        if (args && PyTuple_Check(args))
+        {
+            for (Py_ssize_t i = 0; i < PyTuple_GET_SIZE(args); i++)
+            {
+                PyObject* item = PyTuple_GET_ITEM(args, i);
+                if (PyString_Check(item) && PyString_GET_SIZE(item) == 5)
+                {
+                    memcpy(sqlstate, PyString_AS_STRING(item), 6);
+                    break;
+                }
+            }
+        }
+        Py_XDECREF(args);
+    }
+
+    PyErr_Restore(type, value, traceback);
+}
+
+static void CallSlowHandler(PyObject* pSql, UINT64 duration, Py_ssize_t rows, const char* sqlstate)
+{
+    // The statement's own exception, if any, is saved while the callback runs.  Errors raised by the callback are
+    // reported with PyErr_WriteUnraisable so a monitoring hook cannot make a statement fail.
+
+    PyObject *type, *value, *traceback;
+    PyErr_Fetch(&type, &value, &traceback);
+
+    // The callback could replace itself, so hold our own reference.
+    Object callback(slow_callback);
+    Py_INCREF(slow_callback);
+
+    PyObject* result;
+    if (*sqlstate)
+        result = PyObject_CallFunction(callback, "Odns", pSql, (double)duration / 1000000000.0, rows, sqlstate);
+    else
+        result = PyObject_CallFunction(callback, "OdnO", pSql, (double)duration / 1000000000.0, rows, Py_None);
+
+    if (result)
+        Py_DECREF(result);
+    else
+        PyErr_WriteUnraisable(callback);
+
+    PyErr_Restore(type, value, traceback);
+}
+
+static void AddEvent(PyObject* pSql, Py_ssize_t cParams, UINT64 duration, Py_ssize_t rows, const char* sqlstate)
+{
+    if (ring_size != 0)
+    {
+        QueryEvent& event = ring[head % ring_size];
+        head++;
+
+        Py_INCREF(pSql);
+        Py_XDECREF(event.sql);
+        event.sql         = pSql;
+        event.fingerprint = SqlFingerprint(pSql);
+        event.duration    = duration;
+        event.params      = cParams;
+        event.rows        = rows;
+        memcpy(event.sqlstate, sqlstate, sizeof(event.sqlstate));
+    }
+
+    if (slow_callback && duration >= slow_threshold)
+        CallSlowHandler(pSql, duration, rows, sqlstate);
+}
+
+void QueryLog_Record(Cursor* cur, PyObject* pSql, Py_ssize_t cParams, UINT64 duration, bool succeeded)
+{
+    if (succeeded && (cur->colinfos != 0 || cur->preloaded != 0))
+    {
+        // Counted by the fetch functions until the results are finished.
+        I(cur->querylog_sql == 0);
+        cur->querylog_sql      = pSql;
+        cur->querylog_params   = cParams;
+        cur->querylog_duration = duration;
+        cur->querylog_rows     = 0;
+        Py_INCREF(pSql);
+        return;
+    }
+
+    char sqlstate[6] = "";
+    if (!succeeded)
+        GetSqlState(sqlstate);
+
+    AddEvent(pSql, cParams, duration, succeeded ? cur->rowcount : -1, sqlstate);
+}
+
+void QueryLog_RecordResult(Cursor* cur)
+{
+    PyObject* pSql = cur->querylog_sql;
+    if (!pSql)
+        return;
+    cur->querylog_sql = 0;
+
+    char sqlstate[6] = "";
+    AddEvent(pSql, cur->querylog_params, cur->querylog_duration, cur->querylog_rows, sqlstate);
+    Py_DECREF(pSql);
+}
+
+PyObject* QueryLog_Drain()
+{
+    // Events older than one ring's worth have been overwritten.
+    UINT64 first = (head - tail > ring_size) ? head - ring_size : tail;
+
+    Object result(PyList_New((Py_ssize_t)(head - first)));
+    if (!result)
+        return 0;
+
+    for (UINT64 i = first; i < head; i++)
+    {
+        QueryEvent& event = ring[i % ring_size];
+
+        PyObject* item;
+        if (event.sqlstate[0])
+            item = Py_BuildValue("(OKndns)", event.sql, event.fingerprint, event.params, (double)event.duration / 1000000000.0,
+                                 event.rows, event.sqlstate);
+        else
+            item = Py_BuildValue("(OKndnO)", event.sql, event.fingerprint, event.params, (double)event.duration / 1000000000.0,
+                                 event.rows, Py_None);
+        if (!item)
+            return 0;
+
+        PyList_SET_ITEM(result.Get(), (Py_ssize_t)(i - first), item);
+    }
+
+    tail = head;
+
+    return result.Detach();
+}
+
+template<typename CHAR>
+static UINT64 FingerprintText(const CHAR* pch, Py_ssize_t cch)
+{
+    // Feeds a normalized form of the SQL to FNV-1a: quoted strings and numbers become '?', runs of whitespace become
+    // a single space, and ASCII letters are lowercased.  This is a scanner, not a parser, which is good enough to
+    // group statements that only differ in their literals.
+
+    const UINT64 FNV_OFFSET = 14695981039346656037ULL;
+    const UINT64 FNV_PRIME  = 1099511628211ULL;
+
+    UINT64 hash = FNV_OFFSET;
+    bool   space = false;           // true if whitespace was skipped and a space should be hashed before the next char
+    bool   ident = false;           // true if the previous character was part of an identifier
+
+    Py_ssize_t i = 0;
+    while (i < cch)
+    {
+        unsigned long ch = (unsigned long)pch[i];
+
+        if (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n')
+        {
+            space = true;
+            ident = false;
+            i++;
+            continue;
+        }
+
+        if (space && hash != FNV_OFFSET)
+            hash = (hash ^ ' ') * FNV_PRIME;
+        space = false;
+
+        if (ch == '\'')
+        {
+            // Skip to the closing quote.  Doubled quotes are escapes and simply look like two adjacent strings.
+            i++;
+            while (i < cch && (unsigned long)pch[i] != '\'')
+                i++;
+            i++;
+            ch    = '?';
+            ident = false;
+        }
+        else if (!ident && ch >= '0' && ch <= '9')
+        {
+            while (i < cch && (((unsigned long)pch[i] >= '0' && (unsigned long)pch[i] <= '9') || (unsigned long)pch[i] == '.'))
+                i++;
+            ch    = '?';
+            ident = false;
+        }
+        else
+        {
+            if (ch >= 'A' && ch <= 'Z')
+                ch += 'a' - 'A';
+            ident = (ch >= 'a' && ch <= 'z') || (ch >= '0' && ch <= '9') || ch == '_' || ch > 127;
+            i++;
+        }
+
+        hash = (hash ^ (ch & 0xFF)) * FNV_PRIME;
+        if (ch > 0xFF)
+            hash = (hash ^ (ch >> 8)) * FNV_PRIME;
+    }
+
+    return hash;
+}
+
+UINT64 SqlFingerprint(PyObject* pSql)
+{
+    if (PyString_Check(pSql))
+        return FingerprintText((const unsigned char*)PyString_AS_STRING(pSql), PyString_GET_SIZE(pSql));
+    return FingerprintText(PyUnicode_AS_UNICODE(pSql), PyUnicode_GET_SIZE(pSql));
+}
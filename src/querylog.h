@@ -0,0 +1,40 @@
+
+#ifndef _QUERYLOG_H_
+#define _QUERYLOG_H_
+
+// A log of recently executed statements for production tracing (the TRACE macro only exists in PYODBC_TRACE builds).
+//
+// Each execute records an event into a fixed-size ring buffer that Python drains in bulk with
+// pyodbc.drain_query_log.  When the ring is full the oldest events are overwritten.  Statements slower than a
+// threshold can also be reported to a Python callback as they are recorded.  Statements that return rows are recorded
+// when they complete, once their results have been fetched or discarded, so the event has the number of rows fetched.
+
+struct Cursor;
+
+// True if the ring buffer or the slow query callback is enabled.  When false, execute does not read the clock.
+extern bool querylog_active;
+
+// Records the execution of `pSql`, which took `duration` nanoseconds.  If `succeeded` is false, an exception is set
+// and its SQLSTATE is recorded.  The exception is preserved.  If the statement created a result set, the event is kept
+// by the cursor until QueryLog_RecordResult so it can include the number of rows fetched.
+void QueryLog_Record(Cursor* cur, PyObject* pSql, Py_ssize_t cParams, UINT64 duration, bool succeeded);
+
+// Records the event kept by the cursor, if any, once its result set has been fetched to the end or is being freed.
+void QueryLog_RecordResult(Cursor* cur);
+
+// Returns a 64-bit FNV-1a hash of the SQL with literals replaced by placeholders, runs of whitespace collapsed, and
+// letters lowercased, so statements differing only in their literal values share a fingerprint.
+UINT64 SqlFingerprint(PyObject* pSql);
+
+// Replaces the ring buffer with an empty one holding `size` events.  A size of zero turns the log off.  Returns false
+// and sets an exception if memory cannot be allocated.
+bool QueryLog_SetSize(Py_ssize_t size);
+
+// Returns a list of the events recorded since the last call, oldest first, and empties the ring.
+PyObject* QueryLog_Drain();
+
+// Sets the callback called for statements taking at least `threshold` nanoseconds.  `callback` may be zero to remove
+// the current one.
+void QueryLog_SetSlowHandler(PyObject* callback, UINT64 threshold);
+
+#endif // _QUERYLOG_H_
@@ -0,0 +1,123 @@
+
+#include "pyodbc.h"
+#include "dbspecific.h"
+#include "sqlwchar.h"
+#include "utf8.h"
+#include "cursor.h"
+#include "getdata.h"
+#include "rawrow.h"
+
+RawBlock* RawBlock_New(size_t size)
+{
+    // The data is kept 8-byte aligned so the RawColumn arrays can be read in place.
+
+    size_t header = (sizeof(RawBlock) + 7) & ~(size_t)7;
+
+    char* p = (char*)pyodbc_malloc(header + size, MEM_RAWROWS);
+    if (p == 0)
+        return 0;
+
+    RawBlock* block = (RawBlock*)p;
+    block->refs = 1;
+    block->size = size;
+    block->used = 0;
+    block->data = p + header;
+    return block;
+}
+
+void RawBlock_Release(RawBlock* block)
+{
+    if (--block->refs == 0)
+        pyodbc_free(block);
+}
+
+PyObject* RawRow_Convert(const char* raw, Py_ssize_t i)
+{
+    const RawColumn& col = ((const RawColumn*)raw)[i];
+    const char* pb = raw + col.offset;
+
+    // Each column's data is 8-byte aligned, but the structures are copied out anyway rather than relying on it.
+
+    switch (col.kind)
+    {
+    case RAW_STR:
+        return PyString_FromStringAndSize(pb, col.length);
+
+    case RAW_UTF8:
+        return PyUnicode_FromUTF8(pb, col.length);
+
+    case RAW_WCHAR:
+        if (sizeof(SQLWCHAR) == Py_UNICODE_SIZE)
+            return PyUnicode_FromUnicode((const Py_UNICODE*)pb, col.length / (Py_ssize_t)sizeof(SQLWCHAR));
+        return PyUnicode_FromSQLWCHAR((const SQLWCHAR*)pb, col.length / (Py_ssize_t)sizeof(SQLWCHAR));
+
+    case RAW_BUFFER:
+    {
+        PyObject* str = PyString_FromStringAndSize(pb, col.length);
+        if (str == 0)
+            return 0;
+        PyObject* buffer = PyBuffer_FromObject(str, 0, col.length);
+        Py_DECREF(str);         // If no buffer, release it.  If buffer, the buffer owns it.
+        return buffer;
+    }
+
+    case RAW_BIT:
+        if (*(const SQLCHAR*)pb == SQL_TRUE)
+            Py_RETURN_TRUE;
+        Py_RETURN_FALSE;
+
+    case RAW_LONG:
+    case RAW_ULONG:
+    {
+        long value;
+        memcpy(&value, pb, sizeof(value));
+        if (col.kind == RAW_ULONG)
+            return PyInt_FromLong(*(SQLINTEGER*)&value);
+        return PyInt_FromLong(value);
+    }
+
+    case RAW_BIGINT:
+    case RAW_UBIGINT:
+    {
+        SQLBIGINT value;
+        memcpy(&value, pb, sizeof(value));
+        if (col.kind == RAW_UBIGINT)
+            return PyLong_FromUnsignedLongLong((unsigned PY_LONG_LONG)(SQLUBIGINT)value);
+        return PyLong_FromLongLong((PY_LONG_LONG)value);
+    }
+
+    case RAW_DOUBLE:
+    {
+        double value;
+        memcpy(&value, pb, sizeof(value));
+        return PyFloat_FromDouble(value);
+    }
+
+    case RAW_DATE:
+    case RAW_TIME:
+    case RAW_DATETIME:
+    {
+        TIMESTAMP_STRUCT value;
+        memcpy(&value, pb, sizeof(value));
+        SQLSMALLINT sql_type = (col.kind == RAW_DATE) ? SQL_TYPE_DATE : (col.kind == RAW_TIME) ? SQL_TYPE_TIME : SQL_TYPE_TIMESTAMP;
+        return TemporalFromStruct(sql_type, value);
+    }
+
+    case RAW_SS_TIME:
+    {
+        SQL_SS_TIME2_STRUCT value;
+        memcpy(&value, pb, sizeof(value));
+
+        TIMESTAMP_STRUCT ts;
+        memset(&ts, 0, sizeof(ts));
+        ts.hour     = value.hour;
+        ts.minute   = value.minute;
+        ts.second   = value.second;
+        ts.fraction = value.fraction;
+        return TemporalFromStruct(SQL_TYPE_TIME, ts);
+    }
+    }
+
+    PyErr_SetString(PyExc_SystemError, "A lazy row column has no data.");
+    return 0;
+}
@@ -0,0 +1,68 @@
+
+#ifndef _RAWROW_H_
+#define _RAWROW_H_
+
+// Lazy rows (see Connection.lazy_rows) keep the data read for each column instead of converting it to a Python object
+// during the fetch, and convert a column the first time it is used.  The data still has to be read with SQLGetData
+// while the cursor is on the row, so this saves the object creation for the columns that are never used, not the
+// reading.
+//
+// The rows' data is packed into RawBlocks shared by the rows in them.  Each row's data starts with an array of
+// RawColumns, one per column, followed by the bytes they refer to.  A block is freed when the cursor has moved on to a
+// new block or to the end of the results and every row in it has been freed or has converted all of its columns.
+
+// How a column's data is converted.
+enum RawKind
+{
+    RAW_NONE,                   // converted during the fetch; the value is already in the row
+    RAW_STR,                    // SQL_C_CHAR text returned as str
+    RAW_UTF8,                   // SQL_C_CHAR text decoded from UTF-8 (see Connection.encoding)
+    RAW_WCHAR,                  // SQLWCHAR text
+    RAW_BUFFER,                 // binary returned as a buffer
+    RAW_BIT,                    // SQLCHAR
+    RAW_LONG,                   // long
+    RAW_ULONG,                  // long, read as SQL_C_ULONG
+    RAW_BIGINT,                 // SQLBIGINT
+    RAW_UBIGINT,                // SQLBIGINT, read as SQL_C_UBIGINT
+    RAW_DOUBLE,                 // double
+    RAW_DATE,                   // TIMESTAMP_STRUCT of an SQL_TYPE_DATE column
+    RAW_TIME,                   // TIMESTAMP_STRUCT of an SQL_TYPE_TIME column
+    RAW_DATETIME,               // TIMESTAMP_STRUCT of any other timestamp column
+    RAW_SS_TIME,                // SQL_SS_TIME2_STRUCT
+};
+
+struct RawColumn
+{
+    int kind;                   // a RawKind
+    Py_ssize_t offset;          // from the start of the row's data; always a multiple of 8
+    Py_ssize_t length;          // bytes
+};
+
+struct RawBlock
+{
+    long refs;                  // the cursor's and those of the rows in the block
+    size_t size;                // bytes in `data`
+    size_t used;
+    char* data;                 // follows the RawBlock in the same allocation
+};
+
+// The size of a new block, unless a row needs more.
+#define RAW_BLOCK_SIZE (64 * 1024)
+
+// Returns a new block with a reference count of 1 that can hold `size` bytes, or zero if memory could not be
+// allocated.  An exception is not set.
+RawBlock* RawBlock_New(size_t size);
+
+inline void RawBlock_AddRef(RawBlock* block)
+{
+    block->refs++;
+}
+
+// Releases a reference, freeing the block when it is the last.  Only called while holding the GIL.
+void RawBlock_Release(RawBlock* block);
+
+// Converts column `i` of the row whose data starts at `raw` to a new Python object.  Returns zero with an exception
+// set if it cannot be converted.
+PyObject* RawRow_Convert(const char* raw, Py_ssize_t i);
+
+#endif // _RAWROW_H_
@@ -0,0 +1,530 @@
+
+#include "pyodbc.h"
+#include "pyodbcmodule.h"
+#include "connection.h"
+#include "cursor.h"
+#include "wrapper.h"
+#include "threads.h"
+#include "resultcache.h"
+
+#include <structmember.h>
+
+// A ResultCache holds the rows of SELECT statements so that executing the same statement with the same parameters
+// again returns them without contacting the database.  It is assigned to connections using Connection.result_cache;
+// one cache can be shared by several connections to the same database.
+//
+// Cursors record the rows as they are fetched (see Cursor_fetch) and add them here once the result set has been read
+// to the end, so nothing extra is read from the database and abandoned result sets are never cached.  Rows are stored
+// as tuples of values, which the cursor turns back into Rows, sharing the description and name map, on a hit.
+//
+// Entries are kept in a doubly-linked list in least-recently-used order and indexed by a dictionary mapping each key to
+// the entry's address.  When adding an entry would exceed the byte budget, entries are evicted from the tail.  Only
+// accessed while holding the GIL.
+
+struct CacheEntry
+{
+    CacheEntry* prev;           // more recently used
+    CacheEntry* next;           // less recently used
+
+    PyObject* key;
+    PyObject* description;
+    PyObject* map_name_to_index;
+    PyObject* rows;             // tuple of value tuples
+
+    UINT64 expires;             // MonotonicMicroseconds() when the entry expires, or 0 if it never does
+    size_t size;                // estimated bytes used by the rows
+};
+
+struct ResultCache
+{
+    PyObject_HEAD
+
+    PyObject* index;            // dict: key -> PyLong address of the CacheEntry
+    CacheEntry* head;           // most recently used
+    CacheEntry* tail;           // least recently used
+
+    Py_ssize_t max_bytes;
+    double ttl;                 // seconds; zero means entries do not expire
+
+    Py_ssize_t bytes;           // the sum of the entries' sizes
+    UINT64 generation;          // incremented whenever every entry is discarded
+    long count;
+    long hits;
+    long misses;
+    long evictions;
+};
+
+
+bool IsSelectStatement(PyObject* pSql)
+{
+    static const char szSelect[] = "select";
+    const size_t cchSelect = _countof(szSelect) - 1;
+
+    Py_ssize_t cch = PyString_Check(pSql) ? PyString_GET_SIZE(pSql) : PyUnicode_GET_SIZE(pSql);
+
+    Py_ssize_t i = 0;
+    for (;;)
+    {
+        if (i == cch)
+            return false;
+
+        int ch = PyString_Check(pSql) ? (unsigned char)PyString_AS_STRING(pSql)[i] : (int)PyUnicode_AS_UNICODE(pSql)[i];
+        if (ch != ' ' && ch != '\t' && ch != '\r' && ch != '\n' && ch != '(')
+            break;
+        i++;
+    }
+
+    if (cch - i <= (Py_ssize_t)cchSelect)
+        return false;
+
+    for (size_t j = 0; j <= cchSelect; j++)
+    {
+        int ch = PyString_Check(pSql) ? (unsigned char)PyString_AS_STRING(pSql)[i + j] : (int)PyUnicode_AS_UNICODE(pSql)[i + j];
+
+        if (j == cchSelect)
+            return !isalnum(ch) && ch != '_';
+
+        if (tolower(ch) != szSelect[j])
+            return false;
+    }
+
+    return false;
+}
+
+
+static PyObject* ConnectionSettings(Connection* cnxn)
+{
+    // Returns the settings of the connection that change the values or description of its results: (unicode_results,
+    // encoding, lowercase, converters), where converters is a tuple of (sqltype, function) pairs.
+
+    Object converters(PyTuple_New(cnxn->conv_count));
+    if (!converters)
+        return 0;
+
+    for (int i = 0; i < cnxn->conv_count; i++)
+    {
+        PyObject* pair = Py_BuildValue("(iO)", (int)cnxn->conv_types[i], cnxn->conv_funcs[i]);
+        if (!pair)
+            return 0;
+        PyTuple_SET_ITEM(converters.Get(), i, pair);
+    }
+
+    return Py_BuildValue("(OOOO)", cnxn->unicode_results ? Py_True : Py_False, cnxn->encoding ? cnxn->encoding : Py_None,
+                         lowercase() ? Py_True : Py_False, converters.Get());
+}
+
+
+PyObject* ResultCache_MakeKey(Connection* cnxn, PyObject* pSql, PyObject* params, bool skip_first)
+{
+    // The key is (sql, values, types, settings).  The types are included since values like 1, 1.0, and True are equal
+    // but are not necessarily bound the same way.  The connection's settings are included since one cache can be
+    // shared by connections that would return the same rows as different objects, such as str instead of unicode.
+
+    Object values;
+    if (params == 0)
+        values = PyTuple_New(0);
+    else if (skip_first)
+        values = PyTuple_GetSlice(params, 1, PyTuple_GET_SIZE(params));
+    else
+        values = PySequence_Tuple(params);
+
+    if (!values)
+    {
+        PyErr_Clear();
+        return 0;
+    }
+
+    Py_ssize_t count = PyTuple_GET_SIZE(values.Get());
+    Object types(PyTuple_New(count));
+    if (!types)
+    {
+        PyErr_Clear();
+        return 0;
+    }
+
+    for (Py_ssize_t i = 0; i < count; i++)
+    {
+        PyObject* type = (PyObject*)Py_TYPE(PyTuple_GET_ITEM(values.Get(), i));
+        Py_INCREF(type);
+        PyTuple_SET_ITEM(types.Get(), i, type);
+    }
+
+    Object settings(ConnectionSettings(cnxn));
+    if (!settings)
+    {
+        PyErr_Clear();
+        return 0;
+    }
+
+    Object key(Py_BuildValue("(OOOO)", pSql, values.Get(), types.Get(), settings.Get()));
+    if (!key || PyObject_Hash(key) == -1)
+    {
+        PyErr_Clear();
+        return 0;
+    }
+
+    return key.Detach();
+}
+
+
+static void Unlink(ResultCache* cache, CacheEntry* entry)
+{
+    if (entry->prev)
+        entry->prev->next = entry->next;
+    else
+        cache->head = entry->next;
+
+    if (entry->next)
+        entry->next->prev = entry->prev;
+    else
+        cache->tail = entry->prev;
+
+    entry->prev = 0;
+    entry->next = 0;
+}
+
+
+static void PushFront(ResultCache* cache, CacheEntry* entry)
+{
+    entry->prev = 0;
+    entry->next = cache->head;
+
+    if (cache->head)
+        cache->head->prev = entry;
+    else
+        cache->tail = entry;
+
+    cache->head = entry;
+}
+
+
+static void Remove(ResultCache* cache, CacheEntry* entry)
+{
+    Unlink(cache, entry);
+
+    if (PyDict_DelItem(cache->index, entry->key) == -1)
+        PyErr_Clear();
+
+    cache->bytes -= entry->size;
+    cache->count--;
+
+    Py_DECREF(entry->key);
+    Py_DECREF(entry->description);
+    Py_DECREF(entry->map_name_to_index);
+    Py_DECREF(entry->rows);
+    pyodbc_free(entry);
+}
+
+
+static CacheEntry* Find(ResultCache* cache, PyObject* key)
+{
+    PyObject* address = PyDict_GetItem(cache->index, key);
+    if (!address)
+        return 0;
+    return (CacheEntry*)PyLong_AsVoidPtr(address);
+}
+
+
+bool ResultCache_Lookup(PyObject* self, PyObject* key, Cursor* cur)
+{
+    ResultCache* cache = (ResultCache*)self;
+
+    CacheEntry* entry = Find(cache, key);
+
+    if (entry && entry->expires != 0 && entry->expires <= MonotonicMicroseconds())
+    {
+        Remove(cache, entry);
+        entry = 0;
+    }
+
+    if (!entry)
+    {
+        cache->misses++;
+        return false;
+    }
+
+    cache->hits++;
+
+    Unlink(cache, entry);
+    PushFront(cache, entry);
+
+    Py_DECREF(cur->description);
+    cur->description = entry->description;
+    Py_INCREF(cur->description);
+
+    cur->map_name_to_index = entry->map_name_to_index;
+    Py_INCREF(cur->map_name_to_index);
+
+    cur->preloaded = entry->rows;
+    Py_INCREF(cur->preloaded);
+    cur->preloaded_pos = 0;
+
+    return true;
+}
+
+
+void ResultCache_Add(PyObject* self, PyObject* key, UINT64 generation, PyObject* description, PyObject* map_name_to_index, PyObject* rows, size_t size)
+{
+    ResultCache* cache = (ResultCache*)self;
+
+    if (generation != cache->generation)
+        return;
+
+    size += sizeof(CacheEntry) + sizeof(PyTupleObject) + sizeof(PyObject*) * PyList_GET_SIZE(rows);
+
+    if (size > (size_t)cache->max_bytes)
+        return;
+
+    CacheEntry* existing = Find(cache, key);
+    if (existing)
+        Remove(cache, existing);
+
+    while (cache->tail && (size_t)cache->bytes + size > (size_t)cache->max_bytes)
+    {
+        Remove(cache, cache->tail);
+        cache->evictions++;
+    }
+
+    Object tuple(PyList_AsTuple(rows));
+    CacheEntry* entry = (CacheEntry*)pyodbc_malloc(sizeof(CacheEntry));
+    Object address(PyLong_FromVoidPtr(entry));
+
+    if (!tuple || !entry || !address || PyDict_SetItem(cache->index, key, address) == -1)
+    {
+        pyodbc_free(entry);
+        PyErr_Clear();
+        return;
+    }
+
+    entry->key               = key;
+    entry->description       = description;
+    entry->map_name_to_index = map_name_to_index;
+    entry->rows              = tuple.Detach();
+    entry->expires           = cache->ttl == 0 ? 0 : MonotonicMicroseconds() + (UINT64)(cache->ttl * 1000000.0);
+    entry->size              = size;
+
+    Py_INCREF(key);
+    Py_INCREF(description);
+    Py_INCREF(map_name_to_index);
+
+    PushFront(cache, entry);
+    cache->bytes += size;
+    cache->count++;
+}
+
+
+static size_t ObjectSize(PyObject* o)
+{
+    if (o == Py_None || o == Py_True || o == Py_False)
+        return 0;
+
+    PyTypeObject* type = Py_TYPE(o);
+
+    size_t size = type->tp_basicsize;
+
+    if (type->tp_itemsize != 0)
+    {
+        Py_ssize_t n = Py_SIZE(o);
+        size += (n < 0 ? -n : n) * type->tp_itemsize;
+    }
+
+    if (PyUnicode_Check(o))
+        size += (PyUnicode_GET_SIZE(o) + 1) * sizeof(Py_UNICODE);
+
+    return size;
+}
+
+
+size_t ResultCache_RowSize(PyObject** apValues, Py_ssize_t cValues)
+{
+    size_t size = sizeof(PyTupleObject) + sizeof(PyObject*) * cValues;
+
+    for (Py_ssize_t i = 0; i < cValues; i++)
+        size += ObjectSize(apValues[i]);
+
+    return size;
+}
+
+
+size_t ResultCache_MaxBytes(PyObject* self)
+{
+    return (size_t)((ResultCache*)self)->max_bytes;
+}
+
+
+static void ClearEntries(ResultCache* cache)
+{
+    while (cache->head)
+        Remove(cache, cache->head);
+}
+
+
+void ResultCache_Invalidate(PyObject* self)
+{
+    ResultCache* cache = (ResultCache*)self;
+    ClearEntries(cache);
+    cache->generation++;
+}
+
+
+UINT64 ResultCache_Generation(PyObject* self)
+{
+    return ((ResultCache*)self)->generation;
+}
+
+
+static char* ResultCache_kwnames[] = { "max_bytes", "ttl", 0 };
+
+static PyObject* ResultCache_new(PyTypeObject* type, PyObject* args, PyObject* kwargs)
+{
+    Py_ssize_t max_bytes = 16 * 1024 * 1024;
+    double ttl = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|nd", ResultCache_kwnames, &max_bytes, &ttl))
+        return 0;
+
+    if (max_bytes < 0 || ttl < 0)
+    {
+        PyErr_SetString(PyExc_ValueError, "max_bytes and ttl cannot be negative.");
+        return 0;
+    }
+
+    ResultCache* cache = PyObject_NEW(ResultCache, type);
+    if (!cache)
+        return 0;
+
+    cache->head       = 0;
+    cache->tail       = 0;
+    cache->max_bytes  = max_bytes;
+    cache->ttl        = ttl;
+    cache->bytes      = 0;
+    cache->generation = 0;
+    cache->count      = 0;
+    cache->hits       = 0;
+    cache->misses     = 0;
+    cache->evictions  = 0;
+
+    cache->index = PyDict_New();
+    if (!cache->index)
+    {
+        PyObject_Del(cache);
+        return 0;
+    }
+
+    return (PyObject*)cache;
+}
+
+
+static void ResultCache_dealloc(ResultCache* cache)
+{
+    ClearEntries(cache);
+    Py_DECREF(cache->index);
+    PyObject_Del(cache);
+}
+
+
+static char clear_doc[] =
+    "clear() --> None\n"
+    "\n"
+    "Discards every cached result, including those currently being read.  The\n"
+    "statistics are not reset.";
+
+static PyObject* ResultCache_clear(PyObject* self, PyObject* args)
+{
+    UNUSED(args);
+    ResultCache_Invalidate(self);
+    Py_RETURN_NONE;
+}
+
+
+static PyObject* ResultCache_gethitratio(PyObject* self, void* closure)
+{
+    UNUSED(closure);
+
+    ResultCache* cache = (ResultCache*)self;
+    long lookups = cache->hits + cache->misses;
+    return PyFloat_FromDouble(lookups == 0 ? 0.0 : (double)cache->hits / (double)lookups);
+}
+
+
+static PyMethodDef ResultCache_methods[] =
+{
+    { "clear", (PyCFunction)ResultCache_clear, METH_NOARGS, clear_doc },
+    { 0, 0, 0, 0 }
+};
+
+static PyMemberDef ResultCache_members[] =
+{
+    { "max_bytes", T_PYSSIZET, offsetof(ResultCache, max_bytes), READONLY, "The most memory, in bytes, the cached rows may use." },
+    { "ttl",       T_DOUBLE,   offsetof(ResultCache, ttl),       READONLY, "The number of seconds results are cached, or zero if they do not expire." },
+    { "bytes",     T_PYSSIZET, offsetof(ResultCache, bytes),     READONLY, "The estimated memory, in bytes, used by the cached rows." },
+    { "count",     T_LONG,     offsetof(ResultCache, count),     READONLY, "The number of cached results." },
+    { "hits",      T_LONG,     offsetof(ResultCache, hits),      READONLY, "The number of executes answered from the cache." },
+    { "misses",    T_LONG,     offsetof(ResultCache, misses),    READONLY, "The number of cacheable executes that were not in the cache." },
+    { "evictions", T_LONG,     offsetof(ResultCache, evictions), READONLY, "The number of results discarded to stay within max_bytes." },
+    { 0 }
+};
+
+static PyGetSetDef ResultCache_getseters[] =
+{
+    { "hit_ratio", ResultCache_gethitratio, 0, "hits / (hits + misses), or 0.0 if there have been no lookups.", 0 },
+    { 0 }
+};
+
+static char resultcache_doc[] =
+    "ResultCache(max_bytes=16777216, ttl=0) --> ResultCache\n"
+    "\n"
+    "A cache of SELECT results, keyed by the SQL and parameter values.  Assign it to\n"
+    "Connection.result_cache to use it.  Results are added once they have been\n"
+    "fetched to the end and are evicted, least recently used first, when the\n"
+    "estimated memory used would exceed max_bytes.  If ttl is non-zero, results\n"
+    "expire after that many seconds.";
+
+PyTypeObject ResultCacheType =
+{
+    PyObject_HEAD_INIT(0)
+    0,                                                      // ob_size
+    "pyodbc.ResultCache",                                   // tp_name
+    sizeof(ResultCache),                                    // tp_basicsize
+    0,                                                      // tp_itemsize
+    (destructor)ResultCache_dealloc,                        // destructor tp_dealloc
+    0,                                                      // tp_print
+    0,                                                      // tp_getattr
+    0,                                                      // tp_setattr
+    0,                                                      // tp_compare
+    0,                                                      // tp_repr
+    0,                                                      // tp_as_number
+    0,                                                      // tp_as_sequence
+    0,                                                      // tp_as_mapping
+    0,                                                      // tp_hash
+    0,                                                      // tp_call
+    0,                                                      // tp_str
+    0,                                                      // tp_getattro
+    0,                                                      // tp_setattro
+    0,                                                      // tp_as_buffer
+    Py_TPFLAGS_DEFAULT,                                     // tp_flags
+    resultcache_doc,                                        // tp_doc
+    0,                                                      // tp_traverse
+    0,                                                      // tp_clear
+    0,                                                      // tp_richcompare
+    0,                                                      // tp_weaklistoffset
+    0,                                                      // tp_iter
+    0,                                                      // tp_iternext
+    ResultCache_methods,                                    // tp_methods
+    ResultCache_members,                                    // tp_members
+    ResultCache_getseters,                                  // tp_getset
+    0,                                                      // tp_base
+    0,                                                      // tp_dict
+    0,                                                      // tp_descr_get
+    0,                                                      // tp_descr_set
+    0,                                                      // tp_dictoffset
+    0,                                                      // tp_init
+    0,                                                      // tp_alloc
+    ResultCache_new,                                        // tp_new
+    0,                                                      // tp_free
+    0,                                                      // tp_is_gc
+    0,                                                      // tp_bases
+    0,                                                      // tp_mro
+    0,                                                      // tp_cache
+    0,                                                      // tp_subclasses
+    0,                                                      // tp_weaklist
+};
@@ -0,0 +1,43 @@
+
+#ifndef _RESULTCACHE_H_
+#define _RESULTCACHE_H_
+
+struct Cursor;
+struct Connection;
+
+extern PyTypeObject ResultCacheType;
+
+#define ResultCache_Check(op) PyObject_TypeCheck(op, &ResultCacheType)
+
+// Returns true if the SQL statement is a SELECT and its results can be cached.  This only looks at the first keyword.
+bool IsSelectStatement(PyObject* pSql);
+
+// Returns the cache key for executing pSql on `cnxn` with the given parameters (see the execute function for the meaning
+// of params and skip_first), or zero if the statement cannot be cached, such as when a parameter is not hashable.  An
+// exception is never set.
+PyObject* ResultCache_MakeKey(Connection* cnxn, PyObject* pSql, PyObject* params, bool skip_first);
+
+// Looks up `key`.  If it is cached, the cursor is set up to return the cached rows (see Cursor.preloaded) and true is
+// returned.  Must be called after the cursor's previous results are freed.
+bool ResultCache_Lookup(PyObject* cache, PyObject* key, Cursor* cur);
+
+// Adds the rows of a completely fetched result set.  `rows` is a list of value tuples and `size` is the estimate
+// returned by ResultCache_RowSize for all of them.  `generation` is the ResultCache_Generation value from when the
+// statement was executed; if the cache has been invalidated since, the rows may be stale and are not added.  An
+// exception is never set; if the entry cannot be added it is simply not cached.
+void ResultCache_Add(PyObject* cache, PyObject* key, UINT64 generation, PyObject* description, PyObject* map_name_to_index, PyObject* rows, size_t size);
+
+// Discards every cached result because the database has been changed.  Results being read when this is called are not
+// added either.
+void ResultCache_Invalidate(PyObject* cache);
+
+// Returns a value that changes whenever the cache is invalidated.
+UINT64 ResultCache_Generation(PyObject* cache);
+
+// Returns an estimate of the memory used by a row's values.
+size_t ResultCache_RowSize(PyObject** apValues, Py_ssize_t cValues);
+
+// Returns the most bytes that can be cached for one result set.  Cursors stop recording rows after this.
+size_t ResultCache_MaxBytes(PyObject* cache);
+
+#endif // _RESULTCACHE_H_
@@ -12,6 +12,7 @@
 #include "pyodbc.h"
 #include "pyodbcmodule.h"
 #include "row.h"
+#include "rawrow.h"
 #include "wrapper.h"
 
 struct Row
@@ -31,8 +32,14 @@ struct Row
     // The number of values in apValues.
     Py_ssize_t cValues;
 
-    // The column values, stored as an array.
+    // The column values, stored as an array.  In a lazy row, the values not used yet are zero.
     PyObject** apValues;
+
+    // For lazy rows, the RawBlock holding the row's data, which starts at `raw`, and the number of values that have not
+    // been converted.  The block is released once they all have been.  Zero for other rows.
+    RawBlock* block;
+    const char* raw;
+    Py_ssize_t cPending;
 };
 
 #define Row_Check(op) PyObject_TypeCheck(op, &RowType)
@@ -55,6 +62,8 @@ static void Row_dealloc(Row* self)
     Py_XDECREF(self->description);
     Py_XDECREF(self->map_name_to_index);
     FreeRowValues(self->cValues, self->apValues);
+    if (self->block)
+        RawBlock_Release(self->block);
     PyObject_Del(self);
 }
 
@@ -72,6 +81,9 @@ Row* Row_New(PyObject* description, PyObject* map_name_to_index, Py_ssize_t cVal
         row->map_name_to_index = map_name_to_index;
         row->apValues          = apValues;
         row->cValues           = cValues;
+        row->block             = 0;
+        row->raw               = 0;
+        row->cPending          = 0;
     }
     else
     {
@@ -81,6 +93,58 @@ Row* Row_New(PyObject* description, PyObject* map_name_to_index, Py_ssize_t cVal
     return row;
 }
 
+Row* Row_NewLazy(PyObject* description, PyObject* map_name_to_index, Py_ssize_t cValues, PyObject** apValues,
+                 RawBlock* block, const char* raw)
+{
+    Row* row = Row_New(description, map_name_to_index, cValues, apValues);
+
+    if (row)
+    {
+        for (Py_ssize_t i = 0; i < cValues; i++)
+            if (apValues[i] == 0)
+                row->cPending++;
+
+        if (row->cPending)
+        {
+            RawBlock_AddRef(block);
+            row->block = block;
+            row->raw   = raw;
+        }
+    }
+
+    return row;
+}
+
+static void ReleaseBlock(Row* self)
+{
+    if (self->block)
+    {
+        RawBlock_Release(self->block);
+        self->block = 0;
+        self->raw   = 0;
+    }
+}
+
+static PyObject* Row_GetValue(Row* self, Py_ssize_t i)
+{
+    // Returns a borrowed reference to value `i`, converting it first if this is a lazy row and it has not been used.
+    // Returns zero with an exception set if it cannot be converted.
+
+    PyObject* value = self->apValues[i];
+    if (value)
+        return value;
+
+    value = RawRow_Convert(self->raw, i);
+    if (!value)
+        return 0;
+
+    self->apValues[i] = value;
+    if (--self->cPending == 0)
+        ReleaseBlock(self);
+
+    return value;
+}
+
 static PyObject*
 Row_getattro(PyObject* o, PyObject* name)
 {
@@ -94,8 +158,9 @@ Row_getattro(PyObject* o, PyObject* name)
     {
         // REVIEW: How is this going to work on a 64-bit system?  First, will the value be a PyInt or a PyLong?  
         Py_ssize_t i = PyInt_AsSsize_t(index);
-        Py_INCREF(self->apValues[i]);
-        return self->apValues[i];
+        PyObject* value = Row_GetValue(self, i);
+        Py_XINCREF(value);
+        return value;
     }
 
     return PyObject_GenericGetAttr(o, name);
@@ -116,10 +181,15 @@ Row_contains(Row *self, PyObject *el)
 
     int cmp = 0;
 
-	for (Py_ssize_t i = 0, c = self->cValues ; cmp == 0 && i < c; ++i)
-		cmp = PyObject_RichCompareBool(el, self->apValues[i], Py_EQ);
+    for (Py_ssize_t i = 0, c = self->cValues ; cmp == 0 && i < c; ++i)
+    {
+        PyObject* value = Row_GetValue(self, i);
+        if (!value)
+            return -1;
+        cmp = PyObject_RichCompareBool(el, value, Py_EQ);
+    }
 
-	return cmp;
+    return cmp;
 }
 
 static PyObject *
@@ -133,8 +203,9 @@ Row_item(Row* self, Py_ssize_t i)
 		return NULL;
 	}
 
-	Py_INCREF(self->apValues[i]);
-	return self->apValues[i];
+    PyObject* value = Row_GetValue(self, i);
+	Py_XINCREF(value);
+	return value;
 }
 
 
@@ -149,7 +220,15 @@ Row_ass_item(Row* self, Py_ssize_t i, PyObject* v)
 		return -1;
 	}
 
-    Py_XDECREF(self->apValues[i]);
+    if (self->apValues[i])
+    {
+        Py_DECREF(self->apValues[i]);
+    }
+    else if (--self->cPending == 0)
+    {
+        ReleaseBlock(self);
+    }
+
     Py_INCREF(v);
     self->apValues[i] = v;
 
@@ -199,7 +278,12 @@ Row_slice(PyObject* o, Py_ssize_t iFirst, Py_ssize_t iMax)
 
     for (Py_ssize_t i = 0; i < len; i++)
     {
-        PyObject* item = self->apValues[iFirst + i];
+        PyObject* item = Row_GetValue(self, iFirst + i);
+        if (!item)
+        {
+            Py_DECREF(result);
+            return 0;
+        }
         PyTuple_SET_ITEM(result, i, item);
         Py_INCREF(item);
     }
@@ -221,7 +305,10 @@ Row_repr(PyObject* o)
 
     for (Py_ssize_t i = 0; i < self->cValues; i++)
     {
-        PyObject* piece = PyObject_Repr(self->apValues[i]);
+        PyObject* value = Row_GetValue(self, i);
+        if (!value)
+            return 0;
+        PyObject* piece = PyObject_Repr(value);
         if (!piece)
             return 0;
         PyTuple_SET_ITEM(pieces.Get(), i, piece);
@@ -274,8 +361,14 @@ static PyObject* Row_richcompare(PyObject* olhs, PyObject* orhs, int op)
     }
 
     for (Py_ssize_t i = 0, c = lhs->cValues; i < c; i++)
-        if (!PyObject_RichCompareBool(lhs->apValues[i], rhs->apValues[i], Py_EQ))
-            return PyObject_RichCompare(lhs->apValues[i], rhs->apValues[i], op);
+    {
+        PyObject* lvalue = Row_GetValue(lhs, i);
+        PyObject* rvalue = Row_GetValue(rhs, i);
+        if (!lvalue || !rvalue)
+            return 0;
+        if (!PyObject_RichCompareBool(lvalue, rvalue, Py_EQ))
+            return PyObject_RichCompare(lvalue, rvalue, op);
+    }
 
     // All items are equal.
     switch (op)
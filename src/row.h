@@ -21,6 +21,15 @@ struct Row;
  */
 Row* Row_New(PyObject* description, PyObject* map_name_to_index, Py_ssize_t cValues, PyObject** apValues);
 
+struct RawBlock;
+
+/*
+ * Used to make a new lazy row (see rawrow.h).  The zero entries in apValues are converted from the row's data at `raw`,
+ * which is in `block`, the first time they are used.  The row adds a reference to the block.
+ */
+Row* Row_NewLazy(PyObject* description, PyObject* map_name_to_index, Py_ssize_t cValues, PyObject** apValues,
+                 RawBlock* block, const char* raw);
+
 /*
  * Dereferences each object in apValues and frees apValue.  This is the internal format used by rows.
  *
@@ -2,20 +2,201 @@
 #include "pyodbc.h"
 #include "sqlwchar.h"
 #include "wrapper.h"
+#include "kernelbench.h"
+#include "cpufeatures.h"
 
 
-static bool sqlwchar_copy(SQLWCHAR* pdest, const Py_UNICODE* psrc, Py_ssize_t len)
+static void RaiseTooLarge(Py_UNICODE ch)
 {
-    for (int i = 0; i <= len; i++) // ('<=' to include the NULL)
+    PyErr_Format(PyExc_ValueError, "Cannot convert from Unicode %zd to SQLWCHAR.  Value is too large.", (Py_ssize_t)ch);
+}
+
+#ifdef SQLWCHAR_WIDEN
+
+// Narrowing from UCS4 to UTF-16.  Characters outside the BMP are rare, so blocks without any are narrowed with SIMD
+// and only the blocks that have them are encoded one character at a time.
+
+static Py_ssize_t NarrowScalar(SQLWCHAR* dest, const Py_UNICODE* src, Py_ssize_t len)
+{
+    // Returns the number of SQLWCHARs written, or -1 with an exception set.
+
+    SQLWCHAR* p = dest;
+    for (Py_ssize_t i = 0; i < len; i++)
     {
-        pdest[i] = (SQLWCHAR)psrc[i];
-        if ((Py_UNICODE)pdest[i] < psrc[i])
+        Py_UNICODE ch = src[i];
+        if (ch <= 0xFFFF)
+        {
+            *p++ = (SQLWCHAR)ch;
+        }
+        else if (ch <= 0x10FFFF)
         {
-            PyErr_Format(PyExc_ValueError, "Cannot convert from Unicode %zd to SQLWCHAR.  Value is too large.", (Py_ssize_t)psrc[i]);
-            return false;
+            ch -= 0x10000;
+            *p++ = (SQLWCHAR)(0xD800 + (ch >> 10));
+            *p++ = (SQLWCHAR)(0xDC00 + (ch & 0x3FF));
+        }
+        else
+        {
+            RaiseTooLarge(ch);
+            return -1;
         }
     }
-    return true;
+    return p - dest;
+}
+
+static Py_ssize_t CountScalar(const Py_UNICODE* src, Py_ssize_t len)
+{
+    // Returns the number of characters outside the BMP.
+
+    Py_ssize_t count = 0;
+    for (Py_ssize_t i = 0; i < len; i++)
+    {
+        if (src[i] > 0xFFFF)
+            count++;
+    }
+    return count;
+}
+
+#ifdef PYODBC_SSE2
+inline bool IsBMP(__m128i v)
+{
+    return _mm_movemask_epi8(_mm_cmpeq_epi32(_mm_srli_epi32(v, 16), _mm_setzero_si128())) == 0xFFFF;
+}
+
+static Py_ssize_t NarrowSSE2(SQLWCHAR* dest, const Py_UNICODE* src, Py_ssize_t len)
+{
+    SQLWCHAR* p = dest;
+    Py_ssize_t i = 0;
+
+    for (; i + 8 <= len; i += 8)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i*)&src[i]);
+        __m128i b = _mm_loadu_si128((const __m128i*)&src[i + 4]);
+
+        if (!IsBMP(_mm_or_si128(a, b)))
+        {
+            Py_ssize_t cch = NarrowScalar(p, &src[i], 8);
+            if (cch == -1)
+                return -1;
+            p += cch;
+            continue;
+        }
+
+        // SSE2 only has a signed pack, so sign extend the low 16 bits first to keep it from saturating.
+        a = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16);
+        b = _mm_srai_epi32(_mm_slli_epi32(b, 16), 16);
+        _mm_storeu_si128((__m128i*)p, _mm_packs_epi32(a, b));
+        p += 8;
+    }
+
+    Py_ssize_t cch = NarrowScalar(p, &src[i], len - i);
+    if (cch == -1)
+        return -1;
+    return (p - dest) + cch;
+}
+
+static Py_ssize_t CountSSE2(const Py_UNICODE* src, Py_ssize_t len)
+{
+    Py_ssize_t count = 0;
+    Py_ssize_t i = 0;
+
+    for (; i + 8 <= len; i += 8)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i*)&src[i]);
+        __m128i b = _mm_loadu_si128((const __m128i*)&src[i + 4]);
+        if (!IsBMP(_mm_or_si128(a, b)))
+            count += CountScalar(&src[i], 8);
+    }
+
+    return count + CountScalar(&src[i], len - i);
+}
+#endif
+
+#ifdef PYODBC_AVX2
+PYODBC_TARGET_AVX2
+static Py_ssize_t NarrowAVX2(SQLWCHAR* dest, const Py_UNICODE* src, Py_ssize_t len)
+{
+    // The same as NarrowSSE2, 16 characters at a time.
+
+    const __m256i high = _mm256_set1_epi32((int)0xFFFF0000);
+
+    SQLWCHAR* p = dest;
+    Py_ssize_t i = 0;
+
+    for (; i + 16 <= len; i += 16)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i*)&src[i]);
+        __m256i b = _mm256_loadu_si256((const __m256i*)&src[i + 8]);
+
+        if (!_mm256_testz_si256(_mm256_or_si256(a, b), high))
+        {
+            Py_ssize_t cch = NarrowScalar(p, &src[i], 16);
+            if (cch == -1)
+                return -1;
+            p += cch;
+            continue;
+        }
+
+        // The pack works within each 128-bit lane, so the middle two 64-bit blocks have to be swapped afterward.
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(a, b), 0xD8);
+        _mm256_storeu_si256((__m256i*)p, packed);
+        p += 16;
+    }
+
+    Py_ssize_t cch = NarrowScalar(p, &src[i], len - i);
+    if (cch == -1)
+        return -1;
+    return (p - dest) + cch;
+}
+#endif
+
+#endif // SQLWCHAR_WIDEN
+
+Py_ssize_t SQLWCHAR_Length(const Py_UNICODE* pch, Py_ssize_t len)
+{
+#if defined(SQLWCHAR_WIDEN) && defined(PYODBC_SSE2)
+    return len + CountSSE2(pch, len);
+#elif defined(SQLWCHAR_WIDEN)
+    return len + CountScalar(pch, len);
+#else
+    UNUSED(pch);
+    return len;
+#endif
+}
+
+Py_ssize_t SQLWCHAR_Copy(SQLWCHAR* dest, const Py_UNICODE* src, Py_ssize_t len)
+{
+#if SQLWCHAR_SIZE == Py_UNICODE_SIZE
+    memcpy(dest, src, sizeof(SQLWCHAR) * len);
+    dest[len] = 0;
+    return len;
+#elif defined(SQLWCHAR_WIDEN)
+    Py_ssize_t cch;
+#ifdef PYODBC_AVX2
+    if (cpu_has_avx2)
+        cch = NarrowAVX2(dest, src, len);
+    else
+#endif
+#ifdef PYODBC_SSE2
+    cch = NarrowSSE2(dest, src, len);
+#else
+    cch = NarrowScalar(dest, src, len);
+#endif
+    if (cch != -1)
+        dest[cch] = 0;
+    return cch;
+#else
+    for (Py_ssize_t i = 0; i < len; i++)
+    {
+        dest[i] = (SQLWCHAR)src[i];
+        if ((Py_UNICODE)dest[i] < src[i])
+        {
+            RaiseTooLarge(src[i]);
+            return -1;
+        }
+    }
+    dest[len] = 0;
+    return len;
+#endif
 }
 
 SQLWChar::SQLWChar(PyObject* o)
@@ -59,27 +240,138 @@ bool SQLWChar::Convert(PyObject* o)
     owns_memory = false;
     return true;
 #else
-    SQLWCHAR* pchT = (SQLWCHAR*)pyodbc_malloc(sizeof(SQLWCHAR) * (lenT + 1));
+    SQLWCHAR* pchT = (SQLWCHAR*)pyodbc_malloc(sizeof(SQLWCHAR) * (SQLWCHAR_Length(pU, lenT) + 1), MEM_SQLWCHAR);
     if (pchT == 0)
     {
         PyErr_NoMemory();
         return false;
     }
 
-    if (!sqlwchar_copy(pchT, pU, lenT))
+    Py_ssize_t cch = SQLWCHAR_Copy(pchT, pU, lenT);
+    if (cch == -1)
     {
         pyodbc_free(pchT);
         return false;
     }
     
     pch = pchT;
-    len = lenT;
+    len = cch;
     owns_memory = true;
     return true;
 #endif
 }
 
 
+#ifdef SQLWCHAR_WIDEN
+
+inline bool IsSurrogate(unsigned int ch)
+{
+    return (ch & 0xF800) == 0xD800;
+}
+
+static bool WidenScalar(Py_UNICODE* dest, const SQLWCHAR* src, Py_ssize_t start, Py_ssize_t end)
+{
+    // Widens src[start:end] from the end backward.  Each Py_UNICODE written is at least twice as far into the buffer
+    // as the SQLWCHARs not yet read, so this is safe when src and dest are the same memory.
+
+    bool surrogates = false;
+    for (Py_ssize_t i = end - 1; i >= start; i--)
+    {
+        SQLWCHAR ch = src[i];
+        surrogates |= IsSurrogate(ch);
+        dest[i] = (Py_UNICODE)ch;
+    }
+    return surrogates;
+}
+
+#ifdef PYODBC_SSE2
+static bool WidenSSE2(Py_UNICODE* dest, const SQLWCHAR* src, Py_ssize_t cch)
+{
+    // The same as WidenScalar, 8 characters at a time.  Each block is loaded completely before it is stored.
+
+    Py_ssize_t blocks = cch & ~(Py_ssize_t)7;
+    bool surrogates = WidenScalar(dest, src, blocks, cch);
+
+    const __m128i zero  = _mm_setzero_si128();
+    const __m128i mask  = _mm_set1_epi16((short)0xF800);
+    const __m128i range = _mm_set1_epi16((short)0xD800);
+    __m128i found = _mm_setzero_si128();
+
+    for (Py_ssize_t i = blocks - 8; i >= 0; i -= 8)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)&src[i]);
+        found = _mm_or_si128(found, _mm_cmpeq_epi16(_mm_and_si128(v, mask), range));
+        _mm_storeu_si128((__m128i*)&dest[i + 4], _mm_unpackhi_epi16(v, zero));
+        _mm_storeu_si128((__m128i*)&dest[i], _mm_unpacklo_epi16(v, zero));
+    }
+
+    return surrogates || _mm_movemask_epi8(found) != 0;
+}
+#endif
+
+#ifdef PYODBC_AVX2
+PYODBC_TARGET_AVX2
+static bool WidenAVX2(Py_UNICODE* dest, const SQLWCHAR* src, Py_ssize_t cch)
+{
+    // The same as WidenScalar, 16 characters at a time.
+
+    Py_ssize_t blocks = cch & ~(Py_ssize_t)15;
+    bool surrogates = WidenScalar(dest, src, blocks, cch);
+
+    const __m256i mask  = _mm256_set1_epi16((short)0xF800);
+    const __m256i range = _mm256_set1_epi16((short)0xD800);
+    __m256i found = _mm256_setzero_si256();
+
+    for (Py_ssize_t i = blocks - 16; i >= 0; i -= 16)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i*)&src[i]);
+        found = _mm256_or_si256(found, _mm256_cmpeq_epi16(_mm256_and_si256(v, mask), range));
+        __m256i lo = _mm256_cvtepu16_epi32(_mm256_castsi256_si128(v));
+        __m256i hi = _mm256_cvtepu16_epi32(_mm256_extracti128_si256(v, 1));
+        _mm256_storeu_si256((__m256i*)&dest[i + 8], hi);
+        _mm256_storeu_si256((__m256i*)&dest[i], lo);
+    }
+
+    return surrogates || _mm256_movemask_epi8(found) != 0;
+}
+#endif
+
+bool WidenSQLWCHAR(Py_UNICODE* dest, const SQLWCHAR* src, Py_ssize_t cch)
+{
+#ifdef PYODBC_AVX2
+    if (cpu_has_avx2)
+        return WidenAVX2(dest, src, cch);
+#endif
+#ifdef PYODBC_SSE2
+    return WidenSSE2(dest, src, cch);
+#else
+    return WidenScalar(dest, src, 0, cch);
+#endif
+}
+
+Py_ssize_t CombineSurrogates(Py_UNICODE* pch, Py_ssize_t cch)
+{
+    // Nothing moves until the first high surrogate, so skip to it.
+    Py_ssize_t i = 0;
+    while (i < cch && (pch[i] < 0xD800 || pch[i] > 0xDBFF))
+        i++;
+
+    Py_ssize_t cchOut = i;
+    for (; i < cch; i++)
+    {
+        Py_UNICODE ch = pch[i];
+        if (ch >= 0xD800 && ch <= 0xDBFF && i + 1 < cch && pch[i + 1] >= 0xDC00 && pch[i + 1] <= 0xDFFF)
+        {
+            ch = 0x10000 + (((ch - 0xD800) << 10) | (pch[i + 1] - 0xDC00));
+            i++;
+        }
+        pch[cchOut++] = ch;
+    }
+    return cchOut;
+}
+
+#endif // SQLWCHAR_WIDEN
+
 PyObject* PyUnicode_FromSQLWCHAR(const SQLWCHAR* sz, Py_ssize_t cch)
 {
 #if SQLWCHAR_SIZE == Py_UNICODE_SIZE
@@ -92,6 +384,28 @@ PyObject* PyUnicode_FromSQLWCHAR(const SQLWCHAR* sz, Py_ssize_t cch)
     // use it.
     return PyUnicode_FromWideChar((const wchar_t*)sz, cch);
 
+#elif defined(SQLWCHAR_WIDEN)
+
+    Object result(PyUnicode_FromUnicode(0, cch));
+    if (!result)
+        return 0;
+
+    Py_UNICODE* pch = PyUnicode_AS_UNICODE(result.Get());
+    if (!WidenSQLWCHAR(pch, sz, cch))
+        return result.Detach();
+
+    Py_ssize_t cchOut = CombineSurrogates(pch, cch);
+    if (cchOut == cch)
+        return result.Detach();
+
+    PyObject* tmp = result.Detach();
+    if (PyUnicode_Resize(&tmp, cchOut) == -1)
+    {
+        Py_DECREF(tmp);
+        return 0;
+    }
+    return tmp;
+
 #else
 
     Object result(PyUnicode_FromUnicode(0, cch));
@@ -146,17 +460,3 @@ void SQLWChar::dump()
     }
 }
 
-
-SQLWCHAR* SQLWCHAR_FromUnicode(const Py_UNICODE* pch, Py_ssize_t len)
-{
-    SQLWCHAR* p = (SQLWCHAR*)pyodbc_malloc(sizeof(SQLWCHAR) * len);
-    if (p != 0)
-    {
-        if (!sqlwchar_copy(p, pch, len))
-        {
-            pyodbc_free(p);
-            p = 0;
-        }
-    }
-    return p;
-}
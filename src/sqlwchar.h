@@ -54,8 +54,28 @@ public:
 // Allocate a new Unicode object, initialized from the given SQLWCHAR string.
 PyObject* PyUnicode_FromSQLWCHAR(const SQLWCHAR* sz, Py_ssize_t cch);
 
-#if SQLWCHAR_SIZE != Py_UNCODE_SIZE
-SQLWCHAR* SQLWCHAR_FromUnicode(const Py_UNICODE* pch, Py_ssize_t len);
+// Returns the number of SQLWCHARs needed for `len` characters, not including a NULL terminator.  This is more than
+// `len` when SQLWCHAR is UTF-16 and the text has characters outside the BMP, which are written as surrogate pairs.
+Py_ssize_t SQLWCHAR_Length(const Py_UNICODE* pch, Py_ssize_t len);
+
+// Copies `len` characters to `dest`, which must have room for SQLWCHAR_Length(src, len) + 1 SQLWCHARs, and adds a NULL
+// terminator.  Returns the number of SQLWCHARs written, not including the NULL, or -1 with an exception set if a
+// character cannot be represented as SQLWCHAR.
+Py_ssize_t SQLWCHAR_Copy(SQLWCHAR* dest, const Py_UNICODE* src, Py_ssize_t len);
+
+#if SQLWCHAR_SIZE == 2 && Py_UNICODE_SIZE == 4
+// UCS4 builds of Python with a 2-byte SQLWCHAR, which is UTF-16, such as most Linux distributions with unixODBC.  Text
+// is widened when read and narrowed by SQLWCHAR_Copy when written.
+#define SQLWCHAR_WIDEN 1
+
+// Widens `cch` SQLWCHARs to Py_UNICODE.  The data is processed from the end backward, so `src` may be the start of
+// `dest` itself, which lets text read into the front of a Unicode object be widened in place.  Returns true if there
+// are any surrogates, in which case CombineSurrogates must be called.
+bool WidenSQLWCHAR(Py_UNICODE* dest, const SQLWCHAR* src, Py_ssize_t cch);
+
+// Replaces each UTF-16 surrogate pair in the widened text with the character it encodes and returns the new length.
+// Unpaired surrogates are left as they are.
+Py_ssize_t CombineSurrogates(Py_UNICODE* pch, Py_ssize_t cch);
 #endif
 
 #endif // _PYODBCSQLWCHAR_H
@@ -0,0 +1,136 @@
+
+#include "pyodbc.h"
+#include "threads.h"
+#include "stats.h"
+#include "connection.h"
+#include "cursor.h"
+
+bool stats_enabled = false;
+
+PyObject* gil_warning_callback  = 0;
+UINT64    gil_warning_threshold = 0;
+
+void Stats_Add(Cursor* cur, UINT64 Stats::* field, UINT64 value)
+{
+    cur->stats.*field += value;
+    if (cur->cnxn)
+        cur->cnxn->stats.*field += value;
+}
+
+void Stats_Max(Cursor* cur, UINT64 Stats::* field, UINT64 value)
+{
+    if (value > cur->stats.*field)
+        cur->stats.*field = value;
+    if (cur->cnxn && value > cur->cnxn->stats.*field)
+        cur->cnxn->stats.*field = value;
+}
+
+void Stats_SetGilWarningHandler(PyObject* callback, UINT64 threshold)
+{
+    Py_XINCREF(callback);
+    Py_XDECREF(gil_warning_callback);
+    gil_warning_callback  = callback;
+    gil_warning_threshold = threshold;
+}
+
+void GilClock_Begin(Cursor* cur)
+{
+    if (!stats_enabled && !gil_warning_callback)
+        return;
+
+    memset(&cur->gilclock, 0, sizeof(cur->gilclock));
+    cur->gilclock.mark = MonotonicNanoseconds();
+}
+
+static void CallGilWarningHandler(Cursor* cur, UINT64 longest, Py_ssize_t rows)
+{
+    // Like the slow query handler, any exception from the fetch is preserved and errors from the callback are only
+    // reported.
+
+    PyObject *type, *value, *traceback;
+    PyErr_Fetch(&type, &value, &traceback);
+
+    PyObject* callback = gil_warning_callback;
+    Py_INCREF(callback);
+
+    PyObject* result = PyObject_CallFunction(callback, "Odn", cur, (double)longest / 1000000000.0, rows);
+    if (result)
+        Py_DECREF(result);
+    else
+        PyErr_WriteUnraisable(callback);
+
+    Py_DECREF(callback);
+
+    PyErr_Restore(type, value, traceback);
+}
+
+void GilClock_End(Cursor* cur, Py_ssize_t rows)
+{
+    GilClock& clock = cur->gilclock;
+    if (!clock.mark)
+        return;
+
+    GilClock_Release(clock);
+    clock.mark = 0;
+
+    if (stats_enabled)
+    {
+        Stats_Add(cur, &Stats::fetch_gil_held, clock.held);
+        Stats_Add(cur, &Stats::fetch_gil_released, clock.released);
+        Stats_Max(cur, &Stats::longest_gil_hold, clock.longest);
+    }
+
+    if (gil_warning_callback && clock.longest >= gil_warning_threshold)
+        CallGilWarningHandler(cur, clock.longest, rows);
+}
+
+static bool AddSeconds(PyObject* dict, const char* name, UINT64 ns)
+{
+    PyObject* value = PyFloat_FromDouble((double)ns / 1000000000.0);
+    if (!value)
+        return false;
+    int ret = PyDict_SetItemString(dict, name, value);
+    Py_DECREF(value);
+    return ret == 0;
+}
+
+static bool AddCount(PyObject* dict, const char* name, UINT64 count)
+{
+    PyObject* value = PyLong_FromUnsignedLongLong(count);
+    if (!value)
+        return false;
+    int ret = PyDict_SetItemString(dict, name, value);
+    Py_DECREF(value);
+    return ret == 0;
+}
+
+PyObject* Stats_ToDict(const Stats& stats)
+{
+    PyObject* dict = PyDict_New();
+    if (!dict)
+        return 0;
+
+    // `columns` includes the SQLGetData time, so the difference is the time spent creating Python objects.
+    UINT64 convert = stats.columns > stats.getdata ? stats.columns - stats.getdata : 0;
+
+    if (!AddSeconds(dict, "prepare",      stats.prepare) ||
+        !AddSeconds(dict, "execute",      stats.execute) ||
+        !AddSeconds(dict, "fetch",        stats.fetch) ||
+        !AddSeconds(dict, "getdata",      stats.getdata) ||
+        !AddSeconds(dict, "convert",      convert) ||
+        !AddSeconds(dict, "gil_released", stats.prepare + stats.execute + stats.fetch + stats.getdata) ||
+        !AddSeconds(dict, "fetch_gil_held",     stats.fetch_gil_held) ||
+        !AddSeconds(dict, "fetch_gil_released", stats.fetch_gil_released) ||
+        !AddSeconds(dict, "longest_gil_hold",   stats.longest_gil_hold) ||
+        !AddCount(dict,   "executes",     stats.executes) ||
+        !AddCount(dict,   "rows",         stats.rows) ||
+        !AddCount(dict,   "bytes",        stats.bytes) ||
+        !AddCount(dict,   "intern_hits",   stats.intern_hits) ||
+        !AddCount(dict,   "intern_misses", stats.intern_misses))
+    {
+        Py_DECREF(dict);
+        return 0;
+    }
+
+    return dict;
+}
@@ -0,0 +1,136 @@
+
+#ifndef _STATS_H_
+#define _STATS_H_
+
+#include "threads.h"
+
+// Per-cursor and per-connection timing statistics, exposed as Cursor.stats and Connection.stats.  Collection is turned
+// on and off at runtime with pyodbc.enable_stats.  When off, each instrumented call only tests `stats_enabled`.
+
+struct Cursor;
+
+struct Stats
+{
+    // Nanoseconds spent in each phase.  Only the ODBC calls themselves are timed, which are all made with the GIL
+    // released, so the sum of these (other than `columns`) is the time the GIL was released.
+
+    UINT64 prepare;             // SQLPrepare and SQLNumParams
+    UINT64 execute;             // SQLExecute and SQLExecDirect, plus SQLParamData and SQLPutData
+    UINT64 fetch;               // SQLFetch
+    UINT64 getdata;             // SQLGetData
+    UINT64 columns;             // reading and converting column values, which includes `getdata`
+
+    UINT64 executes;
+    UINT64 rows;
+    UINT64 bytes;               // bytes of column data returned by SQLGetData
+
+    // Lookups of character values in the cursor's intern tables (see Connection.intern_limit).
+    UINT64 intern_hits;
+    UINT64 intern_misses;
+
+    // Nanoseconds the GIL was held and released while fetching, and the longest the GIL was held continuously during
+    // a single fetch call (fetchone, fetchmany, etc.).
+    UINT64 fetch_gil_held;
+    UINT64 fetch_gil_released;
+    UINT64 longest_gil_hold;
+};
+
+struct GilClock
+{
+    // Tracks how long the GIL is held during a fetch call.  The fetch code releases the GIL with the
+    // FETCH_BEGIN_ALLOW_THREADS and FETCH_END_ALLOW_THREADS macros, which record each transition.
+
+    UINT64 mark;                // the time of the last transition, or zero when not timing
+    UINT64 held;
+    UINT64 released;
+    UINT64 longest;             // the longest time the GIL was held between transitions
+};
+
+extern bool stats_enabled;
+
+// Adds `value` to the field in the cursor's stats and in its connection's stats.
+void Stats_Add(Cursor* cur, UINT64 Stats::* field, UINT64 value);
+
+// Raises the field in the cursor's stats and in its connection's stats to `value` if it is larger.
+void Stats_Max(Cursor* cur, UINT64 Stats::* field, UINT64 value);
+
+// The callback set by pyodbc.set_gil_warning_handler, or zero.
+extern PyObject* gil_warning_callback;
+extern UINT64 gil_warning_threshold;
+
+// Sets the callback called when a fetch call holds the GIL for at least `threshold` nanoseconds at a time.
+void Stats_SetGilWarningHandler(PyObject* callback, UINT64 threshold);
+
+// Start and end the GIL timing of a fetch call that returned `rows` rows.  These do nothing unless stats are enabled
+// or there is a GIL warning handler.
+void GilClock_Begin(Cursor* cur);
+void GilClock_End(Cursor* cur, Py_ssize_t rows);
+
+inline void GilClock_Release(GilClock& clock)
+{
+    if (clock.mark)
+    {
+        UINT64 now  = MonotonicNanoseconds();
+        UINT64 held = now - clock.mark;
+        clock.held += held;
+        if (held > clock.longest)
+            clock.longest = held;
+        clock.mark = now;
+    }
+}
+
+inline void GilClock_Acquire(GilClock& clock)
+{
+    if (clock.mark)
+    {
+        UINT64 now = MonotonicNanoseconds();
+        clock.released += now - clock.mark;
+        clock.mark = now;
+    }
+}
+
+#define FETCH_BEGIN_ALLOW_THREADS(cur) GilClock_Release((cur)->gilclock); Py_BEGIN_ALLOW_THREADS
+#define FETCH_END_ALLOW_THREADS(cur)   Py_END_ALLOW_THREADS GilClock_Acquire((cur)->gilclock);
+
+// Returns the statistics as a new dictionary.
+PyObject* Stats_ToDict(const Stats& stats);
+
+inline void Stats_Count(Cursor* cur, UINT64 Stats::* field, UINT64 value)
+{
+    if (stats_enabled)
+        Stats_Add(cur, field, value);
+}
+
+class StatsTimer
+{
+    // Adds the time from construction until Stop (or destruction, so early returns are counted) to a field of the
+    // cursor's stats.
+
+    Cursor* cur;
+    UINT64 Stats::* field;
+    UINT64 start;
+
+public:
+    StatsTimer(Cursor* _cur, UINT64 Stats::* _field)
+    {
+        cur   = stats_enabled ? _cur : 0;
+        field = _field;
+        start = cur ? MonotonicNanoseconds() : 0;
+    }
+
+    ~StatsTimer()
+    {
+        Stop();
+    }
+
+    void Stop()
+    {
+        if (cur)
+        {
+            Stats_Add(cur, field, MonotonicNanoseconds() - start);
+            cur = 0;
+        }
+    }
+};
+
+#endif // _STATS_H_
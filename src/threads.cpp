@@ -0,0 +1,222 @@
+
+#include "pyodbc.h"
+#include "threads.h"
+
+#ifdef _MSC_VER
+#include <process.h>
+#else
+#include <time.h>
+#include <errno.h>
+#include <sys/time.h>
+#ifdef __APPLE__
+#include <mach/mach_time.h>
+#endif
+#endif
+
+#ifdef _MSC_VER
+
+Mutex::Mutex()          { InitializeCriticalSection(&m); }
+Mutex::~Mutex()         { DeleteCriticalSection(&m); }
+void Mutex::Lock()      { EnterCriticalSection(&m); }
+void Mutex::Unlock()    { LeaveCriticalSection(&m); }
+
+Condition::Condition(Mutex& _mutex)
+    : mutex(_mutex)
+{
+    InitializeConditionVariable(&c);
+}
+
+Condition::~Condition()
+{
+}
+
+void Condition::Wait()
+{
+    SleepConditionVariableCS(&c, mutex.get(), INFINITE);
+}
+
+bool Condition::Wait(unsigned long ms)
+{
+    return SleepConditionVariableCS(&c, mutex.get(), ms) != 0;
+}
+
+void Condition::Signal()    { WakeConditionVariable(&c); }
+void Condition::Broadcast() { WakeAllConditionVariable(&c); }
+
+struct ThreadStart
+{
+    void (*func)(void*);
+    void* arg;
+};
+
+static unsigned __stdcall ThreadProc(void* p)
+{
+    ThreadStart start = *(ThreadStart*)p;
+    free(p);
+    start.func(start.arg);
+    return 0;
+}
+
+bool StartThread(void (*func)(void*), void* arg)
+{
+    ThreadStart* start = (ThreadStart*)malloc(sizeof(ThreadStart));
+    if (!start)
+        return false;
+    start->func = func;
+    start->arg  = arg;
+
+    uintptr_t h = _beginthreadex(0, 0, ThreadProc, start, 0, 0);
+    if (h == 0)
+    {
+        free(start);
+        return false;
+    }
+    CloseHandle((HANDLE)h);
+    return true;
+}
+
+UINT64 MonotonicMicroseconds()
+{
+    static LARGE_INTEGER freq = { 0 };
+    if (freq.QuadPart == 0)
+        QueryPerformanceFrequency(&freq);
+
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return (UINT64)(now.QuadPart / freq.QuadPart * 1000000 + (now.QuadPart % freq.QuadPart) * 1000000 / freq.QuadPart);
+}
+
+UINT64 MonotonicNanoseconds()
+{
+    static LARGE_INTEGER freq = { 0 };
+    if (freq.QuadPart == 0)
+        QueryPerformanceFrequency(&freq);
+
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return (UINT64)(now.QuadPart / freq.QuadPart * 1000000000 + (now.QuadPart % freq.QuadPart) * 1000000000 / freq.QuadPart);
+}
+
+void SleepMilliseconds(unsigned long ms)
+{
+    Sleep(ms);
+}
+
+#else
+
+Mutex::Mutex()          { pthread_mutex_init(&m, 0); }
+Mutex::~Mutex()         { pthread_mutex_destroy(&m); }
+void Mutex::Lock()      { pthread_mutex_lock(&m); }
+void Mutex::Unlock()    { pthread_mutex_unlock(&m); }
+
+Condition::Condition(Mutex& _mutex)
+    : mutex(_mutex)
+{
+    pthread_cond_init(&c, 0);
+}
+
+Condition::~Condition()
+{
+    pthread_cond_destroy(&c);
+}
+
+void Condition::Wait()
+{
+    pthread_cond_wait(&c, mutex.get());
+}
+
+bool Condition::Wait(unsigned long ms)
+{
+    // pthread_cond_timedwait uses an absolute time on the realtime clock.  This is only used for short waits so the
+    // clock changing underneath us only results in an early or late wakeup, which callers must handle anyway.
+
+    struct timeval tv;
+    gettimeofday(&tv, 0);
+
+    struct timespec ts;
+    UINT64 nsec = (UINT64)tv.tv_usec * 1000 + (UINT64)(ms % 1000) * 1000000;
+    ts.tv_sec  = tv.tv_sec + (time_t)(ms / 1000) + (time_t)(nsec / 1000000000);
+    ts.tv_nsec = (long)(nsec % 1000000000);
+
+    return pthread_cond_timedwait(&c, mutex.get(), &ts) == 0;
+}
+
+void Condition::Signal()    { pthread_cond_signal(&c); }
+void Condition::Broadcast() { pthread_cond_broadcast(&c); }
+
+struct ThreadStart
+{
+    void (*func)(void*);
+    void* arg;
+};
+
+static void* ThreadProc(void* p)
+{
+    ThreadStart start = *(ThreadStart*)p;
+    free(p);
+    start.func(start.arg);
+    return 0;
+}
+
+bool StartThread(void (*func)(void*), void* arg)
+{
+    ThreadStart* start = (ThreadStart*)malloc(sizeof(ThreadStart));
+    if (!start)
+        return false;
+    start->func = func;
+    start->arg  = arg;
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+    pthread_t thread;
+    int rc = pthread_create(&thread, &attr, ThreadProc, start);
+    pthread_attr_destroy(&attr);
+
+    if (rc != 0)
+    {
+        free(start);
+        return false;
+    }
+    return true;
+}
+
+UINT64 MonotonicMicroseconds()
+{
+#ifdef __APPLE__
+    static mach_timebase_info_data_t timebase = { 0, 0 };
+    if (timebase.denom == 0)
+        mach_timebase_info(&timebase);
+    return mach_absolute_time() * timebase.numer / timebase.denom / 1000;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (UINT64)ts.tv_sec * 1000000 + (UINT64)ts.tv_nsec / 1000;
+#endif
+}
+
+UINT64 MonotonicNanoseconds()
+{
+#ifdef __APPLE__
+    static mach_timebase_info_data_t timebase = { 0, 0 };
+    if (timebase.denom == 0)
+        mach_timebase_info(&timebase);
+    return mach_absolute_time() * timebase.numer / timebase.denom;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (UINT64)ts.tv_sec * 1000000000 + (UINT64)ts.tv_nsec;
+#endif
+}
+
+void SleepMilliseconds(unsigned long ms)
+{
+    struct timespec ts;
+    ts.tv_sec  = (time_t)(ms / 1000);
+    ts.tv_nsec = (long)(ms % 1000) * 1000000;
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR)
+        ;
+}
+
+#endif
@@ -0,0 +1,96 @@
+
+#ifndef _THREADS_H_
+#define _THREADS_H_
+
+// Minimal native threading primitives for the helper threads pyodbc runs outside of Python (e.g. the statement
+// watchdog).  Python 2's pythread.h does not provide condition variables or timed waits, so we wrap the OS directly.
+//
+// None of these touch the GIL, so they are safe to use from threads that have never entered the interpreter.
+
+#ifdef _MSC_VER
+typedef CRITICAL_SECTION OSMutex;
+typedef CONDITION_VARIABLE OSCondition;
+#else
+#include <pthread.h>
+typedef pthread_mutex_t OSMutex;
+typedef pthread_cond_t OSCondition;
+#endif
+
+class Mutex
+{
+    OSMutex m;
+
+public:
+    Mutex();
+    ~Mutex();
+
+    void Lock();
+    void Unlock();
+
+    OSMutex* get() { return &m; }
+};
+
+class MutexLock
+{
+    // Locks a mutex for the lifetime of the object.  Like the Object wrapper, this lets us return early without
+    // having to remember to unlock.
+
+    Mutex& mutex;
+
+public:
+    MutexLock(Mutex& _mutex)
+        : mutex(_mutex)
+    {
+        mutex.Lock();
+    }
+
+    ~MutexLock()
+    {
+        mutex.Unlock();
+    }
+};
+
+class Condition
+{
+    OSCondition c;
+    Mutex& mutex;
+
+public:
+    // The mutex must be locked by the caller when calling any of the Wait methods.
+    Condition(Mutex& mutex);
+    ~Condition();
+
+    void Wait();
+
+    // Waits up to `ms` milliseconds.  Returns false if the time expired.  (Spurious wakeups are possible, so callers
+    // must always recheck their state.)
+    bool Wait(unsigned long ms);
+
+    void Signal();
+    void Broadcast();
+};
+
+// Starts a detached native thread that calls func(arg).  Returns false if the thread could not be created.
+bool StartThread(void (*func)(void*), void* arg);
+
+// Returns the value of a monotonic clock in microseconds.  The value is only meaningful relative to other values
+// returned by this function.
+UINT64 MonotonicMicroseconds();
+
+// The same clock in nanoseconds, for timing short operations.
+UINT64 MonotonicNanoseconds();
+
+// Sleeps the calling thread for about `ms` milliseconds.
+void SleepMilliseconds(unsigned long ms);
+
+// Adds to a counter shared between threads without a lock and returns the new value.  Add (UINT64)-n to subtract.
+inline UINT64 AtomicAdd(volatile UINT64* p, UINT64 value)
+{
+#ifdef _MSC_VER
+    return (UINT64)InterlockedExchangeAdd64((volatile LONGLONG*)p, (LONGLONG)value) + value;
+#else
+    return __sync_add_and_fetch(p, value);
+#endif
+}
+
+#endif // _THREADS_H_
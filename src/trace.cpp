@@ -0,0 +1,236 @@
+
+#include "pyodbc.h"
+#include "trace.h"
+#include "querylog.h"
+#include "cursor.h"
+#include "pyodbcmodule.h"
+#include "threads.h"
+#include "wrapper.h"
+
+// The file starts with the 8 bytes "PYODBCTR" followed by the format version.  All integers are unsigned LEB128
+// varints; signed values (SQL types, column sizes, and row counts) are zigzag encoded first.  Each record starts with
+// a tag byte:
+//
+//   'E'  An execute: the statement id, the SQL fingerprint, the duration in nanoseconds, the rowcount, the number of
+//        parameters followed by a kind byte (TraceParamKind) and size for each, and the number of result columns
+//        followed by the SQL type and column size of each.
+//
+//   'R'  The end of a statement's result set: the statement id, the rows fetched, the bytes of column data read, and
+//        the nanoseconds from the end of the execute until the result set was finished.
+//
+// Statement ids are assigned in execute order starting at 1, so a reader can match each result record with its
+// execute record, which always comes first.
+
+#define TRACE_VERSION 1
+
+enum TraceParamKind
+{
+    PARAM_NONE,
+    PARAM_BOOL,
+    PARAM_INT,
+    PARAM_LONG,
+    PARAM_FLOAT,
+    PARAM_STRING,               // size is the length in bytes
+    PARAM_UNICODE,              // size is the length in characters
+    PARAM_BUFFER,               // size is the length in bytes
+    PARAM_DECIMAL,
+    PARAM_DATETIME,
+    PARAM_DATE,
+    PARAM_TIME,
+    PARAM_OTHER,
+};
+
+bool trace_active = false;
+
+static FILE* trace_file = 0;
+static UINT64 next_id = 1;
+static UINT64 statement_count = 0;
+
+static void WriteVarint(UINT64 n)
+{
+    while (n >= 0x80)
+    {
+        putc((int)(n & 0x7F) | 0x80, trace_file);
+        n >>= 7;
+    }
+    putc((int)n, trace_file);
+}
+
+static void WriteSigned(INT64 n)
+{
+    WriteVarint(((UINT64)n << 1) ^ (UINT64)(n >> 63));
+}
+
+bool Trace_Start(const char* filename)
+{
+    if (trace_file)
+    {
+        UINT64 statements;
+        if (!Trace_Stop(statements))
+            return false;
+    }
+
+    trace_file = fopen(filename, "wb");
+    if (!trace_file)
+    {
+        PyErr_SetFromErrnoWithFilename(PyExc_IOError, (char*)filename);
+        return false;
+    }
+
+    fwrite("PYODBCTR", 1, 8, trace_file);
+    WriteVarint(TRACE_VERSION);
+
+    statement_count = 0;
+    trace_active    = true;
+    return true;
+}
+
+bool Trace_Stop(UINT64& statements)
+{
+    statements = statement_count;
+
+    if (!trace_file)
+        return true;
+
+    // Result sets still open are not recorded.  Their cursors ignore them when they finish since their ids are older
+    // than any a new trace assigns.
+    bool failed = ferror(trace_file) != 0;
+    if (fclose(trace_file) != 0)
+        failed = true;
+
+    trace_file   = 0;
+    trace_active = false;
+
+    if (failed)
+    {
+        PyErr_SetString(PyExc_IOError, "Unable to write the trace file");
+        return false;
+    }
+
+    return true;
+}
+
+static void WriteParam(PyObject* param)
+{
+    // The same order of checks as GetParameterInfo, so each value is classified the way it will be bound.
+
+    TraceParamKind kind;
+    Py_ssize_t size = 0;
+
+    if (param == Py_None)
+        kind = PARAM_NONE;
+    else if (PyString_Check(param))
+    {
+        kind = PARAM_STRING;
+        size = PyString_GET_SIZE(param);
+    }
+    else if (PyUnicode_Check(param))
+    {
+        kind = PARAM_UNICODE;
+        size = PyUnicode_GET_SIZE(param);
+    }
+    else if (PyBool_Check(param))
+        kind = PARAM_BOOL;
+    else if (PyDateTime_Check(param))
+        kind = PARAM_DATETIME;
+    else if (PyDate_Check(param))
+        kind = PARAM_DATE;
+    else if (PyTime_Check(param))
+        kind = PARAM_TIME;
+    else if (PyInt_Check(param))
+        kind = PARAM_INT;
+    else if (PyLong_Check(param))
+        kind = PARAM_LONG;
+    else if (PyFloat_Check(param))
+        kind = PARAM_FLOAT;
+    else if (PyDecimal_Check(param))
+        kind = PARAM_DECIMAL;
+    else if (PyBuffer_Check(param))
+    {
+        kind = PARAM_BUFFER;
+        size = PyObject_Size(param);
+        if (size < 0)
+            PyErr_Clear();
+    }
+    else
+        kind = PARAM_OTHER;
+
+    putc((int)kind, trace_file);
+    WriteVarint(size > 0 ? (UINT64)size : 0);
+}
+
+void Trace_RecordExecute(Cursor* cur, PyObject* pSql, PyObject* params, bool skip_first, UINT64 duration)
+{
+    // Results served from the result cache are not recorded since they never reach the driver.
+    if (cur->preloaded)
+        return;
+
+    // Result sets are recorded when they are closed, but a new execute closes the previous one first, so nothing
+    // should be pending.  The id is cleared in case the trace was restarted while it was open.
+    cur->trace_id = 0;
+
+    UINT64 id = next_id++;
+    statement_count++;
+
+    putc('E', trace_file);
+    WriteVarint(id);
+    WriteVarint(SqlFingerprint(pSql));
+    WriteVarint(duration);
+    WriteSigned(cur->rowcount);
+
+    // execute_statement has already checked that params is a sequence.
+    Py_ssize_t offset  = skip_first ? 1 : 0;
+    Py_ssize_t cParams = params ? PySequence_Size(params) - offset : 0;
+    if (cParams < 0)
+    {
+        PyErr_Clear();
+        cParams = 0;
+    }
+
+    WriteVarint((UINT64)cParams);
+    for (Py_ssize_t i = 0; i < cParams; i++)
+    {
+        Object param(PySequence_GetItem(params, i + offset));
+        if (!param)
+        {
+            PyErr_Clear();
+            putc(PARAM_OTHER, trace_file);
+            WriteVarint(0);
+            continue;
+        }
+        WriteParam(param);
+    }
+
+    Py_ssize_t cCols = (cur->colinfos && cur->description != Py_None) ? PyTuple_GET_SIZE(cur->description) : 0;
+
+    WriteVarint((UINT64)cCols);
+    for (Py_ssize_t i = 0; i < cCols; i++)
+    {
+        WriteSigned(cur->colinfos[i].sql_type);
+        WriteSigned((INT64)(SQLLEN)cur->colinfos[i].column_size);
+    }
+
+    if (cCols)
+    {
+        cur->trace_id    = id;
+        cur->trace_rows  = 0;
+        cur->trace_bytes = 0;
+        cur->trace_start = MonotonicNanoseconds();
+    }
+}
+
+void Trace_RecordResult(Cursor* cur)
+{
+    UINT64 id = cur->trace_id;
+    cur->trace_id = 0;
+
+    // Skip result sets from an earlier trace, which are not in this file.
+    if (!trace_active || id == 0 || id >= next_id || id < next_id - statement_count)
+        return;
+
+    putc('R', trace_file);
+    WriteVarint(id);
+    WriteVarint(cur->trace_rows);
+    WriteVarint(cur->trace_bytes);
+    WriteVarint(MonotonicNanoseconds() - cur->trace_start);
+}
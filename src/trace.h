@@ -0,0 +1,33 @@
+
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+// Records the shape of the work pyodbc does to a compact binary file so it can be replayed without the database (see
+// tests/replaytrace.py, which replays a trace against the mock driver in utils/mockdriver).
+//
+// Only shapes are recorded, never SQL text or values: each statement's fingerprint, the type and size of each
+// parameter, the type and size of each result column, and the rows and bytes fetched.  The file is only written by
+// threads holding the GIL.
+
+struct Cursor;
+
+// True while a trace is being recorded.  When false, execute only tests this.
+extern bool trace_active;
+
+// Starts recording to `filename`, stopping any trace already being recorded.  Returns false and sets an exception if
+// the file cannot be created.
+bool Trace_Start(const char* filename);
+
+// Stops recording and closes the file.  Returns false and sets an exception if the file could not be written.
+// `statements` is set to the number of statements recorded.
+bool Trace_Stop(UINT64& statements);
+
+// Records an execute of `pSql` with `params` (skipping the first if `skip_first`) that took `duration` nanoseconds.  If
+// it produced a result set, the rows and bytes fetched are recorded when it is closed or fetched to the end.
+void Trace_RecordExecute(Cursor* cur, PyObject* pSql, PyObject* params, bool skip_first, UINT64 duration);
+
+// Records the rows and bytes fetched from the cursor's result set.  Called when cur->trace_id is non-zero and the
+// result set is finished.
+void Trace_RecordResult(Cursor* cur);
+
+#endif // _TRACE_H_
@@ -0,0 +1,139 @@
+
+#include "pyodbc.h"
+#include "utf8.h"
+#include "wrapper.h"
+#include "cpufeatures.h"
+
+bool IsUTF8(const char* encoding)
+{
+    return _strcmpi(encoding, "utf-8") == 0 || _strcmpi(encoding, "utf8") == 0 || _strcmpi(encoding, "utf_8") == 0;
+}
+
+static Py_ssize_t CopyASCII(Py_UNICODE* dest, const unsigned char* src, Py_ssize_t cb)
+{
+    // Copies the ASCII characters at the start of `src` and returns how many there were.
+
+    Py_ssize_t i = 0;
+
+#ifdef PYODBC_SSE2
+    const __m128i zero = _mm_setzero_si128();
+
+    for (; i + 16 <= cb; i += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)&src[i]);
+        if (_mm_movemask_epi8(v) != 0)
+            break;
+
+        __m128i lo = _mm_unpacklo_epi8(v, zero);
+        __m128i hi = _mm_unpackhi_epi8(v, zero);
+#if Py_UNICODE_SIZE == 4
+        _mm_storeu_si128((__m128i*)&dest[i],      _mm_unpacklo_epi16(lo, zero));
+        _mm_storeu_si128((__m128i*)&dest[i + 4],  _mm_unpackhi_epi16(lo, zero));
+        _mm_storeu_si128((__m128i*)&dest[i + 8],  _mm_unpacklo_epi16(hi, zero));
+        _mm_storeu_si128((__m128i*)&dest[i + 12], _mm_unpackhi_epi16(hi, zero));
+#else
+        _mm_storeu_si128((__m128i*)&dest[i],     lo);
+        _mm_storeu_si128((__m128i*)&dest[i + 8], hi);
+#endif
+    }
+#endif
+
+    while (i < cb && src[i] < 0x80)
+    {
+        dest[i] = (Py_UNICODE)src[i];
+        i++;
+    }
+
+    return i;
+}
+
+PyObject* PyUnicode_FromUTF8(const char* pch, Py_ssize_t cb)
+{
+    // Every byte produces at most one Py_UNICODE (a 4 byte sequence is two on UCS2 builds), so allocate cb characters
+    // and shrink the object when done.
+
+    static const unsigned int min_value[] = { 0, 0, 0x80, 0x800, 0x10000 };
+
+    Object result(PyUnicode_FromUnicode(0, cb));
+    if (!result)
+        return 0;
+
+    Py_UNICODE* dest = PyUnicode_AS_UNICODE(result.Get());
+    const unsigned char* src = (const unsigned char*)pch;
+
+    Py_ssize_t in  = 0;
+    Py_ssize_t out = 0;
+
+    for (;;)
+    {
+        Py_ssize_t count = CopyASCII(&dest[out], &src[in], cb - in);
+        in  += count;
+        out += count;
+
+        if (in == cb)
+            break;
+
+        // A multibyte sequence.  Anything that is not well formed, including overlong forms and surrogates, is left to
+        // Python's decoder.
+
+        unsigned int ch = src[in];
+        int len;
+        if (ch >= 0xC2 && ch <= 0xDF)
+        {
+            len = 2;
+            ch &= 0x1F;
+        }
+        else if (ch >= 0xE0 && ch <= 0xEF)
+        {
+            len = 3;
+            ch &= 0x0F;
+        }
+        else if (ch >= 0xF0 && ch <= 0xF4)
+        {
+            len = 4;
+            ch &= 0x07;
+        }
+        else
+        {
+            return PyUnicode_DecodeUTF8(pch, cb, "strict");
+        }
+
+        if (in + len > cb)
+            return PyUnicode_DecodeUTF8(pch, cb, "strict");
+
+        for (int i = 1; i < len; i++)
+        {
+            unsigned int c = src[in + i];
+            if ((c & 0xC0) != 0x80)
+                return PyUnicode_DecodeUTF8(pch, cb, "strict");
+            ch = (ch << 6) | (c & 0x3F);
+        }
+
+        if (ch < min_value[len] || ch > 0x10FFFF || (ch >= 0xD800 && ch <= 0xDFFF))
+            return PyUnicode_DecodeUTF8(pch, cb, "strict");
+
+        in += len;
+
+#if Py_UNICODE_SIZE == 2
+        if (ch > 0xFFFF)
+        {
+            ch -= 0x10000;
+            dest[out++] = (Py_UNICODE)(0xD800 + (ch >> 10));
+            dest[out++] = (Py_UNICODE)(0xDC00 + (ch & 0x3FF));
+            continue;
+        }
+#endif
+        dest[out++] = (Py_UNICODE)ch;
+    }
+
+    if (out == cb)
+        return result.Detach();
+
+    PyObject* tmp = result.Detach();
+    if (PyUnicode_Resize(&tmp, out) == -1)
+    {
+        Py_DECREF(tmp);
+        return 0;
+    }
+    return tmp;
+}
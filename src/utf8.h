@@ -0,0 +1,17 @@
+
+#ifndef _UTF8_H_
+#define _UTF8_H_
+
+// Decoding of character data read as UTF-8.  With a connection's `encoding` set and unicode_results on, SQL_CHAR
+// columns are read as SQL_C_CHAR and decoded here instead of asking the driver to convert them to SQLWCHAR, which
+// halves the bytes read for drivers that store UTF-8 and skips the widening.
+
+// Returns a new Unicode object decoded from `cb` bytes of UTF-8.  Runs of ASCII characters are copied 16 at a time.
+// Invalid UTF-8 is passed to PyUnicode_DecodeUTF8, so the errors (and what is accepted) are the same as Python's
+// "strict" decoding.
+PyObject* PyUnicode_FromUTF8(const char* pch, Py_ssize_t cb);
+
+// Returns true if `encoding` is one of Python's names for UTF-8.
+bool IsUTF8(const char* encoding);
+
+#endif // _UTF8_H_
@@ -0,0 +1,126 @@
+
+#include "pyodbc.h"
+#include "threads.h"
+#include "callcounts.h"
+#include "watchdog.h"
+
+#include <new>
+
+// All armed deadlines are kept in a doubly linked list of stack objects owned by the threads executing statements.
+// Everything is protected by `lock`, including the SQLCancel calls, so once Disarm returns the HSTMT can be freed
+// safely.
+//
+// The list is unsorted.  It only holds statements currently executing with a timeout, so it will be short.
+//
+// The mutex and condition are allocated when the thread is started and are never freed.  The thread is still waiting
+// on them when the process exits, and destroying a condition variable that has a waiter blocks on some platforms.
+// They are created while holding the GIL, which serializes the first Deadline constructors.
+
+static Mutex* lock = 0;
+static Condition* wakeup = 0;
+static Deadline* head = 0;
+
+void WatchdogThread(void*)
+{
+    MutexLock locker(*lock);
+
+    for (;;)
+    {
+        UINT64 now  = MonotonicMicroseconds();
+        UINT64 next = 0;
+
+        for (Deadline* p = head; p != 0; p = p->next)
+        {
+            if (p->fired)
+                continue;
+
+            if (p->expires <= now)
+            {
+                TRACE("watchdog: canceling hstmt=%p\n", p->hstmt);
+                ODBC_CALL(0, SQLCancel)(p->hstmt);
+                p->fired = true;
+            }
+            else if (next == 0 || p->expires < next)
+            {
+                next = p->expires;
+            }
+        }
+
+        // Waits are limited to a day so the millisecond count always fits in an unsigned long.
+        if (next == 0)
+            wakeup->Wait();
+        else if (next - now >= (UINT64)86400 * 1000000)
+            wakeup->Wait(86400 * 1000UL);
+        else
+            wakeup->Wait((unsigned long)((next - now + 999) / 1000));
+    }
+}
+
+
+Deadline::Deadline(HSTMT _hstmt, long timeout_ms)
+{
+    hstmt   = _hstmt;
+    expires = 0;
+    fired   = false;
+    prev    = 0;
+    next    = 0;
+
+    if (timeout_ms <= 0)
+        return;
+
+    if (lock == 0)
+    {
+        lock   = new (std::nothrow) Mutex();
+        wakeup = lock ? new (std::nothrow) Condition(*lock) : 0;
+
+        if (wakeup == 0 || !StartThread(WatchdogThread, 0))
+        {
+            // Without the thread we cannot enforce the deadline.  The statement still runs, subject to the
+            // connection's query timeout.
+            TRACE("watchdog: unable to start thread\n");
+            delete wakeup;
+            delete lock;
+            wakeup = 0;
+            lock   = 0;
+            return;
+        }
+    }
+
+    MutexLock locker(*lock);
+
+    // A very long timeout (it can be LONG_MAX) saturates instead of wrapping around into the past.
+    UINT64 now   = MonotonicMicroseconds();
+    UINT64 delay = (UINT64)timeout_ms * 1000;
+    if ((UINT64)timeout_ms > ~(UINT64)0 / 1000 || delay > ~(UINT64)0 - now)
+        expires = ~(UINT64)0;
+    else
+        expires = now + delay;
+
+    next = head;
+    if (head)
+        head->prev = this;
+    head = this;
+
+    wakeup->Signal();
+}
+
+
+bool Deadline::Disarm()
+{
+    if (expires == 0)
+        return fired;
+
+    MutexLock locker(*lock);
+
+    if (prev)
+        prev->next = next;
+    else
+        head = next;
+    if (next)
+        next->prev = prev;
+
+    prev = next = 0;
+    expires = 0;
+
+    return fired;
+}
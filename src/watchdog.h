@@ -0,0 +1,34 @@
+
+#ifndef _WATCHDOG_H_
+#define _WATCHDOG_H_
+
+// The statement watchdog enforces per-call deadlines.  A single native thread sleeps until the earliest armed deadline
+// and calls SQLCancel on any statement that is still running when its deadline passes.  The ODBC call that was
+// running then fails (usually with HY008) and the caller uses Expired() to turn that into a timeout error.
+
+class Deadline
+{
+    HSTMT hstmt;
+    UINT64 expires;             // MonotonicMicroseconds() value; zero if not armed
+    bool fired;                 // set by the watchdog thread after canceling hstmt
+
+    Deadline* prev;
+    Deadline* next;
+
+    friend void WatchdogThread(void*);
+
+public:
+    // Arms the watchdog for the statement if `timeout_ms` is greater than zero.  Otherwise the object does nothing.
+    Deadline(HSTMT hstmt, long timeout_ms);
+
+    ~Deadline()
+    {
+        Disarm();
+    }
+
+    // Removes the deadline from the watchdog.  Once this returns the watchdog will not touch the HSTMT.  Returns true
+    // if the watchdog canceled the statement.
+    bool Disarm();
+};
+
+#endif // _WATCHDOG_H_
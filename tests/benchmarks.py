@@ -0,0 +1,388 @@
+#!/usr/bin/python
+# -*- coding: latin-1 -*-
+
+usage = """\
+usage: %prog [options] [connection_string]
+
+Performance benchmarks using the SQLite ODBC driver from http://www.ch-werner.de/sqliteodbc
+
+Runs a fixed set of workloads and reports the best of several runs of each.  The
+tables are created and filled with the same generated data every time, so results
+from different builds can be compared.  The benchmark tables (bench_*) are dropped
+when the run finishes.
+
+Use a file database, not :memory:, since the threaded benchmarks open one
+connection per thread.  If the database file does not exist, the driver creates it.
+
+  python benchmarks.py -o before.json "Driver=SQLite3;Database=/tmp/bench.db"
+  (rebuild)
+  python benchmarks.py -c before.json "Driver=SQLite3;Database=/tmp/bench.db"
+
+The connection string can also be put into setup.cfg like the sqlitetests:
+
+  [benchmarks]
+  connection-string=Driver=SQLite3 ODBC Driver;Database=/tmp/bench.db
+
+Like the tests, these use the version from the 'build' directory if there is one.
+"""
+
+import sys, os, platform, random, threading
+from time import time, strftime
+from testutils import *
+
+try:
+    import json
+except ImportError:
+    json = None
+
+# Imported by load_pyodbc so the build directory can be added to the path first.
+pyodbc = None
+
+def load_pyodbc():
+    """
+    Adds the build directory to the path so we're testing the latest build, not the installed version, then imports
+    pyodbc for this module and returns it.  Scripts that import their benchmarks from here call this instead of
+    importing pyodbc themselves.
+    """
+    global pyodbc
+    add_to_path()
+    import pyodbc
+    return pyodbc
+
+# Every benchmark returns a list of results, each a dictionary with a name, a value, and the value's unit.  A unit
+# ending in '/s' is a rate where higher is better; all others are times where lower is better.
+
+def result(name, value, unit, **extra):
+    d = dict(name=name, value=value, unit=unit)
+    d.update(extra)
+    return d
+
+def best_time(repeat, func, *args):
+    """
+    Calls func(*args) `repeat` times and returns the shortest elapsed time.  The shortest is used because noise from
+    the rest of the system only ever makes a run slower.
+    """
+    best = None
+    for i in range(repeat):
+        start = time()
+        func(*args)
+        elapsed = time() - start
+        if best is None or elapsed < best:
+            best = elapsed
+    return best
+
+def _generate_string(rnd, length):
+    return ''.join([ chr(rnd.randint(ord('a'), ord('z'))) for i in range(length) ])
+
+
+class BenchmarkSuite(object):
+    """
+    The base class of the benchmark suites.  Each bench_* method is a benchmark that returns a list of results.
+    """
+
+    def names(self):
+        return [ name[len('bench_'):] for name in dir(self) if name.startswith('bench_') ]
+
+    def run(self, names, verbose):
+        results = []
+        for name in names:
+            if verbose:
+                print >>sys.stderr, 'running %s' % name
+            results.extend(getattr(self, 'bench_' + name)())
+        return results
+
+
+class Benchmarks(BenchmarkSuite):
+
+    # (name, column type, function returning the value for row i)
+    COLUMN_TYPES = [
+        ('int',         'int',          lambda rnd, i: i),
+        ('float',       'float',        lambda rnd, i: rnd.random() * 1000000),
+        ('varchar_10',  'varchar(10)',  lambda rnd, i: _generate_string(rnd, 10)),
+        ('varchar_200', 'varchar(200)', lambda rnd, i: _generate_string(rnd, 200)),
+        ('unicode_50',  'varchar(50)',  lambda rnd, i: unicode(_generate_string(rnd, 50))),
+        ('decimal',     'numeric(18,4)', lambda rnd, i: '%d.%04d' % (rnd.randint(0, 99999999), rnd.randint(0, 9999))),
+        ('date',        'date',         lambda rnd, i: '2011-%02d-%02d' % (rnd.randint(1, 12), rnd.randint(1, 28))),
+    ]
+
+    LOB_SIZES = [ 1024, 64 * 1024, 1024 * 1024 ]
+
+    WIDE_COLUMNS = 50
+
+    THREAD_COUNTS = [ 1, 2, 4, 8 ]
+
+    def __init__(self, connection_string, rows, repeat):
+        self.connection_string = connection_string
+        self.rows   = rows
+        self.repeat = repeat
+        self.cnxn   = pyodbc.connect(connection_string)
+        self.cursor = self.cnxn.cursor()
+
+    def drop(self, name):
+        try:
+            self.cursor.execute("drop table %s" % name)
+            self.cnxn.commit()
+        except pyodbc.Error:
+            pass
+
+    def create(self, name, columns, rows, value_func):
+        """
+        Creates table `name` with the given column definitions and fills it with `rows` rows, calling
+        value_func(rnd, i) for the parameters of row i.  The random generator is seeded the same way for every table
+        so the data is identical from run to run.
+        """
+        self.drop(name)
+        self.cursor.execute("create table %s(%s)" % (name, ', '.join(columns)))
+        rnd = random.Random(1)
+        params = [ value_func(rnd, i) for i in range(rows) ]
+        self.cursor.executemany("insert into %s values (%s)" % (name, ','.join('?' * len(columns))), params)
+        self.cnxn.commit()
+
+    def fetchall(self, sql):
+        self.cursor.execute(sql).fetchall()
+
+    def bench_column_types(self):
+        results = []
+        for name, sqltype, func in self.COLUMN_TYPES:
+            self.create('bench_types', [ 'c %s' % sqltype ], self.rows, lambda rnd, i: (func(rnd, i),))
+            elapsed = best_time(self.repeat, self.fetchall, "select c from bench_types")
+            results.append(result('fetch_%s' % name, self.rows / elapsed, 'rows/s'))
+        self.drop('bench_types')
+        return results
+
+    def bench_row_width(self):
+        results = []
+        for name, count in [ ('narrow', 1), ('wide', self.WIDE_COLUMNS) ]:
+            columns = [ 'c%d int' % i for i in range(count) ]
+            self.create('bench_width', columns, self.rows, lambda rnd, i: [ i ] * count)
+            elapsed = best_time(self.repeat, self.fetchall, "select * from bench_width")
+            results.append(result('fetch_%s_rows' % name, self.rows / elapsed, 'rows/s', columns=count))
+            results.append(result('fetch_%s_values' % name, self.rows * count / elapsed, 'values/s', columns=count))
+        self.drop('bench_width')
+        return results
+
+    def bench_lobs(self):
+        results = []
+        for size in self.LOB_SIZES:
+            rows = max(1, min(self.rows, (16 * 1024 * 1024) / size))
+            value = _generate_string(random.Random(1), size)
+            for name, sqltype, param in [ ('text', 'text', value), ('blob', 'blob', buffer(value)) ]:
+                self.create('bench_lobs', [ 'c %s' % sqltype ], rows, lambda rnd, i: (param,))
+                elapsed = best_time(self.repeat, self.fetchall, "select c from bench_lobs")
+                results.append(result('fetch_%s_%dk' % (name, size / 1024), rows * size / elapsed / (1024 * 1024), 'MB/s'))
+        self.drop('bench_lobs')
+        return results
+
+    def bench_executemany(self):
+        rnd = random.Random(1)
+        params = [ (i, _generate_string(rnd, 20), rnd.random()) for i in range(self.rows) ]
+
+        def insert():
+            self.cursor.execute("delete from bench_insert")
+            self.cursor.executemany("insert into bench_insert values (?, ?, ?)", params)
+            self.cnxn.commit()
+
+        self.drop('bench_insert')
+        self.cursor.execute("create table bench_insert(n int, s varchar(20), f float)")
+        elapsed = best_time(self.repeat, insert)
+        self.drop('bench_insert')
+        return [ result('executemany', self.rows / elapsed, 'rows/s') ]
+
+    def bench_prepare_cache(self):
+        """
+        The cursor keeps the statement prepared as long as the same SQL is executed again, so executing one statement
+        repeatedly is compared with alternating between two, which prepares on every execute.
+        """
+        self.create('bench_prepare', [ 'n int' ], 100, lambda rnd, i: (i,))
+
+        count = self.rows
+        sql = [ "select n from bench_prepare where n = ?", "select n from bench_prepare where n = ? " ]
+
+        def run(statements):
+            for i in range(count):
+                self.cursor.execute(statements[i % len(statements)], i % 100).fetchall()
+
+        results = []
+        for name, statements in [ ('same', sql[:1]), ('alternating', sql) ]:
+            before = self.cnxn.odbc_counts['calls'].get('SQLPrepare', 0)
+            elapsed = best_time(self.repeat, run, statements)
+            prepares = self.cnxn.odbc_counts['calls'].get('SQLPrepare', 0) - before
+            results.append(result('execute_%s_sql' % name, count / elapsed, 'executes/s',
+                                  prepares_per_execute=float(prepares) / (count * self.repeat)))
+        self.drop('bench_prepare')
+        return results
+
+    def bench_connect(self):
+        count = max(10, self.rows / 100)
+
+        def connect():
+            for i in range(count):
+                pyodbc.connect(self.connection_string).close()
+
+        elapsed = best_time(self.repeat, connect)
+        return [ result('connect', elapsed / count * 1000, 'ms', pooling=pyodbc.pooling) ]
+
+    def bench_threads(self):
+        """
+        Each thread fetches the whole table on its own connection.  Fetching releases the GIL around each ODBC call,
+        so the aggregate rate should grow with threads until the conversions in the GIL become the bottleneck.
+        """
+        self.create('bench_threads', [ 'n int', 's varchar(50)' ], self.rows,
+                    lambda rnd, i: (i, _generate_string(rnd, 50)))
+
+        results = []
+        for count in self.THREAD_COUNTS:
+            cnxns = [ pyodbc.connect(self.connection_string) for i in range(count) ]
+            errors = []
+
+            def fetch(cnxn):
+                try:
+                    cnxn.cursor().execute("select n, s from bench_threads").fetchall()
+                except Exception, ex:
+                    errors.append(ex)
+
+            def run():
+                threads = [ threading.Thread(target=fetch, args=(cnxn,)) for cnxn in cnxns ]
+                for t in threads:
+                    t.start()
+                for t in threads:
+                    t.join()
+
+            elapsed = best_time(self.repeat, run)
+            for cnxn in cnxns:
+                cnxn.close()
+            if errors:
+                raise errors[0]
+            results.append(result('threads_%d' % count, self.rows * count / elapsed, 'rows/s', threads=count))
+
+        self.drop('bench_threads')
+        return results
+
+
+def environment(cnxn):
+    return dict(python   = sys.version.split()[0],
+                pyodbc   = pyodbc.version,
+                driver   = '%s %s' % (cnxn.getinfo(pyodbc.SQL_DRIVER_NAME), cnxn.getinfo(pyodbc.SQL_DRIVER_VER)),
+                platform = platform.platform(),
+                time     = strftime('%Y-%m-%dT%H:%M:%S'))
+
+
+def print_results(results):
+    for r in results:
+        print '%-28s %14.2f %s' % (r['name'], r['value'], r['unit'])
+
+
+def compare(baseline, results, threshold):
+    """
+    Prints the change in each result from the baseline and returns the number that are more than `threshold`
+    percent worse.
+    """
+    old = dict([ (r['name'], r) for r in baseline['results'] ])
+    regressions = 0
+
+    for r in results:
+        b = old.get(r['name'])
+        if not b or not b['value']:
+            print '%-28s %14.2f %-10s (new)' % (r['name'], r['value'], r['unit'])
+            continue
+
+        change = (r['value'] - b['value']) * 100.0 / b['value']
+        if not r['unit'].endswith('/s'):
+            change = -change        # lower times are better
+
+        flag = ''
+        if change < -threshold:
+            flag = 'REGRESSION'
+            regressions += 1
+
+        print '%-28s %14.2f %-10s %+7.1f%% %s' % (r['name'], r['value'], r['unit'], change, flag)
+
+    return regressions
+
+
+def option_parser(usage, rows_help, rows):
+    """
+    Returns an OptionParser with the options shared by the benchmark scripts.  `rows_help` describes the --rows option
+    and `rows` is its default.
+    """
+    from optparse import OptionParser
+    parser = OptionParser(usage=usage)
+    parser.add_option("-v", "--verbose", action="count", help="Print each benchmark as it starts")
+    parser.add_option("-b", "--bench", action="append", help="Run only the named benchmark (can be used multiple times)")
+    parser.add_option("-r", "--rows", type="int", default=rows, help=rows_help + " (default %default)")
+    parser.add_option("-n", "--repeat", type="int", default=3, help="Runs of each benchmark, best is reported (default %default)")
+    parser.add_option("-o", "--output", help="Write the results as JSON to this file")
+    parser.add_option("-c", "--compare", help="Compare with the JSON results in this file")
+    parser.add_option("-t", "--threshold", type="float", default=10.0,
+                      help="Percent slower than the comparison file reported as a regression (default %default)")
+    parser.add_option("-l", "--list", action="store_true", default=False, help="List the benchmarks and exit")
+    return parser
+
+
+def parse_args(parser):
+    (options, args) = parser.parse_args()
+
+    if (options.output or options.compare) and not json:
+        parser.error('The json module is required to read or write results (Python 2.6 or later).')
+
+    return options, args
+
+
+def run_selected(parser, options, benchmarks, settings):
+    """
+    Runs the benchmarks in the BenchmarkSuite `benchmarks` selected by the command line options, then prints the
+    results, writes them to a file, or compares them with a file.  `settings` is saved with the results so runs with
+    different settings can be detected.
+    """
+    if options.list:
+        print '\n'.join(benchmarks.names())
+        return
+
+    names = options.bench or benchmarks.names()
+    for name in names:
+        if name not in benchmarks.names():
+            parser.error('Unknown benchmark: %s' % name)
+
+    results = benchmarks.run(names, options.verbose)
+
+    document = dict(environment=environment(benchmarks.cnxn),
+                    settings=settings,
+                    results=results)
+
+    if options.output:
+        f = open(options.output, 'w')
+        json.dump(document, f, indent=2, sort_keys=True)
+        f.close()
+
+    if options.compare:
+        baseline = json.load(open(options.compare))
+        if baseline['settings'] != document['settings']:
+            print >>sys.stderr, 'warning: %s was run with different settings: %s' % (options.compare, baseline['settings'])
+        if compare(baseline, results, options.threshold):
+            raise SystemExit(1)
+    else:
+        print_results(results)
+
+
+def main():
+    parser = option_parser(usage, "Rows per table", 20000)
+    (options, args) = parse_args(parser)
+
+    if len(args) > 1:
+        parser.error('Only one argument is allowed.  Do you need quotes around the connection string?')
+
+    if not args:
+        connection_string = load_setup_connection_string('benchmarks')
+        if not connection_string:
+            parser.print_help()
+            raise SystemExit()
+    else:
+        connection_string = args[0]
+
+    benchmarks = Benchmarks(connection_string, options.rows, options.repeat)
+    run_selected(parser, options, benchmarks, dict(rows=options.rows, repeat=options.repeat))
+
+
+if __name__ == '__main__':
+    load_pyodbc()
+    main()
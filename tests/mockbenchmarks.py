@@ -0,0 +1,205 @@
+#!/usr/bin/python
+# -*- coding: latin-1 -*-
+
+usage = """\
+usage: %prog [options] [driver_path]
+
+Benchmarks pyodbc's own overhead using the mock ODBC driver, which makes up its
+results instead of reading them from a database.  Build the driver first with:
+
+  python setup.py mockdriver
+
+The driver is found in build/mockdriver unless its path is passed.  It must be
+loaded through unixODBC or iODBC.
+
+Since no time is spent in a database, the results measure the cost of fetching
+rows (Cursor_fetch and Row_New), converting each column type (GetData), and
+binding parameters (PrepareAndBind).  The output and comparison options are the
+same as benchmarks.py.
+"""
+
+from os.path import join, dirname, abspath, exists
+from testutils import *
+from benchmarks import load_pyodbc, BenchmarkSuite, result, best_time, option_parser, parse_args, run_selected
+
+
+class MockBenchmarks(BenchmarkSuite):
+
+    COLUMN_TYPES = [ 'int', 'bigint', 'bit', 'double', 'decimal(18,4)', 'varchar(20)', 'varchar(200)', 'nvarchar(20)',
+                     'varbinary(20)', 'date', 'time', 'timestamp', 'null' ]
+
+    LOB_SIZES = [ 1024, 64 * 1024, 1024 * 1024 ]
+
+    WIDE_COLUMNS = 50
+
+    def __init__(self, driver, rows, repeat):
+        self.driver = driver
+        self.rows   = rows
+        self.repeat = repeat
+        self.cnxn   = pyodbc.connect('Driver=%s' % driver)
+        self.cursor = self.cnxn.cursor()
+
+    def fetchall(self, sql):
+        self.cursor.execute(sql).fetchall()
+
+    def bench_column_types(self):
+        results = []
+        for sqltype in self.COLUMN_TYPES:
+            elapsed = best_time(self.repeat, self.fetchall, "select %d %s" % (self.rows, sqltype))
+            name = sqltype.replace('(', '_').replace(',', '_').replace(')', '')
+            results.append(result('fetch_%s' % name, self.rows / elapsed, 'rows/s'))
+        return results
+
+    def bench_row_width(self):
+        results = []
+        for name, count in [ ('narrow', 1), ('wide', self.WIDE_COLUMNS) ]:
+            sql = "select %d %s" % (self.rows, ', '.join([ 'int' ] * count))
+            elapsed = best_time(self.repeat, self.fetchall, sql)
+            results.append(result('fetch_%s_rows' % name, self.rows / elapsed, 'rows/s', columns=count))
+            results.append(result('fetch_%s_values' % name, self.rows * count / elapsed, 'values/s', columns=count))
+        return results
+
+    def bench_lobs(self):
+        results = []
+        for size in self.LOB_SIZES:
+            rows = max(1, min(self.rows, (64 * 1024 * 1024) / size))
+            for name in [ 'text', 'ntext', 'blob' ]:
+                elapsed = best_time(self.repeat, self.fetchall, "select %d %s(%d)" % (rows, name, size))
+                results.append(result('fetch_%s_%dk' % (name, size / 1024), rows * size / elapsed / (1024 * 1024), 'MB/s'))
+        return results
+
+    def bench_fetch_methods(self):
+        """
+        Compares the ways of reading the same result set, which differ only in the Python calls made per row.
+        """
+        sql = "select %d int, varchar(10)" % self.rows
+
+        def fetchone():
+            cursor = self.cursor.execute(sql)
+            while cursor.fetchone():
+                pass
+
+        def fetchmany():
+            cursor = self.cursor.execute(sql)
+            while cursor.fetchmany(1000):
+                pass
+
+        def iterate():
+            for row in self.cursor.execute(sql):
+                pass
+
+        results = []
+        for name, func in [ ('fetchall', lambda: self.fetchall(sql)), ('fetchmany', fetchmany), ('fetchone', fetchone),
+                            ('iterate', iterate) ]:
+            elapsed = best_time(self.repeat, func)
+            results.append(result(name, self.rows / elapsed, 'rows/s'))
+        return results
+
+    def bench_execute(self):
+        """
+        Executes statements that return no rows, so only preparing and binding are measured.  Repeating the same SQL
+        lets the cursor skip SQLPrepare; alternating between two statements prepares every time.
+        """
+        count = self.rows
+        results = []
+
+        for nparams in [ 1, 10 ]:
+            markers = ', '.join([ '?' ] * nparams)
+            params  = [ 1, 'abc', 1.5, 2, 'defghi', 3, 4.5, 5, 'j', 6 ][:nparams]
+            sql     = [ "insert into t values (%s)" % markers, "insert into t values (%s) " % markers ]
+
+            for name, statements in [ ('same', sql[:1]), ('alternating', sql) ]:
+                def run():
+                    for i in range(count):
+                        self.cursor.execute(statements[i % len(statements)], params)
+                elapsed = best_time(self.repeat, run)
+                results.append(result('execute_%d_params_%s_sql' % (nparams, name), count / elapsed, 'executes/s',
+                                      params=nparams))
+
+        return results
+
+    def bench_executemany(self):
+        params = [ (i, 'abc', 1.5) for i in range(self.rows) ]
+
+        elapsed = best_time(self.repeat, self.cursor.executemany, "insert into t values (?, ?, ?)", params)
+        return [ result('executemany', self.rows / elapsed, 'rows/s') ]
+
+    def bench_unicode_results(self):
+        """
+        Compares the two ways of returning char columns as unicode: asking the driver to convert them to SQLWCHAR, and
+        reading the bytes and decoding them with the connection's encoding.
+        """
+        results = []
+        for path, encoding in [ ('wchar', None), ('utf8', 'utf-8') ]:
+            cursor = pyodbc.connect('Driver=%s' % self.driver, unicode_results=True, encoding=encoding).cursor()
+            def fetchall(sql):
+                cursor.execute(sql).fetchall()
+
+            for sqltype in [ 'varchar(20)', 'varchar(200)' ]:
+                elapsed = best_time(self.repeat, fetchall, "select %d %s" % (self.rows, sqltype))
+                name = sqltype.replace('(', '_').replace(')', '')
+                results.append(result('unicode_%s_%s' % (name, path), self.rows / elapsed, 'rows/s'))
+
+            for size in self.LOB_SIZES:
+                rows = max(1, min(self.rows, (64 * 1024 * 1024) / size))
+                elapsed = best_time(self.repeat, fetchall, "select %d text(%d)" % (rows, size))
+                results.append(result('unicode_text_%dk_%s' % (size / 1024, path), rows * size / elapsed / (1024 * 1024),
+                                      'MB/s'))
+        return results
+
+    def bench_intern(self):
+        """
+        Fetches char and date columns with and without interning.  The mock driver's strings repeat every 26 rows and
+        its dates every 420.
+        """
+        results = []
+        for name, limit in [ ('off', 0), ('on', 512) ]:
+            self.cnxn.intern_limit = limit
+            for sqltype in [ 'varchar(20)', 'varchar(100)', 'date', 'timestamp' ]:
+                elapsed = best_time(self.repeat, self.fetchall, "select %d %s" % (self.rows, sqltype))
+                results.append(result('intern_%s_%s' % (sqltype.replace('(', '_').replace(')', ''), name),
+                                      self.rows / elapsed, 'rows/s'))
+        self.cnxn.intern_limit = 0
+        return results
+
+    def bench_lazy_rows(self):
+        """
+        Fetches 40 columns and uses 3 of them, with and without lazy rows.
+        """
+        sql = "select %d %s" % (self.rows, ', '.join([ 'int', 'varchar(20)', 'float', 'timestamp' ] * 10))
+
+        def fetch():
+            for row in self.cursor.execute(sql).fetchall():
+                row[0], row[1], row[2]
+
+        results = []
+        for name, lazy in [ ('off', False), ('on', True) ]:
+            self.cnxn.lazy_rows = lazy
+            elapsed = best_time(self.repeat, fetch)
+            results.append(result('lazy_rows_%s' % name, self.rows / elapsed, 'rows/s'))
+        self.cnxn.lazy_rows = False
+        return results
+
+
+def main():
+    parser = option_parser(usage, "Rows per result set", 100000)
+    (options, args) = parse_args(parser)
+
+    if len(args) > 1:
+        parser.error('Only one argument is allowed, the path to the mock driver.')
+
+    if args:
+        driver = abspath(args[0])
+    else:
+        driver = join(dirname(dirname(abspath(__file__))), 'build', 'mockdriver', 'libpyodbcmock.so')
+
+    if not exists(driver):
+        parser.error('The mock driver was not found at %s.  Run "python setup.py mockdriver" first.' % driver)
+
+    benchmarks = MockBenchmarks(driver, options.rows, options.repeat)
+    run_selected(parser, options, benchmarks, dict(rows=options.rows, repeat=options.repeat, driver='mock'))
+
+
+if __name__ == '__main__':
+    pyodbc = load_pyodbc()
+    main()
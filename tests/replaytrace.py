@@ -0,0 +1,320 @@
+#!/usr/bin/python
+# -*- coding: latin-1 -*-
+
+usage = """\
+usage: %prog [options] trace_file [driver_path]
+
+Replays a trace recorded with pyodbc.start_trace against the mock ODBC driver, so
+the pattern of statements from a production system can be rerun anywhere without
+its database:
+
+  pyodbc.start_trace('/tmp/app.trace')
+  (run the application)
+  pyodbc.stop_trace()
+
+  python setup.py mockdriver
+  python replaytrace.py -o before.json /tmp/app.trace
+  (rebuild)
+  python replaytrace.py -c before.json /tmp/app.trace
+
+Each statement is replaced with one the mock driver understands that has the same
+parameter types and sizes and the same result column types.  Statements with the
+same fingerprint get the same SQL, so statements are prepared as often as they
+were when recorded.  Rows are fetched as recorded, and variable length columns are
+sized so each row has about the number of bytes recorded.
+
+Since no time is spent in a database, the results measure pyodbc's own cost for
+the workload.  The output and comparison options are the same as benchmarks.py.
+"""
+
+import sys, os, datetime, decimal
+from os.path import join, dirname, abspath, exists
+from testutils import *
+from benchmarks import load_pyodbc, result, best_time, compare, print_results, environment, json
+
+# Keep in sync with TraceParamKind in src/trace.cpp.
+PARAM_NONE, PARAM_BOOL, PARAM_INT, PARAM_LONG, PARAM_FLOAT, PARAM_STRING, PARAM_UNICODE, PARAM_BUFFER, \
+    PARAM_DECIMAL, PARAM_DATETIME, PARAM_DATE, PARAM_TIME, PARAM_OTHER = range(13)
+
+# The mock driver type for each fixed length SQL type and the bytes a value is read as.
+SQL_TYPES = {
+    -7  : ('bit',       1),         # SQL_BIT
+    -6  : ('smallint',  2),         # SQL_TINYINT
+    5   : ('smallint',  2),         # SQL_SMALLINT
+    4   : ('int',       4),         # SQL_INTEGER
+    -5  : ('bigint',    8),         # SQL_BIGINT
+    6   : ('double',    8),         # SQL_FLOAT
+    7   : ('double',    8),         # SQL_REAL
+    8   : ('double',    8),         # SQL_DOUBLE
+    9   : ('date',      6),         # SQL_DATE
+    91  : ('date',      6),         # SQL_TYPE_DATE
+    10  : ('time',      6),         # SQL_TIME
+    92  : ('time',      6),         # SQL_TYPE_TIME
+    11  : ('timestamp', 16),        # SQL_TIMESTAMP
+    93  : ('timestamp', 16),        # SQL_TYPE_TIMESTAMP
+}
+
+# The mock driver type for each variable length SQL type and the bytes per character.
+VARIABLE_TYPES = {
+    1   : ('char',      1),         # SQL_CHAR
+    12  : ('varchar',   1),         # SQL_VARCHAR
+    -1  : ('text',      1),         # SQL_LONGVARCHAR
+    -8  : ('nvarchar',  2),         # SQL_WCHAR
+    -9  : ('nvarchar',  2),         # SQL_WVARCHAR
+    -10 : ('ntext',     2),         # SQL_WLONGVARCHAR
+    -2  : ('varbinary', 1),         # SQL_BINARY
+    -3  : ('varbinary', 1),         # SQL_VARBINARY
+    -4  : ('blob',      1),         # SQL_LONGVARBINARY
+}
+
+# The size used for variable length columns when no rows were fetched or the column size is unknown.
+DEFAULT_SIZE = 255
+
+
+class Statement(object):
+    def __init__(self, id, fingerprint, duration, rowcount, params, columns):
+        self.id          = id
+        self.fingerprint = fingerprint
+        self.duration    = duration
+        self.rowcount    = rowcount
+        self.params      = params       # [ (kind, size) ]
+        self.columns     = columns      # [ (sql_type, column_size) ]
+        self.rows        = None         # rows, bytes, and fetch duration from the result record, if there is one
+        self.bytes       = 0
+        self.fetch       = 0
+
+
+def read_trace(filename):
+    """
+    Reads a trace file and returns its statements in execute order.
+    """
+    data = open(filename, 'rb').read()
+    pos = [ 0 ]
+
+    def byte():
+        b = ord(data[pos[0]])
+        pos[0] += 1
+        return b
+
+    def varint():
+        n = shift = 0
+        while True:
+            b = byte()
+            n |= (b & 0x7F) << shift
+            shift += 7
+            if not b & 0x80:
+                return n
+
+    def signed():
+        n = varint()
+        return (n >> 1) ^ -(n & 1)
+
+    if data[:8] != 'PYODBCTR':
+        raise ValueError('%s is not a pyodbc trace file' % filename)
+    pos[0] = 8
+    version = varint()
+    if version != 1:
+        raise ValueError('%s is version %d, but only version 1 is supported' % (filename, version))
+
+    statements = []
+    byid = {}
+
+    while pos[0] < len(data):
+        tag = chr(byte())
+        if tag == 'E':
+            id          = varint()
+            fingerprint = varint()
+            duration    = varint()
+            rowcount    = signed()
+            params      = [ (byte(), varint()) for i in range(varint()) ]
+            columns     = [ (signed(), signed()) for i in range(varint()) ]
+            s = Statement(id, fingerprint, duration, rowcount, params, columns)
+            statements.append(s)
+            byid[id] = s
+        elif tag == 'R':
+            id, rows, bytes, fetch = varint(), varint(), varint(), varint()
+            s = byid.get(id)
+            if s:
+                s.rows, s.bytes, s.fetch = rows, bytes, fetch
+        else:
+            raise ValueError('%s has an unknown record type %r at offset %d' % (filename, tag, pos[0] - 1))
+
+    return statements
+
+
+def param_value(kind, size):
+    if kind == PARAM_BOOL:
+        return True
+    if kind == PARAM_INT:
+        return 1
+    if kind == PARAM_LONG:
+        return 1L
+    if kind == PARAM_FLOAT:
+        return 1.5
+    if kind == PARAM_STRING:
+        return 'x' * size
+    if kind == PARAM_UNICODE:
+        return u'x' * size
+    if kind == PARAM_BUFFER:
+        return buffer('x' * size)
+    if kind == PARAM_DECIMAL:
+        return decimal.Decimal('1.5')
+    if kind == PARAM_DATETIME:
+        return datetime.datetime(2011, 1, 1, 12, 30, 0)
+    if kind == PARAM_DATE:
+        return datetime.date(2011, 1, 1)
+    if kind == PARAM_TIME:
+        return datetime.time(12, 30, 0)
+    return None
+
+
+def column_types(statements):
+    """
+    Returns the mock driver types for the columns of statements that share a fingerprint.  Variable length columns
+    split the bytes per row left after the fixed length columns in proportion to their declared sizes.
+    """
+    columns = statements[0].columns
+
+    rows  = sum([ s.rows or 0 for s in statements ])
+    bytes = sum([ s.bytes for s in statements if s.rows ])
+
+    fixed  = 0
+    weight = 0
+    for sql_type, size in columns:
+        if sql_type in SQL_TYPES:
+            fixed += SQL_TYPES[sql_type][1]
+        elif sql_type in (2, 3):        # SQL_NUMERIC, SQL_DECIMAL are read as strings
+            fixed += max(size, 1) + 2
+        else:
+            weight += (size > 0) and min(size, 8000) or DEFAULT_SIZE
+
+    budget = rows and max(0, float(bytes) / rows - fixed)
+
+    types = []
+    for sql_type, size in columns:
+        if sql_type in SQL_TYPES:
+            types.append(SQL_TYPES[sql_type][0])
+        elif sql_type in (2, 3):
+            precision = min(max(size, 1), 38)
+            types.append('decimal(%d,%d)' % (precision, min(2, precision)))
+        else:
+            name, width = VARIABLE_TYPES.get(sql_type, ('varchar', 1))
+            declared = (size > 0) and min(size, 8000) or DEFAULT_SIZE
+            if rows:
+                length = int(budget * declared / weight / width)
+            else:
+                length = min(declared, DEFAULT_SIZE)
+            types.append('%s(%d)' % (name, max(1, length)))
+
+    return types
+
+
+class Replay(object):
+
+    def __init__(self, driver, statements):
+        self.cnxn   = pyodbc.connect('Driver=%s' % driver)
+        self.cursor = self.cnxn.cursor()
+
+        byfingerprint = {}
+        for s in statements:
+            byfingerprint.setdefault((s.fingerprint, tuple(s.columns), len(s.params)), []).append(s)
+
+        sql = {}
+        for key, group in byfingerprint.items():
+            fingerprint, columns, count = key
+            markers = ', '.join([ '?' ] * count)
+            if columns:
+                maxrows = max([ s.rows or 0 for s in group ])
+                text = 'select %d %s' % (maxrows, ', '.join(column_types(group)))
+                if count:
+                    text += ' where ' + markers
+            else:
+                maxrows = 0
+                text = 'insert into t%016x values (%s)' % (fingerprint, markers)
+            sql[key] = (text, maxrows)
+
+        # (sql, params, whether there are results, rows to fetch or None to fetch to the end)
+        self.work = []
+        for s in statements:
+            text, maxrows = sql[(s.fingerprint, tuple(s.columns), len(s.params))]
+            params = [ param_value(kind, size) for kind, size in s.params ]
+            fetch = s.rows
+            if fetch == maxrows:
+                fetch = None
+            self.work.append((text, params, bool(s.columns), fetch))
+
+        self.statements = len(statements)
+        self.rows  = sum([ s.rows or 0 for s in statements ])
+        self.bytes = sum([ s.bytes for s in statements ])
+        self.recorded = sum([ s.duration + s.fetch for s in statements ]) / 1000000000.0
+
+    def run(self):
+        cursor = self.cursor
+        for sql, params, results, fetch in self.work:
+            cursor.execute(sql, params)
+            if results:
+                if fetch is None:
+                    cursor.fetchall()
+                elif fetch:
+                    cursor.fetchmany(fetch)
+
+
+def main():
+    from optparse import OptionParser
+    parser = OptionParser(usage=usage)
+    parser.add_option("-n", "--repeat", type="int", default=3, help="Runs of the trace, best is reported (default %default)")
+    parser.add_option("-o", "--output", help="Write the results as JSON to this file")
+    parser.add_option("-c", "--compare", help="Compare with the JSON results in this file")
+    parser.add_option("-t", "--threshold", type="float", default=10.0,
+                      help="Percent slower than the comparison file reported as a regression (default %default)")
+
+    (options, args) = parser.parse_args()
+
+    if not 1 <= len(args) <= 2:
+        parser.error('Expected the trace file and optionally the path to the mock driver.')
+
+    if (options.output or options.compare) and not json:
+        parser.error('The json module is required to read or write results (Python 2.6 or later).')
+
+    if len(args) == 2:
+        driver = abspath(args[1])
+    else:
+        driver = join(dirname(dirname(abspath(__file__))), 'build', 'mockdriver', 'libpyodbcmock.so')
+
+    if not exists(driver):
+        parser.error('The mock driver was not found at %s.  Run "python setup.py mockdriver" first.' % driver)
+
+    statements = read_trace(args[0])
+    if not statements:
+        parser.error('The trace has no statements.')
+
+    replay = Replay(driver, statements)
+    elapsed = best_time(options.repeat, replay.run)
+
+    results = [ result('replay_statements', replay.statements / elapsed, 'statements/s', statements=replay.statements),
+                result('replay_rows', replay.rows / elapsed, 'rows/s', rows=replay.rows),
+                result('replay_bytes', replay.bytes / elapsed / (1024 * 1024), 'MB/s', bytes=replay.bytes),
+                result('replay_time', elapsed, 's', recorded=replay.recorded) ]
+
+    document = dict(environment=environment(replay.cnxn),
+                    settings=dict(trace=os.path.basename(args[0]), repeat=options.repeat, driver='mock'),
+                    results=results)
+
+    if options.output:
+        f = open(options.output, 'w')
+        json.dump(document, f, indent=2, sort_keys=True)
+        f.close()
+
+    if options.compare:
+        baseline = json.load(open(options.compare))
+        if baseline['settings'] != document['settings']:
+            print >>sys.stderr, 'warning: %s was run with different settings: %s' % (options.compare, baseline['settings'])
+        if compare(baseline, results, options.threshold):
+            raise SystemExit(1)
+    else:
+        print_results(results)
+
+
+if __name__ == '__main__':
+    pyodbc = load_pyodbc()
+    main()
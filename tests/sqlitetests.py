@@ -210,6 +210,19 @@ class SqliteTestCase(unittest.TestCase):
     def test_text_upperlatin(self):
         self._test_strtype('varchar', u'')
 
+    def test_text_nonbmp(self):
+        # Characters outside the BMP are sent and read as UTF-16 surrogate pairs on UCS4 builds.
+        value = u'abc\U0001F600' * 100
+        self._test_strtype('text', value, len(value))
+
+    def test_text_nonbmp_large(self):
+        # Values over the 1024 byte stack buffer are read in pieces and widened in place.  The prefixes put a surrogate
+        # pair on each side of the first piece's boundary.
+        for prefix in (510, 511):
+            value = u'a' * prefix + u'\U0001F600' * 1000
+            self._test_strtype('text', value, len(value))
+            self.cursor.execute("drop table t1")
+
     #
     # blob
     #
@@ -556,6 +569,425 @@ class SqliteTestCase(unittest.TestCase):
         othercnxn.autocommit = False
         self.assertEqual(othercnxn.autocommit, False)
 
+    def test_group_commit(self):
+        self.cursor.execute("create table t1(n int)")
+        self.cnxn.commit()
+        self.cnxn.group_commit(count=3)
+        for i in range(7):
+            self.cursor.execute("insert into t1 values (?)", i)
+            self.cnxn.commit()
+        # Two batches of 3 were sent, coalescing 2 commits each; one commit is still pending.
+        self.assertEqual(self.cnxn.coalesced_commits, 4)
+        self.cnxn.flush()
+        self.cnxn.group_commit()
+        self.assertEqual(self.cnxn.coalesced_commits, 4)
+        self.cnxn.rollback()
+        self.assertEqual(self.cursor.execute("select count(*) from t1").fetchone()[0], 7)
+
+    def test_group_commit_uncommitted(self):
+        # Changes made after the last commit() are not committed implicitly along with the deferred commits.
+        self.cursor.execute("create table t1(n int)")
+        self.cnxn.commit()
+        self.cnxn.group_commit(count=10)
+        self.cursor.execute("insert into t1 values (1)")
+        self.cnxn.commit()
+        self.cursor.execute("insert into t1 values (2)")
+        self.assertRaises(pyodbc.ProgrammingError, self.cnxn.flush)
+        self.assertRaises(pyodbc.ProgrammingError, self.cnxn.close)
+        self.cnxn.commit()
+        self.cnxn.close()
+
+        othercnxn = pyodbc.connect(self.connection_string)
+        self.assertEqual(othercnxn.execute("select count(*) from t1").fetchone()[0], 2)
+        othercnxn.close()
+
+    def test_statement_pool(self):
+        self.cnxn.execute("select 1").fetchone()
+        reused = self.cnxn.statements_reused
+        for i in range(3):
+            self.assertEqual(self.cnxn.execute("select 1").fetchone()[0], 1)
+        self.assertEqual(self.cnxn.statements_reused, reused + 3)
+
+        self.cnxn.statement_pool_size = 0
+        allocated = self.cnxn.statements_allocated
+        self.cnxn.execute("select 1").fetchone()
+        self.cnxn.execute("select 1").fetchone()
+        self.assertEqual(self.cnxn.statements_allocated, allocated + 2)
+        self.assertRaises(ValueError, setattr, self.cnxn, 'statement_pool_size', -1)
+
+    def test_description_cache(self):
+        self.cursor.execute("create table t1(n int, s varchar(20))")
+        self.cursor.execute("insert into t1 values (1, 'one')")
+        sql = "select n, s from t1 where n = ?"
+
+        self.cursor.execute(sql, 1)
+        desc = self.cursor.description
+        self.assertEqual(self.cursor.fetchone().s, 'one')
+
+        # Executing the same prepared statement reuses the description.
+        self.cursor.execute(sql, 1)
+        self.assert_(self.cursor.description is desc)
+        self.assertEqual(self.cursor.fetchone().n, 1)
+
+        # A catalog function replaces the prepared statement.
+        self.cursor.tables().fetchall()
+        self.cursor.execute(sql, 1)
+        self.assertEqual(self.cursor.fetchone().s, 'one')
+
+    def test_description_cache_type_change(self):
+        # The same statement returns a different type when a parameter's type changes, so the cached description is
+        # not reused.
+        sql = "select ?"
+        self.assertEqual(self.cursor.execute(sql, 1).fetchone()[0], 1)
+        value = 'x' * 100
+        self.assertEqual(self.cursor.execute(sql, value).fetchone()[0], value)
+        self.assertEqual(self.cursor.execute(sql, 2.5).fetchone()[0], 2.5)
+
+    def test_recheck_columns(self):
+        self.assertEqual(self.cnxn.recheck_columns, False)
+        self.cnxn.recheck_columns = True
+        self.assertEqual(self.cnxn.recheck_columns, True)
+
+        self.cursor.execute("create table t1(n int, s varchar(20))")
+        self.cursor.execute("insert into t1 values (1, 'one')")
+        sql = "select n, s from t1 where n = ?"
+
+        self.cursor.execute(sql, 1)
+        desc = self.cursor.description
+
+        # The columns are described again, but they are unchanged so the description is still reused.
+        self.cursor.execute(sql, 1)
+        self.assert_(self.cursor.description is desc)
+        self.assertEqual(self.cursor.fetchone().s, 'one')
+
+    def test_metadata_cache(self):
+        self.cursor.execute("create table t1(n int)")
+        self.cnxn.metadata_cache_ttl = 60
+
+        first = [tuple(row) for row in self.cursor.tables(table='t1')]
+        self.assertEqual(self.cnxn.metadata_cache_misses, 1)
+        second = [tuple(row) for row in self.cursor.tables(table='t1')]
+        self.assertEqual(self.cnxn.metadata_cache_hits, 1)
+        self.assertEqual(first, second)
+        self.assertEqual(self.cursor.description[2][0], 'table_name')
+
+        self.cnxn.getinfo(pyodbc.SQL_DRIVER_NAME)
+        self.cnxn.getinfo(pyodbc.SQL_DRIVER_NAME)
+        self.assertEqual(self.cnxn.metadata_cache_hits, 2)
+
+        self.cnxn.clear_metadata_cache()
+        self.cursor.tables(table='t1').fetchall()
+        self.assertEqual(self.cnxn.metadata_cache_misses, 3)
+
+    def test_result_cache(self):
+        self.cursor.execute("create table t1(n int, s varchar(20))")
+        self.cursor.execute("insert into t1 values (1, 'one')")
+        self.cnxn.commit()
+
+        cache = pyodbc.ResultCache(max_bytes=1024 * 1024, ttl=60)
+        self.cnxn.result_cache = cache
+
+        first = self.cursor.execute("select n, s from t1 where n=?", 1).fetchall()
+        self.assertEqual(cache.misses, 1)
+        self.assertEqual(cache.count, 1)
+        self.assert_(cache.bytes > 0)
+
+        second = self.cursor.execute("select n, s from t1 where n=?", 1).fetchall()
+        self.assertEqual(cache.hits, 1)
+        self.assertEqual([tuple(r) for r in first], [tuple(r) for r in second])
+        self.assertEqual(second[0].s, 'one')
+
+        # The cache is bypassed once the transaction has written.
+        self.cursor.execute("insert into t1 values (2, 'two')")
+        self.cursor.execute("select n, s from t1 where n=?", 1).fetchall()
+        self.assertEqual(cache.hits, 1)
+        self.cnxn.rollback()
+
+        self.cursor.execute("select n, s from t1 where n=?", 1).fetchall()
+        self.assertEqual(cache.hits, 2)
+        self.assertEqual(cache.hit_ratio, 2.0 / 3.0)
+
+        cache.clear()
+        self.assertEqual(cache.count, 0)
+        self.assertEqual(cache.bytes, 0)
+
+    def test_result_cache_commit(self):
+        self.cursor.execute("create table t1(n int)")
+        self.cursor.execute("insert into t1 values (1)")
+        self.cnxn.commit()
+
+        cache = pyodbc.ResultCache(max_bytes=1024 * 1024, ttl=60)
+        self.cnxn.result_cache = cache
+        sql = "select count(*) from t1"
+
+        self.assertEqual(self.cursor.execute(sql).fetchall()[0][0], 1)
+        self.assertEqual(self.cursor.execute(sql).fetchall()[0][0], 1)
+        self.assertEqual(cache.hits, 1)
+
+        # Committing a write empties the cache, so the new count is read.
+        self.cursor.execute("insert into t1 values (2)")
+        self.cnxn.commit()
+        self.assertEqual(cache.count, 0)
+        self.assertEqual(self.cursor.execute(sql).fetchall()[0][0], 2)
+
+        # In autocommit mode, each write empties it.
+        self.cnxn.autocommit = True
+        self.assertEqual(self.cursor.execute(sql).fetchall()[0][0], 2)
+        self.cursor.execute("insert into t1 values (3)")
+        self.assertEqual(cache.count, 0)
+        self.assertEqual(self.cursor.execute(sql).fetchall()[0][0], 3)
+
+    def test_result_cache_settings(self):
+        self.cursor.execute("create table t1(s varchar(20))")
+        self.cursor.execute("insert into t1 values ('one')")
+        self.cnxn.commit()
+
+        cache = pyodbc.ResultCache(max_bytes=1024 * 1024, ttl=60)
+        self.cnxn.result_cache = cache
+        othercnxn = pyodbc.connect(self.connection_string, unicode_results=True)
+        othercnxn.result_cache = cache
+        sql = "select s from t1"
+
+        # The connections return different types, so they do not share the cached results.
+        self.assertEqual(type(self.cursor.execute(sql).fetchall()[0].s), str)
+        self.assertEqual(type(othercnxn.cursor().execute(sql).fetchall()[0].s), unicode)
+        self.assertEqual(cache.hits, 0)
+        self.assertEqual(cache.count, 2)
+
+        self.cnxn.add_output_converter(pyodbc.SQL_VARCHAR, lambda s: s.upper())
+        self.assertEqual(self.cursor.execute(sql).fetchall()[0].s, 'ONE')
+        self.assertEqual(cache.hits, 0)
+        othercnxn.close()
+
+    def test_skip_cached_results(self):
+        self.cursor.execute("create table t1(n int)")
+        for i in range(5):
+            self.cursor.execute("insert into t1 values (?)", i)
+        self.cnxn.commit()
+
+        self.cnxn.result_cache = pyodbc.ResultCache(max_bytes=1024 * 1024, ttl=60)
+        sql = "select n from t1 where n < ? order by n"
+
+        # Skipping rows that are being recorded leaves them out, so the results are not cached.
+        self.cursor.execute(sql, 10)
+        self.cursor.skip(1)
+        self.assertEqual([row.n for row in self.cursor], [1, 2, 3, 4])
+        self.assertEqual(self.cnxn.result_cache.count, 0)
+
+        self.cursor.execute(sql, 10).fetchall()
+        self.assertEqual(self.cnxn.result_cache.count, 1)
+
+        self.cursor.execute(sql, 10)
+        self.assertEqual(self.cnxn.result_cache.hits, 1)
+        self.cursor.skip(2)
+        self.assertEqual(self.cursor.fetchone().n, 2)
+        self.cursor.skip(10)
+        self.assertEqual(self.cursor.fetchone(), None)
+
+        self.cursor.execute(sql, 10)
+        self.assertEqual(self.cursor.nextset(), False)
+        self.assertEqual(self.cursor.description, None)
+
+    def test_skip_metadata_cache(self):
+        for name in ['t1', 't2', 't3']:
+            self.cursor.execute("create table %s(n int)" % name)
+        names = [row.table_name for row in self.cursor.tables()]
+
+        self.cnxn.metadata_cache_ttl = 60
+
+        # The first call reads the rows into the cache and the second returns them from it.
+        for i in range(2):
+            self.cursor.tables()
+            self.cursor.skip(1)
+            self.assertEqual(self.cursor.fetchone().table_name, names[1])
+            self.assertEqual(self.cursor.nextset(), False)
+        self.assertEqual(self.cnxn.metadata_cache_hits, 1)
+
+    def test_stats(self):
+        self.cursor.execute("create table t1(n int, s varchar(20))")
+        self.cursor.execute("insert into t1 values (1, 'one')")
+        self.cursor.execute("insert into t1 values (2, 'two')")
+
+        previous = pyodbc.enable_stats(True)
+        try:
+            self.cursor.execute("select n, s from t1").fetchall()
+            stats = self.cursor.stats
+            self.assertEqual(stats['executes'], 1)
+            self.assertEqual(stats['rows'], 2)
+            self.assert_(stats['bytes'] > 0)
+            self.assert_(stats['fetch'] >= 0.0)
+            self.assertEqual(self.cnxn.stats['rows'], 2)
+        finally:
+            pyodbc.enable_stats(previous)
+
+        # Nothing is collected while stats are off.
+        self.cursor.execute("select n, s from t1").fetchall()
+        self.assertEqual(self.cursor.stats['rows'], 2)
+
+    def test_query_log(self):
+        self.cursor.execute("create table t1(n int)")
+        pyodbc.enable_query_log(2)
+        slow = []
+        pyodbc.set_slow_query_handler(lambda *args: slow.append(args), 0.0)
+        try:
+            self.cursor.execute("insert into t1 values (1)")
+            self.cursor.execute("insert into t1 values (?)", 2)
+            self.assertRaises(pyodbc.Error, self.cursor.execute, "select * from bogus")
+
+            # The ring only holds the last two.
+            events = pyodbc.drain_query_log()
+            self.assertEqual(len(events), 2)
+            self.assertEqual(events[0][0], "insert into t1 values (?)")
+            self.assertEqual(events[0][2], 1)
+            self.assertEqual(events[0][4], 1)
+            self.assertEqual(events[0][5], None)
+            self.assertEqual(events[1][4], -1)
+            self.assertNotEqual(events[1][5], None)
+            self.assertEqual(pyodbc.drain_query_log(), [])
+
+            self.cursor.execute("insert into t1 values (3)")
+            events = pyodbc.drain_query_log()
+            self.assertEqual(len(events), 1)
+            self.assertEqual(len(slow), 4)
+
+            # Statements that return rows are recorded when their results are finished, with the rows fetched.
+            self.cursor.execute("select n from t1")
+            self.assertEqual(pyodbc.drain_query_log(), [])
+            self.assertEqual(len(self.cursor.fetchall()), 3)
+            self.cursor.execute("select n from t1").fetchone()
+            self.cursor.close()
+            self.cursor = self.cnxn.cursor()
+            events = pyodbc.drain_query_log()
+            self.assertEqual([event[4] for event in events], [3, 1])
+
+            # Literals do not change the fingerprint.
+            self.cursor.execute("select * from t1 where n = 12").fetchall()
+            self.cursor.execute("SELECT *  FROM t1 WHERE n = 3").fetchall()
+            self.cursor.execute("select * from t1 where n = 'x'").fetchall()
+            events = pyodbc.drain_query_log()
+            self.assertEqual(events[0][1], events[1][1])
+            self.assertEqual(events[0][1], events[2][1])
+        finally:
+            pyodbc.set_slow_query_handler(None)
+            pyodbc.enable_query_log(0)
+
+    def test_gil_warning_handler(self):
+        self.cursor.execute("create table t1(n int)")
+        self.cursor.execute("insert into t1 values (1)")
+        self.cursor.execute("insert into t1 values (2)")
+
+        warnings = []
+        pyodbc.set_gil_warning_handler(lambda *args: warnings.append(args), 0.0)
+        previous = pyodbc.enable_stats(True)
+        try:
+            self.cursor.execute("select n from t1").fetchall()
+            self.assertEqual(len(warnings), 1)
+            cursor, seconds, rows = warnings[0]
+            self.assert_(cursor is self.cursor)
+            self.assert_(seconds >= 0.0)
+            self.assertEqual(rows, 2)
+
+            stats = self.cursor.stats
+            self.assert_(stats['fetch_gil_held'] >= stats['longest_gil_hold'])
+            self.assert_(stats['fetch_gil_released'] > 0.0)
+
+            self.cursor.execute("select n from t1")
+            self.cursor.fetchone()
+            self.assertEqual(warnings[-1][2], 1)
+        finally:
+            pyodbc.enable_stats(previous)
+            pyodbc.set_gil_warning_handler(None)
+
+        self.assertRaises(TypeError, pyodbc.set_gil_warning_handler, 1)
+
+    def test_trace(self):
+        from replaytrace import read_trace, PARAM_INT, PARAM_STRING
+        import tempfile
+
+        self.cursor.execute("create table t1(n int, s varchar(20))")
+        for i in range(3):
+            self.cursor.execute("insert into t1 values (?, 'x')", i)
+
+        fd, filename = tempfile.mkstemp()
+        os.close(fd)
+        try:
+            pyodbc.start_trace(filename)
+            try:
+                self.cursor.execute("insert into t1 values (?, ?)", 3, 'abc')
+                self.cursor.execute("select n, s from t1").fetchall()
+                # executemany records each parameter set as an execute.
+                self.cursor.executemany("insert into t1 values (?, ?)", [ (4, 'a'), (5, 'b') ])
+            finally:
+                self.assertEqual(pyodbc.stop_trace(), 4)
+
+            statements = read_trace(filename)
+            self.assertEqual(len(statements), 4)
+            self.assertEqual(statements[0].params, [ (PARAM_INT, 0), (PARAM_STRING, 3) ])
+            self.assertEqual(statements[0].columns, [])
+            self.assertEqual(len(statements[1].columns), 2)
+            self.assertEqual(statements[1].rows, 4)
+            self.assert_(statements[1].bytes > 0)
+            self.assertEqual(statements[3].params, [ (PARAM_INT, 0), (PARAM_STRING, 1) ])
+        finally:
+            os.remove(filename)
+
+    def test_odbc_counts(self):
+        self.cursor.execute("create table t1(n int, s varchar(20))")
+        self.cursor.execute("insert into t1 values (?, ?)", 1, 'abc')
+
+        before = self.cnxn.odbc_counts
+        total = pyodbc.odbc_counts()
+        self.cursor.execute("select n, s from t1").fetchall()
+        after = self.cnxn.odbc_counts
+
+        self.assertEqual(after['calls']['SQLGetData'] - before['calls']['SQLGetData'], 2)
+        self.assert_(after['calls']['SQLFetch'] > before['calls'].get('SQLFetch', 0))
+        self.assert_(after['bytes_received'] > before['bytes_received'])
+        self.assert_(after['bytes_sent'] > before['bytes_sent'])
+        self.assert_(pyodbc.odbc_counts()['calls']['SQLGetData'] >= total['calls']['SQLGetData'] + 2)
+
+    def test_latency_histograms(self):
+        self.cursor.execute("create table t1(n int)")
+        self.cursor.execute("insert into t1 values (1)")
+
+        pyodbc.reset_latency_histograms()
+        previous = pyodbc.enable_latency_histograms(True)
+        try:
+            for i in range(3):
+                self.cursor.execute("select n from t1 where n = %d" % i).fetchall()
+        finally:
+            pyodbc.enable_latency_histograms(previous)
+
+        histograms = pyodbc.latency_histograms()
+        self.assertEqual(len(histograms), 1)
+        entry = histograms.values()[0]
+        self.assertEqual(entry['sql'], "select n from t1 where n = 0")
+        self.assertEqual(entry['execute']['count'], 3)
+        self.assertEqual(entry['fetch']['count'], 3)
+        self.assertEqual(sum(count for bound, count in entry['execute']['buckets']), 3)
+        self.assert_(entry['execute']['p50'] <= entry['execute']['max'])
+
+        pyodbc.reset_latency_histograms()
+        self.assertEqual(pyodbc.latency_histograms(), {})
+
+    def test_memory_stats(self):
+        self.cursor.execute("create table t1(n int, s varchar(20))")
+        self.cursor.execute("insert into t1 values (1, 'one')")
+
+        previous = pyodbc.enable_memory_tracking(True)
+        try:
+            before = pyodbc.memory_stats()
+            rows = self.cursor.execute("select n, s from t1").fetchall()
+            during = pyodbc.memory_stats()
+            self.assertEqual(during['rowvalues']['live_blocks'] - before['rowvalues']['live_blocks'], 1)
+            self.assert_(during['total']['peak_bytes'] >= during['total']['live_bytes'])
+
+            del rows
+            after = pyodbc.memory_stats()
+            self.assertEqual(after['rowvalues']['live_blocks'], before['rowvalues']['live_blocks'])
+        finally:
+            pyodbc.enable_memory_tracking(previous)
+
     def test_unicode_results(self):
         "Ensure unicode_results forces Unicode"
         othercnxn = pyodbc.connect(self.connection_string, unicode_results=True)
@@ -569,6 +1001,101 @@ class SqliteTestCase(unittest.TestCase):
         value = othercursor.execute("select s from t1").fetchone()[0]
         self.assertEqual(value, u'test')
 
+    def test_unicode_results_encoding(self):
+        "Ensure char data is decoded with the connection's encoding"
+        othercnxn = pyodbc.connect(self.connection_string, unicode_results=True, encoding='utf-8')
+        self.assertEqual(othercnxn.encoding, 'utf-8')
+        othercursor = othercnxn.cursor()
+
+        othercursor.execute("create table t1(s varchar(20))")
+        othercursor.execute("insert into t1 values(?)", u'caf\xe9 \u20ac')
+
+        value = othercursor.execute("select s from t1").fetchone()[0]
+        self.assertEqual(value, u'caf\xe9 \u20ac')
+
+        othercnxn.encoding = None
+        self.assertEqual(othercnxn.encoding, None)
+        self.assertRaises(LookupError, setattr, othercnxn, 'encoding', 'nosuchcodec')
+
+    def test_intern_limit(self):
+        "Ensure repeated values are returned as the same object"
+        self.cursor.execute("create table t1(s varchar(20))")
+        for i in range(10):
+            self.cursor.execute("insert into t1 values(?)", 'abc')
+
+        self.assertEqual(self.cnxn.intern_limit, 0)
+        self.cnxn.intern_limit = 10
+        rows = self.cursor.execute("select s from t1").fetchall()
+        self.assertEqual(rows[0][0], 'abc')
+        self.assert_(rows[0][0] is rows[9][0])
+
+        self.assertRaises(ValueError, setattr, self.cnxn, 'intern_limit', -1)
+
+    def test_intern_limit_dates(self):
+        "Ensure repeated date and datetime values are returned as the same object"
+        self.cursor.execute("create table t1(d date, dt timestamp)")
+        d  = date(2011, 4, 5)
+        dt = datetime(2011, 4, 5, 13, 14, 15)
+        for i in range(5):
+            self.cursor.execute("insert into t1 values(?, ?)", d, dt)
+
+        self.cnxn.intern_limit = 10
+        previous = pyodbc.enable_stats(True)
+        try:
+            rows = self.cursor.execute("select d, dt from t1").fetchall()
+            hits = self.cursor.stats['intern_hits']
+        finally:
+            pyodbc.enable_stats(previous)
+
+        self.assertEqual(rows[0].d, d)
+        self.assertEqual(rows[0].dt, dt)
+        self.assert_(rows[0].d is rows[4].d)
+        self.assert_(rows[0].dt is rows[4].dt)
+
+        # Each column misses on the first row and hits on the other four.
+        self.assertEqual(hits, 8)
+
+    def test_lazy_rows(self):
+        "Ensure lazy rows return the same values as eager ones"
+        self.cursor.execute("create table t1(n int, s varchar(20), f float)")
+        self.cursor.execute("insert into t1 values(?, ?, ?)", 1, 'abc', 1.5)
+        self.cursor.execute("insert into t1 values(?, ?, ?)", 2, None, 2.5)
+
+        self.assertEqual(self.cnxn.lazy_rows, False)
+        self.cnxn.lazy_rows = True
+        rows = self.cursor.execute("select n, s, f from t1 order by n").fetchall()
+        self.assertEqual(rows[0].s, 'abc')
+        self.assertEqual(rows[0][0], 1)
+        self.assertEqual(rows[1][1:], (None, 2.5))
+        self.assertEqual(tuple(rows[0]), (1, 'abc', 1.5))
+
+        # A column is converted once and the object is kept.
+        self.assert_(rows[0].s is rows[0].s)
+
+    def test_lazy_rows_memory(self):
+        "Ensure lazy rows free their data once it is no longer needed"
+        self.cursor.execute("create table t1(n int, s varchar(1000))")
+        # Enough data to fill several 64KB blocks.
+        for i in range(200):
+            self.cursor.execute("insert into t1 values(?, ?)", i, str(i) * (1000 // len(str(i))))
+
+        self.cnxn.lazy_rows = True
+        previous = pyodbc.enable_memory_tracking(True)
+        try:
+            before = pyodbc.memory_stats()['rawrows']['live_blocks']
+
+            rows = self.cursor.execute("select n, s from t1 order by n").fetchall()
+            self.assert_(pyodbc.memory_stats()['rawrows']['live_blocks'] - before > 1)
+            del rows
+            self.assertEqual(pyodbc.memory_stats()['rawrows']['live_blocks'], before)
+
+            rows = self.cursor.execute("select n, s from t1 order by n").fetchall()
+            for i, row in enumerate(rows):
+                self.assertEqual(tuple(row), (i, str(i) * (1000 // len(str(i)))))
+            self.assertEqual(pyodbc.memory_stats()['rawrows']['live_blocks'], before)
+        finally:
+            pyodbc.enable_memory_tracking(previous)
+
     def test_skip(self):
         # Insert 1, 2, and 3.  Fetch 1, skip 2, fetch 3.
 
@@ -711,6 +1238,105 @@ class SqliteTestCase(unittest.TestCase):
         self.cursor.execute('select 1')
         self.cursor.execute('select 1')
 
+    def test_cancel(self):
+        # Nothing is running, so this should not do anything.
+        self.cursor.cancel()
+        value = self.cursor.execute("select 1").fetchone()[0]
+        self.assertEqual(value, 1)
+
+    def test_execute_timeout(self):
+        # A generous timeout should not interfere with a quick statement.
+        value = self.cursor.execute("select ?", 1, timeout=30).fetchone(timeout=30)[0]
+        self.assertEqual(value, 1)
+
+        rows = self.cursor.execute("select 1 union select 2", timeout=0.5).fetchall(timeout=0.5)
+        self.assertEqual(len(rows), 2)
+
+    def test_execute_timeout_expired(self):
+        # Counting to a billion takes far longer than the timeout, so the watchdog cancels it.
+        sql = ("with recursive c(x) as (select 1 union all select x + 1 from c where x < 1000000000) "
+               "select count(*) from c")
+        try:
+            self.cursor.execute(sql, timeout=0.1).fetchone()
+            self.fail("The timeout did not expire")
+        except pyodbc.OperationalError, ex:
+            self.assertEqual(ex.args[1], 'HYT00')
+
+    def test_execute_timeout_invalid(self):
+        self.assertRaises(ValueError, self.cursor.execute, "select 1", timeout=-1)
+        self.assertRaises(ValueError, self.cursor.execute, "select 1", timeout=float('nan'))
+        self.assertRaises(ValueError, self.cursor.execute, "select 1", timeout=float('inf'))
+        self.assertRaises(TypeError, self.cursor.execute, "select 1", bogus=1)
+
+    def test_execute_async(self):
+        future = self.cursor.execute_async("select ?", 1)
+        self.assertEqual(future.cursor, self.cursor)
+        self.assertEqual(future.result(), self.cursor)
+        self.assertEqual(future.done(), True)
+        self.assertEqual(future.cancel(), False)
+        self.assertEqual(self.cursor.fetchone()[0], 1)
+
+    def test_execute_async_error(self):
+        future = self.cursor.execute_async("select * from bogus_table")
+        self.assertRaises(pyodbc.Error, future.result)
+        # The error is kept, and the cursor is usable again.
+        self.assertRaises(pyodbc.Error, future.result)
+        self.assertEqual(self.cursor.execute("select 1").fetchone()[0], 1)
+
+    def test_fetchmany_async(self):
+        self.cursor.execute("create table t1(n int)")
+        for n in range(5):
+            self.cursor.execute("insert into t1 values (?)", n)
+
+        cursors = [ self.cnxn.cursor(), self.cnxn.cursor() ]
+        futures = [ c.execute("select n from t1 order by n").fetchmany_async(3) for c in cursors ]
+
+        done = []
+        pending = futures
+        while pending:
+            d, pending = pyodbc.wait(pending)
+            done.extend(d)
+
+        self.assertEqual(len(done), 2)
+        for future in futures:
+            self.assertEqual([ row.n for row in future.result() ], [ 0, 1, 2 ])
+
+    def test_execute_parallel(self):
+        self.cursor.execute("create table t1(n int)")
+        for n in range(5):
+            self.cursor.execute("insert into t1 values (?)", n)
+        self.cnxn.commit()
+
+        cnxns = [ pyodbc.connect(self.connection_string) for i in range(2) ]
+        jobs = [ ("select n from t1 where n=?", (n,)) for n in range(5) ] + [ "update t1 set n=n where n < 2" ]
+
+        results, wall, summed = pyodbc.execute_parallel(cnxns, jobs, timings=True)
+        self.assertEqual(len(results), 6)
+        for n in range(5):
+            self.assertEqual(results[n][0].n, n)
+        self.assertEqual(results[5], 2)
+        self.assert_(wall >= 0 and summed >= 0)
+
+    def test_execute_parallel_error(self):
+        self.assertRaises(pyodbc.Error, pyodbc.execute_parallel, [ self.cnxn ], [ "select 1", "select * from bogus_table" ])
+        self.assertRaises(pyodbc.ProgrammingError, pyodbc.execute_parallel, [ self.cnxn, self.cnxn ], [ "select 1" ])
+
+    def test_scatter_gather(self):
+        self.cursor.execute("create table t1(n int)")
+        for n in range(10):
+            self.cursor.execute("insert into t1 values (?)", n)
+        self.cnxn.commit()
+
+        cnxns = [ pyodbc.connect(self.connection_string) for i in range(2) ]
+        sql = "select n from t1 where n % 2 = ? order by n"
+        partitions = [ (cnxns[0], sql, (0,)), (cnxns[1], sql, (1,)) ]
+
+        merged = [ row.n for row in pyodbc.scatter_gather(partitions, order_by='n', batch_size=2) ]
+        self.assertEqual(merged, range(10))
+
+        unordered = [ row[0] for row in pyodbc.scatter_gather(partitions, batch_size=3) ]
+        self.assertEqual(sorted(unordered), range(10))
+
 def main():
     from optparse import OptionParser
     parser = OptionParser(usage=usage)
@@ -0,0 +1,636 @@
+
+// Microbenchmarks for pyodbc's native conversion code, run without a database or a driver manager.
+//
+// Build and run it with:
+//
+//   python setup.py kernelbench
+//   build/kernelbench/kernelbench [--json] [--filter text] [--min-time ms] [--no-avx2]
+//
+// The kernels are the functions every fetched value or bound parameter passes through: converting Unicode to and from
+// SQLWCHAR, decoding UTF-8, formatting Decimal parameters, reading long values through DataBuffer, and building Row objects.  They
+// need the Python runtime, so this is a small executable that embeds Python and links the pyodbc sources directly.
+// Functions that are private to their files are reached through the hooks in kernelbench.h, which only exist in this
+// build.  --no-avx2 turns off the AVX2 kernels so they can be compared with the SSE2 ones.
+//
+// Each kernel is run for at least the minimum time, doubling the iterations until it is reached, and the time per
+// call is reported along with the bytes of input handled per call.  With --json, each result is printed as a JSON
+// object on its own line so it can be compared between builds.
+
+#include "pyodbc.h"
+#include "params.h"
+#include "cursor.h"
+#include "row.h"
+#include "wrapper.h"
+#include "threads.h"
+#include "kernelbench.h"
+#include "sqlwchar.h"
+#include "utf8.h"
+#include "cpufeatures.h"
+
+PyMODINIT_FUNC initpyodbc();
+
+static bool json_output = false;
+static const char* filter = 0;
+static UINT64 min_time = 200 * 1000000;      // nanoseconds
+
+static const Py_ssize_t STRING_SIZES[] = { 1, 16, 256, 4096, 65536 };
+static const Py_ssize_t BUFFER_SIZES[] = { 100, 1020, 4096, 65536, 1024 * 1024 };
+static const int DECIMAL_DIGITS[]      = { 4, 12, 28 };
+static const int ROW_COLUMNS[]         = { 1, 10, 100 };
+
+#define _countof(a) (sizeof(a) / sizeof(a[0]))
+
+template<typename Kernel>
+static bool Run(const char* name, Py_ssize_t size, Py_ssize_t bytes, Kernel& kernel)
+{
+    // Returns false if the kernel failed, leaving the Python exception set.
+
+    if (filter && !strstr(name, filter))
+        return true;
+
+    // One call to warm up the caches and the allocator.
+    if (!kernel())
+        return false;
+
+    UINT64 iterations = 1;
+    UINT64 elapsed;
+
+    for (;;)
+    {
+        UINT64 start = MonotonicNanoseconds();
+        for (UINT64 i = 0; i < iterations; i++)
+        {
+            if (!kernel())
+                return false;
+        }
+        elapsed = MonotonicNanoseconds() - start;
+
+        if (elapsed >= min_time)
+            break;
+
+        iterations *= 2;
+    }
+
+    double ns = (double)elapsed / (double)iterations;
+    double mbps = ns > 0 ? (double)bytes / ns * 1000000000.0 / (1024 * 1024) : 0.0;
+
+    if (json_output)
+        printf("{\"kernel\": \"%s\", \"size\": %ld, \"ns_per_op\": %.1f, \"bytes_per_op\": %ld, \"mb_per_s\": %.1f}\n",
+               name, (long)size, ns, (long)bytes, mbps);
+    else
+        printf("%-28s %10ld %14.1f %14ld %12.1f\n", name, (long)size, ns, (long)bytes, mbps);
+
+    fflush(stdout);
+    return true;
+}
+
+//
+// Unicode to SQLWCHAR
+//
+
+struct SqlwcharCopy
+{
+    const Py_UNICODE* src;
+    Py_ssize_t len;
+    SQLWCHAR* dest;
+
+    bool operator()()
+    {
+        // Parameters are measured with SQLWCHAR_Length and then copied, so time both.
+        Py_ssize_t cch = SQLWCHAR_Length(src, len);
+        if (SQLWCHAR_Copy(dest, src, len) != cch)
+        {
+            PyErr_SetString(PyExc_RuntimeError, "SQLWCHAR_Copy failed");
+            return false;
+        }
+        return true;
+    }
+};
+
+static bool BenchSqlwchar()
+{
+    // Text with a character outside the BMP every 16 characters is included since it takes the slower path on UCS4
+    // builds.  (It is only possible on UCS4 builds.)
+
+    static const struct
+    {
+        const char* name;
+        bool nonbmp;
+    } kinds[] =
+    {
+        { "SQLWCHAR_Copy",    false },
+#if Py_UNICODE_SIZE == 4
+        { "SQLWCHAR_Copy_sp", true },
+#endif
+    };
+
+    for (size_t k = 0; k < _countof(kinds); k++)
+    {
+        for (size_t i = 0; i < _countof(STRING_SIZES); i++)
+        {
+            Py_ssize_t len = STRING_SIZES[i];
+
+            Object str(PyUnicode_FromUnicode(0, len));
+            if (!str)
+                return false;
+
+            Py_UNICODE* p = PyUnicode_AS_UNICODE(str.Get());
+            for (Py_ssize_t j = 0; j < len; j++)
+                p[j] = (kinds[k].nonbmp && j % 16 == 15) ? (Py_UNICODE)0x1F600 : (Py_UNICODE)('a' + j % 26);
+
+            SqlwcharCopy kernel;
+            kernel.src  = p;
+            kernel.len  = len;
+            kernel.dest = (SQLWCHAR*)pyodbc_malloc(sizeof(SQLWCHAR) * (SQLWCHAR_Length(p, len) + 1), MEM_SQLWCHAR);
+            if (!kernel.dest)
+            {
+                PyErr_NoMemory();
+                return false;
+            }
+
+            bool ok = Run(kinds[k].name, len, len * sizeof(Py_UNICODE), kernel);
+            pyodbc_free(kernel.dest);
+            if (!ok)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+struct FromSqlwchar
+{
+    const SQLWCHAR* src;
+    Py_ssize_t len;
+
+    bool operator()()
+    {
+        PyObject* value = PyUnicode_FromSQLWCHAR(src, len);
+        if (!value)
+            return false;
+        Py_DECREF(value);
+        return true;
+    }
+};
+
+static bool BenchFromSqlwchar()
+{
+    // Text with a surrogate pair every 16 characters is included since it takes the slower path on UCS4 builds.
+
+    static const struct
+    {
+        const char* name;
+        bool surrogates;
+    } kinds[] =
+    {
+        { "PyUnicode_FromSQLWCHAR",    false },
+        { "PyUnicode_FromSQLWCHAR_sp", true },
+    };
+
+    for (size_t k = 0; k < _countof(kinds); k++)
+    {
+        for (size_t i = 0; i < _countof(STRING_SIZES); i++)
+        {
+            Py_ssize_t len = STRING_SIZES[i];
+
+            SQLWCHAR* src = (SQLWCHAR*)pyodbc_malloc(sizeof(SQLWCHAR) * len, MEM_SQLWCHAR);
+            if (!src)
+            {
+                PyErr_NoMemory();
+                return false;
+            }
+
+            for (Py_ssize_t j = 0; j < len; j++)
+            {
+                if (kinds[k].surrogates && j % 16 == 14 && j + 1 < len)
+                {
+                    src[j++] = 0xD83D;
+                    src[j]   = 0xDE00;
+                }
+                else
+                {
+                    src[j] = (SQLWCHAR)('a' + j % 26);
+                }
+            }
+
+            FromSqlwchar kernel;
+            kernel.src = src;
+            kernel.len = len;
+
+            bool ok = Run(kinds[k].name, len, len * sizeof(SQLWCHAR), kernel);
+            pyodbc_free(src);
+            if (!ok)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+//
+// UTF-8 to Unicode
+//
+
+struct FromUTF8
+{
+    const char* src;
+    Py_ssize_t cb;
+    bool native;
+
+    bool operator()()
+    {
+        PyObject* value = native ? PyUnicode_FromUTF8(src, cb) : PyUnicode_DecodeUTF8(src, cb, "strict");
+        if (!value)
+            return false;
+        Py_DECREF(value);
+        return true;
+    }
+};
+
+static bool BenchUTF8()
+{
+    // PyUnicode_DecodeUTF8 is what the codec machinery calls for other spellings of an encoding, so it is the
+    // baseline.  The mixed text has a 2 byte character every 8 characters and a 3 byte character every 32, which
+    // breaks up the ASCII runs.
+
+    static const struct
+    {
+        const char* name;
+        bool native;
+        bool mixed;
+    } kinds[] =
+    {
+        { "PyUnicode_FromUTF8",          true,  false },
+        { "PyUnicode_FromUTF8_mixed",    true,  true },
+        { "PyUnicode_DecodeUTF8",        false, false },
+        { "PyUnicode_DecodeUTF8_mixed",  false, true },
+    };
+
+    for (size_t k = 0; k < _countof(kinds); k++)
+    {
+        for (size_t i = 0; i < _countof(STRING_SIZES); i++)
+        {
+            Py_ssize_t len = STRING_SIZES[i];
+
+            // At most 3 bytes per character.
+            char* src = (char*)pyodbc_malloc(len * 3);
+            if (!src)
+            {
+                PyErr_NoMemory();
+                return false;
+            }
+
+            Py_ssize_t cb = 0;
+            for (Py_ssize_t j = 0; j < len; j++)
+            {
+                if (kinds[k].mixed && j % 32 == 31)
+                {
+                    src[cb++] = (char)0xE2;     // U+20AC
+                    src[cb++] = (char)0x82;
+                    src[cb++] = (char)0xAC;
+                }
+                else if (kinds[k].mixed && j % 8 == 7)
+                {
+                    src[cb++] = (char)0xC3;     // U+00E9
+                    src[cb++] = (char)0xA9;
+                }
+                else
+                {
+                    src[cb++] = (char)('a' + j % 26);
+                }
+            }
+
+            FromUTF8 kernel;
+            kernel.src    = src;
+            kernel.cb     = cb;
+            kernel.native = kinds[k].native;
+
+            bool ok = Run(kinds[k].name, len, cb, kernel);
+            pyodbc_free(src);
+            if (!ok)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+//
+// Decimal parameters
+//
+
+struct CreateDecimal
+{
+    long sign;
+    PyObject* digits;
+    long exp;
+
+    bool operator()()
+    {
+        char* pch = Bench_CreateDecimalString(sign, digits, exp);
+        if (!pch)
+        {
+            PyErr_NoMemory();
+            return false;
+        }
+        pyodbc_free(pch);
+        return true;
+    }
+};
+
+struct DecimalInfo
+{
+    PyObject* value;
+
+    bool operator()()
+    {
+        ParamInfo info;
+        memset(&info, 0, sizeof(info));
+        if (!Bench_GetDecimalInfo(value, info))
+            return false;
+        if (info.allocated)
+            pyodbc_free(info.ParameterValuePtr);
+        return true;
+    }
+};
+
+static bool BenchDecimal()
+{
+    Object decimal(PyImport_ImportModule("decimal"));
+    if (!decimal)
+        return false;
+
+    for (size_t i = 0; i < _countof(DECIMAL_DIGITS); i++)
+    {
+        int count = DECIMAL_DIGITS[i];
+
+        // For example, 12.34 for 4 digits.
+        char sz[64];
+        for (int j = 0; j < count; j++)
+            sz[j] = (char)('1' + j % 9);
+        memmove(&sz[count - 1], &sz[count - 2], 2);
+        sz[count - 2] = '.';
+        sz[count + 1] = 0;
+
+        Object value(PyObject_CallMethod(decimal, "Decimal", "s", sz));
+        if (!value)
+            return false;
+
+        Object t(PyObject_CallMethod(value, "as_tuple", 0));
+        if (!t)
+            return false;
+
+        CreateDecimal create;
+        create.sign   = PyInt_AsLong(PyTuple_GET_ITEM(t.Get(), 0));
+        create.digits = PyTuple_GET_ITEM(t.Get(), 1);
+        create.exp    = PyInt_AsLong(PyTuple_GET_ITEM(t.Get(), 2));
+
+        if (!Run("CreateDecimalString", count, count, create))
+            return false;
+
+        DecimalInfo info;
+        info.value = value;
+
+        if (!Run("GetDecimalInfo", count, count, info))
+            return false;
+    }
+
+    return true;
+}
+
+//
+// DataBuffer
+//
+
+struct ReadDataBuffer
+{
+    SQLSMALLINT dataType;
+    const char* data;
+    Py_ssize_t cb;
+
+    bool operator()()
+    {
+        PyObject* value = Bench_DataBuffer(dataType, data, cb);
+        if (!value)
+            return false;
+        Py_DECREF(value);
+        return true;
+    }
+};
+
+static bool BenchDataBuffer()
+{
+    static const struct
+    {
+        const char* name;
+        SQLSMALLINT dataType;
+    } types[] =
+    {
+        { "DataBuffer_char",   SQL_C_CHAR },
+        { "DataBuffer_wchar",  SQL_C_WCHAR },
+        { "DataBuffer_binary", SQL_C_BINARY },
+    };
+
+    for (size_t i = 0; i < _countof(BUFFER_SIZES); i++)
+    {
+        // The sizes are multiples of the SQLWCHAR size, so the same data can be read as any type.
+        Py_ssize_t cb = BUFFER_SIZES[i];
+
+        char* data = (char*)pyodbc_malloc((size_t)cb);
+        if (!data)
+        {
+            PyErr_NoMemory();
+            return false;
+        }
+
+        SQLWCHAR* pwch = (SQLWCHAR*)data;
+        for (Py_ssize_t j = 0; j < cb / (Py_ssize_t)sizeof(SQLWCHAR); j++)
+            pwch[j] = (SQLWCHAR)('a' + j % 26);
+
+        for (size_t t = 0; t < _countof(types); t++)
+        {
+            ReadDataBuffer kernel;
+            kernel.dataType = types[t].dataType;
+            kernel.data     = data;
+            kernel.cb       = cb;
+
+            if (!Run(types[t].name, cb, cb, kernel))
+            {
+                pyodbc_free(data);
+                return false;
+            }
+        }
+
+        pyodbc_free(data);
+    }
+
+    return true;
+}
+
+//
+// Rows
+//
+
+struct NewRow
+{
+    PyObject* description;
+    PyObject* map_name_to_index;
+    PyObject** values;
+    Py_ssize_t cValues;
+
+    bool operator()()
+    {
+        // Mirrors Cursor_fetch: allocate the value array, fill it, and hand it to the new row, which frees it along
+        // with the values when it is deallocated.
+
+        PyObject** apValues = (PyObject**)pyodbc_malloc(sizeof(PyObject*) * cValues, MEM_ROWVALUES);
+        if (!apValues)
+        {
+            PyErr_NoMemory();
+            return false;
+        }
+
+        for (Py_ssize_t i = 0; i < cValues; i++)
+        {
+            Py_INCREF(values[i]);
+            apValues[i] = values[i];
+        }
+
+        Row* row = Row_New(description, map_name_to_index, cValues, apValues);
+        if (!row)
+            return false;
+        Py_DECREF(row);
+        return true;
+    }
+};
+
+struct FreeValues
+{
+    PyObject** values;
+    Py_ssize_t cValues;
+
+    bool operator()()
+    {
+        PyObject** apValues = (PyObject**)pyodbc_malloc(sizeof(PyObject*) * cValues, MEM_ROWVALUES);
+        if (!apValues)
+        {
+            PyErr_NoMemory();
+            return false;
+        }
+
+        for (Py_ssize_t i = 0; i < cValues; i++)
+        {
+            Py_INCREF(values[i]);
+            apValues[i] = values[i];
+        }
+
+        FreeRowValues(cValues, apValues);
+        return true;
+    }
+};
+
+static bool BenchRows()
+{
+    for (size_t i = 0; i < _countof(ROW_COLUMNS); i++)
+    {
+        int count = ROW_COLUMNS[i];
+
+        // The description and map are shared by every row in a result set, so they are only built once, as
+        // Cursor_execute does.
+        Object description(PyTuple_New(count));
+        Object map(PyDict_New());
+        Object values(PyTuple_New(count));
+        if (!description || !map || !values)
+            return false;
+
+        for (int j = 0; j < count; j++)
+        {
+            char name[32];
+            sprintf(name, "col%d", j);
+
+            Object colinfo(Py_BuildValue("(sOOOOOO)", name, (PyObject*)&PyInt_Type, Py_None, Py_None, Py_None,
+                                         Py_None, Py_True));
+            Object index(PyInt_FromLong(j));
+            PyObject* value = PyInt_FromLong(j);
+            if (!colinfo || !index || !value)
+            {
+                Py_XDECREF(value);
+                return false;
+            }
+
+            PyTuple_SET_ITEM(description.Get(), j, colinfo.Detach());
+            PyTuple_SET_ITEM(values.Get(), j, value);
+            if (PyDict_SetItemString(map, name, index) != 0)
+                return false;
+        }
+
+        NewRow row;
+        row.description       = description;
+        row.map_name_to_index = map;
+        row.values            = &PyTuple_GET_ITEM(values.Get(), 0);
+        row.cValues           = count;
+
+        if (!Run("Row_New", count, sizeof(PyObject*) * count, row))
+            return false;
+
+        FreeValues freevalues;
+        freevalues.values  = row.values;
+        freevalues.cValues = count;
+
+        if (!Run("FreeRowValues", count, sizeof(PyObject*) * count, freevalues))
+            return false;
+    }
+
+    return true;
+}
+
+static void Usage()
+{
+    fprintf(stderr, "usage: kernelbench [--json] [--filter text] [--min-time ms] [--no-avx2]\n");
+    exit(2);
+}
+
+int main(int argc, char* argv[])
+{
+    bool no_avx2 = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--no-avx2") == 0)
+            no_avx2 = true;
+        else if (strcmp(argv[i], "--json") == 0)
+            json_output = true;
+        else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+            filter = argv[++i];
+        else if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc)
+            min_time = (UINT64)atol(argv[++i]) * 1000000;
+        else
+            Usage();
+    }
+
+    Py_Initialize();
+
+    // Initializes the module the same way importing it would, which sets up the types and the datetime and decimal
+    // imports the kernels use.
+    initpyodbc();
+    if (PyErr_Occurred())
+    {
+        PyErr_Print();
+        return 1;
+    }
+
+    if (no_avx2)
+        cpu_has_avx2 = false;
+
+    if (!json_output)
+        printf("%-28s %10s %14s %14s %12s\n", "kernel", "size", "ns/op", "bytes/op", "MB/s");
+
+    if (!BenchSqlwchar() || !BenchFromSqlwchar() || !BenchUTF8() || !BenchDecimal() || !BenchDataBuffer() || !BenchRows())
+    {
+        PyErr_Print();
+        return 1;
+    }
+
+    Py_Finalize();
+    return 0;
+}
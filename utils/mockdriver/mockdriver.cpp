@@ -0,0 +1,1448 @@
+
+// A minimal ODBC driver that makes up its results, used to measure pyodbc's own overhead without a database.
+//
+// Build it with `python setup.py mockdriver` and connect using the path to the library:
+//
+//   cnxn = pyodbc.connect('Driver=/path/to/build/mockdriver/libpyodbcmock.so')
+//
+// Each SELECT describes the result set it should produce: the number of rows followed by a column type for each
+// column.  For example, this returns 100000 rows, each with an integer, a 20 character varchar, and a timestamp:
+//
+//   select 100000 int, varchar(20), timestamp
+//
+// The types are int, smallint, bigint, bit, double, decimal(p,s), char(n), varchar(n), nvarchar(n), text(n),
+// ntext(n), varbinary(n), blob(n), date, time, timestamp, and null (a varchar column that is always NULL).  Values are
+// generated from the row and column numbers, so every run returns the same data.  Strings are always the full length
+// of the column.  Anything after WHERE is ignored, so parameters can be passed to a select:
+//
+//   select 10 int, varchar(20) where ?, ?
+//
+// Any other statement returns no results and reports one row affected per parameter set.  Parameters, including
+// data-at-execution parameters, are accepted and ignored.
+//
+// Only the functions pyodbc uses are implemented, and only as far as pyodbc uses them.  Nothing here is thread safe
+// beyond what the driver manager provides, since each connection and statement is only used by one thread at a time.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include <sql.h>
+#include <sqlext.h>
+
+#ifndef _countof
+#define _countof(a) (sizeof(a) / sizeof(a[0]))
+#endif
+
+#define DRIVER_NAME "libpyodbcmock.so"
+
+enum HandleType
+{
+    HANDLE_ENV = 1,
+    HANDLE_DBC,
+    HANDLE_STMT
+};
+
+struct Handle
+{
+    int type;
+
+    // The diagnostic record from the last call on this handle.  sqlstate is empty if there is none.
+    char sqlstate[6];
+    char message[256];
+};
+
+struct Env : Handle
+{
+    SQLINTEGER odbc_version;
+};
+
+struct Dbc : Handle
+{
+    bool connected;
+    SQLUINTEGER autocommit;
+};
+
+enum Kind
+{
+    KIND_INTEGER,
+    KIND_DOUBLE,
+    KIND_DECIMAL,
+    KIND_CHAR,
+    KIND_WCHAR,
+    KIND_BINARY,
+    KIND_DATE,
+    KIND_TIME,
+    KIND_TIMESTAMP,
+    KIND_NULL
+};
+
+struct Column
+{
+    char name[32];
+    Kind kind;
+    SQLSMALLINT sqltype;
+    SQLULEN size;
+    SQLSMALLINT digits;
+
+    // If true, every row has the integer value `value`.  Used for the result of SQLGetTypeInfo.
+    bool fixed;
+    SQLBIGINT value;
+};
+
+struct Param
+{
+    bool bound;
+    SQLPOINTER value;
+    SQLLEN* ind;
+};
+
+struct Stmt : Handle
+{
+    Dbc* dbc;
+
+    // The prepared statement.  columns is only allocated for SELECTs.
+    bool prepared;
+    bool select;
+    SQLLEN rows;
+    Column* columns;
+    int ncols;
+    int nmarkers;
+
+    Param* params;
+    int nparams;                // the number of entries allocated in params
+    SQLULEN paramset_size;
+
+    // The index of the next parameter to check for data-at-execution, or -1 if SQLExecute has not returned
+    // SQL_NEED_DATA.
+    int dae_next;
+
+    // True if a result set is open.  row is the current row, -1 before the first fetch.
+    bool open;
+    SQLLEN row;
+    SQLLEN rowcount;
+
+    // The column being read by SQLGetData and the number of bytes of it already returned.  gd_offset is -1 once all
+    // of the data has been returned.
+    int gd_col;
+    SQLLEN gd_offset;
+
+    // The text of the value being read, generated once per row and column so long values can be read in pieces.
+    char* text;
+    SQLLEN textlen;
+    SQLLEN textcap;
+    SQLLEN text_row;
+    int text_col;
+};
+
+struct TypeName
+{
+    const char* name;
+    Kind kind;
+    SQLSMALLINT sqltype;
+    SQLULEN size;               // the size if none is given
+    SQLSMALLINT digits;
+};
+
+static const TypeName TYPES[] =
+{
+    { "int",       KIND_INTEGER,   SQL_INTEGER,        10, 0 },
+    { "integer",   KIND_INTEGER,   SQL_INTEGER,        10, 0 },
+    { "smallint",  KIND_INTEGER,   SQL_SMALLINT,        5, 0 },
+    { "bigint",    KIND_INTEGER,   SQL_BIGINT,         19, 0 },
+    { "bit",       KIND_INTEGER,   SQL_BIT,             1, 0 },
+    { "double",    KIND_DOUBLE,    SQL_DOUBLE,         15, 0 },
+    { "float",     KIND_DOUBLE,    SQL_DOUBLE,         15, 0 },
+    { "decimal",   KIND_DECIMAL,   SQL_DECIMAL,        18, 4 },
+    { "numeric",   KIND_DECIMAL,   SQL_NUMERIC,        18, 4 },
+    { "char",      KIND_CHAR,      SQL_CHAR,           10, 0 },
+    { "varchar",   KIND_CHAR,      SQL_VARCHAR,        10, 0 },
+    { "nvarchar",  KIND_WCHAR,     SQL_WVARCHAR,       10, 0 },
+    { "text",      KIND_CHAR,      SQL_LONGVARCHAR,  1024, 0 },
+    { "ntext",     KIND_WCHAR,     SQL_WLONGVARCHAR, 1024, 0 },
+    { "varbinary", KIND_BINARY,    SQL_VARBINARY,      10, 0 },
+    { "blob",      KIND_BINARY,    SQL_LONGVARBINARY, 1024, 0 },
+    { "date",      KIND_DATE,      SQL_TYPE_DATE,      10, 0 },
+    { "time",      KIND_TIME,      SQL_TYPE_TIME,       8, 0 },
+    { "timestamp", KIND_TIMESTAMP, SQL_TYPE_TIMESTAMP, 23, 3 },
+    { "null",      KIND_NULL,      SQL_VARCHAR,        10, 0 },
+};
+
+//
+// Diagnostics
+//
+
+static void ClearDiag(Handle* h)
+{
+    h->sqlstate[0] = 0;
+    h->message[0]  = 0;
+}
+
+static SQLRETURN SetDiag(Handle* h, SQLRETURN ret, const char* sqlstate, const char* message)
+{
+    strncpy(h->sqlstate, sqlstate, sizeof(h->sqlstate) - 1);
+    h->sqlstate[sizeof(h->sqlstate) - 1] = 0;
+    snprintf(h->message, sizeof(h->message), "[pyodbc][mock driver] %s", message);
+    return ret;
+}
+
+static SQLRETURN SetError(Handle* h, const char* sqlstate, const char* message)
+{
+    return SetDiag(h, SQL_ERROR, sqlstate, message);
+}
+
+static SQLRETURN CopyString(Handle* h, const char* s, SQLPOINTER buffer, SQLLEN buflen, SQLLEN* pcb)
+{
+    // Copies a null terminated string to an ODBC output buffer, truncating it with 01004 if it doesn't fit.
+
+    SQLLEN len = (SQLLEN)strlen(s);
+    if (pcb)
+        *pcb = len;
+
+    if (!buffer || buflen <= 0)
+        return len ? SetDiag(h, SQL_SUCCESS_WITH_INFO, "01004", "String data, right truncated") : SQL_SUCCESS;
+
+    if (len < buflen)
+    {
+        memcpy(buffer, s, len + 1);
+        return SQL_SUCCESS;
+    }
+
+    memcpy(buffer, s, buflen - 1);
+    ((char*)buffer)[buflen - 1] = 0;
+    return SetDiag(h, SQL_SUCCESS_WITH_INFO, "01004", "String data, right truncated");
+}
+
+static SQLRETURN CopyStringS(Handle* h, const char* s, SQLPOINTER buffer, SQLSMALLINT buflen, SQLSMALLINT* pcb)
+{
+    SQLLEN cb;
+    SQLRETURN ret = CopyString(h, s, buffer, buflen, &cb);
+    if (pcb)
+        *pcb = (SQLSMALLINT)cb;
+    return ret;
+}
+
+//
+// Handles
+//
+
+SQLRETURN SQL_API SQLAllocHandle(SQLSMALLINT HandleType, SQLHANDLE InputHandle, SQLHANDLE* OutputHandle)
+{
+    switch (HandleType)
+    {
+    case SQL_HANDLE_ENV:
+    {
+        Env* env = (Env*)calloc(1, sizeof(Env));
+        if (!env)
+            return SQL_ERROR;
+        env->type = HANDLE_ENV;
+        env->odbc_version = SQL_OV_ODBC3;
+        *OutputHandle = env;
+        return SQL_SUCCESS;
+    }
+
+    case SQL_HANDLE_DBC:
+    {
+        Dbc* dbc = (Dbc*)calloc(1, sizeof(Dbc));
+        if (!dbc)
+            return SetError((Handle*)InputHandle, "HY001", "Memory allocation error");
+        dbc->type = HANDLE_DBC;
+        dbc->autocommit = SQL_AUTOCOMMIT_ON;
+        *OutputHandle = dbc;
+        return SQL_SUCCESS;
+    }
+
+    case SQL_HANDLE_STMT:
+    {
+        Stmt* stmt = (Stmt*)calloc(1, sizeof(Stmt));
+        if (!stmt)
+            return SetError((Handle*)InputHandle, "HY001", "Memory allocation error");
+        stmt->type          = HANDLE_STMT;
+        stmt->dbc           = (Dbc*)InputHandle;
+        stmt->paramset_size = 1;
+        stmt->dae_next      = -1;
+        stmt->text_row      = -1;
+        *OutputHandle = stmt;
+        return SQL_SUCCESS;
+    }
+    }
+
+    return SetError((Handle*)InputHandle, "HYC00", "Optional feature not implemented");
+}
+
+static void FreeResults(Stmt* stmt)
+{
+    free(stmt->columns);
+    stmt->columns  = 0;
+    stmt->ncols    = 0;
+    stmt->nmarkers = 0;
+    stmt->prepared = false;
+    stmt->select   = false;
+    stmt->open     = false;
+    stmt->dae_next = -1;
+}
+
+SQLRETURN SQL_API SQLFreeHandle(SQLSMALLINT HandleType, SQLHANDLE Handle)
+{
+    if (HandleType == SQL_HANDLE_STMT)
+    {
+        Stmt* stmt = (Stmt*)Handle;
+        FreeResults(stmt);
+        free(stmt->params);
+        free(stmt->text);
+    }
+
+    free(Handle);
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLFreeStmt(SQLHSTMT StatementHandle, SQLUSMALLINT Option)
+{
+    Stmt* stmt = (Stmt*)StatementHandle;
+    ClearDiag(stmt);
+
+    switch (Option)
+    {
+    case SQL_CLOSE:
+        stmt->open = false;
+        break;
+
+    case SQL_DROP:
+        return SQLFreeHandle(SQL_HANDLE_STMT, stmt);
+
+    case SQL_RESET_PARAMS:
+        if (stmt->params)
+            memset(stmt->params, 0, sizeof(Param) * stmt->nparams);
+        break;
+    }
+
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLCloseCursor(SQLHSTMT StatementHandle)
+{
+    Stmt* stmt = (Stmt*)StatementHandle;
+    ClearDiag(stmt);
+    if (!stmt->open)
+        return SetError(stmt, "24000", "Invalid cursor state");
+    stmt->open = false;
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLCancel(SQLHSTMT StatementHandle)
+{
+    Stmt* stmt = (Stmt*)StatementHandle;
+    ClearDiag(stmt);
+    stmt->dae_next = -1;
+    return SQL_SUCCESS;
+}
+
+//
+// Attributes and information
+//
+
+SQLRETURN SQL_API SQLSetEnvAttr(SQLHENV EnvironmentHandle, SQLINTEGER Attribute, SQLPOINTER Value, SQLINTEGER StringLength)
+{
+    Env* env = (Env*)EnvironmentHandle;
+    if (env)
+    {
+        ClearDiag(env);
+        if (Attribute == SQL_ATTR_ODBC_VERSION)
+            env->odbc_version = (SQLINTEGER)(SQLLEN)Value;
+    }
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLGetEnvAttr(SQLHENV EnvironmentHandle, SQLINTEGER Attribute, SQLPOINTER Value, SQLINTEGER BufferLength, SQLINTEGER* StringLength)
+{
+    Env* env = (Env*)EnvironmentHandle;
+    ClearDiag(env);
+    if (Attribute == SQL_ATTR_ODBC_VERSION)
+    {
+        *(SQLINTEGER*)Value = env->odbc_version;
+        return SQL_SUCCESS;
+    }
+    return SetError(env, "HYC00", "Optional feature not implemented");
+}
+
+SQLRETURN SQL_API SQLSetConnectAttr(SQLHDBC ConnectionHandle, SQLINTEGER Attribute, SQLPOINTER Value, SQLINTEGER StringLength)
+{
+    Dbc* dbc = (Dbc*)ConnectionHandle;
+    ClearDiag(dbc);
+    if (Attribute == SQL_ATTR_AUTOCOMMIT)
+        dbc->autocommit = (SQLUINTEGER)(SQLULEN)Value;
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLGetConnectAttr(SQLHDBC ConnectionHandle, SQLINTEGER Attribute, SQLPOINTER Value, SQLINTEGER BufferLength, SQLINTEGER* StringLength)
+{
+    Dbc* dbc = (Dbc*)ConnectionHandle;
+    ClearDiag(dbc);
+    if (Attribute == SQL_ATTR_AUTOCOMMIT)
+    {
+        *(SQLUINTEGER*)Value = dbc->autocommit;
+        return SQL_SUCCESS;
+    }
+    return SetError(dbc, "HYC00", "Optional feature not implemented");
+}
+
+SQLRETURN SQL_API SQLSetStmtAttr(SQLHSTMT StatementHandle, SQLINTEGER Attribute, SQLPOINTER Value, SQLINTEGER StringLength)
+{
+    Stmt* stmt = (Stmt*)StatementHandle;
+    ClearDiag(stmt);
+    if (Attribute == SQL_ATTR_PARAMSET_SIZE)
+        stmt->paramset_size = (SQLULEN)Value;
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLGetStmtAttr(SQLHSTMT StatementHandle, SQLINTEGER Attribute, SQLPOINTER Value, SQLINTEGER BufferLength, SQLINTEGER* StringLength)
+{
+    Stmt* stmt = (Stmt*)StatementHandle;
+    ClearDiag(stmt);
+
+    switch (Attribute)
+    {
+    case SQL_ATTR_APP_ROW_DESC:
+    case SQL_ATTR_APP_PARAM_DESC:
+    case SQL_ATTR_IMP_ROW_DESC:
+    case SQL_ATTR_IMP_PARAM_DESC:
+        // Descriptors are not implemented, but the driver manager asks for them when allocating statements.
+        *(SQLPOINTER*)Value = stmt;
+        return SQL_SUCCESS;
+
+    case SQL_ATTR_PARAMSET_SIZE:
+        *(SQLULEN*)Value = stmt->paramset_size;
+        return SQL_SUCCESS;
+
+    case SQL_ATTR_NOSCAN:
+        // pyodbc reads this into a SQLUINTEGER.
+        *(SQLUINTEGER*)Value = SQL_NOSCAN_OFF;
+        return SQL_SUCCESS;
+    }
+
+    return SetError(stmt, "HYC00", "Optional feature not implemented");
+}
+
+SQLRETURN SQL_API SQLGetInfo(SQLHDBC ConnectionHandle, SQLUSMALLINT InfoType, SQLPOINTER InfoValue, SQLSMALLINT BufferLength, SQLSMALLINT* StringLength)
+{
+    Dbc* dbc = (Dbc*)ConnectionHandle;
+    ClearDiag(dbc);
+
+    const char* s = 0;
+    SQLUSMALLINT usmallint = 0;
+    SQLUINTEGER uinteger = 0;
+    int size = 0;
+
+    switch (InfoType)
+    {
+    case SQL_DRIVER_NAME:              s = DRIVER_NAME;  break;
+    case SQL_DRIVER_VER:               s = "01.00.0000"; break;
+    case SQL_DRIVER_ODBC_VER:          s = "03.52";      break;
+    case SQL_DBMS_NAME:                s = "pyodbc mock"; break;
+    case SQL_DBMS_VER:                 s = "01.00.0000"; break;
+    case SQL_SERVER_NAME:              s = "mock";       break;
+    case SQL_DATABASE_NAME:            s = "mock";       break;
+    case SQL_DATA_SOURCE_NAME:         s = "";           break;
+    case SQL_USER_NAME:                s = "";           break;
+    case SQL_DESCRIBE_PARAMETER:       s = "N";          break;
+    case SQL_IDENTIFIER_QUOTE_CHAR:    s = "\"";         break;
+    case SQL_SEARCH_PATTERN_ESCAPE:    s = "\\";         break;
+
+    case SQL_CURSOR_COMMIT_BEHAVIOR:
+    case SQL_CURSOR_ROLLBACK_BEHAVIOR: usmallint = SQL_CB_PRESERVE;       size = 2; break;
+    case SQL_TXN_CAPABLE:              usmallint = SQL_TC_ALL;            size = 2; break;
+    case SQL_MAX_CONCURRENT_ACTIVITIES: usmallint = 0;                    size = 2; break;
+    case SQL_ASYNC_MODE:               uinteger = SQL_AM_NONE;            size = 4; break;
+    case SQL_GETDATA_EXTENSIONS:       uinteger = SQL_GD_ANY_COLUMN | SQL_GD_ANY_ORDER; size = 4; break;
+
+    default:
+        return SetError(dbc, "HY096", "Information type out of range");
+    }
+
+    if (s)
+        return CopyStringS(dbc, s, InfoValue, BufferLength, StringLength);
+
+    if (size == 2)
+        *(SQLUSMALLINT*)InfoValue = usmallint;
+    else
+        *(SQLUINTEGER*)InfoValue = uinteger;
+
+    if (StringLength)
+        *StringLength = (SQLSMALLINT)size;
+
+    return SQL_SUCCESS;
+}
+
+//
+// Connections
+//
+
+SQLRETURN SQL_API SQLConnect(SQLHDBC ConnectionHandle, SQLCHAR* ServerName, SQLSMALLINT NameLength1, SQLCHAR* UserName,
+                             SQLSMALLINT NameLength2, SQLCHAR* Authentication, SQLSMALLINT NameLength3)
+{
+    Dbc* dbc = (Dbc*)ConnectionHandle;
+    ClearDiag(dbc);
+    dbc->connected = true;
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLDriverConnect(SQLHDBC hdbc, SQLHWND hwnd, SQLCHAR* szConnStrIn, SQLSMALLINT cbConnStrIn, SQLCHAR* szConnStrOut,
+                                   SQLSMALLINT cbConnStrOutMax, SQLSMALLINT* pcbConnStrOut, SQLUSMALLINT fDriverCompletion)
+{
+    Dbc* dbc = (Dbc*)hdbc;
+    ClearDiag(dbc);
+
+    // The connection string is not used, but is returned as the completed connection string.
+    SQLSMALLINT cch = (cbConnStrIn == SQL_NTS) ? (SQLSMALLINT)strlen((const char*)szConnStrIn) : cbConnStrIn;
+    if (pcbConnStrOut)
+        *pcbConnStrOut = cch;
+    if (szConnStrOut && cbConnStrOutMax > 0)
+    {
+        SQLSMALLINT copy = (cch < cbConnStrOutMax) ? cch : (SQLSMALLINT)(cbConnStrOutMax - 1);
+        memcpy(szConnStrOut, szConnStrIn, copy);
+        szConnStrOut[copy] = 0;
+    }
+
+    dbc->connected = true;
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLDisconnect(SQLHDBC ConnectionHandle)
+{
+    Dbc* dbc = (Dbc*)ConnectionHandle;
+    ClearDiag(dbc);
+    dbc->connected = false;
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLEndTran(SQLSMALLINT HandleType, SQLHANDLE Handle, SQLSMALLINT CompletionType)
+{
+    ClearDiag((::Handle*)Handle);
+    return SQL_SUCCESS;
+}
+
+//
+// Parsing
+//
+
+static const char* SkipSpace(const char* p)
+{
+    while (*p && isspace((unsigned char)*p))
+        p++;
+    return p;
+}
+
+static bool MatchWord(const char*& p, const char* word)
+{
+    // Matches a case-insensitive keyword followed by a non-identifier character.
+
+    size_t len = strlen(word);
+    for (size_t i = 0; i < len; i++)
+        if (tolower((unsigned char)p[i]) != word[i])
+            return false;
+    if (isalnum((unsigned char)p[len]) || p[len] == '_')
+        return false;
+    p += len;
+    return true;
+}
+
+static bool ParseNumber(const char*& p, SQLLEN& n)
+{
+    p = SkipSpace(p);
+    if (!isdigit((unsigned char)*p))
+        return false;
+    char* end;
+    n = (SQLLEN)strtol(p, &end, 10);
+    p = end;
+    return true;
+}
+
+static bool ParseColumn(const char*& p, Column& col, int index)
+{
+    // Parses one column type, such as "int" or "decimal(10, 2)".
+
+    p = SkipSpace(p);
+
+    const TypeName* type = 0;
+    for (size_t i = 0; i < _countof(TYPES) && !type; i++)
+    {
+        // MatchWord rejects "int" at the start of "integer", so the longer names are still found.
+        const char* start = p;
+        if (MatchWord(p, TYPES[i].name))
+            type = &TYPES[i];
+        else
+            p = start;
+    }
+
+    if (!type)
+        return false;
+
+    snprintf(col.name, sizeof(col.name), "c%d", index + 1);
+    col.kind    = type->kind;
+    col.sqltype = type->sqltype;
+    col.size    = type->size;
+    col.digits  = type->digits;
+    col.fixed   = false;
+    col.value   = 0;
+
+    p = SkipSpace(p);
+    if (*p == '(')
+    {
+        SQLLEN size, digits = type->digits;
+        p++;
+        if (!ParseNumber(p, size))
+            return false;
+        p = SkipSpace(p);
+        if (*p == ',')
+        {
+            p++;
+            if (!ParseNumber(p, digits))
+                return false;
+            p = SkipSpace(p);
+        }
+        if (*p != ')')
+            return false;
+        p++;
+        col.size   = (SQLULEN)size;
+        col.digits = (SQLSMALLINT)digits;
+    }
+
+    return true;
+}
+
+static int CountMarkers(const char* sql)
+{
+    // Counts the parameter markers outside of quoted strings.
+
+    int count = 0;
+    char quote = 0;
+    for (const char* p = sql; *p; p++)
+    {
+        if (quote)
+        {
+            if (*p == quote)
+                quote = 0;
+        }
+        else if (*p == '\'' || *p == '"')
+            quote = *p;
+        else if (*p == '?')
+            count++;
+    }
+    return count;
+}
+
+static SQLRETURN Prepare(Stmt* stmt, SQLCHAR* StatementText, SQLINTEGER TextLength)
+{
+    FreeResults(stmt);
+
+    SQLINTEGER cch = (TextLength == SQL_NTS) ? (SQLINTEGER)strlen((const char*)StatementText) : TextLength;
+    char* sql = (char*)malloc(cch + 1);
+    if (!sql)
+        return SetError(stmt, "HY001", "Memory allocation error");
+    memcpy(sql, StatementText, cch);
+    sql[cch] = 0;
+
+    stmt->nmarkers = CountMarkers(sql);
+
+    const char* p = SkipSpace(sql);
+    if (MatchWord(p, "select"))
+    {
+        int maxcols = 1;
+        for (const char* q = p; *q; q++)
+            if (*q == ',')
+                maxcols++;
+
+        stmt->columns = (Column*)calloc(maxcols, sizeof(Column));
+        if (!stmt->columns)
+        {
+            free(sql);
+            return SetError(stmt, "HY001", "Memory allocation error");
+        }
+
+        bool ok = ParseNumber(p, stmt->rows);
+        while (ok)
+        {
+            ok = stmt->ncols < maxcols && ParseColumn(p, stmt->columns[stmt->ncols], stmt->ncols);
+            if (!ok)
+                break;
+            stmt->ncols++;
+
+            // Columns inside decimal(p,s) were counted as separators, so maxcols may be more than needed.
+            p = SkipSpace(p);
+            if (*p != ',')
+                break;
+            p++;
+        }
+
+        // A WHERE clause is ignored, which allows parameters to be passed to a select.
+        if (ok && MatchWord(p, "where"))
+            p += strlen(p);
+
+        if (ok && *p == ';')
+            p = SkipSpace(p + 1);
+
+        if (!ok || *p)
+        {
+            free(sql);
+            FreeResults(stmt);
+            return SetError(stmt, "42000", "Syntax error: expected SELECT <rows> <type>[, <type>...]");
+        }
+
+        stmt->select = true;
+    }
+
+    free(sql);
+    stmt->prepared = true;
+    return SQL_SUCCESS;
+}
+
+//
+// Execution
+//
+
+static bool IsDataAtExec(const Param& param)
+{
+    return param.bound && param.ind && (*param.ind == SQL_DATA_AT_EXEC || *param.ind <= SQL_LEN_DATA_AT_EXEC_OFFSET);
+}
+
+static SQLRETURN FinishExecute(Stmt* stmt)
+{
+    stmt->dae_next = -1;
+
+    if (stmt->select)
+    {
+        stmt->open     = true;
+        stmt->row      = -1;
+        stmt->rowcount = stmt->rows;
+    }
+    else
+    {
+        stmt->open     = false;
+        stmt->rowcount = (SQLLEN)stmt->paramset_size;
+    }
+
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLPrepare(SQLHSTMT StatementHandle, SQLCHAR* StatementText, SQLINTEGER TextLength)
+{
+    Stmt* stmt = (Stmt*)StatementHandle;
+    ClearDiag(stmt);
+    return Prepare(stmt, StatementText, TextLength);
+}
+
+SQLRETURN SQL_API SQLExecute(SQLHSTMT StatementHandle)
+{
+    Stmt* stmt = (Stmt*)StatementHandle;
+    ClearDiag(stmt);
+
+    if (!stmt->prepared)
+        return SetError(stmt, "HY010", "Function sequence error");
+
+    if (stmt->open)
+        return SetError(stmt, "24000", "Invalid cursor state");
+
+    if (stmt->nmarkers > stmt->nparams)
+        return SetError(stmt, "07002", "COUNT field incorrect");
+
+    for (int i = 0; i < stmt->nmarkers; i++)
+    {
+        if (!stmt->params[i].bound)
+            return SetError(stmt, "07002", "COUNT field incorrect");
+    }
+
+    for (int i = 0; i < stmt->nmarkers; i++)
+    {
+        if (IsDataAtExec(stmt->params[i]))
+        {
+            stmt->dae_next = 0;
+            return SQL_NEED_DATA;
+        }
+    }
+
+    return FinishExecute(stmt);
+}
+
+SQLRETURN SQL_API SQLExecDirect(SQLHSTMT StatementHandle, SQLCHAR* StatementText, SQLINTEGER TextLength)
+{
+    Stmt* stmt = (Stmt*)StatementHandle;
+    ClearDiag(stmt);
+
+    SQLRETURN ret = Prepare(stmt, StatementText, TextLength);
+    if (!SQL_SUCCEEDED(ret))
+        return ret;
+
+    return SQLExecute(stmt);
+}
+
+SQLRETURN SQL_API SQLNumParams(SQLHSTMT StatementHandle, SQLSMALLINT* ParameterCountPtr)
+{
+    Stmt* stmt = (Stmt*)StatementHandle;
+    ClearDiag(stmt);
+    *ParameterCountPtr = (SQLSMALLINT)stmt->nmarkers;
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLBindParameter(SQLHSTMT hstmt, SQLUSMALLINT ipar, SQLSMALLINT fParamType, SQLSMALLINT fCType, SQLSMALLINT fSqlType,
+                                   SQLULEN cbColDef, SQLSMALLINT ibScale, SQLPOINTER rgbValue, SQLLEN cbValueMax, SQLLEN* pcbValue)
+{
+    Stmt* stmt = (Stmt*)hstmt;
+    ClearDiag(stmt);
+
+    if (ipar == 0)
+        return SetError(stmt, "07009", "Invalid descriptor index");
+
+    if (ipar > stmt->nparams)
+    {
+        Param* params = (Param*)realloc(stmt->params, sizeof(Param) * ipar);
+        if (!params)
+            return SetError(stmt, "HY001", "Memory allocation error");
+        memset(&params[stmt->nparams], 0, sizeof(Param) * (ipar - stmt->nparams));
+        stmt->params  = params;
+        stmt->nparams = ipar;
+    }
+
+    Param& param = stmt->params[ipar - 1];
+    param.bound = true;
+    param.value = rgbValue;
+    param.ind   = pcbValue;
+
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLDescribeParam(SQLHSTMT StatementHandle, SQLUSMALLINT ParameterNumber, SQLSMALLINT* DataTypePtr, SQLULEN* ParameterSizePtr,
+                                   SQLSMALLINT* DecimalDigitsPtr, SQLSMALLINT* NullablePtr)
+{
+    Stmt* stmt = (Stmt*)StatementHandle;
+    ClearDiag(stmt);
+
+    if (ParameterNumber == 0 || ParameterNumber > stmt->nmarkers)
+        return SetError(stmt, "07009", "Invalid descriptor index");
+
+    if (DataTypePtr)      *DataTypePtr      = SQL_VARCHAR;
+    if (ParameterSizePtr) *ParameterSizePtr = 255;
+    if (DecimalDigitsPtr) *DecimalDigitsPtr = 0;
+    if (NullablePtr)      *NullablePtr      = SQL_NULLABLE;
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLParamData(SQLHSTMT StatementHandle, SQLPOINTER* Value)
+{
+    Stmt* stmt = (Stmt*)StatementHandle;
+    ClearDiag(stmt);
+
+    if (stmt->dae_next < 0)
+        return SetError(stmt, "HY010", "Function sequence error");
+
+    for (int i = stmt->dae_next; i < stmt->nmarkers; i++)
+    {
+        if (IsDataAtExec(stmt->params[i]))
+        {
+            // The application identifies the parameter by the value it bound.
+            *Value = stmt->params[i].value;
+            stmt->dae_next = i + 1;
+            return SQL_NEED_DATA;
+        }
+    }
+
+    return FinishExecute(stmt);
+}
+
+SQLRETURN SQL_API SQLPutData(SQLHSTMT StatementHandle, SQLPOINTER Data, SQLLEN StrLen_or_Ind)
+{
+    Stmt* stmt = (Stmt*)StatementHandle;
+    ClearDiag(stmt);
+
+    if (stmt->dae_next <= 0)
+        return SetError(stmt, "HY010", "Function sequence error");
+
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLRowCount(SQLHSTMT StatementHandle, SQLLEN* RowCount)
+{
+    Stmt* stmt = (Stmt*)StatementHandle;
+    ClearDiag(stmt);
+    *RowCount = stmt->rowcount;
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLMoreResults(SQLHSTMT StatementHandle)
+{
+    Stmt* stmt = (Stmt*)StatementHandle;
+    ClearDiag(stmt);
+    stmt->open = false;
+    return SQL_NO_DATA;
+}
+
+SQLRETURN SQL_API SQLGetTypeInfo(SQLHSTMT StatementHandle, SQLSMALLINT DataType)
+{
+    // pyodbc reads the COLUMN_SIZE (the third column) of the first row for a few types when connecting.  The other
+    // columns of the standard result set are not provided.
+
+    Stmt* stmt = (Stmt*)StatementHandle;
+    ClearDiag(stmt);
+    FreeResults(stmt);
+
+    stmt->columns = (Column*)calloc(3, sizeof(Column));
+    if (!stmt->columns)
+        return SetError(stmt, "HY001", "Memory allocation error");
+
+    SQLBIGINT size = 0;
+    switch (DataType)
+    {
+    case SQL_TYPE_TIMESTAMP: size = 23;   break;
+    case SQL_CHAR:
+    case SQL_VARCHAR:        size = 8000; break;
+    case SQL_WCHAR:
+    case SQL_WVARCHAR:       size = 4000; break;
+    case SQL_BINARY:
+    case SQL_VARBINARY:      size = 8000; break;
+    }
+
+    Column* cols = stmt->columns;
+    strcpy(cols[0].name, "TYPE_NAME");
+    cols[0].kind    = KIND_NULL;
+    cols[0].sqltype = SQL_VARCHAR;
+    cols[0].size    = 128;
+    strcpy(cols[1].name, "DATA_TYPE");
+    cols[1].kind    = KIND_INTEGER;
+    cols[1].sqltype = SQL_SMALLINT;
+    cols[1].size    = 5;
+    cols[1].fixed   = true;
+    cols[1].value   = DataType;
+    strcpy(cols[2].name, "COLUMN_SIZE");
+    cols[2].kind    = KIND_INTEGER;
+    cols[2].sqltype = SQL_INTEGER;
+    cols[2].size    = 10;
+    cols[2].fixed   = true;
+    cols[2].value   = size;
+
+    stmt->ncols    = 3;
+    stmt->rows     = 1;
+    stmt->select   = true;
+    stmt->prepared = true;
+
+    return FinishExecute(stmt);
+}
+
+//
+// Results
+//
+
+SQLRETURN SQL_API SQLNumResultCols(SQLHSTMT StatementHandle, SQLSMALLINT* ColumnCount)
+{
+    Stmt* stmt = (Stmt*)StatementHandle;
+    ClearDiag(stmt);
+    *ColumnCount = (SQLSMALLINT)(stmt->select ? stmt->ncols : 0);
+    return SQL_SUCCESS;
+}
+
+static Column* GetColumn(Stmt* stmt, SQLUSMALLINT ColumnNumber)
+{
+    if (!stmt->select || ColumnNumber == 0 || ColumnNumber > stmt->ncols)
+    {
+        SetError(stmt, "07009", "Invalid descriptor index");
+        return 0;
+    }
+    return &stmt->columns[ColumnNumber - 1];
+}
+
+SQLRETURN SQL_API SQLDescribeCol(SQLHSTMT StatementHandle, SQLUSMALLINT ColumnNumber, SQLCHAR* ColumnName, SQLSMALLINT BufferLength,
+                                 SQLSMALLINT* NameLength, SQLSMALLINT* DataType, SQLULEN* ColumnSize, SQLSMALLINT* DecimalDigits,
+                                 SQLSMALLINT* Nullable)
+{
+    Stmt* stmt = (Stmt*)StatementHandle;
+    ClearDiag(stmt);
+
+    Column* col = GetColumn(stmt, ColumnNumber);
+    if (!col)
+        return SQL_ERROR;
+
+    if (DataType)      *DataType      = col->sqltype;
+    if (ColumnSize)    *ColumnSize    = col->size;
+    if (DecimalDigits) *DecimalDigits = col->digits;
+    if (Nullable)      *Nullable      = (col->kind == KIND_NULL) ? SQL_NULLABLE : SQL_NO_NULLS;
+
+    return CopyStringS(stmt, col->name, ColumnName, BufferLength, NameLength);
+}
+
+SQLRETURN SQL_API SQLColAttribute(SQLHSTMT StatementHandle, SQLUSMALLINT ColumnNumber, SQLUSMALLINT FieldIdentifier,
+                                  SQLPOINTER CharacterAttribute, SQLSMALLINT BufferLength, SQLSMALLINT* StringLength,
+                                  SQLLEN* NumericAttribute)
+{
+    Stmt* stmt = (Stmt*)StatementHandle;
+    ClearDiag(stmt);
+
+    Column* col = GetColumn(stmt, ColumnNumber);
+    if (!col)
+        return SQL_ERROR;
+
+    switch (FieldIdentifier)
+    {
+    case SQL_DESC_NAME:
+    case SQL_DESC_LABEL:
+        return CopyStringS(stmt, col->name, CharacterAttribute, BufferLength, StringLength);
+
+    case SQL_DESC_UNSIGNED:
+        *NumericAttribute = SQL_FALSE;
+        return SQL_SUCCESS;
+
+    case SQL_DESC_TYPE:
+    case SQL_DESC_CONCISE_TYPE:
+        *NumericAttribute = col->sqltype;
+        return SQL_SUCCESS;
+
+    case SQL_DESC_LENGTH:
+    case SQL_DESC_OCTET_LENGTH:
+    case SQL_DESC_DISPLAY_SIZE:
+        *NumericAttribute = (SQLLEN)col->size;
+        return SQL_SUCCESS;
+
+    case SQL_DESC_NULLABLE:
+        *NumericAttribute = (col->kind == KIND_NULL) ? SQL_NULLABLE : SQL_NO_NULLS;
+        return SQL_SUCCESS;
+    }
+
+    return SetError(stmt, "HY091", "Invalid descriptor field identifier");
+}
+
+SQLRETURN SQL_API SQLFetch(SQLHSTMT StatementHandle)
+{
+    Stmt* stmt = (Stmt*)StatementHandle;
+    ClearDiag(stmt);
+
+    if (!stmt->open)
+        return SetError(stmt, "24000", "Invalid cursor state");
+
+    stmt->gd_col = 0;
+
+    if (stmt->row + 1 >= stmt->rows)
+    {
+        stmt->row = stmt->rows;
+        return SQL_NO_DATA;
+    }
+
+    stmt->row++;
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLFetchScroll(SQLHSTMT StatementHandle, SQLSMALLINT FetchOrientation, SQLLEN FetchOffset)
+{
+    if (FetchOrientation != SQL_FETCH_NEXT)
+    {
+        Stmt* stmt = (Stmt*)StatementHandle;
+        ClearDiag(stmt);
+        return SetError(stmt, "HY106", "Fetch type out of range");
+    }
+    return SQLFetch(StatementHandle);
+}
+
+//
+// Values
+//
+
+static SQLBIGINT IntegerValue(Stmt* stmt, int icol)
+{
+    Column& col = stmt->columns[icol];
+    if (col.fixed)
+        return col.value;
+
+    SQLBIGINT n = (SQLBIGINT)stmt->row + icol;
+    switch (col.sqltype)
+    {
+    case SQL_BIT:      return n & 1;
+    case SQL_SMALLINT: return n % 32768;
+    case SQL_INTEGER:  return n % 2147483647;
+    }
+    return n;
+}
+
+static void TemporalValue(Stmt* stmt, int icol, TIMESTAMP_STRUCT& ts)
+{
+    SQLLEN n = stmt->row + icol;
+    ts.year     = (SQLSMALLINT)(2000 + n % 20);
+    ts.month    = (SQLUSMALLINT)(1 + n % 12);
+    ts.day      = (SQLUSMALLINT)(1 + n % 28);
+    ts.hour     = (SQLUSMALLINT)(n % 24);
+    ts.minute   = (SQLUSMALLINT)((n / 24) % 60);
+    ts.second   = (SQLUSMALLINT)(n % 60);
+    ts.fraction = (SQLUINTEGER)((n % 1000) * 1000000);
+}
+
+static bool GenerateText(Stmt* stmt, int icol)
+{
+    // Generates the current row's value for the column as text in stmt->text.  Returns false if memory could not be
+    // allocated.
+
+    if (stmt->text_row == stmt->row && stmt->text_col == icol)
+        return true;
+
+    Column& col = stmt->columns[icol];
+
+    SQLLEN needed = 64;
+    if (col.kind == KIND_CHAR || col.kind == KIND_WCHAR || col.kind == KIND_BINARY || col.kind == KIND_DECIMAL)
+        needed += (SQLLEN)col.size;
+
+    if (needed > stmt->textcap)
+    {
+        char* text = (char*)realloc(stmt->text, needed);
+        if (!text)
+            return false;
+        stmt->text    = text;
+        stmt->textcap = needed;
+    }
+
+    char* text = stmt->text;
+    SQLLEN n = stmt->row + icol;
+    TIMESTAMP_STRUCT ts;
+
+    switch (col.kind)
+    {
+    case KIND_INTEGER:
+        stmt->textlen = sprintf(text, "%lld", (long long)IntegerValue(stmt, icol));
+        break;
+
+    case KIND_DOUBLE:
+        stmt->textlen = sprintf(text, "%.15g", (double)n + 0.25);
+        break;
+
+    case KIND_DECIMAL:
+    {
+        // The integer digits are limited so the value fits the precision.
+        long long limit = 1;
+        for (int i = 0; i < (int)col.size - col.digits && i < 18; i++)
+            limit *= 10;
+        stmt->textlen = sprintf(text, "%lld", (long long)n % limit);
+        if (col.digits > 0)
+        {
+            text[stmt->textlen++] = '.';
+            for (int i = 0; i < col.digits; i++)
+                text[stmt->textlen++] = (char)('0' + (n + i) % 10);
+            text[stmt->textlen] = 0;
+        }
+        break;
+    }
+
+    case KIND_CHAR:
+    case KIND_WCHAR:
+    case KIND_BINARY:
+        for (SQLULEN i = 0; i < col.size; i++)
+            text[i] = (char)('a' + (n + i) % 26);
+        stmt->textlen = (SQLLEN)col.size;
+        text[stmt->textlen] = 0;
+        break;
+
+    case KIND_DATE:
+        TemporalValue(stmt, icol, ts);
+        stmt->textlen = sprintf(text, "%04d-%02d-%02d", ts.year, ts.month, ts.day);
+        break;
+
+    case KIND_TIME:
+        TemporalValue(stmt, icol, ts);
+        stmt->textlen = sprintf(text, "%02d:%02d:%02d", ts.hour, ts.minute, ts.second);
+        break;
+
+    case KIND_TIMESTAMP:
+        TemporalValue(stmt, icol, ts);
+        stmt->textlen = sprintf(text, "%04d-%02d-%02d %02d:%02d:%02d.%03d", ts.year, ts.month, ts.day, ts.hour, ts.minute, ts.second,
+                                (int)(ts.fraction / 1000000));
+        break;
+
+    case KIND_NULL:
+        stmt->textlen = 0;
+        text[0] = 0;
+        break;
+    }
+
+    stmt->text_row = stmt->row;
+    stmt->text_col = icol;
+    return true;
+}
+
+static SQLRETURN GetText(Stmt* stmt, int icol, SQLSMALLINT TargetType, SQLPOINTER TargetValue, SQLLEN BufferLength, SQLLEN* StrLen_or_Ind)
+{
+    // Returns the value as SQL_C_CHAR, SQL_C_WCHAR, or SQL_C_BINARY, in pieces if the buffer is too small.
+
+    if (!GenerateText(stmt, icol))
+        return SetError(stmt, "HY001", "Memory allocation error");
+
+    SQLLEN charsize   = (TargetType == SQL_C_WCHAR) ? (SQLLEN)sizeof(SQLWCHAR) : 1;
+    SQLLEN terminator = (TargetType == SQL_C_BINARY) ? 0 : charsize;
+    SQLLEN total      = stmt->textlen * charsize;
+    SQLLEN remaining  = total - stmt->gd_offset;
+
+    SQLLEN copy = BufferLength - terminator;
+    if (copy < 0)
+        copy = 0;
+    if (copy > remaining)
+        copy = remaining;
+    copy -= copy % charsize;
+
+    if (TargetValue)
+    {
+        if (TargetType == SQL_C_WCHAR)
+        {
+            const char* src = stmt->text + stmt->gd_offset / charsize;
+            SQLWCHAR* dst = (SQLWCHAR*)TargetValue;
+            for (SQLLEN i = 0; i < copy / charsize; i++)
+                dst[i] = (SQLWCHAR)(unsigned char)src[i];
+            if (terminator && BufferLength >= copy + terminator)
+                dst[copy / charsize] = 0;
+        }
+        else
+        {
+            memcpy(TargetValue, stmt->text + stmt->gd_offset, copy);
+            if (terminator && BufferLength >= copy + terminator)
+                ((char*)TargetValue)[copy] = 0;
+        }
+    }
+
+    if (StrLen_or_Ind)
+        *StrLen_or_Ind = remaining;
+
+    if (copy < remaining)
+    {
+        stmt->gd_offset += copy;
+        return SetDiag(stmt, SQL_SUCCESS_WITH_INFO, "01004", "String data, right truncated");
+    }
+
+    stmt->gd_offset = -1;
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLGetData(SQLHSTMT StatementHandle, SQLUSMALLINT ColumnNumber, SQLSMALLINT TargetType, SQLPOINTER TargetValue,
+                             SQLLEN BufferLength, SQLLEN* StrLen_or_Ind)
+{
+    Stmt* stmt = (Stmt*)StatementHandle;
+    ClearDiag(stmt);
+
+    if (!stmt->open || stmt->row < 0 || stmt->row >= stmt->rows)
+        return SetError(stmt, "24000", "Invalid cursor state");
+
+    Column* col = GetColumn(stmt, ColumnNumber);
+    if (!col)
+        return SQL_ERROR;
+
+    int icol = ColumnNumber - 1;
+
+    if (stmt->gd_col != ColumnNumber)
+    {
+        stmt->gd_col    = ColumnNumber;
+        stmt->gd_offset = 0;
+    }
+    else if (stmt->gd_offset < 0)
+    {
+        return SQL_NO_DATA;
+    }
+
+    if (col->kind == KIND_NULL)
+    {
+        if (!StrLen_or_Ind)
+            return SetError(stmt, "22002", "Indicator variable required but not supplied");
+        *StrLen_or_Ind = SQL_NULL_DATA;
+        stmt->gd_offset = -1;
+        return SQL_SUCCESS;
+    }
+
+    if (TargetType == SQL_C_DEFAULT)
+    {
+        switch (col->kind)
+        {
+        case KIND_INTEGER:   TargetType = SQL_C_SBIGINT;        break;
+        case KIND_DOUBLE:    TargetType = SQL_C_DOUBLE;         break;
+        case KIND_WCHAR:     TargetType = SQL_C_WCHAR;          break;
+        case KIND_BINARY:    TargetType = SQL_C_BINARY;         break;
+        case KIND_DATE:      TargetType = SQL_C_TYPE_DATE;      break;
+        case KIND_TIME:      TargetType = SQL_C_TYPE_TIME;      break;
+        case KIND_TIMESTAMP: TargetType = SQL_C_TYPE_TIMESTAMP; break;
+        default:             TargetType = SQL_C_CHAR;           break;
+        }
+    }
+
+    if (TargetType == SQL_C_CHAR || TargetType == SQL_C_WCHAR || TargetType == SQL_C_BINARY)
+        return GetText(stmt, icol, TargetType, TargetValue, BufferLength, StrLen_or_Ind);
+
+    // The remaining types are fixed length and returned all at once.
+    stmt->gd_offset = -1;
+
+    SQLLEN cb = 0;
+
+    if (TargetType == SQL_C_TYPE_DATE || TargetType == SQL_C_TYPE_TIME || TargetType == SQL_C_TYPE_TIMESTAMP ||
+        TargetType == SQL_C_DATE || TargetType == SQL_C_TIME || TargetType == SQL_C_TIMESTAMP)
+    {
+        if (col->kind != KIND_DATE && col->kind != KIND_TIME && col->kind != KIND_TIMESTAMP)
+            return SetError(stmt, "07006", "Restricted data type attribute violation");
+
+        TIMESTAMP_STRUCT ts;
+        TemporalValue(stmt, icol, ts);
+        if (col->kind == KIND_DATE)
+        {
+            ts.hour     = 0;
+            ts.minute   = 0;
+            ts.second   = 0;
+            ts.fraction = 0;
+        }
+        else if (col->kind == KIND_TIME)
+        {
+            ts.year     = 1900;
+            ts.month    = 1;
+            ts.day      = 1;
+            ts.fraction = 0;
+        }
+
+        if (TargetType == SQL_C_TYPE_DATE || TargetType == SQL_C_DATE)
+        {
+            DATE_STRUCT* d = (DATE_STRUCT*)TargetValue;
+            d->year  = ts.year;
+            d->month = ts.month;
+            d->day   = ts.day;
+            cb = sizeof(DATE_STRUCT);
+        }
+        else if (TargetType == SQL_C_TYPE_TIME || TargetType == SQL_C_TIME)
+        {
+            TIME_STRUCT* t = (TIME_STRUCT*)TargetValue;
+            t->hour   = ts.hour;
+            t->minute = ts.minute;
+            t->second = ts.second;
+            cb = sizeof(TIME_STRUCT);
+        }
+        else
+        {
+            *(TIMESTAMP_STRUCT*)TargetValue = ts;
+            cb = sizeof(TIMESTAMP_STRUCT);
+        }
+    }
+    else
+    {
+        if (col->kind == KIND_DATE || col->kind == KIND_TIME || col->kind == KIND_TIMESTAMP)
+            return SetError(stmt, "07006", "Restricted data type attribute violation");
+
+        // Numbers are converted from the integer value, or from the text for doubles, decimals, and strings.
+        SQLBIGINT n = 0;
+        double d = 0;
+        if (col->kind == KIND_INTEGER)
+        {
+            n = IntegerValue(stmt, icol);
+            d = (double)n;
+        }
+        else
+        {
+            if (!GenerateText(stmt, icol))
+                return SetError(stmt, "HY001", "Memory allocation error");
+            d = strtod(stmt->text, 0);
+            n = (SQLBIGINT)d;
+        }
+
+        switch (TargetType)
+        {
+        case SQL_C_LONG:
+        case SQL_C_SLONG:
+        case SQL_C_ULONG:
+            *(SQLINTEGER*)TargetValue = (SQLINTEGER)n;
+            cb = sizeof(SQLINTEGER);
+            break;
+
+        case SQL_C_SHORT:
+        case SQL_C_SSHORT:
+        case SQL_C_USHORT:
+            *(SQLSMALLINT*)TargetValue = (SQLSMALLINT)n;
+            cb = sizeof(SQLSMALLINT);
+            break;
+
+        case SQL_C_SBIGINT:
+        case SQL_C_UBIGINT:
+            *(SQLBIGINT*)TargetValue = n;
+            cb = sizeof(SQLBIGINT);
+            break;
+
+        case SQL_C_BIT:
+        case SQL_C_TINYINT:
+        case SQL_C_STINYINT:
+        case SQL_C_UTINYINT:
+            *(SQLCHAR*)TargetValue = (SQLCHAR)n;
+            cb = sizeof(SQLCHAR);
+            break;
+
+        case SQL_C_DOUBLE:
+            *(SQLDOUBLE*)TargetValue = d;
+            cb = sizeof(SQLDOUBLE);
+            break;
+
+        case SQL_C_FLOAT:
+            *(SQLREAL*)TargetValue = (SQLREAL)d;
+            cb = sizeof(SQLREAL);
+            break;
+
+        default:
+            return SetError(stmt, "HYC00", "Optional feature not implemented");
+        }
+    }
+
+    if (StrLen_or_Ind)
+        *StrLen_or_Ind = cb;
+
+    return SQL_SUCCESS;
+}
+
+//
+// Diagnostics
+//
+
+SQLRETURN SQL_API SQLGetDiagRec(SQLSMALLINT HandleType, SQLHANDLE Handle, SQLSMALLINT RecNumber, SQLCHAR* Sqlstate,
+                                SQLINTEGER* NativeError, SQLCHAR* MessageText, SQLSMALLINT BufferLength, SQLSMALLINT* TextLength)
+{
+    ::Handle* h = (::Handle*)Handle;
+    if (!h || RecNumber != 1 || !h->sqlstate[0])
+        return SQL_NO_DATA;
+
+    if (Sqlstate)
+        memcpy(Sqlstate, h->sqlstate, 6);
+    if (NativeError)
+        *NativeError = 0;
+
+    // Don't use CopyString, which would replace this handle's diagnostics if the message were truncated.
+    SQLSMALLINT len = (SQLSMALLINT)strlen(h->message);
+    if (TextLength)
+        *TextLength = len;
+    if (!MessageText || BufferLength <= 0)
+        return SQL_SUCCESS_WITH_INFO;
+    if (len < BufferLength)
+    {
+        memcpy(MessageText, h->message, len + 1);
+        return SQL_SUCCESS;
+    }
+    memcpy(MessageText, h->message, BufferLength - 1);
+    MessageText[BufferLength - 1] = 0;
+    return SQL_SUCCESS_WITH_INFO;
+}
+
+SQLRETURN SQL_API SQLGetDiagField(SQLSMALLINT HandleType, SQLHANDLE Handle, SQLSMALLINT RecNumber, SQLSMALLINT DiagIdentifier,
+                                  SQLPOINTER DiagInfo, SQLSMALLINT BufferLength, SQLSMALLINT* StringLength)
+{
+    ::Handle* h = (::Handle*)Handle;
+    if (!h)
+        return SQL_INVALID_HANDLE;
+
+    if (DiagIdentifier == SQL_DIAG_NUMBER)
+    {
+        *(SQLINTEGER*)DiagInfo = h->sqlstate[0] ? 1 : 0;
+        return SQL_SUCCESS;
+    }
+
+    if (RecNumber != 1 || !h->sqlstate[0])
+        return SQL_NO_DATA;
+
+    switch (DiagIdentifier)
+    {
+    case SQL_DIAG_SQLSTATE:
+        return CopyStringS(h, h->sqlstate, DiagInfo, BufferLength, StringLength);
+
+    case SQL_DIAG_NATIVE:
+        *(SQLINTEGER*)DiagInfo = 0;
+        return SQL_SUCCESS;
+    }
+
+    return SQL_ERROR;
+}